@@ -6,8 +6,14 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPath.h"
+#include "include/private/SkArenaAlloc.h"
+#include "include/utils/SkRandom.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkScan.h"
 #include "tools/ToolUtils.h"
 
 enum Align {
@@ -82,3 +88,76 @@ DEF_BENCH( return new BigPathBench(kRight_Align,    false); )
 DEF_BENCH( return new BigPathBench(kLeft_Align,     true); )
 DEF_BENCH( return new BigPathBench(kMiddle_Align,   true); )
 DEF_BENCH( return new BigPathBench(kRight_Align,    true); )
+
+// Fills one self-intersecting polygon with more and more edges, like a detailed map feature,
+// with our usual choice of AAA or SAA, then with sparse strips.  Where the two lines cross is
+// where sparse strips start to win.  Both scan convert straight into a bitmap of our own, so
+// neither depends on how the canvas would pick a filler.
+class ComplexPathFillBench : public Benchmark {
+    SkPath                fPath;
+    SkString              fName;
+    int                   fPoints;
+    bool                  fSparse;
+    SkBitmap              fBitmap;
+    SkSTArenaAlloc<2048>  fAlloc;
+    SkBlitter*            fBlitter = nullptr;
+
+public:
+    ComplexPathFillBench(int points, bool sparse) : fPoints(points), fSparse(sparse) {
+        fName.printf("path_fill_complex_%d_%s", points, sparse ? "sparse" : "default");
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        fBitmap.allocN32Pixels(640, 480);
+        fBitmap.eraseColor(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        fBlitter = SkBlitter::Choose(fBitmap.pixmap(), SkMatrix::I(), paint, &fAlloc);
+
+        // A random walk, so edges are short and most scanlines cross many of them.
+        SkRandom rand;
+        SkPoint p = { 320, 240 };
+        fPath.moveTo(p);
+        for (int i = 1; i < fPoints; i++) {
+            p.offset(rand.nextRangeF(-12, 12), rand.nextRangeF(-12, 12));
+            p.set(SkTPin(p.fX, 0.0f, 640.0f), SkTPin(p.fY, 0.0f, 480.0f));
+            fPath.lineTo(p);
+        }
+        fPath.close();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkIRect bounds = SkIRect::MakeWH(fBitmap.width(), fBitmap.height());
+        const SkRasterClip clip(bounds);
+        for (int i = 0; i < loops; i++) {
+            if (fSparse) {
+                SkScan::SparseStripFillPath(fPath, fBlitter, fPath.getBounds().roundOut(),
+                                            bounds, false);
+            } else {
+                SkScan::AntiFillPath(fPath, clip, fBlitter);
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+#define COMPLEX_PATH_FILL_BENCH(points) \
+    DEF_BENCH( return new ComplexPathFillBench(points, false); ) \
+    DEF_BENCH( return new ComplexPathFillBench(points, true);  )
+
+COMPLEX_PATH_FILL_BENCH(256)
+COMPLEX_PATH_FILL_BENCH(1024)
+COMPLEX_PATH_FILL_BENCH(4096)
+COMPLEX_PATH_FILL_BENCH(16384)
+COMPLEX_PATH_FILL_BENCH(65536)
@@ -7,16 +7,23 @@
 
 #include "bench/BitmapRegionDecoderBench.h"
 #include "bench/CodecBenchPriv.h"
+#include "include/codec/SkAndroidCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkColorPriv.h"
+#include "include/encode/SkPngEncoder.h"
+#include "include/utils/SkRandom.h"
+#include "src/android/SkBitmapRegionCodec.h"
+#include "src/codec/SkPngCodec.h"
 #include "src/core/SkOSFile.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
-        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
+        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset, bool indexPng)
     : fBRD(nullptr)
     , fData(SkRef(encoded))
     , fColorType(colorType)
     , fSampleSize(sampleSize)
     , fSubset(subset)
+    , fIndexPng(indexPng)
 {
     // Choose a useful name for the color type
     const char* colorName = color_type_to_str(colorType);
@@ -25,6 +32,9 @@ BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData*
     if (1 != sampleSize) {
         fName.appendf("_%.3f", 1.0f / (float) sampleSize);
     }
+    if (fIndexPng) {
+        fName.append("_indexed");
+    }
 }
 
 const char* BitmapRegionDecoderBench::onGetName() {
@@ -36,6 +46,15 @@ bool BitmapRegionDecoderBench::isSuitableFor(Backend backend) {
 }
 
 void BitmapRegionDecoderBench::onDelayedSetup() {
+    if (fIndexPng) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(fData);
+        if (codec && SkEncodedImageFormat::kPNG == codec->getEncodedFormat()) {
+            static_cast<SkPngCodec*>(codec.get())->buildIndex();
+            fBRD.reset(new SkBitmapRegionCodec(
+                    SkAndroidCodec::MakeFromCodec(std::move(codec)).release()));
+            return;
+        }
+    }
     fBRD.reset(SkBitmapRegionDecoder::Create(fData, SkBitmapRegionDecoder::kAndroidCodec_Strategy));
 }
 
@@ -47,3 +66,36 @@ void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
         SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
     }
 }
+
+// A tall PNG, so the cost of a tile at the bottom is easy to tell apart from one at the top.
+static SkData* tall_png() {
+    static SkData* gData = []{
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::MakeN32(512, 8192, kOpaque_SkAlphaType));
+        SkRandom rand;
+        for (int y = 0; y < bm.height(); y++) {
+            uint32_t* row = bm.getAddr32(0, y);
+            for (int x = 0; x < bm.width(); x++) {
+                // Smooth gradients with a little noise, which deflate handles moderately well.
+                const U8CPU noise = rand.nextU() & 15;
+                row[x] = SkPackARGB32(0xFF, (x / 2 + noise) & 0xFF, (y / 32 + noise) & 0xFF,
+                                      ((x + y) / 4) & 0xFF);
+            }
+        }
+        SkDynamicMemoryWStream stream;
+        SkAssertResult(SkPngEncoder::Encode(&stream, bm.pixmap(), SkPngEncoder::Options()));
+        return stream.detachAsData().release();
+    }();
+    return gData;
+}
+
+#define TALL_PNG_BENCH(name, y, index)                                                         \
+    DEF_BENCH(return new BitmapRegionDecoderBench(name, tall_png(), kN32_SkColorType, 1,        \
+                                                  SkIRect::MakeXYWH(0, y, 512, 512), index))
+
+TALL_PNG_BENCH("tallpng_Top",    0,    false);
+TALL_PNG_BENCH("tallpng_Middle", 3840, false);
+TALL_PNG_BENCH("tallpng_Bottom", 7680, false);
+TALL_PNG_BENCH("tallpng_Top",    0,    true);
+TALL_PNG_BENCH("tallpng_Middle", 3840, true);
+TALL_PNG_BENCH("tallpng_Bottom", 7680, true);
@@ -20,12 +20,15 @@
  *
  *  nanobench.cpp handles creating benchmarks for interesting scaled subsets.  We strive to test
  *  on real use cases.
+ *
+ *  If indexPng is true and the image is a PNG, an SkPngIndex is built before timing, so subsets
+ *  are decoded from the nearest checkpoint rather than from the top of the image.
  */
 class BitmapRegionDecoderBench : public Benchmark {
 public:
     // Calls encoded->ref()
     BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
-            uint32_t sampleSize, const SkIRect& subset);
+            uint32_t sampleSize, const SkIRect& subset, bool indexPng = false);
 
 protected:
     const char* onGetName() override;
@@ -40,6 +43,7 @@ private:
     const SkColorType                              fColorType;
     const uint32_t                                 fSampleSize;
     const SkIRect                                  fSubset;
+    const bool                                     fIndexPng;
     typedef Benchmark INHERITED;
 };
 #endif // BitmapRegionDecoderBench_DEFINED
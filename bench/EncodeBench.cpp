@@ -7,6 +7,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -22,10 +23,12 @@
 class EncodeBench : public Benchmark {
 public:
     using Encoder = bool (*)(SkWStream*, const SkPixmap&);
-    EncodeBench(const char* filename, Encoder encoder, const char* encoderName)
+    EncodeBench(const char* filename, Encoder encoder, const char* encoderName,
+                bool reportSize = false)
         : fSourceFilename(filename)
         , fEncoder(encoder)
-        , fName(SkStringPrintf("Encode_%s_%s", filename, encoderName)) {}
+        , fName(SkStringPrintf("Encode_%s_%s", filename, encoderName))
+        , fReportSize(reportSize) {}
 
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
 
@@ -33,6 +36,11 @@ public:
 
     void onDelayedSetup() override {
         SkAssertResult(GetResourceAsBitmap(fSourceFilename, &fBitmap));
+        if (fReportSize) {
+            SkNullWStream dst;
+            SkAssertResult(fEncoder(&dst, fBitmap.pixmap()));
+            SkDebugf("%s: %zu bytes\n", fName.c_str(), dst.bytesWritten());
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
@@ -49,6 +57,7 @@ private:
     const char* fSourceFilename;
     Encoder     fEncoder;
     SkString    fName;
+    bool        fReportSize;
     SkBitmap    fBitmap;
 };
 
@@ -72,19 +81,29 @@ static bool encode_webp_lossless(SkWStream* dst, const SkPixmap& src) {
     return SkWebpEncoder::Encode(dst, src, opts);
 }
 
+static SkExecutor* band_executor() {
+    static SkExecutor* executor = SkExecutor::MakeFIFOThreadPool().release();
+    return executor;
+}
+
 static bool encode_png(SkWStream* dst,
                        const SkPixmap& src,
                        SkPngEncoder::FilterFlag filters,
-                       int zlibLevel) {
+                       int zlibLevel,
+                       bool banded = false) {
     SkPngEncoder::Options opts;
     opts.fFilterFlags = filters;
     opts.fZLibLevel = zlibLevel;
+    opts.fExecutor = banded ? band_executor() : nullptr;
     return SkPngEncoder::Encode(dst, src, opts);
 }
 
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
+#define PNG_BANDED(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL, true); }
+
 static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
@@ -122,4 +141,14 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+// Compare with PNG, PNG_1 and PNG_6s above.  Each band is compressed on its own, which costs some
+// size, so these also print how many bytes they write.
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_BANDED(kAll, 6), "PNG_banded", true));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_BANDED(kAll, 1), "PNG_1_banded", true));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_BANDED(kSub, 6), "PNG_6s_banded", true));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_BANDED(kAll, 6), "PNG_banded", true));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_BANDED(kAll, 1), "PNG_1_banded", true));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_BANDED(kSub, 6), "PNG_6s_banded", true));
+
+#undef PNG_BANDED
 #undef PNG
@@ -6,7 +6,9 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +74,57 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Several threads finding entries in the global cache at once, the way raster threads drawing the
+// same images do.
+class ImageCacheContentionBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500
+    };
+    const int                   fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkString                    fName;
+
+public:
+    ImageCacheContentionBench(int threads) : fThreads(threads) {
+        fName.printf("imagecache_contention_%d", threads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        // Other users of the global cache may have purged these, so add them before each run.
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            SkResourceCache::Add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup(*fExecutor).batch(fThreads, [loops](int thread) {
+            for (int i = 0; i < loops; ++i) {
+                TestKey key((i * 7 + thread) % CACHE_COUNT);
+                SkResourceCache::Find(key, TestRec::Visitor, nullptr);
+            }
+        });
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ImageCacheContentionBench(1); )
+DEF_BENCH( return new ImageCacheContentionBench(4); )
+DEF_BENCH( return new ImageCacheContentionBench(8); )
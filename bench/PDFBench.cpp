@@ -7,6 +7,8 @@
 
 #include "bench/Benchmark.h"
 
+#include "include/core/SkAnnotation.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
@@ -301,6 +303,48 @@ struct PDFClipPathBenchmark : public Benchmark {
     }
 };
 
+// Many pages of small objects: a graphic state and a link annotation per rectangle.
+static void small_objects_pdf(SkDocument* doc) {
+    sk_sp<SkData> url = SkData::MakeWithCString("https://skia.org");
+    for (int page = 0; page < 20; ++page) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        for (int i = 0; i < 50; ++i) {
+            SkRect rect = SkRect::MakeXYWH(12.0f * i, 15.0f * i, 12, 15);
+            SkPaint paint;
+            paint.setAlpha(SkToU8(5 * i + page));
+            canvas->drawRect(rect, paint);
+            SkAnnotateRectWithURL(canvas, rect, url.get());
+        }
+        doc->endPage();
+    }
+    doc->close();
+}
+
+struct PDFObjectStreamsBench : public Benchmark {
+    bool fObjectStreams;
+    PDFObjectStreamsBench(bool objectStreams) : fObjectStreams(objectStreams) {}
+    const char* onGetName() override {
+        return fObjectStreams ? "PDFSmallObjects_objectStreams" : "PDFSmallObjects_xrefTable";
+    }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        SkNullWStream wStream;
+        small_objects_pdf(this->makeDocument(&wStream).get());
+        SkDebugf("%s: %zu bytes\n", this->onGetName(), wStream.bytesWritten());
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            small_objects_pdf(this->makeDocument(&wStream).get());
+        }
+    }
+    sk_sp<SkDocument> makeDocument(SkWStream* wStream) {
+        SkPDF::Metadata metadata;
+        metadata.fObjectStreams = fObjectStreams;
+        return SkPDF::MakeDocument(wStream, metadata);
+    }
+};
+
 }  // namespace
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
@@ -309,6 +353,8 @@ DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
 DEF_BENCH(return new PDFClipPathBenchmark;)
+DEF_BENCH(return new PDFObjectStreamsBench(false);)
+DEF_BENCH(return new PDFObjectStreamsBench(true);)
 
 #ifdef SK_PDF_ENABLE_SLOW_TESTS
 #include "include/core/SkExecutor.h"
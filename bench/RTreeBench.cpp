@@ -95,6 +95,63 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Time how long it takes to find what intersects every tile of a grid, as tiled playback does,
+// either one tile at a time or all tiles in one batch.
+class RTreeTileQueryBench : public Benchmark {
+public:
+    RTreeTileQueryBench(const char* name, MakeRectProc proc, bool batch)
+        : fProc(proc), fBatch(batch) {
+        fName.printf("rtree_%s_tiles%s", name, batch ? "_batch" : "");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+protected:
+    enum { kTilesPerSide = 16 };
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+    void onDelayedSetup() override {
+        SkRandom rand;
+        SkAutoTMalloc<SkRect> rects(NUM_QUERY_RECTS);
+        for (int i = 0; i < NUM_QUERY_RECTS; ++i) {
+            rects[i] = fProc(rand, i, NUM_QUERY_RECTS);
+        }
+        fTree.insert(rects.get(), NUM_QUERY_RECTS);
+
+        const SkScalar tileSize = GENERATE_EXTENTS / kTilesPerSide;
+        for (int y = 0; y < kTilesPerSide; ++y) {
+            for (int x = 0; x < kTilesPerSide; ++x) {
+                fTiles[y * kTilesPerSide + x] =
+                        SkRect::MakeXYWH(x * tileSize, y * tileSize, tileSize, tileSize);
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const int kTiles = kTilesPerSide * kTilesPerSide;
+        for (int i = 0; i < loops; ++i) {
+            SkTDArray<int> hits[kTiles];
+            if (fBatch) {
+                fTree.search(fTiles, kTiles, hits);
+            } else {
+                for (int j = 0; j < kTiles; ++j) {
+                    fTree.search(fTiles[j], &hits[j]);
+                }
+            }
+        }
+    }
+private:
+    SkRTree fTree;
+    SkRect fTiles[kTilesPerSide * kTilesPerSide];
+    MakeRectProc fProc;
+    bool fBatch;
+    SkString fName;
+    typedef Benchmark INHERITED;
+};
+
 static inline SkRect make_XYordered_rects(SkRandom& rand, int index, int numRects) {
     SkRect out;
     out.fLeft   = SkIntToScalar(index % GRID_WIDTH);
@@ -136,3 +193,8 @@ DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeTileQueryBench("random", &make_random_rects, false));
+DEF_BENCH(return new RTreeTileQueryBench("random", &make_random_rects, true));
+DEF_BENCH(return new RTreeTileQueryBench("concentric", &make_concentric_rects, false));
+DEF_BENCH(return new RTreeTileQueryBench("concentric", &make_concentric_rects, true));
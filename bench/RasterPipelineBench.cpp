@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/private/SkArenaAlloc.h"
+#include "include/private/SkHalf.h"
+#include "include/private/SkTemplates.h"
+#include "src/core/SkRasterPipeline.h"
+
+// These run whichever SkRasterPipeline stages SkOpts picked for this CPU.  To compare our
+// SIMD tiers on one machine, run them again from a build with SK_CPU_LIMIT_AVX2 (or _SSE41).
+//
+// Like the SwizzleBenchs, K is a non-power-of-two so each row has a tail to finish up.
+static const int K = 1023;
+
+// SrcOver, loading and storing K pixels in any of several formats.
+class RasterPipelineSrcOverBench : public Benchmark {
+public:
+    explicit RasterPipelineSrcOverBench(SkColorType ct) : fColorType(ct) {
+        switch (ct) {
+            case kRGBA_8888_SkColorType: fName = "SkRasterPipeline_srcover_8888"; break;
+            case kRGBA_F16_SkColorType:  fName = "SkRasterPipeline_srcover_f16";  break;
+            case kRGBA_F32_SkColorType:  fName = "SkRasterPipeline_srcover_f32";  break;
+            default: SkASSERT(false);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName; }
+
+    void onDelayedSetup() override {
+        const int bpp = SkColorTypeBytesPerPixel(fColorType);
+        fSrcPixels.reset(K*bpp);
+        fDstPixels.reset(K*bpp);
+
+        // Half-transparent gray and opaque white, so srcover does real work.
+        for (int i = 0; i < K; i++) {
+            switch (fColorType) {
+                case kRGBA_8888_SkColorType:
+                    ((uint32_t*)fSrcPixels.get())[i] = 0x80404040;
+                    ((uint32_t*)fDstPixels.get())[i] = 0xffffffff;
+                    break;
+                case kRGBA_F16_SkColorType:
+                    for (int j = 0; j < 4; j++) {
+                        ((uint16_t*)fSrcPixels.get())[4*i+j] = SkFloatToHalf(0.5f);
+                        ((uint16_t*)fDstPixels.get())[4*i+j] = SkFloatToHalf(1.0f);
+                    }
+                    break;
+                case kRGBA_F32_SkColorType:
+                    for (int j = 0; j < 4; j++) {
+                        ((float*)fSrcPixels.get())[4*i+j] = 0.5f;
+                        ((float*)fDstPixels.get())[4*i+j] = 1.0f;
+                    }
+                    break;
+                default: SkASSERT(false);
+            }
+        }
+        fSrc = { fSrcPixels.get(), K };
+        fDst = { fDstPixels.get(), K };
+
+        fPipeline.append_load_dst(fColorType, &fDst);
+        fPipeline.append_load    (fColorType, &fSrc);
+        fPipeline.append(SkRasterPipeline::srcover);
+        fPipeline.append_store   (fColorType, &fDst);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fPipeline.run(0,0,K,1);
+        }
+    }
+
+private:
+    SkColorType                 fColorType;
+    const char*                 fName;
+    SkAutoTMalloc<char>         fSrcPixels,
+                                fDstPixels;
+    SkRasterPipeline_MemoryCtx  fSrc,
+                                fDst;
+    SkRasterPipeline_<256>      fPipeline;
+};
+DEF_BENCH( return new RasterPipelineSrcOverBench(kRGBA_8888_SkColorType); )
+DEF_BENCH( return new RasterPipelineSrcOverBench(kRGBA_F16_SkColorType);  )
+DEF_BENCH( return new RasterPipelineSrcOverBench(kRGBA_F32_SkColorType);  )
+
+// Bilinear sampling of a scaled 8888 image, as SkImageShader would draw it.
+// The clamp/clamp version uses the fused bilerp_clamp_8888 stage, which runs in lowp;
+// the repeat/repeat version is a long chain of highp float stages with many gathers.
+class RasterPipelineBilerpBench : public Benchmark {
+public:
+    explicit RasterPipelineBilerpBench(bool clamp) : fClamp(clamp) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override {
+        return fClamp ? "SkRasterPipeline_bilerp_clamp_8888"
+                      : "SkRasterPipeline_bilerp_repeat_8888";
+    }
+
+    void onDelayedSetup() override {
+        static const int kImageSize = 256;
+        fImage.reset(kImageSize*kImageSize);
+        for (int i = 0; i < kImageSize*kImageSize; i++) {
+            fImage[i] = (i & 1) ? 0xff00ff00 : 0xffff00ff;
+        }
+        fDstPixels.reset(K);
+
+        fGather = { fImage.get(), kImageSize, kImageSize, kImageSize };
+        fLimit  = { kImageSize, 1.0f / kImageSize };
+        fDst    = { fDstPixels.get(), K };
+
+        fPipeline.append(SkRasterPipeline::seed_shader);
+        fPipeline.append_matrix(&fAlloc, SkMatrix::MakeAll(0.37f,0.11f,3.5f,
+                                                            0.07f,0.37f,1.5f,
+                                                            0    ,0    ,1   ));
+        if (fClamp) {
+            fPipeline.append(SkRasterPipeline::bilerp_clamp_8888, &fGather);
+        } else {
+            fPipeline.append(SkRasterPipeline::save_xy, &fSampler);
+            auto sample = [this](SkRasterPipeline::StockStage setup_x,
+                                 SkRasterPipeline::StockStage setup_y) {
+                fPipeline.append(setup_x, &fSampler);
+                fPipeline.append(setup_y, &fSampler);
+                fPipeline.append(SkRasterPipeline::repeat_x, &fLimit);
+                fPipeline.append(SkRasterPipeline::repeat_y, &fLimit);
+                fPipeline.append(SkRasterPipeline::gather_8888, &fGather);
+                fPipeline.append(SkRasterPipeline::accumulate, &fSampler);
+            };
+            sample(SkRasterPipeline::bilinear_nx, SkRasterPipeline::bilinear_ny);
+            sample(SkRasterPipeline::bilinear_px, SkRasterPipeline::bilinear_ny);
+            sample(SkRasterPipeline::bilinear_nx, SkRasterPipeline::bilinear_py);
+            sample(SkRasterPipeline::bilinear_px, SkRasterPipeline::bilinear_py);
+            fPipeline.append(SkRasterPipeline::move_dst_src);
+        }
+        fPipeline.append(SkRasterPipeline::store_8888, &fDst);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fPipeline.run(0,0,K,1);
+        }
+    }
+
+private:
+    bool                          fClamp;
+    SkAutoTMalloc<uint32_t>       fImage,
+                                  fDstPixels;
+    SkRasterPipeline_GatherCtx    fGather;
+    SkRasterPipeline_TileCtx      fLimit;
+    SkRasterPipeline_SamplerCtx   fSampler;
+    SkRasterPipeline_MemoryCtx    fDst;
+    SkSTArenaAlloc<256>           fAlloc;
+    SkRasterPipeline_<256>        fPipeline;
+};
+DEF_BENCH( return new RasterPipelineBilerpBench(true ); )
+DEF_BENCH( return new RasterPipelineBilerpBench(false); )
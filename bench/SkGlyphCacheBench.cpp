@@ -10,6 +10,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
 #include "src/core/SkStrikeCache.h"
@@ -110,7 +111,71 @@ private:
     SkString fName;
 };
 
+// Like drawing short runs of text: find the strike, then look up a handful of its glyphs.
+static void do_text_runs(SkFont* font) {
+    SkPaint defaultPaint;
+    for (SkScalar size : {10, 12, 14, 18}) {
+        font->setSize(size);
+        for (int run = 0; run < 16; run++) {
+            auto cache = SkStrikeCache::FindOrCreateStrikeExclusive(
+                    *font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I());
+            for (int c = 'a' + run; c < 'a' + run + 8; c++) {
+                const SkGlyph& g = cache->getGlyphIDMetrics(font->unicharToGlyph(c));
+                cache->findImage(g);
+            }
+        }
+    }
+}
+
+// Many threads drawing text with the same few fonts, as when rasterizing many documents at once.
+class SkGlyphCacheMultiThread : public Benchmark {
+public:
+    explicit SkGlyphCacheMultiThread(int threads) : fThreads(threads) { }
+
+protected:
+    const char* onGetName() override {
+        fName.printf("SkGlyphCacheMultiThread%d", fThreads);
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        fTypefaces[0] = ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+        fTypefaces[1] = ToolUtils::create_portable_typeface("sans-serif", SkFontStyle::Italic());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup(*fExecutor).batch(fThreads, [&](int threadIndex) {
+            SkFont font;
+            font.setEdging(SkFont::Edging::kAntiAlias);
+            font.setSubpixel(true);
+            font.setTypeface(fTypefaces[threadIndex % 2]);
+            for (int work = 0; work < loops; work++) {
+                do_text_runs(&font);
+            }
+        });
+    }
+
+private:
+    typedef Benchmark INHERITED;
+    const int                   fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkTypeface>           fTypefaces[2];
+    SkString                    fName;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(1); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(2); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(4); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(8); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(16); )
+DEF_BENCH( return new SkGlyphCacheMultiThread(32); )
@@ -6,6 +6,7 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkString.h"
 #include "src/core/SkOpts.h"
 
 class SwizzleBench : public Benchmark {
@@ -13,21 +14,52 @@ public:
 
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u32 fn) : fName(name), fFn_u32(fn) {}
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u8  fn) : fName(name), fFn_u8 (fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_index    fn) : fName(name), fFn_idx(fn) {}
 
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
     const char* onGetName() override { return fName; }
     void onDraw(int loops, SkCanvas*) override {
         static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
-        uint32_t dst[K], src[K];
+        uint32_t dst[K], src[K], ctable[16] = {0};
         while (loops --> 0) {
             if (fFn_u32) { fFn_u32(dst,                 src, K); }
             if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*)src, K); }
+            if (fFn_idx) { fFn_idx(dst, (const uint8_t*)src, K, ctable); }
         }
     }
 private:
     const char* fName;
     SkOpts::Swizzle_8888_u32 fFn_u32 = nullptr;
     SkOpts::Swizzle_8888_u8  fFn_u8  = nullptr;
+    SkOpts::Swizzle_index    fFn_idx = nullptr;
+};
+
+// Covers the 8-bit index and 8888 procs, which also take a stride so that they can sample.
+class SampleSwizzleBench : public Benchmark {
+public:
+    SampleSwizzleBench(bool index8, int sampleX) : fIndex8(index8), fSampleX(sampleX) {
+        fName.printf("SkOpts::%s_sample%d", index8 ? "index8_to_8888" : "sample_8888", sampleX);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+    void onDraw(int loops, SkCanvas*) override {
+        static const int K = 1023;
+        uint32_t dst[K], src[K], ctable[256] = {0};
+        const int deltaSrc = fSampleX * (fIndex8 ? 1 : 4),
+                  count    = K / fSampleX;
+        while (loops --> 0) {
+            if (fIndex8) {
+                SkOpts::index8_to_8888(dst, (const uint8_t*)src, count, deltaSrc, ctable);
+            } else {
+                SkOpts::sample_8888(dst, (const uint8_t*)src, count, deltaSrc);
+            }
+        }
+    }
+private:
+    bool     fIndex8;
+    int      fSampleX;
+    SkString fName;
 };
 
 
@@ -41,3 +73,11 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::index1_to_8888", SkOpts::index1_to_8888));
+DEF_BENCH(return new SwizzleBench("SkOpts::index2_to_8888", SkOpts::index2_to_8888));
+DEF_BENCH(return new SwizzleBench("SkOpts::index4_to_8888", SkOpts::index4_to_8888));
+DEF_BENCH(return new SampleSwizzleBench(true,  1));
+DEF_BENCH(return new SampleSwizzleBench(true,  2));
+DEF_BENCH(return new SampleSwizzleBench(true,  4));
+DEF_BENCH(return new SampleSwizzleBench(false, 2));
+DEF_BENCH(return new SampleSwizzleBench(false, 4));
@@ -148,6 +148,11 @@ static DEFINE_bool(dryRun, false,
 static DEFINE_string(images, "",
                      "List of images and/or directories to decode. A directory with no images"
                      " is treated as a fatal error.");
+static DEFINE_string(codecThreads, "",
+                     "Space-separated thread counts.  For each, time decoding JPEGs from --images "
+                     "on a thread pool of that size, and print MP/s.");
+static DEFINE_bool(pngIndex, false,
+                   "Build an SkPngIndex for PNGs before timing BRD subset decodes.");
 static DEFINE_bool(simpleCodec, false,
                    "Runs of a subset of the codec tests, always N32, Premul or Opaque");
 
@@ -644,6 +649,8 @@ public:
                       , fCurrentSVG(0)
                       , fCurrentUseMPD(0)
                       , fCurrentCodec(0)
+                      , fCurrentThreadedCodec(0)
+                      , fCurrentCodecThreads(0)
                       , fCurrentAndroidCodec(0)
                       , fCurrentBRDImage(0)
                       , fCurrentColorType(0)
@@ -667,6 +674,15 @@ public:
             }
         }
 
+        for (int i = 0; i < FLAGS_codecThreads.count(); i++) {
+            if (1 != sscanf(FLAGS_codecThreads[i], "%d", &fCodecThreads.push_back()) ||
+                    fCodecThreads.back() < 1) {
+                SkDebugf("Can't parse %s from --codecThreads as a thread count.\n",
+                         FLAGS_codecThreads[i]);
+                exit(1);
+            }
+        }
+
         if (2 != sscanf(FLAGS_zoom[0], "%f,%lf", &fZoomMax, &fZoomPeriodMs)) {
             SkDebugf("Can't parse %s from --zoom as a zoomMax,zoomPeriodMs.\n", FLAGS_zoom[0]);
             exit(1);
@@ -939,6 +955,28 @@ public:
             fCurrentColorType = 0;
         }
 
+        // Run the JPEG CodecBenches again for each of --codecThreads.
+        for (; fCurrentThreadedCodec < fImages.count(); fCurrentThreadedCodec++) {
+            fSourceType = "image";
+            fBenchType = "skcodec_threads";
+            const SkString& path = fImages[fCurrentThreadedCodec];
+            if (fCodecThreads.empty() || CommandLineFlags::ShouldSkip(FLAGS_match, path.c_str())) {
+                continue;
+            }
+            sk_sp<SkData> encoded(SkData::MakeFromFileName(path.c_str()));
+            std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(encoded));
+            if (!codec || SkEncodedImageFormat::kJPEG != codec->getEncodedFormat()) {
+                continue;
+            }
+
+            if (fCurrentCodecThreads < fCodecThreads.count()) {
+                int threads = fCodecThreads[fCurrentCodecThreads++];
+                return new CodecBench(SkOSPath::Basename(path.c_str()), encoded.get(),
+                                      kN32_SkColorType, kOpaque_SkAlphaType, threads);
+            }
+            fCurrentCodecThreads = 0;
+        }
+
         // Run AndroidCodecBenches
         const int sampleSizes[] = { 2, 4, 8 };
         for (; fCurrentAndroidCodec < fImages.count(); fCurrentAndroidCodec++) {
@@ -1044,7 +1082,7 @@ public:
                         }
 
                         return new BitmapRegionDecoderBench(basename.c_str(), encoded.get(),
-                                colorType, sampleSize, subset);
+                                colorType, sampleSize, subset, FLAGS_pngIndex);
                     }
                     fCurrentSubsetType = 0;
                     fCurrentSampleSize++;
@@ -1073,6 +1111,11 @@ public:
                                  fUseMPDs[fCurrentUseMPD-1] ? "true" : "false");
             }
         }
+        if (0 == strcmp(fBenchType, "skcodec_threads")) {
+            SkASSERT(fCurrentCodecThreads > 0);
+            log.appendString("codec_threads",
+                    SkStringPrintf("%d", fCodecThreads[fCurrentCodecThreads - 1]).c_str());
+        }
     }
 
     void fillCurrentMetrics(NanoJSONResultsWriter& log) const {
@@ -1104,6 +1147,7 @@ private:
     SkTArray<bool>     fUseMPDs;
     SkTArray<SkString> fImages;
     SkTArray<SkColorType, true> fColorTypes;
+    SkTArray<int>      fCodecThreads;
     SkScalar           fZoomMax;
     double             fZoomPeriodMs;
 
@@ -1118,6 +1162,8 @@ private:
     int fCurrentSVG;
     int fCurrentUseMPD;
     int fCurrentCodec;
+    int fCurrentThreadedCodec;
+    int fCurrentCodecThreads;
     int fCurrentAndroidCodec;
     int fCurrentBRDImage;
     int fCurrentColorType;
@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -257,6 +258,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -300,6 +302,14 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may decode parts of the image concurrently on this executor.
+         *
+         *  Currently only JPEGs with restart markers are decoded this way.  Other images, and
+         *  incremental and scanline decodes, ignore this.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -354,8 +364,9 @@ public:
      *                    allocation widths of the Y, U, V, and A planes. Given current codec
      *                    limitations the size of the A plane will always be 0 and the Y, U, V
      *                    channels will always be planar.
-     *  @param colorSpace Output parameter.  If non-NULL this is set to kJPEG,
-     *                    otherwise this is ignored.
+     *  @param colorSpace Output parameter.  If non-NULL this is set to the
+     *                    planes' color space (kJPEG for JPEG, kRec601 for
+     *                    WebP), otherwise this is ignored.
      */
     bool queryYUV8(SkYUVASizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
         if (nullptr == sizeInfo) {
@@ -382,10 +393,15 @@ public:
      *
      *  @param sizeInfo   Needs to exactly match the values returned by the
      *                    query, except the WidthBytes may be larger than the
-     *                    recommendation (but not smaller).
+     *                    recommendation (but not smaller).  WebP also accepts
+     *                    a smaller Y size, with U and V half of it (rounded
+     *                    up), and decodes all three planes scaled down.
      *  @param planes     Memory for each of the Y, U, and V planes.
+     *  @param executor   If not NULL, parts of the planes may be decoded concurrently on it,
+     *                    as with Options::fExecutor.
      */
-    Result getYUV8Planes(const SkYUVASizeInfo& sizeInfo, void* planes[SkYUVASizeInfo::kMaxCount]) {
+    Result getYUV8Planes(const SkYUVASizeInfo& sizeInfo, void* planes[SkYUVASizeInfo::kMaxCount],
+                         SkExecutor* executor = nullptr) {
         if (!planes || !planes[0] || !planes[1] || !planes[2]) {
             return kInvalidInput;
         }
@@ -395,7 +411,7 @@ public:
             return kCouldNotRewind;
         }
 
-        return this->onGetYUV8Planes(sizeInfo, planes);
+        return this->onGetYUV8Planes(sizeInfo, planes, executor);
     }
 
     /**
@@ -738,7 +754,8 @@ protected:
     }
 
     virtual Result onGetYUV8Planes(const SkYUVASizeInfo&,
-                                   void*[SkYUVASizeInfo::kMaxCount] /*planes*/) {
+                                   void*[SkYUVASizeInfo::kMaxCount] /*planes*/,
+                                   SkExecutor*) {
         return kUnimplemented;
     }
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPartialDataStream_DEFINED
+#define SkPartialDataStream_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+
+#include <memory>
+
+/**
+ *  A stream over encoded data that is still arriving, e.g. from the network, for use with
+ *  SkCodec's incremental decoding.
+ *
+ *  The stream owns a single buffer large enough for all of the data. Each call to append()
+ *  copies the new bytes into place once; bytes that have already arrived are never copied
+ *  again. The buffer never moves, so codecs that can read directly from memory (see
+ *  getMemoryBase()) do so rather than buffering the data themselves.
+ *
+ *  Until all of the data has arrived, the stream behaves as if it ends after the last byte
+ *  received: reads return fewer bytes than requested, and getLength() reports the bytes
+ *  received so far. isAtEnd() only returns true once all of the data has arrived.
+ *
+ *  Not thread safe. Do not call append() while a codec is decoding from this stream.
+ */
+class SK_API SkPartialDataStream : public SkStream {
+public:
+    /**
+     *  Create a stream that will hold totalSize bytes. Returns nullptr if the memory cannot
+     *  be allocated.
+     */
+    static std::unique_ptr<SkPartialDataStream> Make(size_t totalSize);
+
+    /**
+     *  Copy size bytes to the end of the data received so far. Returns the number of bytes
+     *  copied, which is less than size if that would be more than totalSize in all.
+     */
+    size_t append(const void* data, size_t size);
+
+    size_t bytesReceived() const { return fReceived; }
+    bool isComplete() const { return fReceived == fData->size(); }
+
+    size_t read(void* buffer, size_t size) override;
+    size_t peek(void* buffer, size_t size) const override;
+    bool isAtEnd() const override;
+
+    bool rewind() override;
+
+    bool hasPosition() const override { return true; }
+    size_t getPosition() const override { return fOffset; }
+    bool seek(size_t position) override;
+    bool move(long offset) override;
+
+    bool hasLength() const override { return true; }
+    size_t getLength() const override { return fReceived; }
+
+    const void* getMemoryBase() override { return fData->data(); }
+
+private:
+    explicit SkPartialDataStream(sk_sp<SkData> data);
+
+    sk_sp<SkData> fData;
+    size_t        fReceived;
+    size_t        fOffset;
+
+    typedef SkStream INHERITED;
+};
+
+#endif // SkPartialDataStream_DEFINED
@@ -131,6 +131,15 @@ public:
     static size_t GetResourceCacheSingleAllocationByteLimit();
     static size_t SetResourceCacheSingleAllocationByteLimit(size_t newLimit);
 
+    /**
+     *  Lets processes on this host share decoded pixels of lazy images, by keeping them as files
+     *  in dir and mapping them into each process.  The files are limited to byteLimit in total.
+     *  Pass nullptr to stop sharing.
+     *
+     *  Returns false if the directory can't be used, or if this platform doesn't support it.
+     */
+    static bool SetSharedImageCacheDirectory(const char dir[], size_t byteLimit);
+
     /**
      *  Dumps memory usage of caches using the SkTraceMemoryDump interface. See SkTraceMemoryDump
      *  for usage of this method.
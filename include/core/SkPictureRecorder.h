@@ -36,6 +36,9 @@ public:
         // If you call drawPicture() or drawDrawable() on the recording canvas, this flag forces
         // that object to playback its contents immediately rather than reffing the object.
         kPlaybackDrawPicture_RecordFlag     = 1 << 0,
+        // Paths drawn or clipped to with the same points, verbs and conic weights share one copy
+        // of that data, and so one generation ID, in the recorded picture.
+        kInternPaths_RecordFlag             = 1 << 1,
     };
 
     enum FinishFlags {
@@ -20,6 +20,7 @@
 
 class SkCanvas;
 class SkDeferredDisplayList;
+class SkExecutor;
 class SkPaint;
 class SkSurfaceCharacterization;
 class GrBackendRenderTarget;
@@ -160,6 +161,31 @@ public:
     static sk_sp<SkSurface> MakeRasterN32Premul(int width, int height,
                                                 const SkSurfaceProps* surfaceProps = nullptr);
 
+    /** Allocates raster SkSurface whose SkCanvas records draws instead of drawing them.
+        Recorded draws are rasterized when the contents are needed (makeImageSnapshot(),
+        readPixels(), peekPixels(), writePixels(), draw(), flush(), notifyContentWillChange(),
+        or SkCanvas::flush()), replaying them concurrently on executor, one task per
+        tileSize by tileSize tile. Output matches MakeRaster() drawn once per tile with
+        SkCanvas::clipRect() set to that tile: geometry that crosses a tile edge is scan
+        converted against the tile's clip, so its edges there may differ slightly from
+        MakeRaster() output. Layers and image filters see content beyond the tile.
+
+        Use for very large surfaces, where a single thread would rasterize every draw.
+        SkCanvas::readPixels() and SkCanvas::writePixels() are not supported by the returned
+        surface's canvas; call the SkSurface methods instead. Snapshots always copy pixels.
+
+        @param imageInfo  width, height, SkColorType, SkAlphaType, SkColorSpace,
+                          of raster surface; width and height must be greater than zero
+        @param executor   runs the tiles; if nullptr, uses SkExecutor::GetDefault()
+        @param tileSize   width and height of each tile; zero selects a default
+        @param props      LCD striping orientation and setting for device independent fonts;
+                          may be nullptr
+        @return           SkSurface if all parameters are valid; otherwise, nullptr
+    */
+    static sk_sp<SkSurface> MakeRasterTiled(const SkImageInfo& imageInfo, SkExecutor* executor,
+                                            int tileSize = 0,
+                                            const SkSurfaceProps* props = nullptr);
+
     /** Caller data passed to RenderTarget/TextureReleaseProc; may be nullptr. */
     typedef void* ReleaseContext;
 
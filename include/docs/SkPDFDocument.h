@@ -5,6 +5,7 @@
 
 #include "include/core/SkDocument.h"
 
+#include "include/core/SkData.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTime.h"
@@ -79,6 +80,21 @@ struct StructureElementNode {
     DocumentStructureType fType;
 };
 
+/** A cache, supplied by the client, that subset font programs are loaded
+    from and stored to.  It may be shared between documents and processes and
+    persisted, e.g. to disk.
+*/
+struct PersistentCache {
+    virtual ~PersistentCache() = default;
+
+    /** Returns the data for the key if it exists in the cache, otherwise
+        returns null.
+    */
+    virtual sk_sp<SkData> load(const SkData& key) = 0;
+
+    virtual void store(const SkData& key, const SkData& data) = 0;
+};
+
 /** Optional metadata to be passed into the PDF factory function.
 */
 struct Metadata {
@@ -160,6 +176,38 @@ struct Metadata {
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** If true and fExecutor is set, each page is recorded into an SkPicture
+        and drawn into the document on the executor while the caller goes on
+        to the next page; content streams are compressed concurrently.  Pages
+        are still drawn one at a time and in order, and objects are written in
+        the order a serial run would write them, so the output is
+        reproducible regardless of the number of threads.  This buffers
+        objects that finish out of order in memory.  Mutable bitmaps are
+        copied when recorded, so each page gets its own copy; draw SkImages
+        or immutable bitmaps to share them between pages.
+
+        Experimental.
+    */
+    bool fConcurrentPages = false;
+
+    /** If true, objects that are not streams are packed into compressed
+        object streams, and the document ends with a cross-reference stream
+        instead of a cross-reference table.  This makes documents with many
+        small objects (graphic states, fonts, annotations, ...) smaller, but
+        requires a PDF 1.5 reader.
+    */
+    bool fObjectStreams = false;
+
+    /** If greater than zero, each page is written out as soon as it ends,
+        and after every fStreamingChunkSize pages the fonts used so far are
+        written out and the document forgets the fonts, graphic states and
+        shaders it has seen.  This keeps the memory used by documents with
+        very many pages from growing with the number of pages, but each chunk
+        of pages gets its own font subsets, so the file is larger.  Images are
+        still shared between all pages.
+    */
+    int fStreamingChunkSize = 0;
+
     /** Preferred Subsetter. Only respected if both are compiled in.
         Experimental.
     */
@@ -167,6 +215,14 @@ struct Metadata {
         kHarfbuzz_Subsetter,
         kSfntly_Subsetter,
     } fSubsetter = kHarfbuzz_Subsetter;
+
+    /** Optional cache of subset fonts.  Keys are digests of the font data,
+        the glyphs used and the subsetter, so they stay valid across
+        processes.  It is only consulted when a subset is not in the
+        process-wide cache (see SetSubsetFontCacheLimit()).  The caller should
+        retain ownership, and it must be safe to call from any thread.
+    */
+    PersistentCache* fSubsetFontCache = nullptr;
 };
 
 /** Associate a node ID with subsequent drawing commands in an
@@ -198,5 +254,25 @@ static inline sk_sp<SkDocument> MakeDocument(SkWStream* stream) {
     return MakeDocument(stream, Metadata());
 }
 
+/** Subset fonts may be kept in a process-wide cache, keyed by typeface and
+    glyphs used, so that documents that use the same glyphs of a typeface
+    reuse the subset instead of running the subsetter again.  A cached subset
+    of a superset of the glyphs is reused too, if it has at most twice as
+    many glyphs, so with the cache enabled the output can depend on
+    documents made before it.
+
+    The least recently used subsets are purged to keep the cache within its
+    byte limit, which is 0 (no caching) by default.  Returns the previous
+    limit.
+*/
+SK_API size_t SetSubsetFontCacheLimit(size_t bytes);
+SK_API size_t GetSubsetFontCacheLimit();
+
+/** Returns the number of bytes used by the process-wide subset font cache.
+*/
+SK_API size_t GetSubsetFontCacheBytesUsed();
+
+SK_API void PurgeSubsetFontCache();
+
 }  // namespace SkPDF
 #endif  // SkPDFDocument_DEFINED
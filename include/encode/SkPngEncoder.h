@@ -11,6 +11,7 @@
 #include "include/core/SkDataTable.h"
 #include "include/encode/SkEncoder.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -59,6 +60,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If set, Encode() splits large images into bands of rows that are filtered and
+         *  compressed concurrently on this executor, then stitched into a single zlib stream.
+         *  Each band starts a new deflate block primed with the end of the band before it,
+         *  so the output is typically only slightly larger than a serial encode.
+         *
+         *  Make() always encodes serially, since it is handed rows incrementally.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
@@ -14,9 +14,25 @@ class SkImage;
 
 class SkAnimCodecPlayer {
 public:
+    /**
+     *  Keeps every frame once it has been decoded.
+     */
     SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec);
+
+    /**
+     *  Keeps at most frameCacheBytes worth of decoded frames.  When over budget, the least
+     *  recently used frames are dropped first, and key frames (those that depend on no other
+     *  frame, plus every kKeyFrameInterval'th frame) only once every other frame is gone.
+     *
+     *  A frame that is not cached is decoded starting from the nearest cached frame it can be
+     *  built on, so seeking costs the number of frames since that frame.
+     */
+    SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec, size_t frameCacheBytes);
+
     ~SkAnimCodecPlayer();
 
+    static constexpr int kKeyFrameInterval = 16;
+
     /**
      *  Returns the current frame of the animation. This defaults to the first frame for
      *  animated codecs (i.e. msec = 0). Calling this multiple times (without calling seek())
@@ -45,15 +61,29 @@ public:
     bool seek(uint32_t msec);
 
 
+    /**
+     *  Returns the number of bytes of decoded frames currently kept by the player.
+     */
+    size_t frameCacheBytesUsed() const { return fCachedBytes; }
+
 private:
     std::unique_ptr<SkCodec>        fCodec;
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
     std::vector<sk_sp<SkImage> >    fImages;
+    std::vector<uint32_t>           fLastUsed;      // Parallel to fImages, for the LRU.
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
+    uint32_t                        fUseCount = 0;
+    size_t                          fCacheBudget;
+    size_t                          fCachedBytes = 0;
 
     sk_sp<SkImage> getFrameAt(int index);
+    sk_sp<SkImage> decodeFrame(int index, int priorIndex, const SkImage* prior);
+    int findPriorFrame(int requiredFrame, int index) const;
+    bool isKeyFrame(int index) const;
+    void cacheFrame(int index, sk_sp<SkImage>);
+    void purgeFrames();
 };
 
 #endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkImageDecodeQueue_DEFINED
+#define SkImageDecodeQueue_DEFINED
+
+#include "include/core/SkImage.h"
+#include "include/core/SkSize.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkNoncopyable.h"
+
+#include <memory>
+#include <vector>
+
+class SkExecutor;
+class SkTaskGroup;
+
+/**
+ *  Decodes lazy images ahead of time on an SkExecutor, so that drawing them later into a raster
+ *  canvas finds their pixels (and optionally their mipmaps) already in the resource cache,
+ *  instead of decoding them on the drawing thread.
+ *
+ *  Images are identified by their uniqueID().  The queue holds a ref on each image until it has
+ *  been decoded or cancelled.  A decode that has already started always runs to completion.
+ */
+class SK_API SkImageDecodeQueue : SkNoncopyable {
+public:
+    /**
+     *  Decodes run as tasks on executor, which must outlive the queue.
+     */
+    explicit SkImageDecodeQueue(SkExecutor* executor);
+
+    /**
+     *  Cancels everything still queued, and waits for decodes that have started to finish.
+     */
+    ~SkImageDecodeQueue();
+
+    /**
+     *  Queues image to be decoded into SkBitmapCache.  Higher priorities are decoded first, and
+     *  requests of equal priority in the order they were made.
+     *
+     *  If drawSize is not empty and is smaller than the image, the mipmaps that a
+     *  kMedium_SkFilterQuality draw at that size would use are built and cached as well.
+     *
+     *  Requesting an image that is already queued updates its priority and drawSize.  Images
+     *  that are not lazily generated are ignored.
+     */
+    void request(sk_sp<SkImage> image, int priority = 0, SkISize drawSize = {0, 0});
+
+    /**
+     *  Changes the priority of an image that is still queued.  Returns false if it is not.
+     */
+    bool setPriority(const SkImage* image, int priority);
+
+    /**
+     *  Removes image from the queue, e.g. because it has scrolled out of view.  Returns false if
+     *  it was not queued, which includes when its decode has already started.
+     */
+    bool cancel(const SkImage* image);
+
+    /**
+     *  Removes every image from the queue.
+     */
+    void cancelAll();
+
+    /**
+     *  Returns the number of images waiting for their decode to start.
+     */
+    int countQueued() const;
+
+    /**
+     *  Blocks until every image queued so far has been decoded or cancelled.
+     */
+    void wait();
+
+private:
+    struct Request {
+        sk_sp<SkImage> fImage;
+        int            fPriority;
+        SkISize        fDrawSize;
+        uint64_t       fOrder;
+    };
+
+    void decodeNext();
+
+    std::unique_ptr<SkTaskGroup> fTaskGroup;
+
+    mutable SkMutex              fMutex;
+    std::vector<Request>         fRequests;
+    uint64_t                     fNextOrder = 0;
+};
+
+#endif
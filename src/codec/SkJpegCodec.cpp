@@ -8,6 +8,7 @@
 #include "src/codec/SkJpegCodec.h"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
@@ -15,8 +16,11 @@
 #include "include/private/SkTo.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
+#include <vector>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "src/codec/SkJpegUtility.h"
@@ -569,6 +573,270 @@ static inline bool needs_swizzler_to_convert_from_cmyk(J_COLOR_SPACE jpegColorTy
     return !hasCMYKColorSpace || !hasColorSpaceXform;
 }
 
+// The entropy coded data of a single scan, sequential, Huffman coded JPEG, split at its restart
+// markers.  Decoding restarts from scratch at each marker, so any run of whole restart intervals
+// can be decoded on its own, given the headers.
+struct RestartIntervals {
+    size_t fHeightOffset = 0;   // Offset of the frame height in the SOF segment.
+    size_t fScanOffset   = 0;   // Offset of the first byte of entropy coded data.
+
+    // [start, end) of each interval's entropy coded data, not including the markers.
+    std::vector<std::pair<size_t, size_t>> fIntervals;
+};
+
+static bool find_restart_intervals(const uint8_t* data, size_t len, RestartIntervals* out) {
+    // Walk the marker segments up to the start of the scan.
+    size_t pos = 2;
+    for (;;) {
+        while (pos + 1 < len && data[pos] == 0xFF && data[pos + 1] == 0xFF) {
+            pos++;   // Fill bytes.
+        }
+        if (pos + 4 > len || data[pos] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[pos + 1];
+        const size_t segmentLen = (data[pos + 2] << 8) | data[pos + 3];
+        if (pos + 2 + segmentLen > len) {
+            return false;
+        }
+        if (marker == 0xC0 || marker == 0xC1) {
+            out->fHeightOffset = pos + 5;
+        } else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+                   marker != 0xCC) {
+            return false;   // Progressive, lossless, or arithmetic coded.
+        } else if (marker == 0xDA) {
+            out->fScanOffset = pos + 2 + segmentLen;
+            break;
+        }
+        pos += 2 + segmentLen;
+    }
+    if (!out->fHeightOffset) {
+        return false;
+    }
+
+    // Split the entropy coded data at RSTn, ending at EOI.  Any other marker means there is
+    // more than one scan, or something we don't understand, so give up.
+    size_t start = out->fScanOffset;
+    for (pos = start; pos + 1 < len; pos++) {
+        if (data[pos] != 0xFF) {
+            continue;
+        }
+        const uint8_t next = data[pos + 1];
+        if (next == 0x00 || next == 0xFF) {
+            pos += next == 0x00;   // A stuffed 0xFF, or a fill byte.
+        } else if (next >= 0xD0 && next <= 0xD7) {
+            out->fIntervals.push_back({start, pos});
+            start = pos + 2;
+            pos++;
+        } else if (next == 0xD9) {
+            out->fIntervals.push_back({start, pos});
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Builds a JPEG for MCU rows that start at intervals[first] and end before intervals[end], with
+// the frame height replaced by height and the restart markers renumbered from RST0.
+static sk_sp<SkData> make_band_jpeg(const uint8_t* data, const RestartIntervals& restarts,
+                                    int first, int end, int height) {
+    size_t size = restarts.fScanOffset + 2 * (end - first);
+    for (int i = first; i < end; i++) {
+        size += restarts.fIntervals[i].second - restarts.fIntervals[i].first;
+    }
+
+    sk_sp<SkData> band = SkData::MakeUninitialized(size);
+    uint8_t* dst = (uint8_t*)band->writable_data();
+    memcpy(dst, data, restarts.fScanOffset);
+    dst[restarts.fHeightOffset + 0] = (uint8_t)(height >> 8);
+    dst[restarts.fHeightOffset + 1] = (uint8_t)(height >> 0);
+    dst += restarts.fScanOffset;
+    for (int i = first; i < end; i++) {
+        size_t intervalLen = restarts.fIntervals[i].second - restarts.fIntervals[i].first;
+        memcpy(dst, data + restarts.fIntervals[i].first, intervalLen);
+        dst += intervalLen;
+        *dst++ = 0xFF;
+        *dst++ = i + 1 < end ? 0xD0 + ((i - first) & 7) : 0xD9;
+    }
+    SkASSERT(dst == band->bytes() + size);
+    return band;
+}
+
+static SkCodec::Result read_yuv8_rows(jpeg_decompress_struct* dinfo,
+                                      const SkYUVASizeInfo& sizeInfo, void* planes[]);
+
+// The rest of an MCU row band, decoded by one task.
+struct JpegBand {
+    sk_sp<SkData> fData;
+    int           fSkipRows;  // Leading output rows decoded only to prime the upsampler.
+    int           fRows;      // Output rows to keep.
+    void*         fPlanes[3];
+    bool          fSuccess;
+};
+
+bool SkJpegCodec::decodeBands(SkExecutor* executor, const SkImageInfo& dstInfo, void* dst,
+                              size_t rowBytes, const SkYUVASizeInfo* sizeInfo, void* planes[]) {
+    // Bands shorter than this spend too much of their time decoding rows for context.
+    constexpr int kMinBandMCURows = 4;
+    // Enough bands to keep a machine busy, without too many rows decoded twice for context.
+    constexpr int kMaxBands = 16;
+
+    const jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const uint8_t* data = (const uint8_t*)this->stream()->getMemoryBase();
+    if (!data || 0 == dinfo->restart_interval || dinfo->progressive_mode ||
+            dinfo->num_components > 4) {
+        return false;
+    }
+    // The scale is in eighths, unless onDimensionsSupported() was never asked to scale.
+    int scale = 8;
+    if (dinfo->scale_num != dinfo->scale_denom) {
+        if (8 != dinfo->scale_denom) {
+            return false;
+        }
+        scale = dinfo->scale_num;
+    }
+    RestartIntervals restarts;
+    if (!find_restart_intervals(data, this->stream()->getLength(), &restarts)) {
+        return false;
+    }
+
+    // A single component scan is not interleaved, so its MCUs are single blocks.
+    const int mcuW = 1 == dinfo->num_components ? DCTSIZE : DCTSIZE * dinfo->max_h_samp_factor;
+    const int mcuH = 1 == dinfo->num_components ? DCTSIZE : DCTSIZE * dinfo->max_v_samp_factor;
+    const int height = dinfo->image_height;
+    const int mcusPerRow = (dinfo->image_width + mcuW - 1) / mcuW;
+    const int mcuRows = (height + mcuH - 1) / mcuH;
+    const int interval = dinfo->restart_interval;
+    const int64_t mcus = (int64_t)mcusPerRow * mcuRows;
+    if ((mcus + interval - 1) / interval != (int64_t)restarts.fIntervals.size()) {
+        return false;
+    }
+
+    // Bands must start on an MCU row that also starts an interval, i.e. every
+    // lcm(mcusPerRow, interval) / mcusPerRow MCU rows.
+    int gcd = mcusPerRow, r = interval;
+    while (r) {
+        int t = gcd % r;
+        gcd = r;
+        r = t;
+    }
+    const int unit = interval / gcd;
+    int bandRows = SkTMax((mcuRows + kMaxBands - 1) / kMaxBands, kMinBandMCURows);
+    bandRows = (bandRows + unit - 1) / unit * unit;
+    const int bands = (mcuRows + bandRows - 1) / bandRows;
+    if (bands < 2) {
+        return false;
+    }
+
+    // Fancy upsampling reads the chroma rows on either side, so bands also decode (and then
+    // throw away) the unit of MCU rows before and after them.  Raw YUV is not upsampled.
+    int contextRows = 0;
+    for (int i = 0; i < dinfo->num_components && !planes; i++) {
+        if (dinfo->comp_info[i].v_samp_factor != dinfo->max_v_samp_factor) {
+            contextRows = unit;
+        }
+    }
+
+    auto interval_at = [&](int mcuRow) {
+        return mcuRow == mcuRows ? (int)restarts.fIntervals.size()
+                                 : mcuRow * mcusPerRow / interval;
+    };
+    std::vector<JpegBand> tasks(bands);
+    for (int i = 0; i < bands; i++) {
+        int top = i * bandRows,
+            bottom = SkTMin(top + bandRows, mcuRows),
+            decodeTop = SkTMax(top - contextRows, 0),
+            decodeBottom = SkTMin(bottom + contextRows, mcuRows);
+        int decodeHeight = SkTMin(decodeBottom * mcuH, height) - decodeTop * mcuH;
+
+        JpegBand& band = tasks[i];
+        band.fData = make_band_jpeg(data, restarts, interval_at(decodeTop),
+                                    interval_at(decodeBottom), decodeHeight);
+        band.fSkipRows = (top - decodeTop) * mcuH * scale / 8;
+        int firstRow = top * mcuH * scale / 8,
+            endRow = (SkTMin(bottom * mcuH, height) * scale + 7) / 8;
+        band.fRows = endRow - firstRow;
+        band.fSuccess = false;
+        if (planes) {
+            for (int p = 0; p < 3; p++) {
+                int rowsPerMCU = dinfo->comp_info[p].v_samp_factor * DCTSIZE;
+                band.fPlanes[p] = SkTAddOffset<void>(planes[p],
+                        top * rowsPerMCU * sizeInfo->fWidthBytes[p]);
+            }
+        } else {
+            band.fPlanes[0] = SkTAddOffset<void>(dst, firstRow * rowBytes);
+        }
+    }
+
+    const J_COLOR_SPACE outColorSpace = dinfo->out_color_space;
+    const J_DITHER_MODE ditherMode = dinfo->dither_mode;
+    SkTaskGroup(*executor).batch(bands, [&](int i) {
+        JpegBand& band = tasks[i];
+        SkMemoryStream stream(band.fData);
+        JpegDecoderMgr decoderMgr(&stream);
+        // Scratch for rows we throw away, or for the color xform's source.  This must be
+        // allocated before setjmp(), which would skip its destructor.
+        SkAutoTMalloc<uint8_t> storage;
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+        if (setjmp(jmp)) {
+            return;
+        }
+        decoderMgr.init();
+        jpeg_decompress_struct* bandInfo = decoderMgr.dinfo();
+        if (JPEG_HEADER_OK != jpeg_read_header(bandInfo, true)) {
+            return;
+        }
+        bandInfo->out_color_space = outColorSpace;
+        bandInfo->dither_mode = ditherMode;
+        if (planes) {
+            bandInfo->raw_data_out = TRUE;
+        } else {
+            bandInfo->scale_num = scale;
+            bandInfo->scale_denom = 8;
+        }
+        if (!jpeg_start_decompress(bandInfo)) {
+            return;
+        }
+
+        if (planes) {
+            SkYUVASizeInfo bandSizeInfo = *sizeInfo;
+            band.fSuccess = kSuccess == read_yuv8_rows(bandInfo, bandSizeInfo, band.fPlanes);
+            return;
+        }
+
+        // Decode into dst directly, unless the color xform needs its own source row.
+        storage.reset(SkTMax(get_row_bytes(bandInfo), dstInfo.width() * sizeof(uint32_t)));
+        bool xformInPlace = sizeof(uint32_t) == dstInfo.bytesPerPixel();
+        for (int y = 0; y < band.fSkipRows; y++) {
+            JSAMPLE* row = storage.get();
+            if (1 != jpeg_read_scanlines(bandInfo, &row, 1)) {
+                return;
+            }
+        }
+        void* dstRow = band.fPlanes[0];
+        for (int y = 0; y < band.fRows; y++) {
+            JSAMPLE* row = this->colorXform() && !xformInPlace ? storage.get() : (JSAMPLE*)dstRow;
+            if (1 != jpeg_read_scanlines(bandInfo, &row, 1)) {
+                return;
+            }
+            if (this->colorXform()) {
+                this->applyColorXform(dstRow, row, dstInfo.width());
+            }
+            dstRow = SkTAddOffset<void>(dstRow, rowBytes);
+        }
+        band.fSuccess = true;
+    });
+
+    for (const JpegBand& band : tasks) {
+        if (!band.fSuccess) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /*
  * Performs the jpeg decode
  */
@@ -584,6 +852,14 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
+    if (options.fExecutor &&
+            !needs_swizzler_to_convert_from_cmyk(dinfo->out_color_space,
+                                                 this->getEncodedInfo().profile(),
+                                                 this->colorXform()) &&
+            this->decodeBands(options.fExecutor, dstInfo, dst, dstRowBytes, nullptr, nullptr)) {
+        return kSuccess;
+    }
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -864,7 +1140,8 @@ bool SkJpegCodec::onQueryYUV8(SkYUVASizeInfo* sizeInfo, SkYUVColorSpace* colorSp
 }
 
 SkCodec::Result SkJpegCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
-                                             void* planes[SkYUVASizeInfo::kMaxCount]) {
+                                             void* planes[SkYUVASizeInfo::kMaxCount],
+                                             SkExecutor* executor) {
     SkYUVASizeInfo defaultInfo;
 
     // This will check is_yuv_supported(), so we don't need to here.
@@ -888,6 +1165,10 @@ SkCodec::Result SkJpegCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
+    if (executor && this->decodeBands(executor, this->getInfo(), nullptr, 0, &sizeInfo, planes)) {
+        return kSuccess;
+    }
+
     dinfo->raw_data_out = TRUE;
     if (!jpeg_start_decompress(dinfo)) {
         return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
@@ -904,6 +1185,12 @@ SkCodec::Result SkJpegCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
     SkASSERT((uint32_t) sizeInfo.fSizes[0].width() == dinfo->output_width &&
              (uint32_t) sizeInfo.fSizes[0].height() == dinfo->output_height);
 
+    return read_yuv8_rows(dinfo, sizeInfo, planes);
+}
+
+// Reads all of dinfo's rows into planes, which are laid out as described by sizeInfo.
+static SkCodec::Result read_yuv8_rows(jpeg_decompress_struct* dinfo,
+                                      const SkYUVASizeInfo& sizeInfo, void* planes[]) {
     // Build a JSAMPIMAGE to handle output from libjpeg-turbo.  A JSAMPIMAGE has
     // a 2-D array of pixels for each of the components (Y, U, V) in the image.
     // Cheat Sheet:
@@ -943,7 +1230,7 @@ SkCodec::Result SkJpegCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
         JDIMENSION linesRead = jpeg_read_raw_data(dinfo, yuv, numRowsPerBlock);
         if (linesRead < numRowsPerBlock) {
             // FIXME: Handle incomplete YUV decodes without signalling an error.
-            return kInvalidInput;
+            return SkCodec::kInvalidInput;
         }
 
         // Update rowptrs.
@@ -977,11 +1264,11 @@ SkCodec::Result SkJpegCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
         JDIMENSION linesRead = jpeg_read_raw_data(dinfo, yuv, numRowsPerBlock);
         if (linesRead < remainingRows) {
             // FIXME: Handle incomplete YUV decodes without signalling an error.
-            return kInvalidInput;
+            return SkCodec::kInvalidInput;
         }
     }
 
-    return kSuccess;
+    return SkCodec::kSuccess;
 }
 
 // This function is declared in SkJpegInfo.h, used by SkPDF.
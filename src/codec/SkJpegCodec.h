@@ -47,7 +47,7 @@ protected:
     bool onQueryYUV8(SkYUVASizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const override;
 
     Result onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
-                           void* planes[SkYUVASizeInfo::kMaxCount]) override;
+                           void* planes[SkYUVASizeInfo::kMaxCount], SkExecutor*) override;
 
     SkEncodedImageFormat onGetEncodedFormat() const override {
         return SkEncodedImageFormat::kJPEG;
@@ -109,6 +109,18 @@ private:
     void allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Decodes bands of MCU rows concurrently on executor, each from its own copy of the headers
+     * and the restart intervals covering it.  Returns false if the image has no suitable restart
+     * markers, or if any band fails to decode, in which case dst may be partially written and
+     * the caller should decode serially instead.
+     *
+     * If planes is not null, decodes raw YUV into them, as onGetYUV8Planes() does.  Otherwise
+     * decodes dstInfo into dst, as onGetPixels() does when no swizzler is needed.
+     */
+    bool decodeBands(SkExecutor* executor, const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                     const SkYUVASizeInfo* sizeInfo, void* planes[]);
+
     /*
      * Scanline decoding.
      */
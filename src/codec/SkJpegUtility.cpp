@@ -98,9 +98,11 @@ static void sk_init_mem_source(j_decompress_ptr dinfo) {
 }
 
 static void sk_skip_mem_input_data (j_decompress_ptr cinfo, long num_bytes) {
-    jpeg_source_mgr* src = cinfo->src;
+    skjpeg_source_mgr* src = (skjpeg_source_mgr*) cinfo->src;
     size_t bytes = static_cast<size_t>(num_bytes);
     if(bytes > src->bytes_in_buffer) {
+        // Skip over the rest of the data as it arrives.
+        src->fMemoryLength += bytes - src->bytes_in_buffer;
         src->next_input_byte = nullptr;
         src->bytes_in_buffer = 0;
     } else {
@@ -110,11 +112,21 @@ static void sk_skip_mem_input_data (j_decompress_ptr cinfo, long num_bytes) {
 }
 
 static boolean sk_fill_mem_input_buffer (j_decompress_ptr cinfo) {
-    /* The whole JPEG data is expected to reside in the supplied memory,
-     * buffer, so any request for more data beyond the given buffer size
-     * is treated as an error.
+    /* The JPEG data resides in the stream's memory, which libjpeg has already
+     * been given. The only way there can be more is if the stream has grown
+     * since (e.g. an SkPartialDataStream), in which case hand libjpeg the new
+     * bytes in place.
      */
-    return false;
+    skjpeg_source_mgr* src = (skjpeg_source_mgr*) cinfo->src;
+    const size_t length = src->fStream->getLength();
+    if (length <= src->fMemoryLength) {
+        return false;
+    }
+    src->next_input_byte =
+            static_cast<const JOCTET*>(src->fStream->getMemoryBase()) + src->fMemoryLength;
+    src->bytes_in_buffer = length - src->fMemoryLength;
+    src->fMemoryLength = length;
+    return true;
 }
 
 /*
@@ -123,6 +135,7 @@ static boolean sk_fill_mem_input_buffer (j_decompress_ptr cinfo) {
  */
 skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream)
     : fStream(stream)
+    , fMemoryLength(0)
 {
     if (stream->hasLength() && stream->getMemoryBase()) {
         init_source = sk_init_mem_source;
@@ -132,6 +145,7 @@ skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream)
         term_source = sk_term_source;
         bytes_in_buffer = static_cast<size_t>(stream->getLength());
         next_input_byte = static_cast<const JOCTET*>(stream->getMemoryBase());
+        fMemoryLength = bytes_in_buffer;
     } else {
         init_source = sk_init_buffered_source;
         fill_input_buffer = sk_fill_buffered_input_buffer;
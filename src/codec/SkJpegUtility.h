@@ -33,6 +33,8 @@ struct skjpeg_source_mgr : jpeg_source_mgr {
     skjpeg_source_mgr(SkStream* stream);
 
     SkStream* fStream; // unowned
+    // For memory backed streams, how much of the memory has been handed to libjpeg.
+    size_t    fMemoryLength;
     enum {
         // TODO (msarett): Experiment with different buffer sizes.
         // This size was chosen because it matches SkImageDecoder.
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkPartialDataStream.h"
+#include "include/private/SkMalloc.h"
+
+#include <cstring>
+
+std::unique_ptr<SkPartialDataStream> SkPartialDataStream::Make(size_t totalSize) {
+    void* memory = sk_malloc_canfail(totalSize);
+    if (!memory && totalSize) {
+        return nullptr;
+    }
+    sk_sp<SkData> data = SkData::MakeFromMalloc(memory, totalSize);
+    return std::unique_ptr<SkPartialDataStream>(new SkPartialDataStream(std::move(data)));
+}
+
+SkPartialDataStream::SkPartialDataStream(sk_sp<SkData> data)
+    : fData(std::move(data))
+    , fReceived(0)
+    , fOffset(0)
+{}
+
+size_t SkPartialDataStream::append(const void* data, size_t size) {
+    size = SkTMin(size, fData->size() - fReceived);
+    if (size) {
+        memcpy((char*)fData->writable_data() + fReceived, data, size);
+        fReceived += size;
+    }
+    return size;
+}
+
+size_t SkPartialDataStream::read(void* buffer, size_t size) {
+    size = this->peek(buffer, size);
+    fOffset += size;
+    return size;
+}
+
+size_t SkPartialDataStream::peek(void* buffer, size_t size) const {
+    size = SkTMin(size, fReceived - fOffset);
+    if (buffer && size) {
+        memcpy(buffer, fData->bytes() + fOffset, size);
+    }
+    return size;
+}
+
+bool SkPartialDataStream::isAtEnd() const {
+    return fOffset == fData->size();
+}
+
+bool SkPartialDataStream::rewind() {
+    fOffset = 0;
+    return true;
+}
+
+bool SkPartialDataStream::seek(size_t position) {
+    // Like reads, seeks stop at the end of the data received so far.
+    fOffset = SkTMin(position, fReceived);
+    return fOffset == position;
+}
+
+bool SkPartialDataStream::move(long offset) {
+    if (offset < 0 && (size_t)-offset > fOffset) {
+        fOffset = 0;
+        return false;
+    }
+    return this->seek(fOffset + offset);
+}
@@ -135,6 +135,20 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
 
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
         SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
+    if (stream->hasLength() && stream->hasPosition() && stream->getMemoryBase()) {
+        // Hand libpng the bytes in place rather than copying them through buffer. libpng only
+        // reads from the data passed to png_process_data.
+        const size_t position = stream->getPosition();
+        const size_t available = stream->getLength() - SkTMin(position, stream->getLength());
+        const size_t bytesToProcess = SkTMin(length, available);
+        auto data = static_cast<const png_byte*>(stream->getMemoryBase()) + position;
+        // Like the read() below, move past the data before processing it, in case libpng
+        // longjmps out.
+        stream->move(bytesToProcess);
+        png_process_data(png_ptr, info_ptr, const_cast<png_bytep>(data), bytesToProcess);
+        return bytesToProcess == length;
+    }
+
     while (length > 0) {
         const size_t bytesToProcess = std::min(bufferSize, length);
         const size_t bytesRead = stream->read(buffer, bytesToProcess);
@@ -500,6 +514,8 @@ public:
         , fRowBytes(0)
         , fFirstRow(0)
         , fLastRow(0)
+        , fRowsNeeded(0)
+        , fTryIndex(false)
     {}
 
     static void AllRowsCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum, int /*pass*/) {
@@ -519,6 +535,7 @@ private:
     int                         fFirstRow;  // FIXME: Move to baseclass?
     int                         fLastRow;
     int                         fRowsNeeded;
+    bool                        fTryIndex;
 
     typedef SkPngCodec INHERITED;
 
@@ -563,6 +580,7 @@ private:
         fRowBytes = rowBytes;
         fRowsWrittenToOutput = 0;
         fRowsNeeded = fLastRow - fFirstRow + 1;
+        fTryIndex = true;
     }
 
     Result decode(int* rowsDecoded) override {
@@ -571,6 +589,24 @@ private:
             fRowsNeeded = get_scaled_dimension(fLastRow - fFirstRow + 1, sampleY);
         }
 
+        // Skip libpng, and start inflating from a checkpoint, if there is one below the top.
+        // This is only worth trying at the start of the decode.
+        if (fTryIndex && this->index() && this->index()->checkpointRowFor(fFirstRow) > 0) {
+            fTryIndex = false;
+            this->index()->readRows(this->stream(), fFirstRow,
+                                    [this](const uint8_t* row, int rowNum) {
+                return this->writeRow(row, rowNum);
+            });
+            if (fRowsWrittenToOutput == fRowsNeeded) {
+                return kSuccess;
+            }
+            if (rowsDecoded) {
+                *rowsDecoded = fRowsWrittenToOutput;
+            }
+            return kErrorInInput;
+        }
+        fTryIndex = false;
+
         const bool success = this->processData();
         if (success && fRowsWrittenToOutput == fRowsNeeded) {
             return kSuccess;
@@ -584,9 +620,17 @@ private:
     }
 
     void rowCallback(png_bytep row, int rowNum) {
+        if (!this->writeRow(row, rowNum)) {
+            // Fake error to stop decoding scanlines.
+            longjmp(PNG_JMPBUF(this->png_ptr()), kStopDecoding);
+        }
+    }
+
+    // Returns false once all the rows needed have been written.
+    bool writeRow(const uint8_t* row, int rowNum) {
         if (rowNum < fFirstRow) {
             // Ignore this row.
-            return;
+            return true;
         }
 
         SkASSERT(rowNum <= fLastRow);
@@ -599,10 +643,7 @@ private:
             fRowsWrittenToOutput++;
         }
 
-        if (fRowsWrittenToOutput == fRowsNeeded) {
-            // Fake error to stop decoding scanlines.
-            longjmp(PNG_JMPBUF(this->png_ptr()), kStopDecoding);
-        }
+        return fRowsWrittenToOutput < fRowsNeeded;
     }
 };
 
@@ -1136,6 +1177,73 @@ bool SkPngCodec::onRewind() {
     return true;
 }
 
+bool SkPngCodec::getIndexParams(size_t* rowBytes, int* bytesPerPixel) {
+    if (!fPng_ptr) {
+        return false;
+    }
+    png_uint_32 width, height;
+    int bitDepth, colorType, interlaceType;
+    png_get_IHDR(fPng_ptr, fInfo_ptr, &width, &height, &bitDepth, &colorType, &interlaceType,
+                 nullptr, nullptr);
+    const bool hasTRNS = png_get_valid(fPng_ptr, fInfo_ptr, PNG_INFO_tRNS);
+
+    // These are the cases where infoCallback() asks libpng to transform the rows.
+    if (PNG_INTERLACE_NONE != interlaceType || bitDepth < 8 ||
+            (16 == bitDepth && (PNG_COLOR_TYPE_GRAY == colorType ||
+                                PNG_COLOR_TYPE_GRAY_ALPHA == colorType)) ||
+            (hasTRNS && (PNG_COLOR_TYPE_GRAY == colorType || PNG_COLOR_TYPE_RGB == colorType))) {
+        return false;
+    }
+
+    *bytesPerPixel = png_get_channels(fPng_ptr, fInfo_ptr) * bitDepth / 8;
+    *rowBytes = width * (size_t)*bytesPerPixel;
+    return true;
+}
+
+sk_sp<SkData> SkPngCodec::buildIndex(int rowsPerCheckpoint) {
+    size_t rowBytes;
+    int bytesPerPixel;
+    SkStream* stream = this->stream();
+    if (!this->getIndexParams(&rowBytes, &bytesPerPixel) || !stream->hasPosition()) {
+        return nullptr;
+    }
+
+    const int height = this->dimensions().height();
+    if (rowsPerCheckpoint <= 0) {
+        // At most 64 checkpoints (each holds 32K of history), but no closer than 256K of
+        // inflated data, where reading from the top is cheap enough.
+        rowsPerCheckpoint = SkTMax((height + 63) / 64, (int)((256 * 1024) / (rowBytes + 1)) + 1);
+    }
+
+    // libpng has read up to the first IDAT, so put the stream back when we're done.
+    const size_t position = stream->getPosition();
+    std::unique_ptr<SkPngIndex> index = SkPngIndex::Make(stream, height, rowBytes, bytesPerPixel,
+                                                         rowsPerCheckpoint);
+    if (!stream->seek(position) || !index) {
+        return nullptr;
+    }
+    fIndex = std::move(index);
+    return fIndex->serialize();
+}
+
+bool SkPngCodec::setIndex(const SkData& data) {
+    size_t rowBytes;
+    int bytesPerPixel;
+    SkStream* stream = this->stream();
+    if (!this->getIndexParams(&rowBytes, &bytesPerPixel) || !stream->hasPosition()) {
+        return false;
+    }
+
+    const size_t position = stream->getPosition();
+    std::unique_ptr<SkPngIndex> index = SkPngIndex::MakeFromData(
+            data, stream, this->dimensions().height(), rowBytes, bytesPerPixel);
+    if (!stream->seek(position) || !index) {
+        return false;
+    }
+    fIndex = std::move(index);
+    return true;
+}
+
 SkCodec::Result SkPngCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
                                         size_t rowBytes, const Options& options,
                                         int* rowsDecoded) {
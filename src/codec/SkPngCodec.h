@@ -13,8 +13,10 @@
 #include "include/core/SkPngChunkReader.h"
 #include "include/core/SkRefCnt.h"
 #include "src/codec/SkColorTable.h"
+#include "src/codec/SkPngIndex.h"
 #include "src/codec/SkSwizzler.h"
 
+class SkData;
 class SkStream;
 
 class SkPngCodec : public SkCodec {
@@ -28,6 +30,26 @@ public:
     // FIXME (scroggo): Temporarily needed by AutoCleanPng.
     void setIdatLength(size_t len) { fIdatLength = len; }
 
+    /**
+     *  Inflates the image once to build an SkPngIndex, so that later subset decodes (e.g. from
+     *  SkAndroidCodec) start from the nearest checkpoint above the subset rather than from the
+     *  top of the image.  The index is kept across rewinds.
+     *
+     *  @param rowsPerCheckpoint Minimum rows between checkpoints, or 0 to pick a spacing that
+     *                           bounds both the number of checkpoints and the rows inflated to
+     *                           reach a subset.
+     *  @return The index serialized, to pass to setIndex() on a later codec for the same
+     *          encoded image, or nullptr if this image cannot be indexed (it is interlaced, its
+     *          rows need libpng transforms, or its stream cannot seek).
+     */
+    sk_sp<SkData> buildIndex(int rowsPerCheckpoint = 0);
+
+    /**
+     *  Uses an index serialized by buildIndex().  Returns false, and leaves any current index
+     *  alone, if it does not match this image.
+     */
+    bool setIndex(const SkData&);
+
     ~SkPngCodec() override;
 
 protected:
@@ -60,6 +82,8 @@ protected:
 
     SkSwizzler* swizzler() { return fSwizzler.get(); }
 
+    const SkPngIndex* index() const { return fIndex.get(); }
+
     // Initialize variables used by applyXformRow.
     void initializeXformParams();
 
@@ -105,6 +129,8 @@ private:
     void initializeSwizzler(const SkImageInfo& dstInfo, const Options&, bool skipFormatConversion);
     void allocateStorage(const SkImageInfo& dstInfo);
     void destroyReadStruct();
+    // Returns false if rows of this image are not read as they are stored, so can't be indexed.
+    bool getIndexParams(size_t* rowBytes, int* bytesPerPixel);
 
     virtual Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) = 0;
     virtual void setRange(int firstRow, int lastRow, void* dst, size_t rowBytes) = 0;
@@ -116,6 +142,8 @@ private:
     size_t                         fIdatLength;
     bool                           fDecodedIdat;
 
+    std::unique_ptr<SkPngIndex>    fIndex;
+
     typedef SkCodec INHERITED;
 };
 #endif  // SkPngCodec_DEFINED
@@ -0,0 +1,517 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkPngIndex.h"
+
+#include "include/core/SkStream.h"
+#include "include/private/SkTemplates.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+
+// Deflate may refer back this far into the inflated data.
+static constexpr size_t kWindowSize = 32768;
+static constexpr size_t kInputSize  = 16384;
+
+static constexpr char     kMagic[]  = "SkPngIdx";
+static constexpr uint32_t kVersion  = 1;
+
+namespace {
+
+// Owns a z_stream for inflating, and ends it when done.
+struct AutoInflate {
+    z_stream fStream;
+    bool     fInitialized;
+
+    // windowBits is as for inflateInit2(): 15 for a zlib stream, -15 for raw deflate.
+    explicit AutoInflate(int windowBits) {
+        memset(&fStream, 0, sizeof(fStream));
+        fInitialized = Z_OK == inflateInit2(&fStream, windowBits);
+    }
+    ~AutoInflate() {
+        if (fInitialized) {
+            inflateEnd(&fStream);
+        }
+    }
+};
+
+// Reads the zlib data spread across the IDAT chunks as one sequence of bytes.
+class IdatReader {
+public:
+    struct Chunk {
+        uint64_t fOffset;
+        uint32_t fLength;
+    };
+
+    IdatReader(SkStream* stream) : fStream(stream), fChunk(0), fLeft(0) {}
+
+    void addChunk(uint64_t offset, uint32_t length) { fChunks.push_back({offset, length}); }
+
+    // Moves to offset in the zlib data.
+    bool seek(uint64_t offset) {
+        for (fChunk = 0; fChunk < fChunks.size(); fChunk++) {
+            if (offset < fChunks[fChunk].fLength) {
+                fLeft = fChunks[fChunk].fLength - offset;
+                return fStream->seek(fChunks[fChunk].fOffset + offset);
+            }
+            offset -= fChunks[fChunk].fLength;
+        }
+        return false;
+    }
+
+    // Returns the number of bytes read, which is 0 at the end of the data or on error.
+    size_t read(void* buffer, size_t size) {
+        while (0 == fLeft) {
+            if (++fChunk >= fChunks.size() || !fStream->seek(fChunks[fChunk].fOffset)) {
+                return 0;
+            }
+            fLeft = fChunks[fChunk].fLength;
+        }
+        size_t bytesRead = fStream->read(buffer, std::min(size, fLeft));
+        fLeft -= bytesRead;
+        return bytesRead;
+    }
+
+private:
+    SkStream*          fStream;
+    std::vector<Chunk> fChunks;
+    size_t             fChunk;
+    size_t             fLeft;
+};
+
+// Reverses the PNG filter on row, given the previous unfiltered row.
+bool unfilter_row(uint8_t filter, uint8_t* row, const uint8_t* prev, size_t rowBytes, int bpp) {
+    switch (filter) {
+        case 0:  // None
+            return true;
+        case 1:  // Sub
+            for (size_t i = bpp; i < rowBytes; i++) {
+                row[i] += row[i - bpp];
+            }
+            return true;
+        case 2:  // Up
+            for (size_t i = 0; i < rowBytes; i++) {
+                row[i] += prev[i];
+            }
+            return true;
+        case 3:  // Average
+            for (size_t i = 0; i < rowBytes; i++) {
+                int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+                row[i] += (uint8_t)((left + prev[i]) >> 1);
+            }
+            return true;
+        case 4:  // Paeth
+            for (size_t i = 0; i < rowBytes; i++) {
+                int a = i >= (size_t)bpp ? row[i - bpp] : 0,
+                    b = prev[i],
+                    c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+                int p = a + b - c,
+                    pa = SkTAbs(p - a),
+                    pb = SkTAbs(p - b),
+                    pc = SkTAbs(p - c);
+                row[i] += (uint8_t)(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Gathers inflated bytes into rows, and unfilters them.
+class RowAssembler {
+public:
+    RowAssembler(size_t rowBytes, int bpp, int height)
+        : fRowBytes(rowBytes)
+        , fBpp(bpp)
+        , fHeight(height)
+        , fFiltered(rowBytes + 1)
+        , fPrev(rowBytes, 0)
+        , fFilled(0)
+        , fRow(0)
+    {}
+
+    void setRow(int row, const uint8_t* prev) {
+        fRow = row;
+        memcpy(fPrev.data(), prev, fRowBytes);
+    }
+
+    int row() const { return fRow; }
+    bool done() const { return fRow >= fHeight; }
+
+    // The previous unfiltered row.
+    const std::vector<uint8_t>& prev() const { return fPrev; }
+
+    // Calls proc(row, rowNum) after each row is unfiltered.  Returns false if a row has a bad
+    // filter type, or proc returns false.
+    template <typename Proc>
+    bool append(const uint8_t* data, size_t size, Proc&& proc) {
+        while (size > 0 && !this->done()) {
+            size_t n = std::min(size, fRowBytes + 1 - fFilled);
+            memcpy(fFiltered.data() + fFilled, data, n);
+            fFilled += n;
+            data += n;
+            size -= n;
+            if (fFilled == fRowBytes + 1) {
+                fFilled = 0;
+                if (!unfilter_row(fFiltered[0], fFiltered.data() + 1, fPrev.data(), fRowBytes,
+                                  fBpp)) {
+                    return false;
+                }
+                memcpy(fPrev.data(), fFiltered.data() + 1, fRowBytes);
+                if (!proc(fPrev.data(), fRow++)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    const size_t         fRowBytes;
+    const int            fBpp;
+    const int            fHeight;
+    std::vector<uint8_t> fFiltered;
+    std::vector<uint8_t> fPrev;
+    size_t               fFilled;
+    int                  fRow;
+};
+
+}  // namespace
+
+static void write64(SkWStream* stream, uint64_t v) {
+    stream->write32((uint32_t)v);
+    stream->write32((uint32_t)(v >> 32));
+}
+
+static bool read64(SkStream* stream, uint64_t* v) {
+    uint32_t lo, hi;
+    if (!stream->readU32(&lo) || !stream->readU32(&hi)) {
+        return false;
+    }
+    *v = ((uint64_t)hi << 32) | lo;
+    return true;
+}
+
+bool SkPngIndex::ReadChunks(SkStream* stream, std::vector<Chunk>* chunks) {
+    uint8_t header[8];
+    if (!stream->rewind() || stream->read(header, 8) != 8) {
+        return false;
+    }
+    uint64_t offset = 8;
+    while (stream->read(header, 8) == 8) {
+        const uint32_t length = (header[0] << 24) | (header[1] << 16) | (header[2] << 8) |
+                                header[3];
+        const bool isIdat = !memcmp(header + 4, "IDAT", 4);
+        if (!isIdat && !chunks->empty()) {
+            // The IDAT chunks must be consecutive, so we have them all.
+            return true;
+        }
+        if (!memcmp(header + 4, "IEND", 4) || stream->skip(length) != length) {
+            break;
+        }
+        uint8_t crc[4];
+        if (stream->read(crc, 4) != 4) {
+            break;
+        }
+        if (isIdat) {
+            chunks->push_back({ offset + 8, length,
+                                (uint32_t)((crc[0] << 24) | (crc[1] << 16) | (crc[2] << 8) |
+                                           crc[3]) });
+        }
+        offset += 12 + (uint64_t)length;
+    }
+    return false;
+}
+
+std::unique_ptr<SkPngIndex> SkPngIndex::Make(SkStream* stream, int height, size_t rowBytes,
+                                             int bytesPerPixel, int rowsPerCheckpoint) {
+    std::vector<Chunk> chunks;
+    if (rowsPerCheckpoint < 1 || !ReadChunks(stream, &chunks)) {
+        return nullptr;
+    }
+    IdatReader reader(stream);
+    for (const Chunk& chunk : chunks) {
+        reader.addChunk(chunk.fOffset, chunk.fLength);
+    }
+    std::unique_ptr<SkPngIndex> index(new SkPngIndex(std::move(chunks), height, rowBytes,
+                                                     bytesPerPixel));
+
+    AutoInflate inflater(15);
+    if (!inflater.fInitialized || !reader.seek(0)) {
+        return nullptr;
+    }
+    z_stream& strm = inflater.fStream;
+
+    // Inflate into a circular window, so the last 32K is always at hand for a checkpoint.
+    SkAutoTMalloc<uint8_t> input(kInputSize);
+    std::vector<uint8_t> window(kWindowSize);
+    RowAssembler rows(rowBytes, bytesPerPixel, height);
+    const size_t stride = rowBytes + 1;
+    uint64_t totalIn = 0,
+             totalOut = 0;
+    int nextCheckpointRow = rowsPerCheckpoint;
+
+    // A checkpoint in the middle of a row needs that row, unfiltered, once it is complete.
+    Checkpoint pending;
+    bool hasPending = false;
+    auto onRow = [&](const uint8_t* row, int rowNum) {
+        if (hasPending && rowNum == pending.fRow - 1) {
+            pending.fPrevRow.assign(row, row + rowBytes);
+            index->fCheckpoints.push_back(std::move(pending));
+            hasPending = false;
+        }
+        return true;
+    };
+
+    while (!rows.done()) {
+        if (0 == strm.avail_in) {
+            strm.avail_in = (uInt)reader.read(input.get(), kInputSize);
+            if (0 == strm.avail_in) {
+                return nullptr;
+            }
+            strm.next_in = input.get();
+        }
+        const size_t windowPos = totalOut % kWindowSize;
+        const uInt availIn = strm.avail_in,
+                   availOut = (uInt)(kWindowSize - windowPos);
+        strm.next_out = window.data() + windowPos;
+        strm.avail_out = availOut;
+        const int ret = inflate(&strm, Z_BLOCK);
+        if (Z_OK != ret && Z_STREAM_END != ret) {
+            return nullptr;
+        }
+        totalIn += availIn - strm.avail_in;
+        totalOut += availOut - strm.avail_out;
+        if (!rows.append(window.data() + windowPos, availOut - strm.avail_out, onRow)) {
+            return nullptr;
+        }
+        if (Z_STREAM_END == ret) {
+            break;
+        }
+
+        // At the end of a block that is not the last, decoding can start afresh.
+        const bool atBoundary = (strm.data_type & 128) && !(strm.data_type & 64);
+        const int firstRow = (int)((totalOut + stride - 1) / stride);
+        if (atBoundary && !hasPending && firstRow >= nextCheckpointRow && firstRow < height) {
+            Checkpoint checkpoint;
+            checkpoint.fIn = totalIn;
+            checkpoint.fBits = strm.data_type & 7;
+            checkpoint.fOut = totalOut;
+            checkpoint.fRow = firstRow;
+            const size_t windowLen = (size_t)std::min<uint64_t>(totalOut, kWindowSize);
+            const size_t end = totalOut % kWindowSize;
+            checkpoint.fWindow.resize(windowLen);
+            if (windowLen <= end) {
+                memcpy(checkpoint.fWindow.data(), window.data() + end - windowLen, windowLen);
+            } else {
+                const size_t tail = windowLen - end;
+                memcpy(checkpoint.fWindow.data(), window.data() + kWindowSize - tail, tail);
+                memcpy(checkpoint.fWindow.data() + tail, window.data(), end);
+            }
+
+            if (firstRow == rows.row()) {
+                // The boundary is between rows, and we already have the previous one.
+                checkpoint.fPrevRow = rows.prev();
+                index->fCheckpoints.push_back(std::move(checkpoint));
+            } else {
+                pending = std::move(checkpoint);
+                hasPending = true;
+            }
+            nextCheckpointRow = firstRow + rowsPerCheckpoint;
+        }
+    }
+
+    if (!rows.done() || index->fCheckpoints.empty()) {
+        return nullptr;
+    }
+    return index;
+}
+
+int SkPngIndex::checkpointRowFor(int row) const {
+    auto after = std::upper_bound(fCheckpoints.begin(), fCheckpoints.end(), row,
+                                  [](int r, const Checkpoint& c) { return r < c.fRow; });
+    return after == fCheckpoints.begin() ? -1 : (after - 1)->fRow;
+}
+
+bool SkPngIndex::readRows(SkStream* stream, int firstRow, const RowProc& proc) const {
+    auto after = std::upper_bound(fCheckpoints.begin(), fCheckpoints.end(), firstRow,
+                                  [](int r, const Checkpoint& c) { return r < c.fRow; });
+    if (after == fCheckpoints.begin() || firstRow >= fHeight) {
+        return false;
+    }
+    const Checkpoint& checkpoint = *(after - 1);
+
+    IdatReader reader(stream);
+    for (const Chunk& chunk : fChunks) {
+        reader.addChunk(chunk.fOffset, chunk.fLength);
+    }
+    AutoInflate inflater(-15);
+    if (!inflater.fInitialized || !reader.seek(checkpoint.fIn - (checkpoint.fBits ? 1 : 0))) {
+        return false;
+    }
+    z_stream& strm = inflater.fStream;
+    if (checkpoint.fBits) {
+        uint8_t byte;
+        if (reader.read(&byte, 1) != 1 ||
+                Z_OK != inflatePrime(&strm, checkpoint.fBits, byte >> (8 - checkpoint.fBits))) {
+            return false;
+        }
+    }
+    if (!checkpoint.fWindow.empty() &&
+            Z_OK != inflateSetDictionary(&strm, checkpoint.fWindow.data(),
+                                         (uInt)checkpoint.fWindow.size())) {
+        return false;
+    }
+
+    RowAssembler rows(fRowBytes, fBytesPerPixel, fHeight);
+    rows.setRow(checkpoint.fRow, checkpoint.fPrevRow.data());
+    // The inflated data starts partway into the row before the checkpoint's.
+    size_t skip = (size_t)(checkpoint.fRow * (uint64_t)(fRowBytes + 1) - checkpoint.fOut);
+
+    bool stopped = false;
+    auto onRow = [&](const uint8_t* row, int rowNum) {
+        if (rowNum >= firstRow && !proc(row, rowNum)) {
+            stopped = true;
+            return false;
+        }
+        return true;
+    };
+
+    SkAutoTMalloc<uint8_t> input(kInputSize);
+    SkAutoTMalloc<uint8_t> output(kWindowSize);
+    while (!rows.done()) {
+        if (0 == strm.avail_in) {
+            strm.avail_in = (uInt)reader.read(input.get(), kInputSize);
+            if (0 == strm.avail_in) {
+                return false;
+            }
+            strm.next_in = input.get();
+        }
+        strm.next_out = output.get();
+        strm.avail_out = kWindowSize;
+        const int ret = inflate(&strm, Z_NO_FLUSH);
+        if (Z_OK != ret && Z_STREAM_END != ret) {
+            return false;
+        }
+        const uint8_t* out = output.get();
+        size_t produced = kWindowSize - strm.avail_out;
+        const size_t skipped = std::min(skip, produced);
+        skip -= skipped;
+        if (!rows.append(out + skipped, produced - skipped, onRow)) {
+            return stopped;
+        }
+        if (Z_STREAM_END == ret) {
+            break;
+        }
+    }
+    return rows.done();
+}
+
+sk_sp<SkData> SkPngIndex::serialize() const {
+    SkDynamicMemoryWStream stream;
+    stream.write(kMagic, 8);
+    stream.write32(kVersion);
+    stream.write32(fHeight);
+    stream.write32((uint32_t)fRowBytes);
+    stream.write32(fBytesPerPixel);
+    stream.write32((uint32_t)fChunks.size());
+    for (const Chunk& chunk : fChunks) {
+        write64(&stream, chunk.fOffset);
+        stream.write32(chunk.fLength);
+        stream.write32(chunk.fCRC);
+    }
+
+    // The windows are most of the size, and usually compress well.
+    stream.write32((uint32_t)fCheckpoints.size());
+    std::vector<uint8_t> raw, compressed;
+    for (const Checkpoint& checkpoint : fCheckpoints) {
+        write64(&stream, checkpoint.fIn);
+        stream.write32(checkpoint.fBits);
+        write64(&stream, checkpoint.fOut);
+        stream.write32(checkpoint.fRow);
+        stream.write32((uint32_t)checkpoint.fWindow.size());
+
+        raw = checkpoint.fWindow;
+        raw.insert(raw.end(), checkpoint.fPrevRow.begin(), checkpoint.fPrevRow.end());
+        uLongf compressedLen = compressBound((uLong)raw.size());
+        compressed.resize(compressedLen);
+        if (Z_OK != compress(compressed.data(), &compressedLen, raw.data(), (uLong)raw.size())) {
+            return nullptr;
+        }
+        stream.write32((uint32_t)compressedLen);
+        stream.write(compressed.data(), compressedLen);
+    }
+    return stream.detachAsData();
+}
+
+std::unique_ptr<SkPngIndex> SkPngIndex::MakeFromData(const SkData& data, SkStream* stream,
+                                                     int height, size_t rowBytes,
+                                                     int bytesPerPixel) {
+    SkMemoryStream in(data.data(), data.size(), false);
+    char magic[8];
+    uint32_t version, storedHeight, storedRowBytes, storedBpp, chunkCount;
+    if (in.read(magic, 8) != 8 || memcmp(magic, kMagic, 8) ||
+            !in.readU32(&version) || kVersion != version ||
+            !in.readU32(&storedHeight) || (uint32_t)height != storedHeight ||
+            !in.readU32(&storedRowBytes) || rowBytes != storedRowBytes ||
+            !in.readU32(&storedBpp) || (uint32_t)bytesPerPixel != storedBpp ||
+            !in.readU32(&chunkCount)) {
+        return nullptr;
+    }
+
+    // The index is only good for the same compressed data, so check the IDAT CRCs too.
+    std::vector<Chunk> chunks;
+    if (!ReadChunks(stream, &chunks) || chunks.size() != chunkCount) {
+        return nullptr;
+    }
+    for (const Chunk& chunk : chunks) {
+        Chunk stored;
+        if (!read64(&in, &stored.fOffset) || !in.readU32(&stored.fLength) ||
+                !in.readU32(&stored.fCRC) || stored.fOffset != chunk.fOffset ||
+                stored.fLength != chunk.fLength || stored.fCRC != chunk.fCRC) {
+            return nullptr;
+        }
+    }
+    std::unique_ptr<SkPngIndex> index(new SkPngIndex(std::move(chunks), height, rowBytes,
+                                                     bytesPerPixel));
+
+    uint32_t checkpointCount;
+    if (!in.readU32(&checkpointCount)) {
+        return nullptr;
+    }
+    std::vector<uint8_t> compressed;
+    int lastRow = 0;
+    for (uint32_t i = 0; i < checkpointCount; i++) {
+        Checkpoint checkpoint;
+        uint32_t bits, row, windowLen, compressedLen;
+        if (!read64(&in, &checkpoint.fIn) || !in.readU32(&bits) ||
+                !read64(&in, &checkpoint.fOut) || !in.readU32(&row) ||
+                !in.readU32(&windowLen) || !in.readU32(&compressedLen) ||
+                bits > 7 || windowLen > kWindowSize || (int)row <= lastRow ||
+                (int)row >= height || compressedLen > in.getLength() - in.getPosition() ||
+                checkpoint.fOut > row * (uint64_t)(rowBytes + 1) ||
+                checkpoint.fOut + rowBytes + 1 <= row * (uint64_t)(rowBytes + 1)) {
+            return nullptr;
+        }
+        checkpoint.fBits = bits;
+        checkpoint.fRow = lastRow = row;
+
+        compressed.resize(compressedLen);
+        in.read(compressed.data(), compressedLen);
+        std::vector<uint8_t> raw(windowLen + rowBytes);
+        uLongf rawLen = (uLongf)raw.size();
+        if (Z_OK != uncompress(raw.data(), &rawLen, compressed.data(), compressedLen) ||
+                rawLen != raw.size()) {
+            return nullptr;
+        }
+        checkpoint.fWindow.assign(raw.begin(), raw.begin() + windowLen);
+        checkpoint.fPrevRow.assign(raw.begin() + windowLen, raw.end());
+        index->fCheckpoints.push_back(std::move(checkpoint));
+    }
+    return index;
+}
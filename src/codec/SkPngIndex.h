@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngIndex_DEFINED
+#define SkPngIndex_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypes.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class SkStream;
+
+/**
+ *  Random access into the image data of a non-interlaced PNG.
+ *
+ *  Building an index inflates the whole image once, and records a checkpoint at a deflate block
+ *  boundary roughly every N rows: where the block starts in the compressed data, the 32K of
+ *  history it may refer back to, and the unfiltered row before the first whole row it produces.
+ *  Reading from a checkpoint then costs the same no matter how far down the image it is.
+ *
+ *  The index does not depend on libpng, and only hands back unfiltered rows.  It is up to the
+ *  caller to know that those are the rows libpng would have produced (i.e. no transforms).
+ */
+class SkPngIndex {
+public:
+    /**
+     *  Called for each unfiltered row, in order.  Return false to stop reading.
+     */
+    using RowProc = std::function<bool(const uint8_t* row, int rowNum)>;
+
+    /**
+     *  Inflates all of the IDAT data in stream, which must support seek().
+     *
+     *  @param rowBytes      Bytes in an unfiltered row, not counting the filter type.
+     *  @param bytesPerPixel Bytes per complete pixel for filtering, rounded up to 1.
+     *  @param rowsPerCheckpoint Minimum number of rows between checkpoints.
+     *
+     *  Returns nullptr if the data cannot be inflated, or would have no checkpoints.
+     */
+    static std::unique_ptr<SkPngIndex> Make(SkStream* stream, int height, size_t rowBytes,
+                                            int bytesPerPixel, int rowsPerCheckpoint);
+
+    /**
+     *  Reads an index written by serialize().  Returns nullptr if it is malformed, was built for
+     *  an image of a different size, or if the IDAT chunks in stream do not match those the
+     *  index was built from.
+     */
+    static std::unique_ptr<SkPngIndex> MakeFromData(const SkData& data, SkStream* stream,
+                                                    int height, size_t rowBytes,
+                                                    int bytesPerPixel);
+
+    sk_sp<SkData> serialize() const;
+
+    int countCheckpoints() const { return (int)fCheckpoints.size(); }
+
+    /**
+     *  Returns the first row of the last checkpoint at or above row, or -1 if there is none.
+     */
+    int checkpointRowFor(int row) const;
+
+    /**
+     *  Reads rows from the last checkpoint at or above firstRow, calling proc with each row
+     *  starting at firstRow.  Leaves stream at an unspecified position.
+     *
+     *  Returns false if there is no such checkpoint, or if the data ends or fails to inflate
+     *  before proc returns false or the last row is read.
+     */
+    bool readRows(SkStream* stream, int firstRow, const RowProc& proc) const;
+
+private:
+    struct Chunk {
+        uint64_t fOffset;   // Of the chunk's data in the stream.
+        uint32_t fLength;
+        uint32_t fCRC;
+    };
+
+    struct Checkpoint {
+        uint64_t             fIn;       // Offset into the zlib data of the first whole byte.
+        uint32_t             fBits;     // Bits of the byte before fIn still to be inflated.
+        uint64_t             fOut;      // Offset into the inflated data.
+        int                  fRow;      // First row starting at or after fOut.
+        std::vector<uint8_t> fWindow;   // Up to 32K of inflated data before fOut.
+        std::vector<uint8_t> fPrevRow;  // Unfiltered row fRow - 1.
+    };
+
+    SkPngIndex(std::vector<Chunk> chunks, int height, size_t rowBytes, int bytesPerPixel)
+        : fChunks(std::move(chunks))
+        , fHeight(height)
+        , fRowBytes(rowBytes)
+        , fBytesPerPixel(bytesPerPixel)
+    {}
+
+    static bool ReadChunks(SkStream*, std::vector<Chunk>*);
+
+    const std::vector<Chunk> fChunks;
+    const int                fHeight;
+    const size_t             fRowBytes;
+    const int                fBytesPerPixel;
+    std::vector<Checkpoint>  fCheckpoints;
+};
+
+#endif  // SkPngIndex_DEFINED
@@ -13,6 +13,7 @@ SkStreamBuffer::SkStreamBuffer(std::unique_ptr<SkStream> stream)
     , fBytesBuffered(0)
     , fHasLengthAndPosition(fStream->hasLength() && fStream->hasPosition())
     , fTrulyBuffered(0)
+    , fMemoryBase(fHasLengthAndPosition ? (const char*)fStream->getMemoryBase() : nullptr)
 {}
 
 SkStreamBuffer::~SkStreamBuffer() {
@@ -21,6 +22,9 @@ SkStreamBuffer::~SkStreamBuffer() {
 
 const char* SkStreamBuffer::get() const {
     SkASSERT(fBytesBuffered >= 1);
+    if (fMemoryBase) {
+        return fMemoryBase + fPosition;
+    }
     if (fHasLengthAndPosition && fTrulyBuffered < fBytesBuffered) {
         const size_t bytesToBuffer = fBytesBuffered - fTrulyBuffered;
         char* dst = SkTAddOffset<char>(const_cast<char*>(fBuffer), fTrulyBuffered);
@@ -75,6 +79,12 @@ sk_sp<SkData> SkStreamBuffer::getDataAtPosition(size_t position, size_t length)
     SkASSERT(length <= fStream->getLength() &&
              position <= fStream->getLength() - length);
 
+    if (fMemoryBase) {
+        // The data is only used while this buffer, and so the stream that
+        // owns this memory, is alive.
+        return SkData::MakeWithoutCopy(fMemoryBase + position, length);
+    }
+
     const size_t oldPosition = fStream->getPosition();
     if (!fStream->seek(position)) {
         return nullptr;
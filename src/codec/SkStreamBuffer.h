@@ -111,6 +111,10 @@ private:
     // Only used if !fHasLengthAndPosition. In that case, markPosition will
     // copy into an SkData, stored here.
     SkTHashMap<size_t, SkData*> fMarkedData;
+    // If the stream's bytes are in memory (and it has a length and position),
+    // get() and getDataAtPosition() point into that memory rather than
+    // copying.
+    const char*                 fMemoryBase;
 };
 #endif // SkStreamBuffer_DEFINED
 
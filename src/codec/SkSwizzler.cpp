@@ -47,12 +47,7 @@ static void sample2(void* dst, const uint8_t* src, int width, int bpp, int delta
 
 static void sample4(void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
-    src += offset;
-    uint32_t* dst32 = (uint32_t*) dst;
-    for (int x = 0; x < width; x++) {
-        dst32[x] = *((const uint32_t*) src);
-        src += deltaSrc;
-    }
+    SkOpts::sample_8888((uint32_t*) dst, src + offset, width, deltaSrc);
 }
 
 static void sample6(void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
@@ -228,19 +223,33 @@ static void swizzle_small_index_to_n32(
     }
 }
 
+static void fast_swizzle_small_index_to_n32(
+        void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
+        int bpp, int deltaSrc, int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    // The optimized routines start at the high bits of a byte.
+    if (offset % 8 != 0) {
+        swizzle_small_index_to_n32(dstRow, src, dstWidth, bpp, deltaSrc, offset, ctable);
+        return;
+    }
+
+    SkOpts::Swizzle_index proc = 1 == bpp ? SkOpts::index1_to_8888
+                               : 2 == bpp ? SkOpts::index2_to_8888
+                               :            SkOpts::index4_to_8888;
+    proc((uint32_t*) dstRow, src + offset / 8, dstWidth, ctable);
+}
+
 // kIndex
 
 static void swizzle_index_to_n32(
         void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
         int bpp, int deltaSrc, int offset, const SkPMColor ctable[]) {
 
-    src += offset;
-    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
-    for (int x = 0; x < dstWidth; x++) {
-        SkPMColor c = ctable[*src];
-        dst[x] = c;
-        src += deltaSrc;
-    }
+    SkOpts::index8_to_8888((uint32_t*) dstRow, src + offset, dstWidth, deltaSrc, ctable);
 }
 
 static void swizzle_index_to_n32_skipZ(
@@ -909,6 +918,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                         case kRGBA_8888_SkColorType:
                         case kBGRA_8888_SkColorType:
                             proc = &swizzle_small_index_to_n32;
+                            fastProc = &fast_swizzle_small_index_to_n32;
                             break;
                         case kRGB_565_SkColorType:
                             proc = &swizzle_small_index_to_565;
@@ -1219,8 +1229,8 @@ int SkSwizzler::onSetSampleX(int sampleX) {
     }
 
     // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
+    // are already fast because they skip pixels.  The sampled palette and 8888
+    // procs still reach SkOpts, which can gather strided pixels.
     if (1 == fSampleX && fFastProc) {
         fActualProc = fFastProc;
     } else {
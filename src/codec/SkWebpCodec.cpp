@@ -213,6 +213,131 @@ bool SkWebpCodec::onGetValidSubset(SkIRect* desiredSubset) const {
     return true;
 }
 
+// Sets sizeInfo to the planes libwebp decodes an opaque, lossy image of the given size to: a
+// full size Y plane, and U and V planes subsampled by two in each direction.
+static void set_yuv_sizes(SkYUVASizeInfo* sizeInfo, SkISize size) {
+    const SkISize uvSize = SkISize::Make((size.width() + 1) / 2, (size.height() + 1) / 2);
+    sizeInfo->fSizes[0] = size;
+    sizeInfo->fSizes[1] = uvSize;
+    sizeInfo->fSizes[2] = uvSize;
+    sizeInfo->fSizes[3] = SkISize::MakeEmpty();
+    sizeInfo->fWidthBytes[0] = SkAlign8(size.width());
+    sizeInfo->fWidthBytes[1] = SkAlign8(uvSize.width());
+    sizeInfo->fWidthBytes[2] = SkAlign8(uvSize.width());
+    sizeInfo->fWidthBytes[3] = 0;
+}
+
+bool SkWebpCodec::onQueryYUV8(SkYUVASizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
+    // Only a still, opaque, lossy image is stored as YUV that we can hand back as is.
+    if (this->getEncodedInfo().color() != SkEncodedInfo::kYUV_Color ||
+            (WebPDemuxGetI(fDemux, WEBP_FF_FORMAT_FLAGS) & ANIMATION_FLAG)) {
+        return false;
+    }
+
+    set_yuv_sizes(sizeInfo, this->dimensions());
+    sizeInfo->fOrigin = this->getOrigin();
+
+    if (colorSpace) {
+        // VP8 uses Rec. 601 with limited range.
+        *colorSpace = kRec601_SkYUVColorSpace;
+    }
+    return true;
+}
+
+// Fills the rows of the planes that libwebp did not decode with black.
+static void fill_yuv_rows(const SkYUVASizeInfo& sizeInfo, void* planes[], int yRowsDecoded) {
+    const int uvRowsDecoded = (yRowsDecoded + 1) / 2;
+    const int     rowsDecoded[3] = { yRowsDecoded, uvRowsDecoded, uvRowsDecoded };
+    const uint8_t black[3]       = { 16, 128, 128 };
+    for (int i = 0; i < 3; ++i) {
+        for (int y = rowsDecoded[i]; y < sizeInfo.fSizes[i].height(); ++y) {
+            memset(SkTAddOffset<void>(planes[i], y * sizeInfo.fWidthBytes[i]), black[i],
+                   sizeInfo.fSizes[i].width());
+        }
+    }
+}
+
+SkCodec::Result SkWebpCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
+                                             void* planes[SkYUVASizeInfo::kMaxCount],
+                                             SkExecutor*) {
+    SkYUVASizeInfo defaultInfo;
+    if (!this->onQueryYUV8(&defaultInfo, nullptr)) {
+        return kInvalidInput;
+    }
+
+    // The Y plane may be smaller than the image, in which case libwebp scales all three planes
+    // down as it decodes, rather than scaling RGB afterwards.
+    const SkISize ySize = sizeInfo.fSizes[0];
+    if (ySize.isEmpty() ||
+            ySize.width() > defaultInfo.fSizes[0].width() ||
+            ySize.height() > defaultInfo.fSizes[0].height()) {
+        return kInvalidInput;
+    }
+    SkYUVASizeInfo expectedInfo;
+    set_yuv_sizes(&expectedInfo, ySize);
+    for (int i = 0; i < 3; ++i) {
+        if (sizeInfo.fSizes[i] != expectedInfo.fSizes[i] ||
+                sizeInfo.fWidthBytes[i] < (size_t)expectedInfo.fSizes[i].width()) {
+            return kInvalidInput;
+        }
+    }
+
+    WebPDecoderConfig config;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        // ABI mismatch.
+        return kInvalidInput;
+    }
+
+    // Free any memory associated with the buffer. Must be called last, so we declare it first.
+    SkAutoTCallVProc<WebPDecBuffer, WebPFreeDecBuffer> autoFree(&(config.output));
+
+    WebPIterator frame;
+    SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoFrame(&frame);
+    if (!WebPDemuxGetFrame(fDemux, 1, &frame)) {
+        return kIncompleteInput;
+    }
+
+    if (ySize != this->dimensions()) {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = ySize.width();
+        config.options.scaled_height = ySize.height();
+    }
+
+    config.output.colorspace = MODE_YUV;
+    config.output.is_external_memory = 1;
+    WebPYUVABuffer& yuva = config.output.u.YUVA;
+    yuva.y = static_cast<uint8_t*>(planes[0]);
+    yuva.u = static_cast<uint8_t*>(planes[1]);
+    yuva.v = static_cast<uint8_t*>(planes[2]);
+    yuva.y_stride = static_cast<int>(sizeInfo.fWidthBytes[0]);
+    yuva.u_stride = static_cast<int>(sizeInfo.fWidthBytes[1]);
+    yuva.v_stride = static_cast<int>(sizeInfo.fWidthBytes[2]);
+    yuva.y_size = sizeInfo.fWidthBytes[0] * sizeInfo.fSizes[0].height();
+    yuva.u_size = sizeInfo.fWidthBytes[1] * sizeInfo.fSizes[1].height();
+    yuva.v_size = sizeInfo.fWidthBytes[2] * sizeInfo.fSizes[2].height();
+
+    SkAutoTCallVProc<WebPIDecoder, WebPIDelete> idec(WebPIDecode(nullptr, 0, &config));
+    if (!idec) {
+        return kInvalidInput;
+    }
+
+    switch (WebPIUpdate(idec, frame.fragment.bytes, frame.fragment.size)) {
+        case VP8_STATUS_OK:
+            return kSuccess;
+        case VP8_STATUS_SUSPENDED: {
+            int rowsDecoded = 0;
+            if (!WebPIDecGetYUVA(idec, &rowsDecoded, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                 nullptr, nullptr, nullptr) || rowsDecoded <= 0) {
+                return kInvalidInput;
+            }
+            fill_yuv_rows(sizeInfo, planes, rowsDecoded);
+            return kIncompleteInput;
+        }
+        default:
+            return kInvalidInput;
+    }
+}
+
 int SkWebpCodec::onGetRepetitionCount() {
     auto flags = WebPDemuxGetI(fDemux.get(), WEBP_FF_FORMAT_FLAGS);
     if (!(flags & ANIMATION_FLAG)) {
@@ -35,7 +35,36 @@
 
 #define SK_WUFFS_CODEC_BUFFER_SIZE 4096
 
+// If the stream's bytes are already in memory, returns them, so that the
+// io_buffer can read from them in place instead of copying them into its own
+// buffer. That memory is only ever read, never written, by the io_buffer.
+static const uint8_t* memory_base(SkStream* s) {
+    if (!s->hasLength() || !s->hasPosition()) {
+        return nullptr;
+    }
+    return static_cast<const uint8_t*>(s->getMemoryBase());
+}
+
 static bool fill_buffer(wuffs_base__io_buffer* b, SkStream* s) {
+    if (const uint8_t* base = memory_base(s)) {
+        // Make the io_buffer cover everything the stream has so far, keeping
+        // the reader where it was. The stream may have grown since the last
+        // fill, e.g. if it is an SkPartialDataStream.
+        const uint64_t readPosition = b->meta.pos + b->meta.ri;
+        const uint64_t oldEnd = b->meta.pos + b->meta.wi;
+        const size_t length = s->getLength();
+        if (readPosition > length) {
+            return false;
+        }
+        b->data = wuffs_base__make_slice_u8(const_cast<uint8_t*>(base), length);
+        b->meta.wi = length;
+        b->meta.ri = readPosition;
+        b->meta.pos = 0;
+        s->seek(length);
+        b->meta.closed = s->isAtEnd();
+        return length > oldEnd;
+    }
+
     b->compact();
     size_t num_read = s->read(b->data.ptr + b->meta.wi, b->data.len - b->meta.wi);
     b->meta.wi += num_read;
@@ -276,9 +305,17 @@ SkWuffsCodec::SkWuffsCodec(SkEncodedInfo&&
       fDecoderIsSuspended(false) {
     fFrameHolder.init(this, imgcfg.pixcfg.width(), imgcfg.pixcfg.height());
 
-    // Initialize fIOBuffer's fields, copying any outstanding data from iobuf to
-    // fIOBuffer, as iobuf's backing array may not be valid for the lifetime of
-    // this SkWuffsCodec object, but fIOBuffer's backing array (fBuffer) is.
+    // If iobuf is reading straight from the stream's memory, that memory lives
+    // as long as fStream does, so keep using it.
+    if (iobuf.data.ptr && iobuf.data.ptr == memory_base(fStream.get())) {
+        fIOBuffer = iobuf;
+        return;
+    }
+
+    // Otherwise, initialize fIOBuffer's fields, copying any outstanding data
+    // from iobuf to fIOBuffer, as iobuf's backing array may not be valid for
+    // the lifetime of this SkWuffsCodec object, but fIOBuffer's backing array
+    // (fBuffer) is.
     SkASSERT(iobuf.data.len == SK_WUFFS_CODEC_BUFFER_SIZE);
     memmove(fBuffer, iobuf.data.ptr, iobuf.meta.wi);
     fIOBuffer.data = wuffs_base__make_slice_u8(fBuffer, SK_WUFFS_CODEC_BUFFER_SIZE);
@@ -201,6 +201,16 @@ SkBitmapCache::RecPtr SkBitmapCache::Alloc(const SkBitmapCacheDesc& desc, const
     return RecPtr(new Rec(desc, info, rb, std::move(dm), block));
 }
 
+SkBitmapCache::RecPtr SkBitmapCache::Wrap(const SkBitmapCacheDesc& desc, const SkImageInfo& info,
+                                          size_t rowBytes,
+                                          std::unique_ptr<SkDiscardableMemory> dm) {
+    SkASSERT(info.width() == desc.fSubset.width());
+    SkASSERT(info.height() == desc.fSubset.height());
+    SkASSERT(dm && dm->data());
+    SkASSERT(rowBytes >= info.minRowBytes());
+    return RecPtr(new Rec(desc, info, rowBytes, std::move(dm), nullptr));
+}
+
 void SkBitmapCache::Add(RecPtr rec, SkBitmap* bitmap) {
     SkResourceCache::Add(rec.release(), bitmap);
 }
@@ -13,6 +13,7 @@
 
 class SkBitmap;
 class SkBitmapProvider;
+class SkDiscardableMemory;
 class SkImage;
 struct SkImageInfo;
 class SkMipMap;
@@ -50,6 +51,12 @@ public:
     typedef std::unique_ptr<Rec, RecDeleter> RecPtr;
 
     static RecPtr Alloc(const SkBitmapCacheDesc&, const SkImageInfo&, SkPixmap*);
+
+    /**
+     *  Returns a rec for pixels that already exist in memory, which must start out locked.
+     */
+    static RecPtr Wrap(const SkBitmapCacheDesc&, const SkImageInfo&, size_t rowBytes,
+                       std::unique_ptr<SkDiscardableMemory>);
     static void Add(RecPtr, SkBitmap*);
 
 private:
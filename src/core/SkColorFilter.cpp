@@ -416,7 +416,7 @@ public:
             };
             rec.fPipeline->append(SkRasterPipeline::callback, ctx);
         } else {
-            struct InterpreterCtx : public SkRasterPipeline_CallbackCtx {
+            struct InterpreterCtx : public SkRasterPipeline_InterpreterCtx {
                 SkSL::ByteCodeFunction* main;
                 std::unique_ptr<SkSL::Interpreter> interpreter;
                 const void* inputs;
@@ -435,15 +435,15 @@ public:
             std::unique_ptr<SkSL::ByteCode> byteCode = c.toByteCode(*prog);
             ctx->main = byteCode->fFunctions[0].get();
             ctx->interpreter.reset(new SkSL::Interpreter(std::move(prog), std::move(byteCode)));
-            ctx->fn = [](SkRasterPipeline_CallbackCtx* arg, int active_pixels) {
+            ctx->fn = [](SkRasterPipeline_InterpreterCtx* arg, int stride, int active_pixels) {
+                // main(inout half4 color) takes r,g,b,a in its first four slots, and the stage
+                // hands us exactly that: one stride-wide stripe per channel.
                 auto ctx = (InterpreterCtx*)arg;
-                for (int i = 0; i < active_pixels; i++) {
-                    ctx->interpreter->run(*ctx->main,
-                                          (SkSL::Interpreter::Value*) (ctx->rgba + i * 4),
-                                          (SkSL::Interpreter::Value*) ctx->inputs);
-                }
+                ctx->interpreter->runStriped(*ctx->main, stride, active_pixels,
+                                             (SkSL::Interpreter::Value*) ctx->rgba,
+                                             (SkSL::Interpreter::Value*) ctx->inputs);
             };
-            rec.fPipeline->append(SkRasterPipeline::callback, ctx);
+            rec.fPipeline->append(SkRasterPipeline::interpreter, ctx);
         }
         return true;
     }
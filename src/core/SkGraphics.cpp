@@ -26,6 +26,7 @@
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkTypefaceCache.h"
+#include "src/lazy/SkSharedDecodeCache.h"
 #include "src/utils/SkUTF.h"
 
 #include <stdlib.h>
@@ -49,6 +50,19 @@ void SkGraphics::PurgeAllCaches() {
     SkImageFilter::PurgeCache();
 }
 
+bool SkGraphics::SetSharedImageCacheDirectory(const char dir[], size_t byteLimit) {
+    if (!dir) {
+        SkSharedDecodeCache::Set(nullptr);
+        return true;
+    }
+    sk_sp<SkSharedDecodeCache> cache = SkSharedDecodeCache::Make(dir, byteLimit);
+    if (!cache) {
+        return false;
+    }
+    SkSharedDecodeCache::Set(std::move(cache));
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static const char kFontCacheLimitStr[] = "font-cache-limit";
@@ -692,6 +692,10 @@ void SkLiteDL::draw(SkCanvas* canvas) const {
     this->map(draw_fns, canvas, canvas->getTotalMatrix());
 }
 
+void SkLiteDL::draw(SkCanvas* canvas, const SkMatrix& original) const {
+    this->map(draw_fns, canvas, original);
+}
+
 SkLiteDL::~SkLiteDL() {
     this->reset();
 }
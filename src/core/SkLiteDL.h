@@ -22,6 +22,12 @@ public:
 
     void draw(SkCanvas* canvas) const;
 
+    // Like draw(), but does not restore the canvas afterwards: saves and layers opened by these
+    // ops stay open.  setMatrix() ops are applied relative to original.  Clips, including any
+    // device clip restriction, are whatever the caller has set on canvas.  This lets a display
+    // list be replayed in pieces onto a canvas that keeps its state between them.
+    void draw(SkCanvas* canvas, const SkMatrix& original) const;
+
     void reset();
     bool empty() const { return fUsed == 0; }
 
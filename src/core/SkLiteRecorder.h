@@ -13,7 +13,7 @@
 
 class SkLiteDL;
 
-class SkLiteRecorder final : public SkCanvasVirtualEnforcer<SkNoDrawCanvas> {
+class SkLiteRecorder : public SkCanvasVirtualEnforcer<SkNoDrawCanvas> {
 public:
     SkLiteRecorder();
     void reset(SkLiteDL*, const SkIRect& bounds);
@@ -8,19 +8,31 @@
 #include "src/core/SkMaskBlurFilter.h"
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/private/SkArenaAlloc.h"
 #include "include/private/SkMalloc.h"
 #include "include/private/SkNx.h"
+#include "include/private/SkTLogic.h"
 #include "include/private/SkTemplates.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkTaskGroup.h"
 
+#include <array>
 #include <cmath>
 #include <climits>
 
 namespace {
 static const double kPi = 3.14159265358979323846264338327950288;
 
+// Store each lane's low byte.
+static void store_lanes(uint8_t* to, const SkNx<1, uint32_t>& v) { *to = SkTo<uint8_t>(v[0]); }
+static void store_lanes(uint8_t* to, const Sk4u& v) { SkNx_cast<uint8_t>(v).store(to); }
+template <int N> static void store_lanes(uint8_t* to, const SkNx<N, uint32_t>& v) {
+    store_lanes(to,       v.fLo);
+    store_lanes(to + N/2, v.fHi);
+}
+
 class PlanGauss final {
 public:
     explicit PlanGauss(double sigma) {
@@ -90,12 +102,16 @@ public:
     int    border()     const { return fBorder; }
 
 public:
+    // Blurs N rows at once, one per lane.
+    template <int N>
     class Scan {
     public:
+        using V = SkNx<N, uint32_t>;
+
         Scan(uint64_t weight, int noChangeCount,
-             uint32_t* buffer0, uint32_t* buffer0End,
-             uint32_t* buffer1, uint32_t* buffer1End,
-             uint32_t* buffer2, uint32_t* buffer2End)
+             V* buffer0, V* buffer0End,
+             V* buffer1, V* buffer1End,
+             V* buffer2, V* buffer2End)
             : fWeight{weight}
             , fNoChangeCount{noChangeCount}
             , fBuffer0{buffer0}
@@ -104,28 +120,27 @@ public:
             , fBuffer1End{buffer1End}
             , fBuffer2{buffer2}
             , fBuffer2End{buffer2End}
-        { }
+        {
+            // We only get here with sigma >= 2, so window >= 4 and the weight fits in 32 bits.
+            SkASSERT(weight < (static_cast<uint64_t>(1) << 32));
+        }
 
-        template <typename AlphaIter> void blur(const AlphaIter srcBegin, const AlphaIter srcEnd,
-                    uint8_t* dst, int dstStride, uint8_t* dstEnd) const {
+        // Row i of N reads srcLen values starting at src[i], and writes dstLen values to
+        // dst + i, dst + i + dstStride, ...  So the N results for each position are adjacent.
+        template <typename AlphaIter> void blur(AlphaIter src[N], int srcLen,
+                    uint8_t* dst, size_t dstStride, int dstLen) const {
             auto buffer0Cursor = fBuffer0;
             auto buffer1Cursor = fBuffer1;
             auto buffer2Cursor = fBuffer2;
 
-            std::memset(fBuffer0, 0x00, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
+            V sum0, sum1, sum2;
 
-            uint32_t sum0 = 0;
-            uint32_t sum1 = 0;
-            uint32_t sum2 = 0;
-
-            // Consume the source generating pixels.
-            for (AlphaIter src = srcBegin; src < srcEnd; ++src, dst += dstStride) {
-                uint32_t leadingEdge = *src;
+            auto blurValue = [&](const V& leadingEdge) -> V {
                 sum0 += leadingEdge;
                 sum1 += sum0;
                 sum2 += sum1;
 
-                *dst = this->finalScale(sum2);
+                V value = this->finalScale(sum2);
 
                 sum2 -= *buffer2Cursor;
                 *buffer2Cursor = sum1;
@@ -138,88 +153,73 @@ public:
                 sum0 -= *buffer0Cursor;
                 *buffer0Cursor = leadingEdge;
                 buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-            }
 
-            // The leading edge is off the right side of the mask.
-            for (int i = 0; i < fNoChangeCount; i++) {
-                uint32_t leadingEdge = 0;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
+                return value;
+            };
 
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
+            auto reset = [&] {
+                sk_bzero(fBuffer0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
+                sum0 = sum1 = sum2 = 0;
+            };
 
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
+            uint32_t leadingEdges[N];
 
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
+            // Consume the source generating pixels.
+            reset();
+            int i = 0;
+            for (; i < srcLen; ++i, dst += dstStride) {
+                for (int lane = 0; lane < N; lane++) {
+                    leadingEdges[lane] = *src[lane];
+                    ++src[lane];
+                }
+                store_lanes(dst, blurValue(V::Load(leadingEdges)));
+            }
 
-                dst += dstStride;
+            // The leading edge is off the right side of the mask.
+            for (int j = 0; j < fNoChangeCount; ++j, ++i, dst += dstStride) {
+                store_lanes(dst, blurValue(0));
             }
 
             // Starting from the right, fill in the rest of the buffer.
-            std::memset(fBuffer0, 0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            sum0 = sum1 = sum2 = 0;
-
-            uint8_t* dstCursor = dstEnd;
-            AlphaIter src = srcEnd;
+            reset();
+            uint8_t* dstCursor = dst + (dstLen - i) * dstStride;
             while (dstCursor > dst) {
                 dstCursor -= dstStride;
-                uint32_t leadingEdge = *(--src);
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dstCursor = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
+                for (int lane = 0; lane < N; lane++) {
+                    leadingEdges[lane] = *(--src[lane]);
+                }
+                store_lanes(dstCursor, blurValue(V::Load(leadingEdges)));
             }
         }
 
     private:
-        static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
-
-        uint8_t finalScale(uint32_t sum) const {
-            return SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
+        // This is (fWeight * sum + 2^31) >> 32 with only 32-bit multiplies: if the product is
+        // hi << 32 | lo, adding 2^31 carries into hi exactly when the top bit of lo is set.
+        V finalScale(const V& sum) const {
+            V weight = static_cast<uint32_t>(fWeight);
+            return sum.mulHi(weight) + ((sum * weight) >> 31);
         }
 
         uint64_t  fWeight;
         int       fNoChangeCount;
-        uint32_t* fBuffer0;
-        uint32_t* fBuffer0End;
-        uint32_t* fBuffer1;
-        uint32_t* fBuffer1End;
-        uint32_t* fBuffer2;
-        uint32_t* fBuffer2End;
+        V*        fBuffer0;
+        V*        fBuffer0End;
+        V*        fBuffer1;
+        V*        fBuffer1End;
+        V*        fBuffer2;
+        V*        fBuffer2End;
     };
 
-    Scan makeBlurScan(int width, uint32_t* buffer) const {
-        uint32_t* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
+    template <int N>
+    Scan<N> makeBlurScan(int width, typename Scan<N>::V* buffer) const {
+        typename Scan<N>::V *buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
         buffer0 = buffer;
         buffer0End = buffer1 = buffer0 + fPass0Size;
         buffer1End = buffer2 = buffer1 + fPass1Size;
         buffer2End = buffer2 + fPass2Size;
         int noChangeCount = fSlidingWindow > width ? fSlidingWindow - width : 0;
 
-        return Scan(
+        return Scan<N>(
             fWeight, noChangeCount,
             buffer0, buffer0End,
             buffer1, buffer1End,
@@ -949,9 +949,57 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     return {radiusX, radiusY};
 }
 
+template <typename AlphaIter, size_t... Lanes>
+static std::array<AlphaIter, sizeof...(Lanes)> row_starts(AlphaIter start, size_t rowBytes, int y,
+                                                          skstd::index_sequence<Lanes...>) {
+    auto row = [&](size_t lane) {
+        AlphaIter it = start;
+        it >>= SkTo<uint32_t>((y + lane) * rowBytes);
+        return it;
+    };
+    return {{ row(Lanes)... }};
+}
+
+// Blurs rows rows of srcW values, row y starting y * srcRB bytes after start, and writes each
+// row's dstLen results down a column: row y goes to dst + y, dst + y + dstStride, ...
+//
+// Rows are independent, so we split them into bands and blur the bands in parallel.  Within a
+// band we blur kLanes rows at a time, one per SIMD lane, which makes each store kLanes bytes wide.
+template <typename AlphaIter>
+static void blur_rows_to_columns(const PlanGauss& plan,
+                                 AlphaIter start, size_t srcRB, int srcW, int rows,
+                                 uint8_t* dst, size_t dstStride, int dstLen,
+                                 SkExecutor& executor) {
+    static constexpr int kLanes       = 8,
+                         kRowsPerBand = 16 * kLanes;
+
+    SkTaskGroup(executor).batch((rows + kRowsPerBand - 1) / kRowsPerBand, [&](int band) {
+        SkSTArenaAlloc<1024> alloc;
+        auto wide   = alloc.makeArrayDefault<PlanGauss::Scan<kLanes>::V>(plan.bufferSize());
+        auto narrow = alloc.makeArrayDefault<PlanGauss::Scan<1     >::V>(plan.bufferSize());
+        const auto& wideScan   = plan.makeBlurScan<kLanes>(srcW, wide);
+        const auto& narrowScan = plan.makeBlurScan<1     >(srcW, narrow);
+
+        int y = band * kRowsPerBand;
+        const int end = std::min(rows, y + kRowsPerBand);
+        for (; y + kLanes <= end; y += kLanes) {
+            auto src = row_starts(start, srcRB, y, skstd::make_index_sequence<kLanes>{});
+            wideScan.blur(src.data(), srcW, dst + y, dstStride, dstLen);
+        }
+        for (; y < end; y++) {
+            auto src = row_starts(start, srcRB, y, skstd::make_index_sequence<1>{});
+            narrowScan.blur(src.data(), srcW, dst + y, dstStride, dstLen);
+        }
+    });
+}
+
 // TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
 // API forces the sigmas to be the same.
 SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
+    return this->blur(src, dst, SkExecutor::GetDefault());
+}
+
+SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst, SkExecutor& executor) const {
 
     if (fSigmaW < 2.0 && fSigmaH < 2.0) {
         return small_blur(fSigmaW, fSigmaH, src, dst);
@@ -982,9 +1030,6 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
     // Blur both directions.
     int tmpW = srcH,
         tmpH = dstW;
@@ -992,43 +1037,28 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
     switch (src.fFormat) {
         case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(src.fImage, 0);
+            blur_rows_to_columns(planW, start, src.fRowBytes, srcW, srcH, tmp, tmpW, tmpH,
+                                 executor);
         } break;
         case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(src.fImage);
+            blur_rows_to_columns(planW, start, src.fRowBytes, srcW, srcH, tmp, tmpW, tmpH,
+                                 executor);
         } break;
         case SkMask::kARGB32_Format: {
             const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
             auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_rows_to_columns(planW, start, src.fRowBytes, srcW, srcH, tmp, tmpW, tmpH,
+                                 executor);
         } break;
         case SkMask::kLCD16_Format: {
             const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
             auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_rows_to_columns(planW, start, src.fRowBytes, srcW, srcH, tmp, tmpW, tmpH,
+                                 executor);
         } break;
         default:
             SK_ABORT("Unhandled format.");
@@ -1036,14 +1066,8 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    blur_rows_to_columns(planH, SkMask::AlphaIter<SkMask::kA8_Format>(tmp), tmpW, tmpW, tmpH,
+                         dst->fImage, dst->fRowBytes, dstH, executor);
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
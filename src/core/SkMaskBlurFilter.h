@@ -15,6 +15,8 @@
 #include "include/core/SkTypes.h"
 #include "src/core/SkMask.h"
 
+class SkExecutor;
+
 // Implement a single channel Gaussian blur. The specifics for implementation are taken from:
 // https://drafts.fxtf.org/filters/#feGaussianBlurElement
 class SkMaskBlurFilter {
@@ -29,6 +31,9 @@ public:
     // Given a src SkMask, generate dst SkMask returning the border width and height.
     SkIPoint blur(const SkMask& src, SkMask* dst) const;
 
+    // As above, but large blurs run their bands on executor rather than SkExecutor::GetDefault().
+    SkIPoint blur(const SkMask& src, SkMask* dst, SkExecutor& executor) const;
+
 private:
     const double fSigmaW;
     const double fSigmaH;
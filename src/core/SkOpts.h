@@ -44,6 +44,19 @@ namespace SkOpts {
                            grayA_to_RGBA,   // i.e. expand to color channels
                            grayA_to_rgbA;   // i.e. expand to color channels and premultiply
 
+    // Look up packed 1, 2, or 4-bit indices (high bits first) in a table of 8888 pixels.
+    typedef void (*Swizzle_index)(uint32_t*, const uint8_t*, int, const uint32_t ctable[]);
+    extern Swizzle_index index1_to_8888,
+                         index2_to_8888,
+                         index4_to_8888;
+
+    // Look up 8-bit indices, deltaSrc bytes apart, in a table of 8888 pixels.
+    extern void (*index8_to_8888)(uint32_t*, const uint8_t*, int, int deltaSrc,
+                                  const uint32_t ctable[]);
+
+    // Copy 4-byte pixels, deltaSrc bytes apart.
+    extern void (*sample_8888)(uint32_t*, const uint8_t*, int, int deltaSrc);
+
     extern void (*memset16)(uint16_t[], uint16_t, int);
     extern void SK_API (*memset32)(uint32_t[], uint32_t, int);
     extern void (*memset64)(uint64_t[], uint64_t, int);
@@ -86,6 +86,19 @@ public:
         return false;
     }
 
+    static SkPathRef* PathRef(const SkPath& path) {
+        return path.fPathRef.get();
+    }
+
+    /**
+     *  Makes path share ref, which must have exactly the same contents as the path's own
+     *  SkPathRef.  Everything SkPath caches about its contents stays valid.
+     */
+    static void SetPathRef(SkPath* path, sk_sp<SkPathRef> ref) {
+        SkASSERT(*ref == *path->fPathRef);
+        path->fPathRef = std::move(ref);
+    }
+
     static void AddGenIDChangeListener(const SkPath& path,
                                        sk_sp<SkPathRef::GenIDChangeListener> listener) {
         path.fPathRef->addGenIDChangeListener(std::move(listener));
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPathRefInterner.h"
+
+#include "src/core/SkOpts.h"
+#include "src/core/SkPathPriv.h"
+
+bool SkPathRefInterner::Key::operator==(const Key& that) const {
+    const SkPathRef& a = *fRef;
+    const SkPathRef& b = *that.fRef;
+    if (!(a == b)) {
+        return false;
+    }
+    // The oval and rrect tags are hints that live on the SkPathRef, not part of its contents,
+    // but whoever shares the ref shares the hint, so they have to match too.
+    bool aCCW = false, bCCW = false;
+    unsigned aStart = 0, bStart = 0;
+    if (a.isOval(nullptr, &aCCW, &aStart) != b.isOval(nullptr, &bCCW, &bStart) ||
+        a.isRRect(nullptr, &aCCW, &aStart) != b.isRRect(nullptr, &bCCW, &bStart)) {
+        return false;
+    }
+    return aCCW == bCCW && aStart == bStart;
+}
+
+uint32_t SkPathRefInterner::Traits::Hash(const Key& key) {
+    const SkPathRef& ref = *key.fRef;
+    uint32_t hash = SkOpts::hash_fn(ref.points(), ref.countPoints() * sizeof(SkPoint),
+                                    ref.countVerbs());
+    hash = SkOpts::hash_fn(ref.verbsMemBegin(), ref.countVerbs() * sizeof(uint8_t), hash);
+    return SkOpts::hash_fn(ref.conicWeights(), ref.countWeights() * sizeof(SkScalar), hash);
+}
+
+SkPath SkPathRefInterner::intern(const SkPath& src) {
+    SkPathRef* ref = SkPathPriv::PathRef(src);
+    // Empty paths already share one SkPathRef, and volatile paths are about to change.
+    if (src.isVolatile() || 0 == ref->countVerbs()) {
+        return src;
+    }
+
+    SkPath dst = src;
+    if (const sk_sp<SkPathRef>* found = fRefs.find({ref})) {
+        SkPathPriv::SetPathRef(&dst, *found);
+    } else {
+        fRefs.set(sk_ref_sp(ref));
+    }
+    return dst;
+}
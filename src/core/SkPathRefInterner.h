@@ -0,0 +1,47 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPathRefInterner_DEFINED
+#define SkPathRefInterner_DEFINED
+
+#include "include/core/SkPath.h"
+#include "include/private/SkPathRef.h"
+#include "include/private/SkTHash.h"
+
+/**
+ *  Deduplicates SkPathRefs by content.  Every path passed through intern() that has the same
+ *  points, verbs and conic weights as one seen before comes back sharing that earlier path's
+ *  SkPathRef, and so its storage and generation ID.  Paths are copy-on-write, so editing one
+ *  afterwards is safe; it just gets its own SkPathRef again.
+ *
+ *  The interner holds a ref on every SkPathRef it has seen until it is destroyed.
+ *  Not thread safe.
+ */
+class SkPathRefInterner {
+public:
+    SkPathRefInterner() = default;
+
+    /** Returns a path equal to src, sharing its SkPathRef with every equal path interned so far. */
+    SkPath intern(const SkPath& src);
+
+    /** The number of distinct SkPathRefs held. */
+    int count() const { return fRefs.count(); }
+
+private:
+    struct Key {
+        const SkPathRef* fRef;
+        bool operator==(const Key&) const;
+    };
+    struct Traits {
+        static Key GetKey(const sk_sp<SkPathRef>& ref) { return {ref.get()}; }
+        static uint32_t Hash(const Key&);
+    };
+
+    SkTHashTable<sk_sp<SkPathRef>, Key, Traits> fRefs;
+};
+
+#endif
@@ -45,6 +45,9 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
         ? SkRecorder::Playback_DrawPictureMode
         : SkRecorder::Record_DrawPictureMode;
     fRecorder->reset(fRecord.get(), cullRect, dpm, fMiniRecorder.get());
+    if (recordFlags & kInternPaths_RecordFlag) {
+        fRecorder->internPaths();
+    }
     fActivelyRecording = true;
     return this->getRecordingCanvas();
 }
@@ -7,6 +7,9 @@
 
 #include "src/core/SkRTree.h"
 
+#include "include/private/SkNx.h"
+#include "include/private/SkTemplates.h"
+
 SkRTree::SkRTree(SkScalar aspectRatio)
     : fCount(0), fAspectRatio(isfinite(aspectRatio) ? aspectRatio : 1) {}
 
@@ -40,8 +43,7 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
         if (1 == fCount) {
             fNodes.setReserve(1);
             Node* n = this->allocateNodeAtLevel(0);
-            n->fNumChildren = 1;
-            n->fChildren[0] = branches[0];
+            n->append(branches[0]);
             fRoot.fSubtree = n;
             fRoot.fBounds  = branches[0].fBounds;
         } else {
@@ -55,11 +57,41 @@ SkRTree::Node* SkRTree::allocateNodeAtLevel(uint16_t level) {
     SkDEBUGCODE(Node* p = fNodes.begin());
     Node* out = fNodes.push();
     SkASSERT(fNodes.begin() == p);  // If this fails, we didn't setReserve() enough.
-    out->fNumChildren = 0;
+    sk_bzero(out, sizeof(Node));
     out->fLevel = level;
     return out;
 }
 
+void SkRTree::Node::append(const Branch& branch) {
+    SkASSERT(fNumChildren < kMaxChildren);
+    int i = fNumChildren++;
+    fLeft  [i] = branch.fBounds.fLeft;
+    fTop   [i] = branch.fBounds.fTop;
+    fRight [i] = branch.fBounds.fRight;
+    fBottom[i] = branch.fBounds.fBottom;
+    if (0 == fLevel) {
+        fChildren[i].fOpIndex = branch.fOpIndex;
+    } else {
+        fChildren[i].fSubtree = branch.fSubtree;
+    }
+}
+
+void SkRTree::Node::intersect(const SkRect& query, float hits[kChildLanes]) const {
+    const Sk4f qL(query.fLeft),
+               qT(query.fTop),
+               qR(query.fRight),
+               qB(query.fBottom);
+    for (int i = 0; i < kChildLanes; i += 4) {
+        // Just like SkRect::Intersects(child, query), argument order and all, so that NaNs in
+        // the query are treated the same way.
+        Sk4f L = Sk4f::Max(Sk4f::Load(fLeft   + i), qL),
+             T = Sk4f::Max(Sk4f::Load(fTop    + i), qT),
+             R = Sk4f::Min(Sk4f::Load(fRight  + i), qR),
+             B = Sk4f::Min(Sk4f::Load(fBottom + i), qB);
+        (L < R).thenElse((T < B).thenElse(Sk4f(1), Sk4f(0)), Sk4f(0)).store(hits + i);
+    }
+}
+
 // This function parallels bulkLoad, but just counts how many nodes bulkLoad would allocate.
 int SkRTree::CountNodes(int branches, SkScalar aspectRatio) {
     if (branches == 1) {
@@ -142,16 +174,14 @@ SkRTree::Branch SkRTree::bulkLoad(SkTDArray<Branch>* branches, int level) {
                 }
             }
             Node* n = allocateNodeAtLevel(level);
-            n->fNumChildren = 1;
-            n->fChildren[0] = (*branches)[currentBranch];
+            n->append((*branches)[currentBranch]);
             Branch b;
             b.fBounds = (*branches)[currentBranch].fBounds;
             b.fSubtree = n;
             ++currentBranch;
             for (int k = 1; k < incrementBy && currentBranch < branches->count(); ++k) {
                 b.fBounds.join((*branches)[currentBranch].fBounds);
-                n->fChildren[k] = (*branches)[currentBranch];
-                ++n->fNumChildren;
+                n->append((*branches)[currentBranch]);
                 ++currentBranch;
             }
             (*branches)[newBranches] = b;
@@ -169,8 +199,10 @@ void SkRTree::search(const SkRect& query, SkTDArray<int>* results) const {
 }
 
 void SkRTree::search(Node* node, const SkRect& query, SkTDArray<int>* results) const {
+    float hits[kChildLanes];
+    node->intersect(query, hits);
     for (int i = 0; i < node->fNumChildren; ++i) {
-        if (SkRect::Intersects(node->fChildren[i].fBounds, query)) {
+        if (hits[i]) {
             if (0 == node->fLevel) {
                 results->push_back(node->fChildren[i].fOpIndex);
             } else {
@@ -180,6 +212,52 @@ void SkRTree::search(Node* node, const SkRect& query, SkTDArray<int>* results) c
     }
 }
 
+void SkRTree::search(const SkRect queries[], int count, SkTDArray<int> results[]) const {
+    if (fCount == 0) {
+        return;
+    }
+    SkAutoSTMalloc<64, int> active(count);
+    int activeCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (SkRect::Intersects(fRoot.fBounds, queries[i])) {
+            active[activeCount++] = i;
+        }
+    }
+    if (activeCount > 0) {
+        this->search(fRoot.fSubtree, queries, active.get(), activeCount, results);
+    }
+}
+
+// active holds the indices of the queries that intersect node's bounds.
+void SkRTree::search(Node* node, const SkRect queries[], const int active[], int activeCount,
+                     SkTDArray<int> results[]) const {
+    SkAutoSTMalloc<16 * kChildLanes, float> hits(activeCount * kChildLanes);
+    for (int j = 0; j < activeCount; ++j) {
+        node->intersect(queries[active[j]], hits.get() + j * kChildLanes);
+    }
+
+    SkAutoSTMalloc<16, int> childActive(activeCount);
+    for (int i = 0; i < node->fNumChildren; ++i) {
+        int childActiveCount = 0;
+        for (int j = 0; j < activeCount; ++j) {
+            if (hits[j * kChildLanes + i]) {
+                childActive[childActiveCount++] = active[j];
+            }
+        }
+        if (childActiveCount == 0) {
+            continue;
+        }
+        if (0 == node->fLevel) {
+            for (int j = 0; j < childActiveCount; ++j) {
+                results[childActive[j]].push_back(node->fChildren[i].fOpIndex);
+            }
+        } else {
+            this->search(node->fChildren[i].fSubtree, queries, childActive.get(),
+                         childActiveCount, results);
+        }
+    }
+}
+
 size_t SkRTree::bytesUsed() const {
     size_t byteCount = sizeof(SkRTree);
 
@@ -44,6 +44,13 @@ public:
     void search(const SkRect& query, SkTDArray<int>* results) const override;
     size_t bytesUsed() const override;
 
+    /**
+     * Fills results[i] just as search(queries[i], &results[i]) would, but finds the results for
+     * all the queries in one walk down the tree.  Useful for finding the ops for every tile of a
+     * tiled playback at once.
+     */
+    void search(const SkRect queries[], int count, SkTDArray<int> results[]) const;
+
     // Methods and constants below here are only public for tests.
 
     // Return the depth of the tree structure.
@@ -69,13 +76,32 @@ private:
         SkRect fBounds;
     };
 
+    // Enough for kMaxChildren, rounded up to a whole number of 4-float vectors.
+    static const int kChildLanes = (kMaxChildren + 3) & ~3;
+
     struct Node {
         uint16_t fNumChildren;
         uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
+        // The children's bounds are kept one edge per array, so a query can be tested against
+        // four children at a time.  Lanes past fNumChildren are zero.
+        float    fLeft  [kChildLanes];
+        float    fTop   [kChildLanes];
+        float    fRight [kChildLanes];
+        float    fBottom[kChildLanes];
+        union {
+            Node* fSubtree;
+            int fOpIndex;
+        } fChildren[kMaxChildren];
+
+        void append(const Branch&);
+
+        // Sets hits[i] non-zero if SkRect::Intersects(bounds of child i, query), zero if not.
+        void intersect(const SkRect& query, float hits[kChildLanes]) const;
     };
 
     void search(Node* root, const SkRect& query, SkTDArray<int>* results) const;
+    void search(Node* root, const SkRect queries[], const int active[], int activeCount,
+                SkTDArray<int> results[]) const;
 
     // Consumes the input array.
     Branch bulkLoad(SkTDArray<Branch>* branches, int level = 0);
@@ -33,7 +33,7 @@
  */
 
 #define SK_RASTER_PIPELINE_STAGES(M)                               \
-    M(callback)                                                    \
+    M(callback) M(interpreter)                                     \
     M(move_src_dst) M(move_dst_src)                                \
     M(clamp_0) M(clamp_1) M(clamp_a) M(clamp_gamut)                \
     M(unpremul) M(premul) M(premul_dst)                            \
@@ -142,6 +142,16 @@ struct SkRasterPipeline_CallbackCtx {
     float* read_from = rgba;
 };
 
+// Like SkRasterPipeline_CallbackCtx, but hands fn() all our lanes at once, planar, for
+// SkSL::Interpreter::runStriped() to work on directly.
+struct SkRasterPipeline_InterpreterCtx {
+    void (*fn)(SkRasterPipeline_InterpreterCtx* self, int stride, int active_pixels);
+
+    // When called, fn() will find r in rgba[0..stride), g in rgba[stride..2*stride), etc.,
+    // and should leave its results there too.
+    float rgba[4*SkRasterPipeline_kMaxStride];
+};
+
 struct SkRasterPipeline_GradientCtx {
     size_t stopCount;
     float* fs[4];
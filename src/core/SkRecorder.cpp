@@ -65,10 +65,17 @@ void SkRecorder::reset(SkRecord* record, const SkRect& bounds,
 
 void SkRecorder::forgetRecord() {
     fDrawableList.reset(nullptr);
+    fPathRefInterner.reset(nullptr);
     fApproxBytesUsedBySubPictures = 0;
     fRecord = nullptr;
 }
 
+void SkRecorder::internPaths() {
+    if (!fPathRefInterner) {
+        fPathRefInterner.reset(new SkPathRefInterner);
+    }
+}
+
 // To make appending to fRecord a little less verbose.
 template<typename T, typename... Args>
 void SkRecorder::append(Args&&... args) {
@@ -191,7 +198,7 @@ void SkRecorder::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
 
 void SkRecorder::onDrawPath(const SkPath& path, const SkPaint& paint) {
     TRY_MINIRECORDER(drawPath, path, paint);
-    this->append<SkRecords::DrawPath>(paint, path);
+    this->append<SkRecords::DrawPath>(paint, this->internPath(path));
 }
 
 void SkRecorder::onDrawBitmap(const SkBitmap& bitmap,
@@ -307,7 +314,7 @@ void SkRecorder::onDrawAtlas(const SkImage* atlas, const SkRSXform xform[], cons
 }
 
 void SkRecorder::onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
-    this->append<SkRecords::DrawShadowRec>(path, rec);
+    this->append<SkRecords::DrawShadowRec>(this->internPath(path), rec);
 }
 
 void SkRecorder::onDrawAnnotation(const SkRect& rect, const char key[], SkData* value) {
@@ -390,7 +397,7 @@ void SkRecorder::onClipRRect(const SkRRect& rrect, SkClipOp op, ClipEdgeStyle ed
 void SkRecorder::onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) {
     INHERITED(onClipPath, path, op, edgeStyle);
     SkRecords::ClipOpAndAA opAA(op, kSoft_ClipEdgeStyle == edgeStyle);
-    this->append<SkRecords::ClipPath>(path, opAA);
+    this->append<SkRecords::ClipPath>(this->internPath(path), opAA);
 }
 
 void SkRecorder::onClipRegion(const SkRegion& deviceRgn, SkClipOp op) {
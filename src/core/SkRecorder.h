@@ -13,6 +13,7 @@
 #include "include/utils/SkNoDrawCanvas.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkMiniRecorder.h"
+#include "src/core/SkPathRefInterner.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecords.h"
 
@@ -54,6 +55,10 @@ public:
     // Make SkRecorder forget entirely about its SkRecord*; all calls to SkRecorder will fail.
     void forgetRecord();
 
+    // Until the next reset() or forgetRecord(), share one SkPathRef between all recorded paths
+    // with the same contents.
+    void internPaths();
+
     void onFlush() override;
 
     void willSave() override;
@@ -133,10 +138,15 @@ private:
     template<typename T, typename... Args>
     void append(Args&&...);
 
+    SkPath internPath(const SkPath& path) {
+        return fPathRefInterner ? fPathRefInterner->intern(path) : path;
+    }
+
     DrawPictureMode fDrawPictureMode;
     size_t fApproxBytesUsedBySubPictures;
     SkRecord* fRecord;
     std::unique_ptr<SkDrawableList> fDrawableList;
+    std::unique_ptr<SkPathRefInterner> fPathRefInterner;
 
     SkMiniRecorder* fMiniRecorder;
 };
@@ -14,7 +14,9 @@
 #include "src/core/SkDiscardableMemory.h"
 #include "src/core/SkMipMap.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkSharedMutex.h"
 
+#include <algorithm>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -83,6 +85,7 @@ void SkResourceCache::init() {
     fHash = new Hash;
     fTotalBytesUsed = 0;
     fCount = 0;
+    fDiscardableCountLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
     fSingleAllocationByteLimit = 0;
 
     // One of these should be explicit set by the caller after we return.
@@ -128,6 +131,20 @@ bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     return false;
 }
 
+bool SkResourceCache::findShared(const Key& key, FindVisitor visitor, void* context,
+                                 bool* stale) const {
+    *stale = false;
+    if (auto found = fHash->find(key)) {
+        Rec* rec = *found;
+        if (visitor(*rec, context)) {
+            rec->fRecentlyUsed.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        *stale = true;
+    }
+    return false;
+}
+
 static void make_size_str(size_t size, SkString* str) {
     const char suffix[] = { 'b', 'k', 'm', 'g', 't', 0 };
     int i = 0;
@@ -203,13 +220,17 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
     int    countLimit;
 
     if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+        countLimit = fDiscardableCountLimit;
         byteLimit = UINT32_MAX;  // no limit based on bytes
     } else {
         countLimit = SK_MaxS32; // no limit based on count
         byteLimit = fTotalByteLimit;
     }
 
+    this->purgeDownTo(byteLimit, countLimit, forcePurge);
+}
+
+void SkResourceCache::purgeDownTo(size_t byteLimit, int countLimit, bool forcePurge) {
     Rec* rec = fTail;
     while (rec) {
         if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
@@ -217,7 +238,12 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         }
 
         Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
+        if (!forcePurge && rec->fRecentlyUsed.load(std::memory_order_relaxed)) {
+            // Found since it was last considered, so treat it as if find() had moved it to the
+            // head.  We still come back to it if we walk all the way to the head.
+            rec->fRecentlyUsed.store(false, std::memory_order_relaxed);
+            this->moveToHead(rec);
+        } else if (rec->canBePurged()) {
             this->remove(rec);
         }
         rec = prev;
@@ -289,17 +315,20 @@ size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
     return prevLimit;
 }
 
-SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
-    this->checkMessages();
-
-    if (fDiscardableFactory) {
-        SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+static SkCachedData* new_cached_data(SkResourceCache::DiscardableFactory factory, size_t bytes) {
+    if (factory) {
+        SkDiscardableMemory* dm = factory(bytes);
         return dm ? new SkCachedData(bytes, dm) : nullptr;
     } else {
         return new SkCachedData(sk_malloc_throw(bytes), bytes);
     }
 }
 
+SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
+    this->checkMessages();
+    return new_cached_data(fDiscardableFactory, bytes);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::release(Rec* rec) {
@@ -449,91 +478,276 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkResourceCache* gResourceCache = nullptr;
-
-/** Must hold gMutex when calling. */
-static SkResourceCache* get_cache() {
-    // gMutex is always held when this is called, so we don't need to be fancy in here.
-    gMutex.assertHeld();
-    if (nullptr == gResourceCache) {
+// Counts the purge messages posted, so finds on the global cache can tell when a shard has some
+// waiting without taking its lock.
+static std::atomic<uint32_t> gPurgeMessagesPosted{0};
+
+// The global cache.  Keys are split by hash into shards, each an SkResourceCache behind its own
+// lock.  Finds that hit take that lock shared, so threads drawing the same images don't queue up
+// behind one another.  Everything that changes a shard takes its lock exclusively, including finds
+// that must first read purge messages, or that find a stale rec.
+//
+// Each shard's own limit is the whole budget, so a busy shard can use more than its even slice
+// while the cache as a whole has room.  Once the total goes over budget, reconcileBudget() takes
+// the excess back from the shards furthest over their slices.
+class SkShardedResourceCache {
+public:
+    SkShardedResourceCache() {
+        for (Shard& shard : fShards) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+            shard.fCache.reset(new SkResourceCache(SkDiscardableMemory::Create));
+            shard.fCache->fDiscardableCountLimit =
+                    SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / kShardCount;
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+            shard.fCache.reset(new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT));
 #endif
+        }
+    }
+
+    bool find(const SkResourceCache::Key& key, SkResourceCache::FindVisitor visitor,
+              void* context) {
+        Shard& shard = this->shardFor(key);
+        if (!shard.hasUnreadMessages()) {
+            SkAutoSharedMutexShared lock(shard.fMutex);
+            bool stale;
+            if (shard.fCache->findShared(key, visitor, context, &stale)) {
+                return true;
+            }
+            if (!stale) {
+                return false;
+            }
+        }
+        // Take the shard to ourselves, so find() can read the purge messages first and purge
+        // the rec if it is stale.
+        SkAutoExclusive lock(shard.fMutex);
+        shard.willReadMessages();
+        bool found = shard.fCache->find(key, visitor, context);
+        shard.updateBytesUsed();
+        return found;
+    }
+
+    void add(SkResourceCache::Rec* rec, void* payload) {
+        Shard& shard = this->shardFor(rec->getKey());
+        {
+            SkAutoExclusive lock(shard.fMutex);
+            shard.willReadMessages();
+            shard.fCache->add(rec, payload);
+            shard.updateBytesUsed();
+        }
+        this->reconcileBudget();
+    }
+
+    void visitAll(SkResourceCache::Visitor visitor, void* context) {
+        for (Shard& shard : fShards) {
+            SkAutoSharedMutexShared lock(shard.fMutex);
+            shard.fCache->visitAll(visitor, context);
+        }
+    }
+
+    size_t getTotalBytesUsed() const {
+        size_t used = 0;
+        for (const Shard& shard : fShards) {
+            used += shard.fBytesUsed.load(std::memory_order_relaxed);
+        }
+        return used;
+    }
+
+    size_t getTotalByteLimit() {
+        SkAutoSharedMutexShared lock(fShards[0].fMutex);
+        return fShards[0].fCache->getTotalByteLimit();
+    }
+
+    size_t setTotalByteLimit(size_t newLimit) {
+        size_t prevLimit = 0;
+        for (Shard& shard : fShards) {
+            SkAutoExclusive lock(shard.fMutex);
+            prevLimit = shard.fCache->setTotalByteLimit(newLimit);
+            shard.updateBytesUsed();
+        }
+        this->reconcileBudget();
+        return prevLimit;
     }
+
+    size_t setSingleAllocationByteLimit(size_t newLimit) {
+        size_t prevLimit = 0;
+        for (Shard& shard : fShards) {
+            SkAutoExclusive lock(shard.fMutex);
+            prevLimit = shard.fCache->setSingleAllocationByteLimit(newLimit);
+        }
+        return prevLimit;
+    }
+
+    size_t getSingleAllocationByteLimit() {
+        SkAutoSharedMutexShared lock(fShards[0].fMutex);
+        return fShards[0].fCache->getSingleAllocationByteLimit();
+    }
+
+    size_t getEffectiveSingleAllocationByteLimit() {
+        SkAutoSharedMutexShared lock(fShards[0].fMutex);
+        return fShards[0].fCache->getEffectiveSingleAllocationByteLimit();
+    }
+
+    void purgeAll() {
+        for (Shard& shard : fShards) {
+            SkAutoExclusive lock(shard.fMutex);
+            shard.fCache->purgeAll();
+            shard.updateBytesUsed();
+        }
+    }
+
+    // This never changes after construction, so needs no lock.
+    SkResourceCache::DiscardableFactory discardableFactory() const {
+        return fShards[0].fCache->discardableFactory();
+    }
+
+    SkCachedData* newCachedData(size_t bytes) {
+        return new_cached_data(this->discardableFactory(), bytes);
+    }
+
+    void dump() {
+        for (Shard& shard : fShards) {
+            SkAutoSharedMutexShared lock(shard.fMutex);
+            shard.fCache->dump();
+        }
+    }
+
+private:
+    static constexpr int kShardBits  = 3;
+    static constexpr int kShardCount = 1 << kShardBits;
+
+    struct Shard {
+        SkSharedMutex                    fMutex;
+        std::unique_ptr<SkResourceCache> fCache;
+        // A copy of fCache->getTotalBytesUsed(), so the total can be read without any locks.
+        std::atomic<size_t>              fBytesUsed{0};
+        // gPurgeMessagesPosted as of the last time fCache read its messages.
+        std::atomic<uint32_t>            fMessagesRead{0};
+
+        bool hasUnreadMessages() const {
+            return fMessagesRead.load(std::memory_order_relaxed) !=
+                   gPurgeMessagesPosted.load(std::memory_order_acquire);
+        }
+
+        // The rest must hold fMutex exclusively.
+        void willReadMessages() {
+            fMessagesRead.store(gPurgeMessagesPosted.load(std::memory_order_acquire),
+                                std::memory_order_relaxed);
+        }
+
+        void updateBytesUsed() {
+            fBytesUsed.store(fCache->getTotalBytesUsed(), std::memory_order_relaxed);
+        }
+    };
+
+    Shard& shardFor(const SkResourceCache::Key& key) {
+        // Each shard's hash table picks slots with the low bits of the hash, so shard on the high.
+        return fShards[key.hash() >> (32 - kShardBits)];
+    }
+
+    void reconcileBudget() {
+        if (this->discardableFactory()) {
+            return;  // No byte budget, and each shard keeps to its share of the count limit.
+        }
+
+        size_t limit = this->getTotalByteLimit();
+        if (this->getTotalBytesUsed() < limit) {
+            return;
+        }
+        const size_t slice = limit / kShardCount;
+
+        // Visit the shards furthest over their slices first.
+        int order[kShardCount];
+        size_t used[kShardCount];
+        for (int i = 0; i < kShardCount; i++) {
+            order[i] = i;
+            used[i] = fShards[i].fBytesUsed.load(std::memory_order_relaxed);
+        }
+        std::sort(order, order + kShardCount, [&](int a, int b) { return used[a] > used[b]; });
+
+        for (int i : order) {
+            size_t total = this->getTotalBytesUsed();
+            if (total < limit) {
+                break;
+            }
+            Shard& shard = fShards[i];
+            SkAutoExclusive lock(shard.fMutex);
+            size_t shardUsed = shard.fCache->getTotalBytesUsed();
+            if (shardUsed < slice) {
+                continue;
+            }
+            // purgeDownTo() leaves the shard strictly under target, so like purgeAsNeeded() we
+            // end up strictly under the limit, even with every shard exactly at its slice.
+            size_t excess = total - limit;
+            size_t target = shardUsed - SkTMin(shardUsed - slice, excess);
+            shard.fCache->purgeDownTo(target, SK_MaxS32, false);
+            shard.updateBytesUsed();
+        }
+    }
+
+    Shard fShards[kShardCount];
+};
+
+static SkShardedResourceCache* get_cache() {
+    static SkShardedResourceCache* gResourceCache = new SkShardedResourceCache;
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->purgeAll();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->visitAll(visitor, context);
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
     if (sharedID) {
         SkMessageBus<PurgeSharedIDMessage>::Post(PurgeSharedIDMessage(sharedID));
+        gPurgeMessagesPosted.fetch_add(1, std::memory_order_release);
     }
 }
 
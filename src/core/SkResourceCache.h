@@ -12,6 +12,8 @@
 #include "include/private/SkMessageBus.h"
 #include "include/private/SkTDArray.h"
 
+#include <atomic>
+
 class SkCachedData;
 class SkDiscardableMemory;
 class SkTraceMemoryDump;
@@ -25,6 +27,9 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is split by key hash into several shards, each with its
+ *  own lock, LRU and slice of the budget, so threads working with different
+ *  keys rarely wait on one another.
  */
 class SkResourceCache {
 public:
@@ -106,6 +111,10 @@ public:
         Rec*    fNext;
         Rec*    fPrev;
 
+        // Set by finds on the global cache, which don't move the rec to the head of the LRU.
+        // The next purge gives a rec with this set a second chance instead of removing it.
+        std::atomic<bool> fRecentlyUsed{false};
+
         friend class SkResourceCache;
     };
 
@@ -148,6 +157,10 @@ public:
      *  Its return value is interpreted to mean:
      *      true  : Rec is valid
      *      false : Rec is "stale" -- the cache will purge it.
+     *
+     *  Finds that hit only take a shared lock, so the visitor may be called on the same Rec
+     *  from several threads at once.  A visitor that returns false is called again under an
+     *  exclusive lock before the Rec is purged.
      */
     static bool Find(const Key& key, FindVisitor, void* context);
     static void Add(Rec*, void* payload = nullptr);
@@ -257,6 +270,8 @@ public:
     void dump() const;
 
 private:
+    friend class SkShardedResourceCache;
+
     Rec*    fHead;
     Rec*    fTail;
 
@@ -269,11 +284,18 @@ private:
     size_t  fTotalByteLimit;
     size_t  fSingleAllocationByteLimit;
     int     fCount;
+    int     fDiscardableCountLimit;
 
     SkMessageBus<PurgeSharedIDMessage>::Inbox fPurgeSharedIDInbox;
 
     void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
+    void purgeDownTo(size_t byteLimit, int countLimit, bool forcePurge);
+
+    // Like find(), but may run concurrently with other calls to findShared(): rather than move
+    // a valid rec to the head it marks it recently used, and it leaves stale recs in place,
+    // returning false and setting *stale.
+    bool findShared(const Key&, FindVisitor, void* context, bool* stale) const;
 
     // linklist management
     void moveToHead(Rec*);
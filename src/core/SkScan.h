@@ -25,6 +25,8 @@ typedef SkIRect SkXRect;
 
 extern std::atomic<bool> gSkUseAnalyticAA;
 extern std::atomic<bool> gSkForceAnalyticAA;
+extern std::atomic<bool> gSkUseSparseStripAA;
+extern std::atomic<bool> gSkForceSparseStripAA;
 
 class AdditiveBlitter;
 
@@ -70,6 +72,13 @@ public:
     // Needed by do_fill_path in SkScanPriv.h
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
 
+    // The experimental sparse-strip filler that AntiFillPath() picks under gSkUseSparseStripAA
+    // or gSkForceSparseStripAA, for tests and benches that want it regardless of the flags.
+    // Fills non-inverse paths within pathIR and clipBounds.
+    static void SparseStripFillPath(const SkPath& path, SkBlitter* blitter,
+                                    const SkIRect& pathIR, const SkIRect& clipBounds,
+                                    bool forceRLE);
+
 private:
     friend class SkAAClip;
     friend class SkRegion;
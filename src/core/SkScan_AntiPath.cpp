@@ -672,6 +672,23 @@ static bool ShouldUseAAA(const SkPath& path, SkScalar avgLength, SkScalar comple
 #endif
 }
 
+// Sparse strips skip AAA's and SAA's per-scanline edge sorting, which dominates once a path has
+// very many edges.  They are experimental, and only used when gSkUseSparseStripAA or
+// gSkForceSparseStripAA is set.
+// TODO: This threshold is untuned.  Tune it from release-build path_fill_complex_* bench and SKP
+// numbers before turning sparse strips on by default.
+static constexpr int kSparseStripMinPoints = 4096;
+
+static bool ShouldUseSparseStrips(const SkPath& path) {
+    if (path.isInverseFillType()) {
+        return false;   // Sparse strips only fill within the path's bounds.
+    }
+    if (gSkForceSparseStripAA) {
+        return true;
+    }
+    return gSkUseSparseStripAA && path.countPoints() >= kSparseStripMinPoints;
+}
+
 void SkScan::SAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& ir,
                   const SkIRect& clipBounds, bool forceRLE) {
     bool containedInClip = clipBounds.contains(ir);
@@ -783,6 +800,11 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
         sk_blit_above(blitter, ir, *clipRgn);
     }
 
+    if (ShouldUseSparseStrips(path)) {
+        SkScan::SparseStripFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE);
+        return;
+    }
+
     SkScalar avgLength, complexity;
     compute_complexity(path, avgLength, complexity);
 
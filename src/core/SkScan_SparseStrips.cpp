@@ -0,0 +1,442 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPath.h"
+#include "include/private/SkNx.h"
+#include "include/private/SkTDArray.h"
+#include "include/private/SkTemplates.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkGeometry.h"
+#include "src/core/SkScan.h"
+#include "src/core/SkTSort.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+
+Sparse strips: an anti-aliased path filler for paths with very many edges.
+
+AAA and SAA walk the path one scanline at a time, keeping a sorted list of the active edges.
+With hundreds of thousands of edges that bookkeeping, not the coverage math, dominates.  Here
+we never sort edges against each other.  Instead:
+
+  1. Flatten the path to lines, and split every line where it crosses the edges of a grid of
+     kTileW x kTileH pixel tiles, recording each piece with the tile it falls in.
+
+  2. Sort the pieces by tile, in raster order.
+
+  3. For each tile holding pieces, accumulate each piece's signed area into a small grid of
+     cells, one per pixel plus one extra column.  Coverage at a pixel is the running sum of the
+     cells from the left edge of the path bounds, so a piece's effect on all the pixels to the
+     right of its tile is just the extra column.  We sum the cells with Sk4f, one tile column
+     (all kTileH rows) at a time.
+
+  4. Between tiles the running sum (the "backdrop") is constant along each row, so the gaps
+     between tiles become single solid (or empty) spans.
+
+Pixels on the path's edges end up in short strips of tiles, and everything else in long spans,
+so the work is proportional to the path's edges and its height, not its area.
+
+*/
+
+static constexpr int kTileW = 16,
+                     kTileH = 4;    // We sum a tile one column, one Sk4f, at a time.
+
+namespace {
+
+struct Piece {
+    uint32_t tile;              // Tile row << 16 | tile column.
+    float    x0, y0, x1, y1;    // Relative to the tile's top left corner.
+};
+
+// Splits lines into pieces, each within one tile.
+class PieceBuilder {
+public:
+    PieceBuilder(int width, int height) : fWidth(width), fHeight(height) {}
+
+    // p0 and p1 are relative to the top left of the bounds we're filling.
+    void addLine(SkPoint p0, SkPoint p1) {
+        float x0 = p0.fX, y0 = p0.fY,
+              x1 = p1.fX, y1 = p1.fY;
+        if (y0 == y1) {
+            return;     // Horizontal lines don't change coverage.
+        }
+        if (std::max(y0, y1) <= 0 || std::min(y0, y1) >= fHeight) {
+            return;
+        }
+        const float dxdy = (x1 - x0) / (y1 - y0);
+        auto clamp_y = [&](float* x, float* y) {
+            float clamped = SkTPin(*y, 0.0f, (float)fHeight);
+            *x += (clamped - *y) * dxdy;
+            *y = clamped;
+        };
+        clamp_y(&x0, &y0);
+        clamp_y(&x1, &y1);
+        if (y0 == y1) {
+            return;
+        }
+
+        // Lines right of the bounds don't affect any pixel we draw.  Lines left of the bounds
+        // affect every pixel to their right the same way a vertical line on the left edge would.
+        // Split the line where it crosses either side, then handle each part separately.
+        float ts[4] = { 0, 1, 1, 1 };
+        int count = 1;
+        if (x0 != x1) {
+            for (float edge : { 0.0f, (float)fWidth }) {
+                float t = (edge - x0) / (x1 - x0);
+                if (0 < t && t < 1) {
+                    ts[count++] = t;
+                }
+            }
+        }
+        ts[count++] = 1;
+        std::sort(ts, ts + count);
+
+        for (int i = 0; i + 1 < count; i++) {
+            float xa = x0 + (x1 - x0) * ts[i],   ya = y0 + (y1 - y0) * ts[i],
+                  xb = x0 + (x1 - x0) * ts[i+1], yb = y0 + (y1 - y0) * ts[i+1];
+            float mid = 0.5f * (xa + xb);
+            if (mid >= fWidth) {
+                continue;
+            }
+            if (mid <= 0) {
+                xa = xb = 0;
+            }
+            this->addClippedLine(SkTPin(xa, 0.0f, (float)fWidth), ya,
+                                 SkTPin(xb, 0.0f, (float)fWidth), yb);
+        }
+    }
+
+    SkTDArray<Piece>* pieces() { return &fPieces; }
+
+private:
+    // 0 <= x <= fWidth, 0 <= y <= fHeight.
+    void addClippedLine(float x0, float y0, float x1, float y1) {
+        if (y0 == y1) {
+            return;
+        }
+        const float dxdy = (x1 - x0) / (y1 - y0);
+        const int top    = (int)(std::min(y0, y1) * (1.0f / kTileH)),
+                  bottom = (int)std::ceil(std::max(y0, y1) * (1.0f / kTileH));
+        for (int ty = top; ty < bottom; ty++) {
+            // Clip to this row of tiles, keeping the line's direction.
+            float rowTop    = (float)(ty * kTileH),
+                  rowBottom = rowTop + kTileH;
+            float ya = SkTPin(y0, rowTop, rowBottom),
+                  yb = SkTPin(y1, rowTop, rowBottom);
+            if (ya == yb) {
+                continue;
+            }
+            this->addRowPiece(ty, x0 + (ya - y0) * dxdy, ya,
+                                  x0 + (yb - y0) * dxdy, yb);
+        }
+    }
+
+    // Splits a line within one row of tiles at each tile column it crosses.
+    void addRowPiece(int ty, float x0, float y0, float x1, float y1) {
+        const float left  = std::min(x0, x1),
+                    right = std::max(x0, x1);
+        const int first = (int)(left * (1.0f / kTileW)),
+                  last  = std::min((int)(right * (1.0f / kTileW)), (fWidth - 1) / kTileW);
+        const float dydx = x0 == x1 ? 0 : (y1 - y0) / (x1 - x0);
+
+        for (int tx = first; tx <= last; tx++) {
+            float tileLeft = (float)(tx * kTileW),
+                  cl = std::max(left,  tileLeft),
+                  cr = std::min(right, tileLeft + kTileW);
+            float xa = x0, ya = y0,
+                  xb = x1, yb = y1;
+            if (x0 != x1) {
+                if (cl >= cr) {
+                    continue;
+                }
+                // Keep the original direction: x0 is the start, whichever side it's on.
+                xa = x0 < x1 ? cl : cr;
+                xb = x0 < x1 ? cr : cl;
+                ya = y0 + (xa - x0) * dydx;
+                yb = y0 + (xb - x0) * dydx;
+            }
+            float tileTop = (float)(ty * kTileH);
+            fPieces.push_back({ (uint32_t)ty << 16 | (uint32_t)tx,
+                                SkTPin(xa - tileLeft, 0.0f, (float)kTileW),
+                                SkTPin(ya - tileTop,  0.0f, (float)kTileH),
+                                SkTPin(xb - tileLeft, 0.0f, (float)kTileW),
+                                SkTPin(yb - tileTop,  0.0f, (float)kTileH) });
+        }
+    }
+
+    int              fWidth,
+                     fHeight;
+    SkTDArray<Piece> fPieces;
+};
+
+}  // namespace
+
+// cells[x][y] holds the change in signed coverage between pixel x-1 and pixel x on row y.
+// Column kTileW carries each row's total change on to every pixel right of the tile.
+using Cells = float[kTileW + 1][kTileH];
+
+static void add_cell(Cells cells, int x, int y, float v) {
+    cells[SkTPin(x, 0, kTileW)][y] += v;
+}
+
+// Accumulates the signed area to the right of one piece, one row of pixels at a time.
+static void accumulate(Cells cells, const Piece& piece) {
+    float x0 = piece.x0, y0 = piece.y0,
+          x1 = piece.x1, y1 = piece.y1;
+    if (y0 == y1) {
+        return;
+    }
+    float dir = 1;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1;
+    }
+    const float dxdy = (x1 - x0) / (y1 - y0);
+
+    float x = x0;
+    for (int y = (int)y0; y < kTileH && y < y1; y++) {
+        const float dy    = std::min(y + 1.0f, y1) - std::max((float)y, y0),
+                    xnext = x + dxdy * dy,
+                    d     = dy * dir;
+        const float left  = std::min(x, xnext),
+                    right = std::max(x, xnext);
+        const float leftFloor = std::floor(left),
+                    rightCeil = std::ceil(right);
+        const int   l = (int)leftFloor,
+                    r = (int)rightCeil;
+
+        if (r <= l + 1) {
+            // Within one pixel: split by how far across the pixel the piece sits, on average.
+            float mid = 0.5f * (x + xnext) - leftFloor;
+            add_cell(cells, l,     y, d - d * mid);
+            add_cell(cells, l + 1, y, d * mid);
+        } else {
+            // Across several pixels: a triangle in the first, trapezoids, a triangle in the last.
+            const float s       = 1 / (right - left),
+                        leftF   = left - leftFloor,
+                        first   = 0.5f * s * (1 - leftF) * (1 - leftF),
+                        rightF  = right - rightCeil + 1,
+                        last    = 0.5f * s * rightF * rightF;
+            add_cell(cells, l, y, d * first);
+            if (r == l + 2) {
+                add_cell(cells, l + 1, y, d * (1 - first - last));
+            } else {
+                const float second = s * (1.5f - leftF);
+                add_cell(cells, l + 1, y, d * (second - first));
+                for (int i = l + 2; i < r - 1; i++) {
+                    add_cell(cells, i, y, d * s);
+                }
+                const float beforeLast = second + (r - l - 3) * s;
+                add_cell(cells, r - 1, y, d * (1 - beforeLast - last));
+            }
+            add_cell(cells, r, y, d * last);
+        }
+        x = xnext;
+    }
+}
+
+namespace {
+
+// Builds the runs for one row of pixels left to right, merging neighbors with equal alpha.
+class RowBuilder {
+public:
+    void reset(int width) {
+        fAlpha.reset(width + 1);
+        fRuns .reset(width + 1);
+        fStart = -1;
+    }
+
+    void append(int x, int len, SkAlpha alpha) {
+        if (fStart < 0) {
+            if (alpha == 0) {
+                return;
+            }
+            fStart = fLastRun = x;
+            fAlpha[x] = alpha;
+            fRuns [x] = len;
+        } else if (fAlpha[fLastRun] == alpha) {
+            fRuns[fLastRun] += len;
+        } else {
+            fLastRun = x;
+            fAlpha[x] = alpha;
+            fRuns [x] = len;
+        }
+        fEnd = x + len;
+    }
+
+    void flush(SkBlitter* blitter, int left, int y) {
+        if (fStart < 0) {
+            return;
+        }
+        int end = fAlpha[fLastRun] ? fEnd : fLastRun;
+        fRuns[end] = 0;
+        blitter->blitAntiH(left + fStart, y, fAlpha.get() + fStart, fRuns.get() + fStart);
+        fStart = -1;
+    }
+
+private:
+    SkAutoTMalloc<SkAlpha> fAlpha;
+    SkAutoTMalloc<int16_t> fRuns;
+    int                    fStart,
+                           fLastRun,
+                           fEnd;
+};
+
+}  // namespace
+
+static Sk4b to_alpha(const Sk4f& winding, bool evenOdd) {
+    Sk4f c = winding.abs();
+    if (evenOdd) {
+        c = c - 2.0f * (c * 0.5f).floor();     // Now in [0,2).
+        c = Sk4f::Min(c, 2.0f - c);
+    }
+    return SkNx_cast<uint8_t>(Sk4f::Min(c, 1) * 255 + 0.5f);
+}
+
+static void flatten_path(const SkPath& path, SkPoint origin, PieceBuilder* builder) {
+    // Curves are split into lines no more than this many pixels from the curve.
+    static constexpr float kTolerance = 1.0f / 16;
+    static constexpr int   kMaxLines  = 256;
+
+    auto quad = [&](const SkPoint pts[3]) {
+        float dd = ((pts[0] - pts[1]) - (pts[1] - pts[2])).length();
+        int n = SkTPin((int)std::ceil(std::sqrt(0.25f * dd / kTolerance)), 1, kMaxLines);
+        SkPoint prev = pts[0];
+        for (int i = 1; i <= n; i++) {
+            SkPoint next = i == n ? pts[2] : SkEvalQuadAt(pts, (float)i / n);
+            builder->addLine(prev - origin, next - origin);
+            prev = next;
+        }
+    };
+
+    SkPath::Iter iter(path, true);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kLine_Verb:
+                builder->addLine(pts[0] - origin, pts[1] - origin);
+                break;
+            case SkPath::kQuad_Verb:
+                quad(pts);
+                break;
+            case SkPath::kConic_Verb: {
+                SkAutoConicToQuads quadder;
+                const SkPoint* quads = quadder.computeQuads(pts, iter.conicWeight(), kTolerance);
+                for (int i = 0; i < quadder.countQuads(); i++) {
+                    quad(quads + 2*i);
+                }
+                break;
+            }
+            case SkPath::kCubic_Verb: {
+                float dd = std::max(((pts[0] - pts[1]) - (pts[1] - pts[2])).length(),
+                                    ((pts[1] - pts[2]) - (pts[2] - pts[3])).length());
+                int n = SkTPin((int)std::ceil(std::sqrt(0.75f * dd / kTolerance)), 1, kMaxLines);
+                SkPoint prev = pts[0];
+                for (int i = 1; i <= n; i++) {
+                    SkPoint next = pts[3];
+                    if (i < n) {
+                        SkEvalCubicAt(pts, (float)i / n, &next, nullptr, nullptr);
+                    }
+                    builder->addLine(prev - origin, next - origin);
+                    prev = next;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// Every row is blitted with one blitAntiH(), top to bottom, never with blitMask(), so the
+// output is already what forceRLE asks for (e.g. SkAAClip's builder) either way.
+void SkScan::SparseStripFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
+                                 const SkIRect& clipBounds, bool forceRLE) {
+    SkASSERT(!path.isInverseFillType());
+    (void)forceRLE;
+    SkIRect bounds;
+    if (!bounds.intersect(pathIR, clipBounds)) {
+        return;
+    }
+    const int width  = bounds.width(),
+              height = bounds.height();
+    const bool evenOdd = path.getFillType() == SkPath::kEvenOdd_FillType;
+
+    PieceBuilder builder(width, height);
+    flatten_path(path, SkPoint::Make(bounds.fLeft, bounds.fTop), &builder);
+
+    SkTDArray<Piece>& pieces = *builder.pieces();
+    if (pieces.isEmpty()) {
+        return;
+    }
+    SkTQSort(pieces.begin(), pieces.end() - 1, [](const Piece& a, const Piece& b) {
+        return a.tile < b.tile;
+    });
+
+    RowBuilder rows[kTileH];
+    for (RowBuilder& row : rows) {
+        row.reset(width);
+    }
+
+    const Piece* piece = pieces.begin();
+    while (piece != pieces.end()) {
+        // Draw this row of tiles, left to right.
+        const int ty   = piece->tile >> 16,
+                  top  = ty * kTileH,
+                  rowsHere = std::min(kTileH, height - top);
+        Sk4f backdrop = 0;
+        int x = 0;
+
+        auto span = [&](int end) {
+            if (end > x) {
+                uint8_t alpha[4];
+                to_alpha(backdrop, evenOdd).store(alpha);
+                for (int y = 0; y < rowsHere; y++) {
+                    rows[y].append(x, end - x, alpha[y]);
+                }
+                x = end;
+            }
+        };
+
+        while (piece != pieces.end() && (int)(piece->tile >> 16) == ty) {
+            const uint32_t tile = piece->tile;
+            const int tx = tile & 0xffff;
+            span(tx * kTileW);
+
+            Cells cells = {};
+            for (; piece != pieces.end() && piece->tile == tile; piece++) {
+                accumulate(cells, *piece);
+            }
+
+            const int cols = std::min(kTileW, width - x);
+            Sk4f winding = backdrop;
+            for (int c = 0; c < cols; c++) {
+                winding += Sk4f::Load(cells[c]);
+                uint8_t alpha[4];
+                to_alpha(winding, evenOdd).store(alpha);
+                for (int y = 0; y < rowsHere; y++) {
+                    rows[y].append(x + c, 1, alpha[y]);
+                }
+            }
+            // Everything right of this tile sees all of its cells, including the carry column.
+            for (int c = cols; c <= kTileW; c++) {
+                winding += Sk4f::Load(cells[c]);
+            }
+            backdrop = winding;
+            x += cols;
+        }
+        span(width);
+
+        for (int y = 0; y < rowsHere; y++) {
+            rows[y].flush(blitter, bounds.fLeft, bounds.fTop + top + y);
+        }
+    }
+}
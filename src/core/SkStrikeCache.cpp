@@ -7,6 +7,8 @@
 
 #include "src/core/SkStrikeCache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 
 #include "include/core/SkGraphics.h"
@@ -16,6 +18,7 @@
 #include "include/private/SkTemplates.h"
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkTLS.h"
 
 class SkStrikeCache::Node final : public SkStrikeInterface {
 public:
@@ -62,15 +65,95 @@ public:
         fStrikeCache->attachNode(this);
     }
 
+    // Whoever claims a strike may use it until they release it.  A purge claims a strike for
+    // good before deleting it.
+    bool tryClaim() {
+        bool inUse = false;
+        return fInUse.compare_exchange_strong(inUse, true, std::memory_order_acquire);
+    }
+    void release() { fInUse.store(false, std::memory_order_release); }
+
+    // The list holds one ref, and each front cache that remembers the strike holds another.
+    void ref() { fRefCnt.fetch_add(1, std::memory_order_relaxed); }
+    void unref() {
+        if (1 == fRefCnt.fetch_add(-1, std::memory_order_acq_rel)) {
+            delete this;
+        }
+    }
+
     SkStrikeCache* const            fStrikeCache;
     Node*                           fNext{nullptr};
     Node*                           fPrev{nullptr};
     SkStrike                        fStrike;
     std::unique_ptr<SkStrikePinner> fPinner;
+    // A new strike is in use by the thread that created it until it is first attached.
+    std::atomic<bool>               fInUse{true};
+    std::atomic<int32_t>            fRefCnt{1};
+    // Only read or written by whoever has claimed the strike.
+    bool                            fListed{false};
+    size_t                          fMemoryCounted{0};
+};
+
+// A few strikes one thread has used recently in one cache, so it can find them again without
+// taking fLock.  The strikes stay on the cache's list, counted against its budget and purged as
+// usual; the front cache holds a ref on each so the pointers stay valid after a purge, and a
+// purged strike can never be claimed again.  They are all let go when the thread turns to another
+// cache, or when the cache's generation changes, which happens whenever strikes are purged.  The
+// most recently used strike is last.
+class SkStrikeCache::FrontCache {
+public:
+    static constexpr int kMaxStrikes = 8;
+
+    ~FrontCache() { this->forgetAll(); }
+
+    Node* find(const SkDescriptor& desc) const {
+        for (int i = fCount - 1; i >= 0; i--) {
+            if (fStrikes[i]->fStrike.getDescriptor() == desc) {
+                return fStrikes[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void remember(Node* node) {
+        Node** end = std::remove(fStrikes, fStrikes + fCount, node);
+        if (end == fStrikes + fCount) {
+            node->ref();
+            if (fCount == kMaxStrikes) {
+                fStrikes[0]->unref();
+                std::copy(fStrikes + 1, fStrikes + fCount, fStrikes);
+                fCount -= 1;
+            }
+        } else {
+            fCount = end - fStrikes;
+        }
+        fStrikes[fCount++] = node;
+    }
+
+    void revalidate(const SkStrikeCache* cache, uint32_t generation) {
+        if (fCache != cache || fGeneration != generation) {
+            this->forgetAll();
+            fCache = cache;
+            fGeneration = generation;
+        }
+    }
+
+private:
+    void forgetAll() {
+        for (int i = 0; i < fCount; i++) {
+            fStrikes[i]->unref();
+        }
+        fCount = 0;
+    }
+
+    Node*                fStrikes[kMaxStrikes];
+    int                  fCount{0};
+    const SkStrikeCache* fCache{nullptr};
+    uint32_t             fGeneration{0};
 };
 
 SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
-    static auto* cache = new SkStrikeCache;
+    static auto* cache = new SkStrikeCache{true};
     return cache;
 }
 
@@ -134,7 +217,9 @@ SkStrikeCache::~SkStrikeCache() {
     Node* node = fHead;
     while (node) {
         Node* next = node->fNext;
-        delete node;
+        // Front caches may still hold refs; claiming the strike keeps them from using it.
+        SkAssertResult(node->tryClaim());
+        node->unref();
         node = next;
     }
 }
@@ -312,12 +397,31 @@ void SkStrikeCache::attachNode(Node* node) {
     if (node == nullptr) {
         return;
     }
+
+    // A strike already on the list that has not grown needs no bookkeeping; just let it go.
+    if (node->fListed && node->fMemoryCounted == node->fStrike.getMemoryUsed()) {
+        node->release();
+        return;
+    }
+
+    if (fUseFrontCaches && !node->fListed) {
+        // Remember a new strike before it can be purged.
+        FrontCache* front = this->frontCache();
+        front->revalidate(this, fGeneration.load(std::memory_order_relaxed));
+        front->remember(node);
+    }
+
     SkAutoExclusive ac(fLock);
 
     this->validate();
     node->fStrike.validate();
 
+    // Move it to the head, counting any glyphs it gained while in use.
+    if (node->fListed) {
+        this->internalDetachCache(node);
+    }
     this->internalAttachToHead(node);
+    node->release();
     this->internalPurge();
 }
 
@@ -326,16 +430,36 @@ SkExclusiveStrikePtr SkStrikeCache::findStrikeExclusive(const SkDescriptor& desc
 }
 
 auto SkStrikeCache::findAndDetachStrike(const SkDescriptor& desc) -> Node* {
-    SkAutoExclusive ac(fLock);
-
-    for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
-        if (node->fStrike.getDescriptor() == desc) {
-            this->internalDetachCache(node);
+    FrontCache* front = nullptr;
+    if (fUseFrontCaches) {
+        front = this->frontCache();
+        front->revalidate(this, fGeneration.load(std::memory_order_relaxed));
+        // The claim fails if another thread is using the strike, or if it was purged since the
+        // generation was read; either way, look on the list.
+        Node* node = front->find(desc);
+        if (node != nullptr && node->tryClaim()) {
             return node;
         }
     }
 
-    return nullptr;
+    Node* found = nullptr;
+    {
+        SkAutoExclusive ac(fLock);
+        for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
+            if (node->fStrike.getDescriptor() == desc && node->tryClaim()) {
+                this->internalDetachCache(node);
+                this->internalAttachToHead(node);
+                found = node;
+                break;
+            }
+        }
+    }
+
+    // Claimed strikes cannot be purged, so this can wait until fLock is released.
+    if (front != nullptr && found != nullptr) {
+        front->remember(found);
+    }
+    return found;
 }
 
 
@@ -373,8 +497,10 @@ bool SkStrikeCache::desperationSearchForImage(const SkDescriptor& desc, SkGlyph*
     SkFixed targetSubX = glyph->getSubXFixed(),
             targetSubY = glyph->getSubYFixed();
 
+    // Strikes other threads are using are skipped, as they were when they left the list.
     for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
-        if (loose_compare(node->fStrike.getDescriptor(), desc)) {
+        if (loose_compare(node->fStrike.getDescriptor(), desc) && node->tryClaim()) {
+            bool found = false;
             auto targetGlyphID = SkPackedGlyphID(glyphID, targetSubX, targetSubY);
             if (node->fStrike.isGlyphCached(glyphID, targetSubX, targetSubY)) {
                 SkGlyph* fallback = node->fStrike.getRawGlyphByID(targetGlyphID);
@@ -382,12 +508,14 @@ bool SkStrikeCache::desperationSearchForImage(const SkDescriptor& desc, SkGlyph*
                 // need to copy the glyph from node into this strike, including a
                 // deep copy of the mask.
                 targetCache->initializeGlyphFromFallback(glyph, *fallback);
-                return true;
-            }
-
-            // Look for any sub-pixel pos for this glyph, in case there is a pos mismatch.
-            if (const auto* fallback = node->fStrike.getCachedGlyphAnySubPix(glyphID)) {
+                found = true;
+            } else if (const auto* fallback = node->fStrike.getCachedGlyphAnySubPix(glyphID)) {
+                // Look for any sub-pixel pos for this glyph, in case there is a pos mismatch.
                 targetCache->initializeGlyphFromFallback(glyph, *fallback);
+                found = true;
+            }
+            node->release();
+            if (found) {
                 return true;
             }
         }
@@ -407,16 +535,21 @@ bool SkStrikeCache::desperationSearchForPath(
     // This will have to search the sub-pixel positions too.
     // There is also a problem with accounting for cache size with shared path data.
     for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
-        if (loose_compare(node->fStrike.getDescriptor(), desc)) {
+        if (loose_compare(node->fStrike.getDescriptor(), desc) && node->tryClaim()) {
+            bool found = false;
             if (node->fStrike.isGlyphCached(glyphID, 0, 0)) {
                 SkGlyph* from = node->fStrike.getRawGlyphByID(SkPackedGlyphID(glyphID));
                 if (from->fPathData != nullptr) {
                     // We can just copy the path out by value here, so no need to worry
                     // about the lifetime of this desperate-match node.
                     *path = from->fPathData->fPath;
-                    return true;
+                    found = true;
                 }
             }
+            node->release();
+            if (found) {
+                return true;
+            }
         }
     }
     return false;
@@ -457,9 +590,28 @@ auto SkStrikeCache::createStrike(
     return new Node{this, desc, std::move(scaler), fontMetrics, std::move(pinner)};
 }
 
+void* SkStrikeCache::CreateFrontCache() {
+    return new FrontCache;
+}
+
+void SkStrikeCache::DeleteFrontCache(void* ptr) {
+    delete static_cast<FrontCache*>(ptr);
+}
+
+auto SkStrikeCache::frontCache() -> FrontCache* {
+    return static_cast<FrontCache*>(SkTLS::Get(CreateFrontCache, DeleteFrontCache));
+}
+
 void SkStrikeCache::purgeAll() {
-    SkAutoExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    {
+        SkAutoExclusive ac(fLock);
+        this->internalPurge(fTotalMemoryUsed);
+    }
+    // Let go of the purged strikes this thread remembers now; other threads will when they next
+    // look up a strike.
+    if (fUseFrontCaches) {
+        this->frontCache()->revalidate(this, fGeneration.load(std::memory_order_relaxed));
+    }
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
@@ -532,7 +684,10 @@ void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor)
     this->validate();
 
     for (Node* node = this->internalGetHead(); node != nullptr; node = node->fNext) {
-        visitor(node->fStrike);
+        if (node->tryClaim()) {
+            visitor(node->fStrike);
+            node->release();
+        }
     }
 }
 
@@ -570,18 +725,28 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     while (node != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         Node* prev = node->fPrev;
 
-        // Only delete if the strike is not pinned.
-        if (node->fPinner == nullptr || node->fPinner->canDelete()) {
-            bytesFreed += node->fStrike.getMemoryUsed();
-            countFreed += 1;
-            this->internalDetachCache(node);
-            delete node;
+        // Only delete if the strike is not in use or pinned.  A purged strike stays claimed, so
+        // front caches that still hold it will not use it.
+        if (node->tryClaim()) {
+            if (node->fPinner == nullptr || node->fPinner->canDelete()) {
+                bytesFreed += node->fMemoryCounted;
+                countFreed += 1;
+                this->internalDetachCache(node);
+                node->unref();
+            } else {
+                node->release();
+            }
         }
         node = prev;
     }
 
     this->validate();
 
+    // Front caches may hold the strikes we purged.
+    if (countFreed) {
+        fGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
         SkDebugf("purging %dK from font cache [%d entries]\n",
@@ -604,14 +769,17 @@ void SkStrikeCache::internalAttachToHead(Node* node) {
         fTail = node;
     }
 
+    node->fListed = true;
+    node->fMemoryCounted = node->fStrike.getMemoryUsed();
     fCacheCount += 1;
-    fTotalMemoryUsed += node->fStrike.getMemoryUsed();
+    fTotalMemoryUsed += node->fMemoryCounted;
 }
 
 void SkStrikeCache::internalDetachCache(Node* node) {
     SkASSERT(fCacheCount > 0);
     fCacheCount -= 1;
-    fTotalMemoryUsed -= node->fStrike.getMemoryUsed();
+    fTotalMemoryUsed -= node->fMemoryCounted;
+    node->fListed = false;
 
     if (node->fPrev) {
         node->fPrev->fNext = node->fNext;
@@ -647,7 +815,7 @@ void SkStrikeCache::validate() const {
 
     const Node* node = fHead;
     while (node != nullptr) {
-        computedBytes += node->fStrike.getMemoryUsed();
+        computedBytes += node->fMemoryCounted;
         computedCount += 1;
         node = node->fNext;
     }
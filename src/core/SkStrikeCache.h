@@ -8,6 +8,7 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -41,9 +42,13 @@ public:
 
 class SkStrikeCache final : public SkStrikeCacheInterface {
     class Node;
+    class FrontCache;
 
 public:
     SkStrikeCache() = default;
+    // With front caches, each thread remembers the last few strikes it used and finds them again
+    // without taking the lock.
+    explicit SkStrikeCache(bool useFrontCaches) : fUseFrontCaches{useFrontCaches} {}
     ~SkStrikeCache() override;
 
     class ExclusiveStrikePtr {
@@ -190,6 +195,13 @@ private:
 
     void forEachStrike(std::function<void(const SkStrike&)> visitor) const;
 
+    // The calling thread's front cache.
+    FrontCache* frontCache();
+    static void* CreateFrontCache();
+    static void DeleteFrontCache(void*);
+
+    const bool         fUseFrontCaches{false};
+
     mutable SkSpinlock fLock;
     Node*              fHead{nullptr};
     Node*              fTail{nullptr};
@@ -197,6 +209,8 @@ private:
     size_t             fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
     int32_t            fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
     int32_t            fCacheCount{0};
+    // Changes whenever strikes are purged.  Front caches read it without the lock.
+    std::atomic<uint32_t> fGeneration{0};
     int32_t            fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
 };
 
@@ -10,6 +10,7 @@
 #include <algorithm>
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/private/SkArenaAlloc.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkNx.h"
@@ -20,7 +21,9 @@
 #include "src/core/SkOpts.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
+#include "src/effects/imagefilters/SkBlurImageFilterPriv.h"
 
 #if SK_SUPPORT_GPU
 #include "include/gpu/GrContext.h"
@@ -260,21 +263,17 @@ static int calculate_buffer(int window) {
 //
 using Pass0And1 = Sk4u[2];
 // The would be dLeft parameter is assumed to be 0.
-static void blur_one_direction(Sk4u* buffer, int window,
+static void blur_one_direction(int window,
                                int srcLeft, int srcRight, int dstRight,
                                const uint32_t* src, int srcXStride, int srcYStride, int srcH,
-                                     uint32_t* dst, int dstXStride, int dstYStride) {
+                                     uint32_t* dst, int dstXStride, int dstYStride,
+                               SkExecutor& executor) {
 
     // The circular buffers are one less than the window.
     auto pass0Count = window - 1,
          pass1Count = window - 1,
          pass2Count = (window & 1) == 1 ? window - 1 : window;
 
-    Pass0And1* buffer01Start = (Pass0And1*)buffer;
-    Sk4u*      buffer2Start  = buffer + pass0Count + pass1Count;
-    Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
-    Sk4u*      buffer2End    = buffer2Start + pass2Count;
-
     // If the window is odd then the divisor is just window ^ 3 otherwise,
     // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
     auto window2 = window * window;
@@ -302,87 +301,100 @@ static void blur_one_direction(Sk4u* buffer, int window,
          srcEnd   = srcRight - border,
          dstEnd   = dstRight;
 
-    for (auto y = 0; y < srcH; y++) {
-        auto buffer01Cursor = buffer01Start;
-        auto buffer2Cursor  = buffer2Start;
-
-        Sk4u sum0{0u};
-        Sk4u sum1{0u};
-        Sk4u sum2{half};
-
-        sk_bzero(buffer01Start, (buffer2End - (Sk4u *) (buffer01Start)) * sizeof(*buffer2Start));
-
-        // Given an expanded input pixel, move the window ahead using the leadingEdge value.
-        auto processValue = [&](const Sk4u& leadingEdge) -> Sk4u {
-            sum0 += leadingEdge;
-            sum1 += sum0;
-            sum2 += sum1;
-
-            Sk4u value = sum2.mulHi(weight);
-
-            sum2 -= *buffer2Cursor;
-            *buffer2Cursor = sum1;
-            buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
-
-            sum1 -= (*buffer01Cursor)[1];
-            (*buffer01Cursor)[1] = sum0;
-            sum0 -= (*buffer01Cursor)[0];
-            (*buffer01Cursor)[0] = leadingEdge;
-            buffer01Cursor =
-                    (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
-
-            return value;
-        };
-
-        auto srcIdx = srcStart;
-        auto dstIdx = 0;
-        const uint32_t* srcCursor = src;
-              uint32_t* dstCursor = dst;
-
-        // The destination pixels are not effected by the src pixels,
-        // change to zero as per the spec.
-        // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
-        while (dstIdx < srcIdx) {
-            *dstCursor = 0;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
-        }
-
-        // The edge of the source is before the edge of the destination. Calculate the sums for
-        // the pixels before the start of the destination.
-        while (dstIdx > srcIdx) {
-            Sk4u leadingEdge = srcIdx < srcEnd ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor)) : 0;
-            (void) processValue(leadingEdge);
-            srcCursor += srcXStride;
-            srcIdx++;
-        }
-
-        // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
-        // Consume the source generating pixels to dst.
-        auto loopEnd = std::min(dstEnd, srcEnd);
-        while (dstIdx < loopEnd) {
-            Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor));
-            SkNx_cast<uint8_t>(processValue(leadingEdge)).store(dstCursor);
-            srcCursor += srcXStride;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
-        }
-
-        // The leading edge is beyond the end of the source. Assume that the pixels
-        // are now 0x0000 until the end of the destination.
-        loopEnd = dstEnd;
-        while (dstIdx < loopEnd) {
-            SkNx_cast<uint8_t>(processValue(0u)).store(dstCursor);
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
+    // Each row (or column) is blurred independently, so split them into bands, each with its
+    // own circular buffers, and blur the bands in parallel.
+    static constexpr int kLinesPerBand = 64;
+    SkTaskGroup(executor).batch((srcH + kLinesPerBand - 1) / kLinesPerBand, [&](int band) {
+        // The amount 1024 is enough for buffers up to 10 sigma.
+        SkSTArenaAlloc<1024> alloc;
+        Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(calculate_buffer(window));
+
+        Pass0And1* buffer01Start = (Pass0And1*)buffer;
+        Sk4u*      buffer2Start  = buffer + pass0Count + pass1Count;
+        Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
+        Sk4u*      buffer2End    = buffer2Start + pass2Count;
+
+        const int end = std::min(srcH, (band + 1) * kLinesPerBand);
+        for (int y = band * kLinesPerBand; y < end; y++) {
+            auto buffer01Cursor = buffer01Start;
+            auto buffer2Cursor  = buffer2Start;
+
+            Sk4u sum0{0u};
+            Sk4u sum1{0u};
+            Sk4u sum2{half};
+
+            sk_bzero(buffer01Start,
+                     (buffer2End - (Sk4u *) (buffer01Start)) * sizeof(*buffer2Start));
+
+            // Given an expanded input pixel, move the window ahead using the leadingEdge value.
+            auto processValue = [&](const Sk4u& leadingEdge) -> Sk4u {
+                sum0 += leadingEdge;
+                sum1 += sum0;
+                sum2 += sum1;
+
+                Sk4u value = sum2.mulHi(weight);
+
+                sum2 -= *buffer2Cursor;
+                *buffer2Cursor = sum1;
+                buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
+
+                sum1 -= (*buffer01Cursor)[1];
+                (*buffer01Cursor)[1] = sum0;
+                sum0 -= (*buffer01Cursor)[0];
+                (*buffer01Cursor)[0] = leadingEdge;
+                buffer01Cursor =
+                        (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
+
+                return value;
+            };
+
+            auto srcIdx = srcStart;
+            auto dstIdx = 0;
+            const uint32_t* srcCursor = src + y * srcYStride;
+                  uint32_t* dstCursor = dst + y * dstYStride;
+
+            // The destination pixels are not effected by the src pixels,
+            // change to zero as per the spec.
+            // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
+            while (dstIdx < srcIdx) {
+                *dstCursor = 0;
+                dstCursor += dstXStride;
+                SK_PREFETCH(dstCursor);
+                dstIdx++;
+            }
+
+            // The edge of the source is before the edge of the destination. Calculate the sums for
+            // the pixels before the start of the destination.
+            while (dstIdx > srcIdx) {
+                Sk4u leadingEdge = srcIdx < srcEnd ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor)) : 0;
+                (void) processValue(leadingEdge);
+                srcCursor += srcXStride;
+                srcIdx++;
+            }
+
+            // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
+            // Consume the source generating pixels to dst.
+            auto loopEnd = std::min(dstEnd, srcEnd);
+            while (dstIdx < loopEnd) {
+                Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor));
+                SkNx_cast<uint8_t>(processValue(leadingEdge)).store(dstCursor);
+                srcCursor += srcXStride;
+                dstCursor += dstXStride;
+                SK_PREFETCH(dstCursor);
+                dstIdx++;
+            }
+
+            // The leading edge is beyond the end of the source. Assume that the pixels
+            // are now 0x0000 until the end of the destination.
+            loopEnd = dstEnd;
+            while (dstIdx < loopEnd) {
+                SkNx_cast<uint8_t>(processValue(0u)).store(dstCursor);
+                dstCursor += dstXStride;
+                SK_PREFETCH(dstCursor);
+                dstIdx++;
+            }
         }
-
-        src += srcYStride;
-        dst += dstYStride;
-    }
+    });
 }
 
 static sk_sp<SkSpecialImage> copy_image_with_bounds(
@@ -451,10 +463,10 @@ static sk_sp<SkSpecialImage> copy_image_with_bounds(
 }
 
 // TODO: Implement CPU backend for different fTileMode.
-static sk_sp<SkSpecialImage> cpu_blur(
+sk_sp<SkSpecialImage> SkBlurImageFilterCPU(
         SkVector sigma,
         SkSpecialImage *source, const sk_sp<SkSpecialImage> &input,
-        SkIRect srcBounds, SkIRect dstBounds) {
+        SkIRect srcBounds, SkIRect dstBounds, SkExecutor& executor) {
     auto windowW = calculate_window(sigma.x()),
          windowH = calculate_window(sigma.y());
 
@@ -491,14 +503,6 @@ static sk_sp<SkSpecialImage> cpu_blur(
         return nullptr;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
-
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
-
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
     //     the destination. Then, do an in-place vertical blur.
@@ -540,18 +544,18 @@ static sk_sp<SkSpecialImage> cpu_blur(
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
         blur_one_direction(
-                buffer, windowW,
+                windowW,
                 srcBounds.left(), srcBounds.right(), dstBounds.right(),
                 static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
-                intermediateSrc, 1, intermediateRowBytesAsPixels);
+                intermediateSrc, 1, intermediateRowBytesAsPixels, executor);
     }
 
     if (windowH > 1) {
         blur_one_direction(
-                buffer, windowH,
+                windowH,
                 srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
                 intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
-                intermediateDst, dst.rowBytesAsPixels(), 1);
+                intermediateDst, dst.rowBytesAsPixels(), 1, executor);
     }
 
     return SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(dstBounds.width(),
@@ -605,7 +609,8 @@ sk_sp<SkSpecialImage> SkBlurImageFilterImpl::onFilterImage(SkSpecialImage* sourc
     } else
 #endif
     {
-        result = cpu_blur(sigma, source, input, inputBounds, dstBounds);
+        result = SkBlurImageFilterCPU(sigma, source, input, inputBounds, dstBounds,
+                                      SkExecutor::GetDefault());
     }
 
     // Return the resultOffset if the blur succeeded.
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurImageFilterPriv_DEFINED
+#define SkBlurImageFilterPriv_DEFINED
+
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+class SkExecutor;
+class SkSpecialImage;
+
+/**
+ *  The raster path of SkBlurImageFilter: blurs the srcBounds of input by sigma into an image the
+ *  size of dstBounds, both relative to input.  Bands of rows and columns are blurred in parallel
+ *  on executor.  Returns nullptr if input is not N32.
+ */
+sk_sp<SkSpecialImage> SkBlurImageFilterCPU(SkVector sigma,
+                                           SkSpecialImage* source,
+                                           const sk_sp<SkSpecialImage>& input,
+                                           SkIRect srcBounds, SkIRect dstBounds,
+                                           SkExecutor& executor);
+
+#endif
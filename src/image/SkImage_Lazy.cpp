@@ -12,8 +12,10 @@
 #include "include/core/SkImageGenerator.h"
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkCachedData.h"
+#include "src/core/SkDiscardableMemory.h"
 #include "src/core/SkImagePriv.h"
 #include "src/core/SkNextID.h"
+#include "src/lazy/SkSharedDecodeCache.h"
 
 #if SK_SUPPORT_GPU
 #include "include/gpu/GrSamplerState.h"
@@ -178,6 +180,11 @@ static bool generate_pixels(SkImageGenerator* gen, const SkPixmap& pmap, int ori
 }
 
 bool SkImage_Lazy::getROPixels(SkBitmap* bitmap, SkImage::CachingHint chint) const {
+    return this->getROPixels(bitmap, chint, SkSharedDecodeCache::Get().get());
+}
+
+bool SkImage_Lazy::getROPixels(SkBitmap* bitmap, SkImage::CachingHint chint,
+                               SkSharedDecodeCache* shared) const {
     auto check_output_bitmap = [bitmap]() {
         SkASSERT(bitmap->isImmutable());
         SkASSERT(bitmap->getPixels());
@@ -191,15 +198,44 @@ bool SkImage_Lazy::getROPixels(SkBitmap* bitmap, SkImage::CachingHint chint) con
     }
 
     if (SkImage::kAllow_CachingHint == chint) {
-        SkPixmap pmap;
-        SkBitmapCache::RecPtr cacheRec = SkBitmapCache::Alloc(desc, this->imageInfo(), &pmap);
-        if (!cacheRec ||
-            !generate_pixels(ScopedGenerator(fSharedGenerator), pmap,
-                             fOrigin.x(), fOrigin.y())) {
-            return false;
+        sk_sp<SkData> encoded;
+        SkSharedDecodeCache::Key sharedKey;
+        {
+            ScopedGenerator generator(fSharedGenerator);
+            // Another thread (e.g. an SkImageDecodeQueue) may have cached our pixels while we were
+            // waiting for the generator.
+            if (SkBitmapCache::Find(desc, bitmap)) {
+                check_output_bitmap();
+                return true;
+            }
+
+            // Another process may already have decoded the same encoded bytes.
+            encoded = shared ? generator->refEncodedData() : nullptr;
+            if (encoded) {
+                sharedKey = SkSharedDecodeCache::MakeKey(*encoded, this->imageInfo(), fOrigin);
+                size_t rowBytes;
+                if (auto dm = shared->find(sharedKey, this->imageInfo(), &rowBytes)) {
+                    SkBitmapCache::Add(SkBitmapCache::Wrap(desc, this->imageInfo(), rowBytes,
+                                                           std::move(dm)),
+                                       bitmap);
+                    this->notifyAddedToRasterCache();
+                    check_output_bitmap();
+                    return true;
+                }
+            }
+
+            SkPixmap pmap;
+            SkBitmapCache::RecPtr cacheRec = SkBitmapCache::Alloc(desc, this->imageInfo(), &pmap);
+            if (!cacheRec || !generate_pixels(generator, pmap, fOrigin.x(), fOrigin.y())) {
+                return false;
+            }
+            SkBitmapCache::Add(std::move(cacheRec), bitmap);
+            this->notifyAddedToRasterCache();
+        }
+        // Written once the generator is free, so other images sharing it need not wait on disk.
+        if (encoded) {
+            shared->add(sharedKey, bitmap->pixmap());
         }
-        SkBitmapCache::Add(std::move(cacheRec), bitmap);
-        this->notifyAddedToRasterCache();
     } else {
         if (!bitmap->tryAllocPixels(this->imageInfo()) ||
             !generate_pixels(ScopedGenerator(fSharedGenerator), bitmap->pixmap(), fOrigin.x(),
@@ -16,6 +16,7 @@
 #endif
 
 class SharedGenerator;
+class SkSharedDecodeCache;
 
 class SkImage_Lazy : public SkImage_Base {
 public:
@@ -51,6 +52,9 @@ public:
     sk_sp<SkData> onRefEncoded() const override;
     sk_sp<SkImage> onMakeSubset(GrRecordingContext*, const SkIRect&) const override;
     bool getROPixels(SkBitmap*, CachingHint) const override;
+    // As above, but shares decodes through the given cache (which may be null) rather than
+    // SkSharedDecodeCache::Get().
+    bool getROPixels(SkBitmap*, CachingHint, SkSharedDecodeCache*) const;
     bool onIsLazyGenerated() const override { return true; }
     sk_sp<SkImage> onMakeColorTypeAndColorSpace(GrRecordingContext*,
                                                 SkColorType, sk_sp<SkColorSpace>) const override;
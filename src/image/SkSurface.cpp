@@ -79,6 +79,10 @@ GrBackendRenderTarget SkSurface_Base::onGetBackendRenderTarget(BackendHandleAcce
     return GrBackendRenderTarget(); // invalid
 }
 
+bool SkSurface_Base::onReadPixels(const SkPixmap& dst, int x, int y) {
+    return this->getCachedCanvas()->readPixels(dst, x, y);
+}
+
 void SkSurface_Base::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y, const SkPaint* paint) {
     auto image = this->makeImageSnapshot();
     if (image) {
@@ -155,6 +159,7 @@ uint32_t SkSurface::generationID() {
 }
 
 void SkSurface::notifyContentWillChange(ContentChangeMode mode) {
+    asSB(this)->onResolveDeferredDraws();
     asSB(this)->aboutToDraw(mode);
 }
 
@@ -163,6 +168,7 @@ SkCanvas* SkSurface::getCanvas() {
 }
 
 sk_sp<SkImage> SkSurface::makeImageSnapshot() {
+    asSB(this)->onResolveDeferredDraws();
     return asSB(this)->refCachedImage();
 }
 
@@ -176,6 +182,7 @@ sk_sp<SkImage> SkSurface::makeImageSnapshot(const SkIRect& srcBounds) {
     if (bounds == surfBounds) {
         return this->makeImageSnapshot();
     } else {
+        asSB(this)->onResolveDeferredDraws();
         return asSB(this)->onNewImageSnapshot(&bounds);
     }
 }
@@ -186,15 +193,18 @@ sk_sp<SkSurface> SkSurface::makeSurface(const SkImageInfo& info) {
 
 void SkSurface::draw(SkCanvas* canvas, SkScalar x, SkScalar y,
                      const SkPaint* paint) {
+    asSB(this)->onResolveDeferredDraws();
     return asSB(this)->onDraw(canvas, x, y, paint);
 }
 
 bool SkSurface::peekPixels(SkPixmap* pmap) {
+    asSB(this)->onResolveDeferredDraws();
     return this->getCanvas()->peekPixels(pmap);
 }
 
 bool SkSurface::readPixels(const SkPixmap& pm, int srcX, int srcY) {
-    return this->getCanvas()->readPixels(pm, srcX, srcY);
+    asSB(this)->onResolveDeferredDraws();
+    return asSB(this)->onReadPixels(pm, srcX, srcY);
 }
 
 bool SkSurface::readPixels(const SkImageInfo& dstInfo, void* dstPixels, size_t dstRowBytes,
@@ -219,6 +229,7 @@ void SkSurface::writePixels(const SkPixmap& pmap, int x, int y) {
         if (srcR.contains(dstR)) {
             mode = kDiscard_ContentChangeMode;
         }
+        asSB(this)->onResolveDeferredDraws();
         asSB(this)->aboutToDraw(mode);
         asSB(this)->onWritePixels(pmap, x, y);
     }
@@ -244,6 +255,7 @@ void SkSurface::flush() {
 }
 
 GrSemaphoresSubmitted SkSurface::flush(BackendSurfaceAccess access, const GrFlushInfo& flushInfo) {
+    asSB(this)->onResolveDeferredDraws();
     return asSB(this)->onFlush(access, flushInfo);
 }
 
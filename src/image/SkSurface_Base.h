@@ -45,6 +45,11 @@ public:
 
     virtual void onWritePixels(const SkPixmap&, int x, int y) = 0;
 
+    /**
+     *  Default implementation reads through the surface's canvas.
+     */
+    virtual bool onReadPixels(const SkPixmap&, int x, int y);
+
     /**
      *  Default implementation:
      *
@@ -75,6 +80,13 @@ public:
      */
     virtual void onRestoreBackingMutability() {}
 
+    /**
+     *  Called before the surface's contents are read or modified other than through its canvas.
+     *  Surfaces whose canvas records draws for later execution (e.g. tiled raster) must execute
+     *  any pending draws here, calling aboutToDraw() first.
+     */
+    virtual void onResolveDeferredDraws() {}
+
     /**
      * Issue any pending surface IO to the current backend 3D API and resolve any surface MSAA.
      * Inserts the requested number of semaphores for the gpu to signal when work is complete on the
@@ -104,12 +116,13 @@ public:
     // called by SkSurface to compute a new genID
     uint32_t newGenerationID();
 
+protected:
+    void aboutToDraw(ContentChangeMode mode);
+
 private:
     std::unique_ptr<SkCanvas>   fCachedCanvas;
     sk_sp<SkImage>              fCachedImage;
 
-    void aboutToDraw(ContentChangeMode mode);
-
     // Returns true if there is an outstanding image-snapshot, indicating that a call to aboutToDraw
     // would trigger a copy-on-write.
     bool outstandingImageSnapshot() const;
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMallocPixelRef.h"
+#include "include/private/SkTArray.h"
+#include "src/core/SkImagePriv.h"
+#include "src/core/SkLiteDL.h"
+#include "src/core/SkLiteRecorder.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/image/SkSurface_Base.h"
+
+// Big enough that replaying every op once per tile is cheap next to rasterizing it,
+// small enough to keep many threads busy on a large surface.
+static constexpr int kDefaultTileSize = 512;
+
+// A raster surface whose canvas records into an SkLiteDL instead of drawing.  When the contents
+// are needed, the recorded ops are replayed concurrently onto one SkCanvas per tile.  Each tile
+// canvas draws into the whole bitmap, and lives as long as the surface, so saves, layers, matrix
+// and clip carry over from one replay to the next as they would on a single raster canvas.
+//
+// Tiles are kept apart by clipping each tile canvas to its tile, below any save the recording
+// can restore.  Layers take their bounds from that clip, widened where an image filter needs
+// input from beyond the tile, and are clipped to the tile again as they are drawn back down.
+// This is not a device clip restriction: that is in bitmap coordinates, and would be handed on
+// to each layer device, which clips in its own.  Like any clip, it changes how geometry crossing
+// it is scan converted.
+class SkSurface_RasterTiled : public SkSurface_Base {
+public:
+    SkSurface_RasterTiled(const SkImageInfo&, sk_sp<SkPixelRef>, SkExecutor*, int tileSize,
+                          const SkSurfaceProps*);
+
+    SkCanvas* onNewCanvas() override;
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo&) override;
+    sk_sp<SkImage> onNewImageSnapshot(const SkIRect* subset) override;
+    void onWritePixels(const SkPixmap&, int x, int y) override;
+    void onDraw(SkCanvas*, SkScalar x, SkScalar y, const SkPaint*) override;
+    void onCopyOnWrite(ContentChangeMode) override {}
+    void onResolveDeferredDraws() override;
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+
+    const SkBitmap& bitmap() const { return fBitmap; }
+
+private:
+    SkBitmap                               fBitmap;
+    SkExecutor*                            fExecutor;
+    int                                    fTileSize;
+    SkLiteDL                               fDL;
+    SkTArray<std::unique_ptr<SkCanvas>>    fTiles;
+
+    typedef SkSurface_Base INHERITED;
+};
+
+// The canvas handed out by SkSurface_RasterTiled.
+class SkTiledRecorder final : public SkLiteRecorder {
+public:
+    SkTiledRecorder(SkSurface_RasterTiled* surface, SkLiteDL* dl) : fSurface(surface) {
+        this->reset(dl, SkIRect::MakeWH(surface->width(), surface->height()));
+    }
+
+    SkImageInfo onImageInfo() const override { return fSurface->bitmap().info(); }
+
+    bool onGetProps(SkSurfaceProps* props) const override {
+        *props = fSurface->props();
+        return true;
+    }
+
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo& info, const SkSurfaceProps& props) override {
+        return SkSurface::MakeRaster(info, &props);
+    }
+
+    bool onPeekPixels(SkPixmap* pixmap) override {
+        fSurface->onResolveDeferredDraws();
+        return fSurface->bitmap().peekPixels(pixmap);
+    }
+
+    bool onAccessTopLayerPixels(SkPixmap* pixmap) override {
+        // Layers only exist on the tiles, so this is only meaningful with none outstanding.
+        return this->getSaveCount() == 1 && this->onPeekPixels(pixmap);
+    }
+
+    void onFlush() override {
+        fSurface->onResolveDeferredDraws();
+    }
+
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+        if (!rec.fBackdrop) {
+            return INHERITED::getSaveLayerStrategy(rec);
+        }
+        // A backdrop reads from outside the tile that is drawing it.  Finish everything before
+        // the saveLayer, then run it alone, so no tile is still writing pixels another reads.
+        // (Backdrops nested inside other layers only see their own tile's part of that layer.)
+        fSurface->onResolveDeferredDraws();
+        SaveLayerStrategy strategy = INHERITED::getSaveLayerStrategy(rec);
+        fSurface->onResolveDeferredDraws();
+        return strategy;
+    }
+
+    void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+        // Drawables need not be thread safe, so draw them into the recording now rather than
+        // once per tile at replay.
+        drawable->draw(this, matrix);
+    }
+
+private:
+    SkSurface_RasterTiled* fSurface;
+
+    typedef SkLiteRecorder INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSurface_RasterTiled::SkSurface_RasterTiled(const SkImageInfo& info, sk_sp<SkPixelRef> pr,
+                                             SkExecutor* executor, int tileSize,
+                                             const SkSurfaceProps* props)
+    : INHERITED(pr->width(), pr->height(), props)
+    , fExecutor(executor)
+    , fTileSize(tileSize)
+{
+    fBitmap.setInfo(info, pr->rowBytes());
+    fBitmap.setPixelRef(std::move(pr), 0, 0);
+
+    for (int y = 0; y < info.height(); y += tileSize) {
+        for (int x = 0; x < info.width(); x += tileSize) {
+            std::unique_ptr<SkCanvas> tile(new SkCanvas(fBitmap, this->props()));
+            tile->clipRect(SkRect::Make(SkIRect::MakeXYWH(x, y, tileSize, tileSize)));
+            fTiles.push_back(std::move(tile));
+        }
+    }
+}
+
+SkCanvas* SkSurface_RasterTiled::onNewCanvas() { return new SkTiledRecorder(this, &fDL); }
+
+sk_sp<SkSurface> SkSurface_RasterTiled::onNewSurface(const SkImageInfo& info) {
+    return SkSurface::MakeRasterTiled(info, fExecutor, fTileSize, &this->props());
+}
+
+void SkSurface_RasterTiled::onResolveDeferredDraws() {
+    if (fDL.empty()) {
+        return;
+    }
+    this->aboutToDraw(kRetain_ContentChangeMode);
+
+    SkTaskGroup(*fExecutor).batch(fTiles.count(), [this](int i) {
+        fDL.draw(fTiles[i].get(), SkMatrix::I());
+    });
+
+    fDL.reset();
+}
+
+bool SkSurface_RasterTiled::onReadPixels(const SkPixmap& dst, int x, int y) {
+    // Our canvas only records, so read the tiles' bitmap directly.
+    return fBitmap.readPixels(dst, x, y);
+}
+
+sk_sp<SkImage> SkSurface_RasterTiled::onNewImageSnapshot(const SkIRect* subset) {
+    // Our pixels are written by the tile canvases, which we cannot point at new pixels the way
+    // SkSurface_Raster does on copy-on-write, so snapshots always copy.
+    if (subset) {
+        SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
+        SkBitmap dst;
+        dst.allocPixels(fBitmap.info().makeWH(subset->width(), subset->height()));
+        SkAssertResult(fBitmap.readPixels(dst.pixmap(), subset->left(), subset->top()));
+        dst.setImmutable();
+        return SkImage::MakeFromBitmap(dst);
+    }
+    return SkMakeImageFromRasterBitmap(fBitmap, kAlways_SkCopyPixelsMode);
+}
+
+void SkSurface_RasterTiled::onWritePixels(const SkPixmap& src, int x, int y) {
+    fBitmap.writePixels(src, x, y);
+}
+
+void SkSurface_RasterTiled::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                                   const SkPaint* paint) {
+    canvas->drawBitmap(fBitmap, x, y, paint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+sk_sp<SkSurface> SkSurface::MakeRasterTiled(const SkImageInfo& info, SkExecutor* executor,
+                                            int tileSize, const SkSurfaceProps* props) {
+    if (!SkSurfaceValidateRasterInfo(info) || tileSize < 0) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    if (!executor) {
+        executor = &SkExecutor::GetDefault();
+    }
+    if (tileSize == 0) {
+        tileSize = kDefaultTileSize;
+    }
+    return sk_make_sp<SkSurface_RasterTiled>(info, std::move(pr), executor, tileSize, props);
+}
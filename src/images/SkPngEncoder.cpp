@@ -9,16 +9,19 @@
 
 #ifdef SK_HAS_PNG_LIBRARY
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/images/SkImageEncoderFns.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -58,10 +61,24 @@ public:
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
 
+    /*
+     * Returns true if writeBands() can encode src: libpng must not need to transform the rows,
+     * and src must be big enough to split.
+     */
+    bool canWriteBands(const SkPixmap& src) const;
+
+    /*
+     * Writes all of src as IDAT chunks, filtering and compressing bands of rows on executor,
+     * followed by IEND.
+     */
+    bool writeBands(const SkPixmap& src, SkExecutor* executor);
+
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    int filters() const { return fFilters; }
+    int zlibLevel() const { return fZLibLevel; }
 
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
@@ -72,11 +89,15 @@ private:
     SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr)
         : fPngPtr(pngPtr)
         , fInfoPtr(infoPtr)
+        , fUsesFiller(false)
     {}
 
     png_structp             fPngPtr;
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
+    int                     fFilters;
+    int                     fZLibLevel;
+    bool                    fUsesFiller;
     transform_scanline_proc fProc;
 };
 
@@ -196,10 +217,12 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
     SkASSERT(filters == (int)options.fFilterFlags);
     png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, filters);
+    fFilters = filters;
 
     int zlibLevel = SkTMin(SkTMax(0, options.fZLibLevel), 9);
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
+    fZLibLevel = zlibLevel;
 
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
@@ -363,6 +386,7 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
         // For kOpaque, kRGBA_F16, we will keep the row as RGBA and tell libpng
         // to skip the alpha channel.
         png_set_filler(fPngPtr, 0, PNG_FILLER_AFTER);
+        fUsesFiller = true;
     }
 
     return true;
@@ -372,6 +396,228 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+// Roughly how many bytes of unfiltered rows go in each band, and so each deflate job.
+static constexpr size_t kBandBytes = 128 * 1024;
+
+// Deflate's window.  Each band is primed with this much of the band before it.
+static constexpr size_t kDictionaryBytes = 32 * 1024;
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Writes row filtered with filter (a PNG_FILTER_VALUE_*) to dst, returning libpng's measure of
+// how well it will compress: the sum of the filtered bytes taken as signed magnitudes.
+static uint32_t filter_row(uint8_t* dst, int filter, const uint8_t* row, const uint8_t* prev,
+                           size_t rowBytes, int bpp) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < rowBytes; i++) {
+        int a = i >= (size_t)bpp ? row[i - bpp] : 0,
+            b = prev[i],
+            c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+        uint8_t v = row[i];
+        switch (filter) {
+            case PNG_FILTER_VALUE_SUB:   v -= a;                        break;
+            case PNG_FILTER_VALUE_UP:    v -= b;                        break;
+            case PNG_FILTER_VALUE_AVG:   v -= (a + b) >> 1;             break;
+            case PNG_FILTER_VALUE_PAETH: v -= paeth_predictor(a, b, c); break;
+            default:                                                    break;
+        }
+        dst[i] = v;
+        sum += v < 128 ? v : 256 - v;
+    }
+    return sum;
+}
+
+// Writes the filter byte and filtered row to dst, choosing among filters as libpng does.
+static void filter_row(uint8_t* dst, int filters, const uint8_t* row, const uint8_t* prev,
+                       size_t rowBytes, int bpp, uint8_t* scratch) {
+    static const struct { int flag, value; } kFilters[] = {
+        { PNG_FILTER_NONE,  PNG_FILTER_VALUE_NONE  },
+        { PNG_FILTER_SUB,   PNG_FILTER_VALUE_SUB   },
+        { PNG_FILTER_UP,    PNG_FILTER_VALUE_UP    },
+        { PNG_FILTER_AVG,   PNG_FILTER_VALUE_AVG   },
+        { PNG_FILTER_PAETH, PNG_FILTER_VALUE_PAETH },
+    };
+    if (0 == filters) {
+        filters = PNG_FILTER_NONE;
+    }
+
+    uint32_t best = UINT32_MAX;
+    for (auto f : kFilters) {
+        if (!(filters & f.flag)) {
+            continue;
+        }
+        if (filters == f.flag) {
+            dst[0] = f.value;
+            filter_row(dst + 1, f.value, row, prev, rowBytes, bpp);
+            return;
+        }
+        uint32_t sum = filter_row(scratch, f.value, row, prev, rowBytes, bpp);
+        if (sum < best) {
+            best = sum;
+            dst[0] = f.value;
+            memcpy(dst + 1, scratch, rowBytes);
+        }
+    }
+}
+
+// Deflates src into dst as raw deflate blocks, primed with dict.  All but the last band end in a
+// sync flush, leaving dst byte aligned and the stream open, so the bands can be concatenated.
+static bool deflate_band(std::vector<uint8_t>* dst, const uint8_t* src, size_t len,
+                         const uint8_t* dict, size_t dictLen, int level, int strategy, bool last) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (Z_OK != deflateInit2(&z, level, Z_DEFLATED, -MAX_WBITS, 8, strategy)) {
+        return false;
+    }
+    if (dictLen > 0 && Z_OK != deflateSetDictionary(&z, dict, (uInt)dictLen)) {
+        deflateEnd(&z);
+        return false;
+    }
+
+    dst->resize(deflateBound(&z, len) + 16);
+    z.next_in = const_cast<uint8_t*>(src);
+    z.avail_in = (uInt)len;
+    z.next_out = dst->data();
+    z.avail_out = (uInt)dst->size();
+
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    for (;;) {
+        int ret = deflate(&z, flush);
+        if (ret == Z_STREAM_ERROR) {
+            break;
+        }
+        if (last ? ret == Z_STREAM_END : z.avail_in == 0 && z.avail_out > 0) {
+            dst->resize(z.total_out);
+            deflateEnd(&z);
+            return true;
+        }
+        if (z.avail_out == 0) {
+            size_t used = z.total_out;
+            dst->resize(2 * dst->size());
+            z.next_out = dst->data() + used;
+            z.avail_out = (uInt)(dst->size() - used);
+        }
+    }
+    deflateEnd(&z);
+    return false;
+}
+
+static bool write_u32(SkWStream* stream, uint32_t v) {
+    uint8_t bytes[4] = { (uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v };
+    return stream->write(bytes, 4);
+}
+
+// Writes one chunk whose data is the concatenation of the non-empty pieces.
+static bool write_chunk(SkWStream* stream, const char type[4],
+                        std::initializer_list<std::pair<const uint8_t*, size_t>> pieces) {
+    size_t len = 0;
+    uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+    for (auto piece : pieces) {
+        len += piece.second;
+        crc = crc32(crc, piece.first, (uInt)piece.second);
+    }
+    if (!write_u32(stream, (uint32_t)len) || !stream->write(type, 4)) {
+        return false;
+    }
+    for (auto piece : pieces) {
+        if (piece.second > 0 && !stream->write(piece.first, piece.second)) {
+            return false;
+        }
+    }
+    return write_u32(stream, (uint32_t)crc);
+}
+
+static int rows_per_band(size_t rowBytes) {
+    return SkTMax<int>(1, (int)(kBandBytes / rowBytes));
+}
+
+bool SkPngEncoderMgr::canWriteBands(const SkPixmap& src) const {
+    return !fUsesFiller &&
+           src.height() > rows_per_band((size_t)fPngBytesPerPixel * src.width());
+}
+
+bool SkPngEncoderMgr::writeBands(const SkPixmap& src, SkExecutor* executor) {
+    SkASSERT(this->canWriteBands(src));
+    const size_t rowBytes = (size_t)fPngBytesPerPixel * src.width();
+    const int rowsPerBand = rows_per_band(rowBytes);
+    const int bands = (src.height() + rowsPerBand - 1) / rowsPerBand;
+
+    // Filter every band.  Each band transforms the row above it too, so Up, Avg and Paeth can
+    // see it without waiting on the band that owns it.
+    const size_t filteredRowBytes = rowBytes + 1;
+    std::vector<uint8_t> filtered(filteredRowBytes * src.height());
+    const int srcBpp = SkColorTypeBytesPerPixel(src.colorType());
+    SkTaskGroup(*executor).batch(bands, [&](int band) {
+        std::vector<uint8_t> storage(3 * rowBytes, 0);
+        uint8_t* prev    = storage.data();
+        uint8_t* row     = prev + rowBytes;
+        uint8_t* scratch = row + rowBytes;
+
+        int y = band * rowsPerBand,
+            end = SkTMin(y + rowsPerBand, src.height());
+        if (y > 0) {
+            fProc((char*)prev, (const char*)src.addr(0, y - 1), src.width(), srcBpp);
+        }
+        for (; y < end; y++) {
+            fProc((char*)row, (const char*)src.addr(0, y), src.width(), srcBpp);
+            filter_row(filtered.data() + y * filteredRowBytes, fFilters, row, prev,
+                       rowBytes, fPngBytesPerPixel, scratch);
+            std::swap(prev, row);
+        }
+    });
+
+    // Deflate every band, priming each with the window of filtered bytes before it.
+    const size_t bandBytes = filteredRowBytes * rowsPerBand;
+    // Like libpng, favor Huffman coding over string matching for filtered rows.
+    const int strategy = fFilters & ~PNG_FILTER_NONE ? Z_FILTERED : Z_DEFAULT_STRATEGY;
+    std::vector<std::vector<uint8_t>> compressed(bands);
+    std::vector<uLong> adlers(bands);
+    std::unique_ptr<bool[]> ok(new bool[bands]);
+    SkTaskGroup(*executor).batch(bands, [&](int band) {
+        size_t start = band * bandBytes,
+               len   = SkTMin(bandBytes, filtered.size() - start),
+               dict  = SkTMin(start, kDictionaryBytes);
+        const uint8_t* data = filtered.data() + start;
+        adlers[band] = adler32(adler32(0, nullptr, 0), data, (uInt)len);
+        ok[band] = deflate_band(&compressed[band], data, len, data - dict, dict, fZLibLevel,
+                                strategy, band == bands - 1);
+    });
+
+    // Stitch the bands into one zlib stream, one IDAT chunk per band.
+    uLong adler = adlers[0];
+    for (int band = 1; band < bands; band++) {
+        size_t len = SkTMin(bandBytes, filtered.size() - band * bandBytes);
+        adler = adler32_combine(adler, adlers[band], len);
+    }
+    const int flevel = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+    uint8_t header[2] = { 0x78, (uint8_t)(flevel << 6) };
+    header[1] += (31 - ((header[0] << 8) + header[1]) % 31) % 31;
+    uint8_t trailer[4] = { (uint8_t)(adler >> 24), (uint8_t)(adler >> 16),
+                           (uint8_t)(adler >>  8), (uint8_t)(adler >>  0) };
+
+    SkWStream* stream = (SkWStream*)png_get_io_ptr(fPngPtr);
+    for (int band = 0; band < bands; band++) {
+        bool first = band == 0,
+             last  = band == bands - 1;
+        if (!ok[band] ||
+            !write_chunk(stream, "IDAT", {{header,  first ? sizeof(header)  : 0},
+                                          {compressed[band].data(), compressed[band].size()},
+                                          {trailer, last  ? sizeof(trailer) : 0}})) {
+            return false;
+        }
+    }
+    return write_chunk(stream, "IEND", {});
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -434,7 +680,14 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
 
 bool SkPngEncoder::Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
     auto encoder = SkPngEncoder::Make(dst, src, options);
-    return encoder.get() && encoder->encodeRows(src.height());
+    if (!encoder) {
+        return false;
+    }
+    SkPngEncoderMgr* encoderMgr = static_cast<SkPngEncoder*>(encoder.get())->fEncoderMgr.get();
+    if (options.fExecutor && encoderMgr->canWriteBands(src)) {
+        return encoderMgr->writeBands(src, options.fExecutor);
+    }
+    return encoder->encodeRows(src.height());
 }
 
 #endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
+#include "include/private/SkMutex.h"
+#include "src/lazy/SkSharedDecodeCache.h"
+
+static SkMutex& global_mutex() {
+    static SkMutex& mutex = *(new SkMutex);
+    return mutex;
+}
+
+static sk_sp<SkSharedDecodeCache>& global_cache() {
+    static sk_sp<SkSharedDecodeCache>& cache = *(new sk_sp<SkSharedDecodeCache>);
+    return cache;
+}
+
+sk_sp<SkSharedDecodeCache> SkSharedDecodeCache::Get() {
+    SkAutoMutexAcquire lock(global_mutex());
+    return global_cache();
+}
+
+void SkSharedDecodeCache::Set(sk_sp<SkSharedDecodeCache> cache) {
+    SkAutoMutexAcquire lock(global_mutex());
+    global_cache() = std::move(cache);
+}
+
+SkSharedDecodeCache::Key SkSharedDecodeCache::MakeKey(const SkData& encoded,
+                                                      const SkImageInfo& info, SkIPoint origin) {
+    // Everything here goes into file names shared between processes, so only hash values with a
+    // fixed layout and byte order.
+    SkMD5 md5;
+    auto write32 = [&md5](int32_t v) {
+        const uint8_t bytes[4] = {
+            (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24),
+        };
+        md5.write(bytes, sizeof(bytes));
+    };
+    write32((int32_t)encoded.size());
+    md5.write(encoded.data(), encoded.size());
+    write32(info.width());
+    write32(info.height());
+    write32(info.colorType());
+    write32(info.alphaType());
+    write32(origin.x());
+    write32(origin.y());
+    if (sk_sp<SkData> cs = info.colorSpace() ? info.colorSpace()->serialize() : nullptr) {
+        md5.write(cs->data(), cs->size());
+    }
+    return md5.finish();
+}
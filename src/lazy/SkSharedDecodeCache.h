@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedDecodeCache_DEFINED
+#define SkSharedDecodeCache_DEFINED
+
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRefCnt.h"
+#include "src/core/SkMD5.h"
+
+#include <memory>
+
+class SkData;
+class SkDiscardableMemory;
+class SkPixmap;
+
+/**
+ *  Decoded pixels that processes on the same host can share, stored as files in one directory.
+ *
+ *  Entries are keyed by a hash of the encoded data and of how it was decoded, so a process can
+ *  pick up pixels another process decoded from the same bytes.  Each entry is written once under
+ *  a temporary name and renamed into place, then only ever mapped read-only.  Eviction removes
+ *  the file, which leaves the pixels mapped for any process that already has them.
+ *
+ *  When the files add up to more than the byte limit, whoever adds an entry removes the least
+ *  recently used ones, going by the files' modification times, which find() refreshes, until
+ *  they fit in three quarters of it.  Each cache keeps a running count of the bytes used rather
+ *  than listing the directory on every add, so while several processes are adding entries the
+ *  directory can run over the limit until one of them next evicts.
+ */
+class SkSharedDecodeCache : public SkRefCnt {
+public:
+    using Key = SkMD5::Digest;
+
+    /**
+     *  Opens the cache in dir, creating the directory if needed.  Returns nullptr if it cannot,
+     *  or if this platform has no implementation.
+     */
+    static sk_sp<SkSharedDecodeCache> Make(const char dir[], size_t byteLimit);
+
+    /**
+     *  The cache lazy images use, set by SkGraphics::SetSharedImageCacheDirectory().  May be
+     *  nullptr.
+     */
+    static sk_sp<SkSharedDecodeCache> Get();
+    static void Set(sk_sp<SkSharedDecodeCache>);
+
+    /**
+     *  Returns the key for encoded decoded to info, where origin is the top left of info within
+     *  the full image.
+     */
+    static Key MakeKey(const SkData& encoded, const SkImageInfo& info, SkIPoint origin);
+
+    /**
+     *  If the cache holds pixels for key that match info, maps them and returns them as
+     *  memory whose lock() always succeeds.  The pixels are read-only even though data() is not
+     *  const; they must only be installed in an immutable SkBitmap.
+     */
+    virtual std::unique_ptr<SkDiscardableMemory> find(const Key&, const SkImageInfo& info,
+                                                      size_t* rowBytes) = 0;
+
+    /**
+     *  Stores a copy of pixels under key, then evicts entries if the cache is over its limit.
+     *  Returns false if the pixels could not be written.
+     */
+    virtual bool add(const Key&, const SkPixmap& pixels) = 0;
+
+    /**
+     *  Returns the bytes used by every entry in the cache, from all processes.
+     */
+    virtual size_t getTotalBytesUsed() = 0;
+
+    /**
+     *  Removes every entry.
+     */
+    virtual void purgeAll() = 0;
+};
+
+#endif
@@ -39,6 +39,28 @@
     }
 #endif
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    // The same math as SkPMSrcOver_SSE2(), 16 pixels at a time.
+    static inline __m512i SkPMSrcOver_SKX(const __m512i& src, const __m512i& dst) {
+        const __m512i mask = _mm512_set1_epi32(0xFF00FF);
+        __m512i scale = _mm512_sub_epi32(_mm512_set1_epi32(256), _mm512_srli_epi32(src, 24)),
+                    s = _mm512_or_si512(_mm512_slli_epi32(scale, 16), scale);
+
+        // uint32_t rb = ((dst & mask) * scale) >> 8
+        __m512i rb = _mm512_and_si512(mask, dst);
+        rb = _mm512_mullo_epi16(rb, s);
+        rb = _mm512_srli_epi16(rb, 8);
+
+        // uint32_t ag = ((dst >> 8) & mask) * scale
+        __m512i ag = _mm512_srli_epi16(dst, 8);
+        ag = _mm512_mullo_epi16(ag, s);
+
+        // src + ((rb & mask) | (ag & ~mask))
+        ag = _mm512_andnot_si512(mask, ag);
+        return _mm512_add_epi32(src, _mm512_or_si512(rb, ag));
+    }
+#endif
+
 namespace SK_OPTS_NS {
 
 // Blend constant color over count src pixels, writing into dst.
@@ -117,7 +139,38 @@ void blit_row_s32a_opaque(SkPMColor* dst, const SkPMColor* src, int len, U8CPU a
     SkASSERT(alpha == 0xFF);
     sk_msan_assert_initialized(src, src+len);
 
-#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE41
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    while (len >= 16) {
+        // Load 16 source pixels.
+        auto s = _mm512_loadu_si512(src);
+
+        const auto alphaMask = _mm512_set1_epi32(0xFF000000);
+
+        if (0 == _mm512_test_epi32_mask(s, alphaMask)) {
+            // All 16 source pixels are transparent.  Nothing to do.
+            src += 16;
+            dst += 16;
+            len -= 16;
+            continue;
+        }
+
+        if (0xFFFF == _mm512_cmpeq_epi32_mask(_mm512_and_si512(s, alphaMask), alphaMask)) {
+            // All 16 source pixels are opaque.  SrcOver becomes Src.
+            _mm512_storeu_si512(dst, s);
+            src += 16;
+            dst += 16;
+            len -= 16;
+            continue;
+        }
+
+        // Do SrcOver, exactly as the SSE paths below do.
+        _mm512_storeu_si512(dst, SkPMSrcOver_SKX(s, _mm512_loadu_si512(dst)));
+        src += 16;
+        dst += 16;
+        len -= 16;
+    }
+
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE41
     while (len >= 16) {
         // Load 16 source pixels.
         auto s0 = _mm_loadu_si128((const __m128i*)(src) + 0),
@@ -10,6 +10,7 @@
 #define SK_OPTS_NS hsw
 #include "src/opts/SkBlitRow_opts.h"
 #include "src/opts/SkRasterPipeline_opts.h"
+#include "src/opts/SkSwizzler_opts.h"
 #include "src/opts/SkUtils_opts.h"
 
 namespace SkOpts {
@@ -17,6 +18,9 @@ namespace SkOpts {
         blit_row_color32     = hsw::blit_row_color32;
         blit_row_s32a_opaque = hsw::blit_row_s32a_opaque;
 
+        index8_to_8888 = hsw::index8_to_8888;
+        sample_8888    = hsw::sample_8888;
+
     #define M(st) stages_highp[SkRasterPipeline::st] = (StageFn)SK_OPTS_NS::st;
         SK_RASTER_PIPELINE_STAGES(M)
         just_return_highp = (StageFn)SK_OPTS_NS::just_return;
@@ -27,6 +27,10 @@ namespace SkOpts {
         grayA_to_rgbA         = ssse3::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = ssse3::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = ssse3::inverted_CMYK_to_BGR1;
+        index1_to_8888        = ssse3::index1_to_8888;
+        index2_to_8888        = ssse3::index2_to_8888;
+        index4_to_8888        = ssse3::index4_to_8888;
+        sample_8888           = ssse3::sample_8888;
 
         S32_alpha_D32_filter_DX  = ssse3::S32_alpha_D32_filter_DX;
     }
@@ -84,7 +84,7 @@ struct Ctx {
 #elif defined(SK_ARM_HAS_NEON)
     #define JUMPER_IS_NEON
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
-    #define JUMPER_IS_AVX512
+    #define JUMPER_IS_SKX
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
     #define JUMPER_IS_HSW
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -289,7 +289,151 @@ namespace SK_OPTS_NS {
         }
     }
 
-#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    // These are __m512 and __m512i, but friendlier and strongly-typed.
+    template <typename T> using V = T __attribute__((ext_vector_type(16)));
+    using F   = V<float   >;
+    using I32 = V< int32_t>;
+    using U64 = V<uint64_t>;
+    using U32 = V<uint32_t>;
+    using U16 = V<uint16_t>;
+    using U8  = V<uint8_t >;
+
+    SI F   mad(F f, F m, F a)   { return _mm512_fmadd_ps(f,m,a); }
+    SI F   min(F a, F b)        { return _mm512_min_ps(a,b);     }
+    SI F   max(F a, F b)        { return _mm512_max_ps(a,b);     }
+    SI F   abs_  (F v)          { return _mm512_and_ps(v, 0-v);  }
+    SI F   floor_(F v)          { return _mm512_floor_ps(v);     }
+    SI F   rcp   (F v)          { return _mm512_rcp14_ps  (v);   }
+    SI F   rsqrt (F v)          { return _mm512_rsqrt14_ps(v);   }
+    SI F    sqrt_(F v)          { return _mm512_sqrt_ps   (v);   }
+    SI U32 round (F v, F scale) { return _mm512_cvtps_epi32(v*scale); }
+
+    SI U16 pack(U32 v) { return _mm512_cvtusepi32_epi16(v); }
+    SI U8  pack(U16 v) { return _mm256_cvtusepi16_epi8 (v); }
+
+    SI F if_then_else(I32 c, F t, F e) {
+        return _mm512_mask_blend_ps(_mm512_movepi32_mask(c), e,t);
+    }
+
+    template <typename T>
+    SI V<T> gather(const T* p, U32 ix) {
+        return { p[ix[ 0]], p[ix[ 1]], p[ix[ 2]], p[ix[ 3]],
+                 p[ix[ 4]], p[ix[ 5]], p[ix[ 6]], p[ix[ 7]],
+                 p[ix[ 8]], p[ix[ 9]], p[ix[10]], p[ix[11]],
+                 p[ix[12]], p[ix[13]], p[ix[14]], p[ix[15]], };
+    }
+    SI F   gather(const float*    p, U32 ix) { return _mm512_i32gather_ps   (ix, p, 4); }
+    SI U32 gather(const uint32_t* p, U32 ix) { return _mm512_i32gather_epi32(ix, p, 4); }
+    SI U64 gather(const uint64_t* p, U32 ix) {
+        __m512i parts[] = {
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix,0), p, 8),
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix,1), p, 8),
+        };
+        return bit_cast<U64>(parts);
+    }
+
+    // Masks selecting the first n lanes, n clamped to [0,16] or [0,32].
+    // Our interlaced loads and stores use these to handle the tail without running over.
+    SI __mmask16 first16(int n) { return n <= 0 ? 0 : n >= 16 ?     0xffff : (1u<<n)-1; }
+    SI __mmask32 first32(int n) { return n <= 0 ? 0 : n >= 32 ? 0xffffffff : (1u<<n)-1; }
+
+    SI void load3(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b) {
+        const int n = 3 * (tail ? (int)tail : 16);
+        __m512i lo = _mm512_maskz_loadu_epi16(first32(n   ), ptr +  0),  // r0 g0 b0 ... r10 g10
+                hi = _mm512_maskz_loadu_epi16(first32(n-32), ptr + 32);  // b10 r11 ... b15
+
+        // Channel c of pixel p is element 3p+c of lo:hi.
+        const __m256i ix = _mm256_setr_epi16(0, 3, 6, 9,12,15,18,21,
+                                            24,27,30,33,36,39,42,45);
+        auto channel = [&](int c) {
+            __m512i i = _mm512_castsi256_si512(_mm256_add_epi16(ix, _mm256_set1_epi16(c)));
+            return _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, i, hi));
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+    }
+    SI void load4(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b, U16* a) {
+        const int n = 4 * (tail ? (int)tail : 16);
+        __m512i lo = _mm512_maskz_loadu_epi16(first32(n   ), ptr +  0),  // pixels 0-7
+                hi = _mm512_maskz_loadu_epi16(first32(n-32), ptr + 32);  // pixels 8-15
+
+        // Channel c of pixel p is element 4p+c of lo:hi.
+        const __m256i ix = _mm256_setr_epi16(0, 4, 8,12,16,20,24,28,
+                                            32,36,40,44,48,52,56,60);
+        auto channel = [&](int c) {
+            __m512i i = _mm512_castsi256_si512(_mm256_add_epi16(ix, _mm256_set1_epi16(c)));
+            return _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, i, hi));
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+        *a = channel(3);
+    }
+    SI void store4(uint16_t* ptr, size_t tail, U16 r, U16 g, U16 b, U16 a) {
+        // Element 4p+c of the output is lane p+16c of rg:ba.
+        static const uint16_t kInterlace[32] = {
+            0,16,32,48,  1,17,33,49,  2,18,34,50,  3,19,35,51,
+            4,20,36,52,  5,21,37,53,  6,22,38,54,  7,23,39,55,
+        };
+        __m512i rg = _mm512_inserti64x4(_mm512_castsi256_si512(r), g, 1),
+                ba = _mm512_inserti64x4(_mm512_castsi256_si512(b), a, 1),
+                ix = _mm512_loadu_si512(kInterlace);
+
+        __m512i lo = _mm512_permutex2var_epi16(rg, ix, ba),  // pixels 0-7
+                hi = _mm512_permutex2var_epi16(rg, _mm512_add_epi16(ix, _mm512_set1_epi16(8)),
+                                               ba);          // pixels 8-15
+
+        const int n = 4 * (tail ? (int)tail : 16);
+        _mm512_mask_storeu_epi16(ptr +  0, first32(n   ), lo);
+        _mm512_mask_storeu_epi16(ptr + 32, first32(n-32), hi);
+    }
+
+    SI void load4(const float* ptr, size_t tail, F* r, F* g, F* b, F* a) {
+        const int n = 4 * (tail ? (int)tail : 16);
+        F _0123   = _mm512_maskz_loadu_ps(first16(n- 0), ptr+ 0),
+          _4567   = _mm512_maskz_loadu_ps(first16(n-16), ptr+16),
+          _89ab   = _mm512_maskz_loadu_ps(first16(n-32), ptr+32),
+          _cdef   = _mm512_maskz_loadu_ps(first16(n-48), ptr+48);
+
+        const __m512i rg = _mm512_setr_epi32(0,4,8,12,16,20,24,28, 1,5,9,13,17,21,25,29),
+                      ba = _mm512_setr_epi32(2,6,10,14,18,22,26,30, 3,7,11,15,19,23,27,31);
+        F rg07 = _mm512_permutex2var_ps(_0123, rg, _4567),  // r0 ... r7 g0 ... g7
+          ba07 = _mm512_permutex2var_ps(_0123, ba, _4567),  // b0 ... b7 a0 ... a7
+          rg8f = _mm512_permutex2var_ps(_89ab, rg, _cdef),  // r8 ... rf g8 ... gf
+          ba8f = _mm512_permutex2var_ps(_89ab, ba, _cdef);  // b8 ... bf a8 ... af
+
+        const __m512i los = _mm512_setr_epi32(0,1,2,3,4,5,6,7, 16,17,18,19,20,21,22,23),
+                      his = _mm512_setr_epi32(8,9,10,11,12,13,14,15, 24,25,26,27,28,29,30,31);
+        *r = _mm512_permutex2var_ps(rg07, los, rg8f);
+        *g = _mm512_permutex2var_ps(rg07, his, rg8f);
+        *b = _mm512_permutex2var_ps(ba07, los, ba8f);
+        *a = _mm512_permutex2var_ps(ba07, his, ba8f);
+    }
+    SI void store4(float* ptr, size_t tail, F r, F g, F b, F a) {
+        const __m512i los = _mm512_setr_epi32(0,1,2,3,4,5,6,7, 16,17,18,19,20,21,22,23),
+                      his = _mm512_setr_epi32(8,9,10,11,12,13,14,15, 24,25,26,27,28,29,30,31);
+        F rg07 = _mm512_permutex2var_ps(r, los, g),  // r0 ... r7 g0 ... g7
+          rg8f = _mm512_permutex2var_ps(r, his, g),  // r8 ... rf g8 ... gf
+          ba07 = _mm512_permutex2var_ps(b, los, a),  // b0 ... b7 a0 ... a7
+          ba8f = _mm512_permutex2var_ps(b, his, a);  // b8 ... bf a8 ... af
+
+        const __m512i _0 = _mm512_setr_epi32(0, 8,16,24, 1, 9,17,25, 2,10,18,26, 3,11,19,27),
+                      _4 = _mm512_setr_epi32(4,12,20,28, 5,13,21,29, 6,14,22,30, 7,15,23,31);
+        F _0123 = _mm512_permutex2var_ps(rg07, _0, ba07),  // r0 g0 b0 a0 r1 ... a3
+          _4567 = _mm512_permutex2var_ps(rg07, _4, ba07),
+          _89ab = _mm512_permutex2var_ps(rg8f, _0, ba8f),
+          _cdef = _mm512_permutex2var_ps(rg8f, _4, ba8f);
+
+        const int n = 4 * (tail ? (int)tail : 16);
+        _mm512_mask_storeu_ps(ptr+ 0, first16(n- 0), _0123);
+        _mm512_mask_storeu_ps(ptr+16, first16(n-16), _4567);
+        _mm512_mask_storeu_ps(ptr+32, first16(n-32), _89ab);
+        _mm512_mask_storeu_ps(ptr+48, first16(n-48), _cdef);
+    }
+
+#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW)
     // These are __m256 and __m256i, but friendlier and strongly-typed.
     template <typename T> using V = T __attribute__((ext_vector_type(8)));
     using F   = V<float   >;
@@ -300,7 +444,7 @@ namespace SK_OPTS_NS {
     using U8  = V<uint8_t >;
 
     SI F mad(F f, F m, F a)  {
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         return _mm256_fmadd_ps(f,m,a);
     #else
         return f*m+a;
@@ -332,7 +476,7 @@ namespace SK_OPTS_NS {
         return { p[ix[0]], p[ix[1]], p[ix[2]], p[ix[3]],
                  p[ix[4]], p[ix[5]], p[ix[6]], p[ix[7]], };
     }
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         SI F   gather(const float*    p, U32 ix) { return _mm256_i32gather_ps   (p, ix, 4); }
         SI U32 gather(const uint32_t* p, U32 ix) { return _mm256_i32gather_epi32(p, ix, 4); }
         SI U64 gather(const uint64_t* p, U32 ix) {
@@ -732,7 +876,10 @@ SI F from_half(U16 h) {
 #if defined(SK_CPU_ARM64) && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f32_f16(h);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtph_ps(h);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtph_ps(h);
 
 #else
@@ -752,7 +899,10 @@ SI U16 to_half(F f) {
 #if defined(SK_CPU_ARM64) && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f16_f32(f);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
 
 #else
@@ -892,6 +1042,16 @@ SI V load(const T* src, size_t tail) {
     if (__builtin_expect(tail, 0)) {
         V v{};  // Any inactive lanes are zeroed.
         switch (tail) {
+        #if defined(JUMPER_IS_SKX)
+            case 15: v[14] = src[14];
+            case 14: v[13] = src[13];
+            case 13: v[12] = src[12];
+            case 12: memcpy(&v, src, 12*sizeof(T)); break;
+            case 11: v[10] = src[10];
+            case 10: v[ 9] = src[ 9];
+            case  9: v[ 8] = src[ 8];
+            case  8: memcpy(&v, src,  8*sizeof(T)); break;
+        #endif
             case 7: v[6] = src[6];
             case 6: v[5] = src[5];
             case 5: v[4] = src[4];
@@ -912,6 +1072,16 @@ SI void store(T* dst, V v, size_t tail) {
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         switch (tail) {
+        #if defined(JUMPER_IS_SKX)
+            case 15: dst[14] = v[14];
+            case 14: dst[13] = v[13];
+            case 13: dst[12] = v[12];
+            case 12: memcpy(dst, &v, 12*sizeof(T)); break;
+            case 11: dst[10] = v[10];
+            case 10: dst[ 9] = v[ 9];
+            case  9: dst[ 8] = v[ 8];
+            case  8: memcpy(dst, &v,  8*sizeof(T)); break;
+        #endif
             case 7: dst[6] = v[6];
             case 6: dst[5] = v[5];
             case 5: dst[4] = v[4];
@@ -1011,7 +1181,7 @@ STAGE(seed_shader, Ctx::None) {
 
 STAGE(dither, const float* rate) {
     // Get [(dx,dy), (dx+1,dy), (dx+2,dy), ...] loaded up in integer vectors.
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    uint32_t iota[] = {0,1,2,3,4,5,6,7, 8,9,10,11,12,13,14,15};
     U32 X = dx + unaligned_load<U32>(iota),
         Y = dy;
 
@@ -1590,7 +1760,7 @@ STAGE(to_srgb, Ctx::None) {
         U32 sign;
         l = strip_sign(l, &sign);
         // We tweak c and d for each instruction set to make sure fn(1) is exactly 1.
-    #if defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_SKX)
         const float c = 1.130026340485f,
                     d = 0.141387879848f;
     #elif defined(JUMPER_IS_SSE2) || defined(JUMPER_IS_SSE41) || \
@@ -1933,7 +2103,22 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <=8) {
+        // The stop arrays are padded to at least 8 floats, and idx < 8 never reads the top half.
+        auto lookup = [&](const float* v) {
+            return _mm512_permutexvar_ps(idx, _mm512_castps256_ps512(_mm256_loadu_ps(v)));
+        };
+        fr = lookup(c->fs[0]);
+        br = lookup(c->bs[0]);
+        fg = lookup(c->fs[1]);
+        bg = lookup(c->bs[1]);
+        fb = lookup(c->fs[2]);
+        bb = lookup(c->bs[2]);
+        fa = lookup(c->fs[3]);
+        ba = lookup(c->bs[3]);
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), idx);
@@ -2198,6 +2383,18 @@ STAGE(callback, SkRasterPipeline_CallbackCtx* c) {
     load4(c->read_from,0, &r,&g,&b,&a);
 }
 
+STAGE(interpreter, SkRasterPipeline_InterpreterCtx* c) {
+    unaligned_store(c->rgba + 0*N, r);
+    unaligned_store(c->rgba + 1*N, g);
+    unaligned_store(c->rgba + 2*N, b);
+    unaligned_store(c->rgba + 3*N, a);
+    c->fn(c, N, tail ? tail : N);
+    r = unaligned_load<F>(c->rgba + 0*N);
+    g = unaligned_load<F>(c->rgba + 1*N);
+    b = unaligned_load<F>(c->rgba + 2*N);
+    a = unaligned_load<F>(c->rgba + 3*N);
+}
+
 STAGE(gauss_a_to_rgba, Ctx::None) {
     // x = 1 - x;
     // exp(-x * x * 4) - 0.018f;
@@ -2270,7 +2467,7 @@ namespace lowp {
 
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     using U8  = uint8_t  __attribute__((ext_vector_type(16)));
     using U16 = uint16_t __attribute__((ext_vector_type(16)));
     using I16 =  int16_t __attribute__((ext_vector_type(16)));
@@ -2496,7 +2693,7 @@ SI F mad(F f, F m, F a) { return f*m+a; }
 SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 
 SI F rcp(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_rcp_ps(lo), _mm256_rcp_ps(hi));
@@ -2517,7 +2714,7 @@ SI F rcp(F x) {
 #endif
 }
 SI F sqrt_(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_sqrt_ps(lo), _mm256_sqrt_ps(hi));
@@ -2552,7 +2749,7 @@ SI F floor_(F x) {
     float32x4_t lo,hi;
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_floor_ps(lo), _mm256_floor_ps(hi));
@@ -2750,7 +2947,7 @@ SI V load(const T* ptr, size_t tail) {
     V v = 0;
     switch (tail & (N-1)) {
         case  0: memcpy(&v, ptr, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: v[14] = ptr[14];
         case 14: v[13] = ptr[13];
         case 13: v[12] = ptr[12];
@@ -2774,7 +2971,7 @@ template <typename V, typename T>
 SI void store(T* ptr, size_t tail, V v) {
     switch (tail & (N-1)) {
         case  0: memcpy(ptr, &v, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: ptr[14] = v[14];
         case 14: ptr[13] = v[13];
         case 13: ptr[12] = v[12];
@@ -2794,7 +2991,7 @@ SI void store(T* ptr, size_t tail, V v) {
     }
 }
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     template <typename V, typename T>
     SI V gather(const T* ptr, U32 ix) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
@@ -2832,7 +3029,7 @@ SI void store(T* ptr, size_t tail, V v) {
 // ~~~~~~ 32-bit memory loads and stores ~~~~~~ //
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
-#if 1 && defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if 1 && defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
     __m256i _01,_23;
     split(rgba, &_01, &_23);
@@ -3201,7 +3398,7 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -3381,6 +3578,7 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
 // If a pipeline uses these stages, it'll boot it out of lowp into highp.
 #define NOT_IMPLEMENTED(st) static void (*st)(void) = nullptr;
     NOT_IMPLEMENTED(callback)
+    NOT_IMPLEMENTED(interpreter)
     NOT_IMPLEMENTED(unbounded_set_rgb)
     NOT_IMPLEMENTED(unbounded_uniform_color)
     NOT_IMPLEMENTED(unpremul)
@@ -10,6 +10,7 @@
 
 #include "include/private/SkColorData.h"
 
+#include <cstring>
 #include <utility>
 
 #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
@@ -158,6 +159,32 @@ static void inverted_CMYK_to_BGR1_portable(uint32_t* dst, const uint32_t* src, i
     }
 }
 
+// Indices are packed high bits first, as in PNG, BMP, and GIF.
+template <int kBits>
+static void small_index_to_8888_portable(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t ctable[]) {
+    const uint8_t mask = (1 << kBits) - 1;
+    for (int i = 0; i < count; i++) {
+        int bit = i * kBits;
+        dst[i] = ctable[(src[bit >> 3] >> (8 - kBits - (bit & 7))) & mask];
+    }
+}
+
+static void index8_to_8888_portable(uint32_t dst[], const uint8_t* src, int count, int deltaSrc,
+                                    const uint32_t ctable[]) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = ctable[*src];
+        src += deltaSrc;
+    }
+}
+
+static void sample_8888_portable(uint32_t dst[], const uint8_t* src, int count, int deltaSrc) {
+    for (int i = 0; i < count; i++) {
+        memcpy(dst + i, src, 4);
+        src += deltaSrc;
+    }
+}
+
 #if defined(SK_ARM_HAS_NEON)
 
 // Rounded divide by 255, (x + 127) / 255
@@ -477,6 +504,122 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+static uint8x16_t lookup(uint8x16_t table, uint8x16_t indices) {
+#if defined(SK_CPU_ARM64)
+    return vqtbl1q_u8(table, indices);
+#else
+    uint8x8x2_t halves = {{ vget_low_u8(table), vget_high_u8(table) }};
+    return vcombine_u8(vtbl2_u8(halves, vget_low_u8 (indices)),
+                       vtbl2_u8(halves, vget_high_u8(indices)));
+#endif
+}
+
+// Unpacks the next 16 indices from src, one per byte.
+template <int kBits>
+static uint8x16_t unpack_indices(const uint8_t* src) {
+    if (kBits == 4) {
+        uint8x8_t packed = vld1_u8(src);
+        uint8x8x2_t hilo = vzip_u8(vshr_n_u8(packed, 4), vand_u8(packed, vdup_n_u8(0x0F)));
+        return vcombine_u8(hilo.val[0], hilo.val[1]);
+    }
+
+    // Copy each byte to the lanes of the indices it holds, then test each index's bits.
+    uint64_t packed = 0;
+    memcpy(&packed, src, 16 * kBits / 8);
+    const uint8x8_t bytes = vcreate_u8(packed);
+    if (kBits == 2) {
+        const uint8_t lo[] = { 0,0,0,0, 1,1,1,1 },
+                      hi[] = { 2,2,2,2, 3,3,3,3 },
+                      b1[] = { 0x80,0x20,0x08,0x02, 0x80,0x20,0x08,0x02 },
+                      b0[] = { 0x40,0x10,0x04,0x01, 0x40,0x10,0x04,0x01 };
+        uint8x16_t spread = vcombine_u8(vtbl1_u8(bytes, vld1_u8(lo)),
+                                        vtbl1_u8(bytes, vld1_u8(hi)));
+        uint8x16_t bit1 = vtstq_u8(spread, vcombine_u8(vld1_u8(b1), vld1_u8(b1))),
+                   bit0 = vtstq_u8(spread, vcombine_u8(vld1_u8(b0), vld1_u8(b0)));
+        return vorrq_u8(vandq_u8(bit1, vdupq_n_u8(2)), vandq_u8(bit0, vdupq_n_u8(1)));
+    }
+
+    SkASSERT(kBits == 1);
+    const uint8_t bits[] = { 0x80,0x40,0x20,0x10, 0x08,0x04,0x02,0x01 };
+    uint8x16_t spread = vcombine_u8(vdup_lane_u8(bytes, 0), vdup_lane_u8(bytes, 1));
+    uint8x16_t bit0 = vtstq_u8(spread, vcombine_u8(vld1_u8(bits), vld1_u8(bits)));
+    return vandq_u8(bit0, vdupq_n_u8(1));
+}
+
+template <int kBits>
+static void small_index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                const uint32_t ctable[]) {
+    // Split the (at most 16) colors into one table per byte, so each lookup does 16 pixels.
+    uint32_t colors[16] = {0};
+    memcpy(colors, ctable, sizeof(uint32_t) << kBits);
+    const uint8x16x4_t planes = vld4q_u8((const uint8_t*)colors);
+
+    while (count >= 16) {
+        uint8x16_t indices = unpack_indices<kBits>(src);
+        uint8x16x4_t pixels;
+        pixels.val[0] = lookup(planes.val[0], indices);
+        pixels.val[1] = lookup(planes.val[1], indices);
+        pixels.val[2] = lookup(planes.val[2], indices);
+        pixels.val[3] = lookup(planes.val[3], indices);
+        vst4q_u8((uint8_t*)dst, pixels);
+
+        src += 16 * kBits / 8;
+        dst += 16;
+        count -= 16;
+    }
+
+    small_index_to_8888_portable<kBits>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index1_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<1>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index2_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<2>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index4_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<4>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index8_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          int deltaSrc, const uint32_t ctable[]) {
+    // NEON has no gather, so there's nothing to gain over the portable loop.
+    index8_to_8888_portable(dst, src, count, deltaSrc, ctable);
+}
+
+/*not static*/ inline void sample_8888(uint32_t dst[], const uint8_t* src, int count,
+                                       int deltaSrc) {
+    // Each vector reads a whole run of pixels, the last one just past the final one we sample.
+    // The pixel after that one is the next we sample, so it's safe while count > 4.
+    if (deltaSrc == 8) {
+        while (count > 4) {
+            uint32x4_t a = vreinterpretq_u32_u8(vld1q_u8(src +  0)),
+                       b = vreinterpretq_u32_u8(vld1q_u8(src + 16));
+            vst1q_u32(dst, vuzpq_u32(a, b).val[0]);
+            src += 4*8;
+            dst += 4;
+            count -= 4;
+        }
+    } else if (deltaSrc == 16) {
+        while (count > 4) {
+            uint32x4_t a = vreinterpretq_u32_u8(vld1q_u8(src +  0)),
+                       b = vreinterpretq_u32_u8(vld1q_u8(src + 16)),
+                       c = vreinterpretq_u32_u8(vld1q_u8(src + 32)),
+                       d = vreinterpretq_u32_u8(vld1q_u8(src + 48));
+            vst1q_u32(dst, vuzpq_u32(vuzpq_u32(a, b).val[0], vuzpq_u32(c, d).val[0]).val[0]);
+            src += 4*16;
+            dst += 4;
+            count -= 4;
+        }
+    }
+    sample_8888_portable(dst, src, count, deltaSrc);
+}
+
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
 // Scale a byte by another.
@@ -489,6 +632,15 @@ static __m128i scale(__m128i x, __m128i y) {
     return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, y), _128), _257);
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+static __m512i scale(__m512i x, __m512i y) {
+    const __m512i _128 = _mm512_set1_epi16(128);
+    const __m512i _257 = _mm512_set1_epi16(257);
+
+    return _mm512_mulhi_epu16(_mm512_add_epi16(_mm512_mullo_epi16(x, y), _128), _257);
+}
+#endif
+
 template <bool kSwapRB>
 static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count) {
 
@@ -525,6 +677,55 @@ static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count)
         *hi = _mm_unpackhi_epi16(rg, ba);                         // RGBARGBA RGBARGBA
     };
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    // The same as premul8(), but on all four 128-bit lanes at once.  Every step stays within its
+    // lane, so each lane of lo and hi is premultiplied just as premul8() would, in place.
+    auto premul32 = [](__m512i* lo, __m512i* hi) {
+        const __m512i zeros = _mm512_setzero_si512();
+        __m512i planar;
+        if (kSwapRB) {
+            planar = _mm512_broadcast_i32x4(
+                    _mm_setr_epi8(2,6,10,14, 1,5,9,13, 0,4,8,12, 3,7,11,15));
+        } else {
+            planar = _mm512_broadcast_i32x4(
+                    _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15));
+        }
+
+        *lo = _mm512_shuffle_epi8(*lo, planar);
+        *hi = _mm512_shuffle_epi8(*hi, planar);
+        __m512i rg = _mm512_unpacklo_epi32(*lo, *hi),
+                ba = _mm512_unpackhi_epi32(*lo, *hi);
+
+        __m512i r = _mm512_unpacklo_epi8(rg, zeros),
+                g = _mm512_unpackhi_epi8(rg, zeros),
+                b = _mm512_unpacklo_epi8(ba, zeros),
+                a = _mm512_unpackhi_epi8(ba, zeros);
+
+        r = scale(r, a);
+        g = scale(g, a);
+        b = scale(b, a);
+
+        rg = _mm512_or_si512(r, _mm512_slli_epi16(g, 8));
+        ba = _mm512_or_si512(b, _mm512_slli_epi16(a, 8));
+        *lo = _mm512_unpacklo_epi16(rg, ba);
+        *hi = _mm512_unpackhi_epi16(rg, ba);
+    };
+
+    while (count >= 32) {
+        __m512i lo = _mm512_loadu_si512(src +  0),
+                hi = _mm512_loadu_si512(src + 16);
+
+        premul32(&lo, &hi);
+
+        _mm512_storeu_si512(dst +  0, lo);
+        _mm512_storeu_si512(dst + 16, hi);
+
+        src += 32;
+        dst += 32;
+        count -= 32;
+    }
+#endif
+
     while (count >= 8) {
         __m128i lo = _mm_loadu_si128((const __m128i*) (src + 0)),
                 hi = _mm_loadu_si128((const __m128i*) (src + 4));
@@ -568,6 +769,19 @@ static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count)
 /*not static*/ inline void RGBA_to_BGRA(uint32_t* dst, const uint32_t* src, int count) {
     const __m128i swapRB = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    const __m512i swapRB4 = _mm512_broadcast_i32x4(swapRB);
+    while (count >= 16) {
+        __m512i rgba = _mm512_loadu_si512(src);
+        __m512i bgra = _mm512_shuffle_epi8(rgba, swapRB4);
+        _mm512_storeu_si512(dst, bgra);
+
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+#endif
+
     while (count >= 4) {
         __m128i rgba = _mm_loadu_si128((const __m128i*) src);
         __m128i bgra = _mm_shuffle_epi8(rgba, swapRB);
@@ -774,6 +988,159 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+// Unpacks the next 16 indices from src, one per byte.
+template <int kBits>
+static __m128i unpack_indices(const uint8_t* src) {
+    if (kBits == 4) {
+        __m128i packed = _mm_loadl_epi64((const __m128i*) src),
+                lowBits = _mm_set1_epi8(0x0F);
+        return _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(packed, 4), lowBits),
+                                 _mm_and_si128(packed, lowBits));
+    }
+
+    // Copy each byte to the lanes of the indices it holds, then test each index's bits.
+    int32_t packed = 0;
+    memcpy(&packed, src, 16 * kBits / 8);
+    const __m128i bytes = _mm_cvtsi32_si128(packed);
+    auto test = [](__m128i x, __m128i bits) {
+        return _mm_cmpeq_epi8(_mm_and_si128(x, bits), bits);
+    };
+    if (kBits == 2) {
+        __m128i spread = _mm_shuffle_epi8(bytes, _mm_setr_epi8(0,0,0,0, 1,1,1,1,
+                                                               2,2,2,2, 3,3,3,3));
+        __m128i bit1 = test(spread, _mm_set1_epi32(0x02082080)),
+                bit0 = test(spread, _mm_set1_epi32(0x01041040));
+        return _mm_or_si128(_mm_and_si128(bit1, _mm_set1_epi8(2)),
+                            _mm_and_si128(bit0, _mm_set1_epi8(1)));
+    }
+
+    SkASSERT(kBits == 1);
+    __m128i spread = _mm_shuffle_epi8(bytes, _mm_setr_epi8(0,0,0,0, 0,0,0,0,
+                                                           1,1,1,1, 1,1,1,1));
+    __m128i bit0 = test(spread, _mm_set1_epi64x(0x0102040810204080));
+    return _mm_and_si128(bit0, _mm_set1_epi8(1));
+}
+
+template <int kBits>
+static void small_index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                const uint32_t ctable[]) {
+    // Split the (at most 16) colors into one table per byte, so each lookup does 16 pixels.
+    uint32_t colors[16] = {0};
+    memcpy(colors, ctable, sizeof(uint32_t) << kBits);
+    const __m128i byPlane = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+    __m128i c0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (colors +  0)), byPlane),
+            c1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (colors +  4)), byPlane),
+            c2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (colors +  8)), byPlane),
+            c3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (colors + 12)), byPlane);
+    __m128i p01_01 = _mm_unpacklo_epi32(c0, c1),
+            p01_23 = _mm_unpackhi_epi32(c0, c1),
+            p23_01 = _mm_unpacklo_epi32(c2, c3),
+            p23_23 = _mm_unpackhi_epi32(c2, c3);
+    const __m128i plane0 = _mm_unpacklo_epi64(p01_01, p23_01),
+                  plane1 = _mm_unpackhi_epi64(p01_01, p23_01),
+                  plane2 = _mm_unpacklo_epi64(p01_23, p23_23),
+                  plane3 = _mm_unpackhi_epi64(p01_23, p23_23);
+
+    while (count >= 16) {
+        __m128i indices = unpack_indices<kBits>(src);
+        __m128i b0 = _mm_shuffle_epi8(plane0, indices),
+                b1 = _mm_shuffle_epi8(plane1, indices),
+                b2 = _mm_shuffle_epi8(plane2, indices),
+                b3 = _mm_shuffle_epi8(plane3, indices);
+
+        __m128i b01_lo = _mm_unpacklo_epi8(b0, b1),
+                b01_hi = _mm_unpackhi_epi8(b0, b1),
+                b23_lo = _mm_unpacklo_epi8(b2, b3),
+                b23_hi = _mm_unpackhi_epi8(b2, b3);
+        _mm_storeu_si128((__m128i*) (dst +  0), _mm_unpacklo_epi16(b01_lo, b23_lo));
+        _mm_storeu_si128((__m128i*) (dst +  4), _mm_unpackhi_epi16(b01_lo, b23_lo));
+        _mm_storeu_si128((__m128i*) (dst +  8), _mm_unpacklo_epi16(b01_hi, b23_hi));
+        _mm_storeu_si128((__m128i*) (dst + 12), _mm_unpackhi_epi16(b01_hi, b23_hi));
+
+        src += 16 * kBits / 8;
+        dst += 16;
+        count -= 16;
+    }
+
+    small_index_to_8888_portable<kBits>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index1_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<1>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index2_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<2>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index4_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888<4>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index8_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          int deltaSrc, const uint32_t ctable[]) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    if (deltaSrc == 1) {
+        while (count >= 8) {
+            __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) src));
+            _mm256_storeu_si256((__m256i*) dst,
+                                _mm256_i32gather_epi32((const int*) ctable, indices, 4));
+            src += 8;
+            dst += 8;
+            count -= 8;
+        }
+    } else {
+        // Each index is gathered as the low byte of 4, so the last one reads 3 bytes past where
+        // it sits.  Those are safe to read as long as at least 2 more indices follow this batch.
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0,1,2,3,4,5,6,7),
+                                                   _mm256_set1_epi32(deltaSrc));
+        while (count >= 10) {
+            __m256i indices = _mm256_and_si256(_mm256_i32gather_epi32((const int*) src,
+                                                                      offsets, 1),
+                                               _mm256_set1_epi32(0xFF));
+            _mm256_storeu_si256((__m256i*) dst,
+                                _mm256_i32gather_epi32((const int*) ctable, indices, 4));
+            src += 8 * deltaSrc;
+            dst += 8;
+            count -= 8;
+        }
+    }
+#endif
+    index8_to_8888_portable(dst, src, count, deltaSrc, ctable);
+}
+
+/*not static*/ inline void sample_8888(uint32_t dst[], const uint8_t* src, int count,
+                                       int deltaSrc) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0,1,2,3,4,5,6,7),
+                                               _mm256_set1_epi32(deltaSrc));
+    while (count >= 8) {
+        _mm256_storeu_si256((__m256i*) dst,
+                            _mm256_i32gather_epi32((const int*) src, offsets, 1));
+        src += 8 * deltaSrc;
+        dst += 8;
+        count -= 8;
+    }
+#else
+    if (deltaSrc == 8) {
+        // Each pair of vectors reads the pixel after the last one we sample, which is safe as
+        // long as the next pixel we'd sample exists.
+        while (count > 4) {
+            __m128 a = _mm_loadu_ps((const float*) (src +  0)),
+                   b = _mm_loadu_ps((const float*) (src + 16));
+            _mm_storeu_ps((float*) dst, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+            src += 4*8;
+            dst += 4;
+            count -= 4;
+        }
+    }
+#endif
+    sample_8888_portable(dst, src, count, deltaSrc);
+}
+
 #else
 
 /*not static*/ inline void RGBA_to_rgbA(uint32_t* dst, const uint32_t* src, int count) {
@@ -816,6 +1183,31 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_CMYK_to_BGR1_portable(dst, src, count);
 }
 
+/*not static*/ inline void index1_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888_portable<1>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index2_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888_portable<2>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index4_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          const uint32_t ctable[]) {
+    small_index_to_8888_portable<4>(dst, src, count, ctable);
+}
+
+/*not static*/ inline void index8_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                          int deltaSrc, const uint32_t ctable[]) {
+    index8_to_8888_portable(dst, src, count, deltaSrc, ctable);
+}
+
+/*not static*/ inline void sample_8888(uint32_t dst[], const uint8_t* src, int count,
+                                       int deltaSrc) {
+    sample_8888_portable(dst, src, count, deltaSrc);
+}
+
 #endif
 
 }
@@ -11,10 +11,30 @@
 #include <stdint.h>
 #include "include/private/SkNx.h"
 
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    #include <immintrin.h>
+#endif
+
 namespace SK_OPTS_NS {
 
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    static inline __m512i splat512(uint16_t v) { return _mm512_set1_epi16(v); }
+    static inline __m512i splat512(uint32_t v) { return _mm512_set1_epi32(v); }
+    static inline __m512i splat512(uint64_t v) { return _mm512_set1_epi64(v); }
+#endif
+
     template <typename T>
     static void memsetT(T buffer[], T value, int count) {
+    #if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+        // SkNx has no 512-bit types, so we store a full register at a time by hand,
+        // and let the 256-bit loop below finish up.
+        const __m512i splat = splat512(value);
+        while (count >= (int)(64 / sizeof(T))) {
+            _mm512_storeu_si512(buffer, splat);
+            buffer += 64 / sizeof(T);
+            count  -= 64 / sizeof(T);
+        }
+    #endif
     #if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
         static const int N = 32 / sizeof(T);
     #else
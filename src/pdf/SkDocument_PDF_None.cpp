@@ -13,3 +13,8 @@ sk_sp<SkDocument> SkPDF::MakeDocument(SkWStream*, const SkPDF::Metadata&) { retu
 void SkPDF::SetNodeId(SkCanvas* c, int n) {
     c->drawAnnotation({0, 0, 0, 0}, "PDF_Node_Key", SkData::MakeWithCopy(&n, sizeof(n)).get());
 }
+
+size_t SkPDF::SetSubsetFontCacheLimit(size_t) { return 0; }
+size_t SkPDF::GetSubsetFontCacheLimit() { return 0; }
+size_t SkPDF::GetSubsetFontCacheBytesUsed() { return 0; }
+void SkPDF::PurgeSubsetFontCache() {}
@@ -7,6 +7,9 @@
 
 #include "src/pdf/SkPDFBitmap.h"
 
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
@@ -14,6 +17,7 @@
 #include "include/private/SkColorData.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkOpts.h"
 #include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkJpegInfo.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
@@ -193,20 +197,26 @@ static void do_deflated_image(const SkPixmap& pm,
     }
 }
 
-static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
-                    SkPDFIndirectReference ref) {
+// Returns true if data is a JPEG of the given size that can be written into the PDF as is.
+static bool can_embed_jpeg(const SkData& data, SkISize size, bool* yuv) {
     SkISize jpegSize;
     SkEncodedInfo::Color jpegColorType;
     SkEncodedOrigin exifOrientation;
-    if (!SkGetJpegInfo(data->data(), data->size(), &jpegSize,
+    if (!SkGetJpegInfo(data.data(), data.size(), &jpegSize,
                        &jpegColorType, &exifOrientation)) {
         return false;
     }
-    bool yuv = jpegColorType == SkEncodedInfo::kYUV_Color;
-    bool goodColorType = yuv || jpegColorType == SkEncodedInfo::kGray_Color;
-    if (jpegSize != size  // Sanity check.
-            || !goodColorType
-            || kTopLeft_SkEncodedOrigin != exifOrientation) {
+    *yuv = jpegColorType == SkEncodedInfo::kYUV_Color;
+    bool goodColorType = *yuv || jpegColorType == SkEncodedInfo::kGray_Color;
+    return jpegSize == size  // Sanity check.
+           && goodColorType
+           && kTopLeft_SkEncodedOrigin == exifOrientation;
+}
+
+static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
+                    SkPDFIndirectReference ref) {
+    bool yuv;
+    if (!can_embed_jpeg(*data, size, &yuv)) {
         return false;
     }
     #ifdef SK_PDF_BASE85_BINARY
@@ -217,7 +227,7 @@ static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
 
     emit_image_stream(doc, ref,
                       [&data](SkWStream* dst) { dst->write(data->data(), data->size()); },
-                      jpegSize, yuv ? "DeviceRGB" : "DeviceGray",
+                      size, yuv ? "DeviceRGB" : "DeviceGray",
                       SkPDFIndirectReference(), SkToInt(data->size()), true);
     return true;
 }
@@ -275,7 +285,10 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
+    // An image may need a soft mask, numbered once the image is read, so it can only be
+    // serialized on another thread if objects need not be numbered and written in order.
+    SkExecutor* executor = doc->emitsInOrder() ? nullptr : doc->executor();
+    if (executor) {
         SkRef(img);
         doc->incrementJobCount();
         executor->add([img, encodingQuality, doc, ref]() {
@@ -288,3 +301,99 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     serialize_image(img, encodingQuality, doc, ref);
     return ref;
 }
+
+// serialize_image() writes these JPEGs out unchanged, so the encoded data identifies them.
+static sk_sp<SkData> embeddable_jpeg(const SkImage* img) {
+    bool yuv;
+    sk_sp<SkData> data = img->refEncodedData();
+    return data && can_embed_jpeg(*data, img->dimensions(), &yuv) ? data : nullptr;
+}
+
+// Other lazy images (PNG, WebP, ...) are decoded to be written, so their encoded data identifies
+// them too, as long as they are the whole encoded image and not a subset of it.  Reading the
+// header for the encoded size does not decode anything.
+static sk_sp<SkData> encoded_lazy_image(const SkImage* img) {
+    if (!img->isLazyGenerated()) {
+        return nullptr;
+    }
+    sk_sp<SkData> data = img->refEncodedData();
+    if (!data) {
+        return nullptr;
+    }
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    return codec && codec->dimensions() == img->dimensions() ? data : nullptr;
+}
+
+static uint32_t hash_encoded_sample(const SkData& data) {
+    const uint8_t* bytes = data.bytes();
+    const size_t size = data.size();
+    uint32_t hash = SkOpts::hash(&size, sizeof(size));
+    for (size_t i = 0; i < 64; ++i) {
+        hash = SkOpts::hash(bytes + i * (size - 1) / 63, 1, hash);
+    }
+    return hash;
+}
+
+static uint32_t image_format(SkColorType colorType, SkAlphaType alphaType) {
+    return (uint32_t)colorType | (uint32_t)alphaType << 8;
+}
+
+bool SkPDFMakeImageContentKey(const SkImage* img, SkPDFImageContentKey* key) {
+    SkASSERT(img);
+    SkASSERT(key);
+    key->fWidth = img->width();
+    key->fHeight = img->height();
+    if (sk_sp<SkData> data = embeddable_jpeg(img)) {
+        key->fFormat = SkPDFImageContentKey::kJpeg_Format;
+        key->fSampleHash = hash_encoded_sample(*data);
+        return true;
+    }
+    if (sk_sp<SkData> data = encoded_lazy_image(img)) {
+        key->fFormat = SkPDFImageContentKey::kEncoded_Format |
+                       image_format(img->colorType(), img->alphaType());
+        key->fSampleHash = hash_encoded_sample(*data);
+        return true;
+    }
+    // Anything else would have to be decoded or drawn to be compared; leave that to the writer.
+    SkPixmap pm;
+    if (!img->peekPixels(&pm)) {
+        return false;
+    }
+    const size_t bpp = pm.info().bytesPerPixel();
+    if (0 == bpp || pm.width() < 1 || pm.height() < 1) {
+        return false;
+    }
+    uint32_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            hash = SkOpts::hash(pm.addr(x * (pm.width() - 1) / 7, y * (pm.height() - 1) / 7),
+                                bpp, hash);
+        }
+    }
+    key->fFormat = image_format(pm.colorType(), pm.alphaType());
+    key->fSampleHash = hash;
+    return true;
+}
+
+SkMD5::Digest SkPDFImageContentDigest(const SkImage* img) {
+    SkASSERT(img);
+    SkMD5 md5;
+    if (sk_sp<SkData> data = embeddable_jpeg(img)) {
+        md5.write(data->data(), data->size());
+        return md5.finish();
+    }
+    if (sk_sp<SkData> data = encoded_lazy_image(img)) {
+        md5.write(data->data(), data->size());
+    } else {
+        SkPixmap pm;
+        SkAssertResult(img->peekPixels(&pm));
+        for (int y = 0; y < pm.height(); ++y) {
+            md5.write(pm.addr(0, y), pm.width() * pm.info().bytesPerPixel());
+        }
+    }
+    if (SkColorSpace* colorSpace = img->colorSpace()) {
+        sk_sp<SkData> profile = colorSpace->serialize();
+        md5.write(profile->data(), profile->size());
+    }
+    return md5.finish();
+}
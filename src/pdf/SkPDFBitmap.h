@@ -7,9 +7,11 @@
 #ifndef SkPDFBitmap_DEFINED
 #define SkPDFBitmap_DEFINED
 
-class SkImage;
+#include "include/core/SkImage.h"
+#include "src/core/SkMD5.h"
+#include "src/pdf/SkPDFTypes.h"
+
 class SkPDFDocument;
-struct SkPDFIndirectReference;
 
 /**
  * Serialize a SkImage as an Image Xobject.
@@ -19,4 +21,47 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
                                            SkPDFDocument* doc,
                                            int encodingQuality = 101);
 
+/**
+ *  Cheaply identifies what SkPDFSerializeImage() writes for an image, so that separate SkImages
+ *  with the same contents (e.g. the same logo decoded once per page) can share one Image XObject.
+ *
+ *  JPEGs that are written as is and other lazy images are identified by their encoded data, and
+ *  raster images by their pixels.  The key covers only the size, the format and a sample of the
+ *  data: images with the same contents have the same key, but images with the same key may still
+ *  differ, so compare their SkPDFImageContentDigest()s before sharing.
+ */
+struct SkPDFImageContentKey {
+    int32_t  fWidth;
+    int32_t  fHeight;
+    uint32_t fFormat;   // Color type and alpha type (plus kEncoded_Format), or kJpeg_Format.
+    uint32_t fSampleHash;
+
+    static constexpr uint32_t kJpeg_Format = ~0u;
+    static constexpr uint32_t kEncoded_Format = 1u << 31;
+
+    bool operator==(const SkPDFImageContentKey& that) const {
+        return fSampleHash == that.fSampleHash && fWidth == that.fWidth &&
+               fHeight == that.fHeight && fFormat == that.fFormat;
+    }
+};
+
+/**
+ *  Returns false if the image's contents cannot be identified without decoding or drawing it.
+ */
+bool SkPDFMakeImageContentKey(const SkImage* img, SkPDFImageContentKey* key);
+
+/**
+ *  Returns an MD5 of the contents of an image that has an SkPDFImageContentKey.
+ */
+SkMD5::Digest SkPDFImageContentDigest(const SkImage* img);
+
+/**
+ *  An Image XObject already written for an SkPDFImageContentKey.  Images are digested when they
+ *  are written, so the document keeps no SkImages alive to compare against later.
+ */
+struct SkPDFImageContentEntry {
+    SkMD5::Digest          fDigest;
+    SkPDFIndirectReference fRef;
+};
+
 #endif  // SkPDFBitmap_DEFINED
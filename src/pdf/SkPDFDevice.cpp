@@ -107,11 +107,6 @@ sk_sp<SkImage> alpha_image_to_greyscale_image(const SkImage* mask) {
     return SkImage::MakeFromBitmap(greyBitmap);
 }
 
-static int add_resource(SkTHashSet<SkPDFIndirectReference>& resources, SkPDFIndirectReference ref) {
-    resources.add(ref);
-    return ref.fValue;
-}
-
 static void draw_points(SkCanvas::PointMode mode,
                         size_t count,
                         const SkPoint* points,
@@ -195,7 +190,7 @@ SkBaseDevice* SkPDFDevice::onCreateDevice(const CreateInfo& cinfo, const SkPaint
         // need to return a raster device, which we will detect in drawDevice()
         return SkBitmapDevice::Create(cinfo.fInfo, SkSurfaceProps(0, kUnknown_SkPixelGeometry));
     }
-    return new SkPDFDevice(cinfo.fInfo.dimensions(), fDocument);
+    return new SkPDFDevice(cinfo.fInfo.dimensions(), fDocument, SkMatrix::I(), fPage);
 }
 
 // A helper class to automatically finish a ContentEntry at the end of a
@@ -273,19 +268,21 @@ private:
     SkPDFDevice* fDevice = nullptr;
     SkDynamicMemoryWStream* fContentStream = nullptr;
     SkBlendMode fBlendMode;
-    SkPDFIndirectReference fDstFormXObject;
+    SkPDFResource fDstFormXObject;
     SkPath fShape;
     const SkClipStack* fClipStack;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-SkPDFDevice::SkPDFDevice(SkISize pageSize, SkPDFDocument* doc, const SkMatrix& transform)
+SkPDFDevice::SkPDFDevice(SkISize pageSize, SkPDFDocument* doc, const SkMatrix& transform,
+                         SkPDFConcurrentPage* page)
     : INHERITED(SkImageInfo::MakeUnknown(pageSize.width(), pageSize.height()),
                 SkSurfaceProps(0, kUnknown_SkPixelGeometry))
     , fInitialTransform(transform)
     , fNodeId(0)
     , fDocument(doc)
+    , fPage(page)
 {
     SkASSERT(!pageSize.isEmpty());
 }
@@ -293,10 +290,7 @@ SkPDFDevice::SkPDFDevice(SkISize pageSize, SkPDFDocument* doc, const SkMatrix& t
 SkPDFDevice::~SkPDFDevice() = default;
 
 void SkPDFDevice::reset() {
-    fGraphicStateResources.reset();
-    fXObjectResources.reset();
-    fShaderResources.reset();
-    fFontResources.reset();
+    fResources = SkPDFResourceList();
     fContent.reset();
     fActiveStackState = SkPDFGraphicStackState();
 }
@@ -305,7 +299,7 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
     if (!value) {
         return;
     }
-    const SkMatrix& pageXform = fDocument->currentPageTransform();
+    const SkMatrix& pageXform = fPage ? fPage->transform() : fDocument->currentPageTransform();
     SkPoint deviceOffset = {(float)this->getOrigin().x(), (float)this->getOrigin().y()};
     if (rect.isEmpty()) {
         if (!strcmp(key, SkPDFGetNodeIdKey())) {
@@ -318,6 +312,10 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
         if (!strcmp(SkAnnotationKeys::Define_Named_Dest_Key(), key)) {
             SkPoint p = deviceOffset + this->ctm().mapXY(rect.x(), rect.y());
             pageXform.mapPoints(&p, 1);
+            if (fPage) {
+                fPage->fNamedDestinations.emplace_back(sk_ref_sp(value), p);
+                return;
+            }
             auto pg = fDocument->currentPage();
             fDocument->fNamedDestinations.push_back(SkPDFNamedDestination{sk_ref_sp(value), p, pg});
         }
@@ -335,12 +333,14 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
     if (transformedRect.isEmpty()) {
         return;
     }
+    auto& linkToURLs =
+            fPage ? fPage->fLinkToURLs : fDocument->fCurrentPageLinkToURLs;
+    auto& linkToDestinations =
+            fPage ? fPage->fLinkToDestinations : fDocument->fCurrentPageLinkToDestinations;
     if (!strcmp(SkAnnotationKeys::URL_Key(), key)) {
-        fDocument->fCurrentPageLinkToURLs.push_back(
-                std::make_pair(sk_ref_sp(value), transformedRect));
+        linkToURLs.push_back(std::make_pair(sk_ref_sp(value), transformedRect));
     } else if (!strcmp(SkAnnotationKeys::Link_Named_Dest_Key(), key)) {
-        fDocument->fCurrentPageLinkToDestinations.emplace_back(
-                std::make_pair(sk_ref_sp(value), transformedRect));
+        linkToDestinations.emplace_back(std::make_pair(sk_ref_sp(value), transformedRect));
     }
 }
 
@@ -505,27 +505,43 @@ void SkPDFDevice::internalDrawPathWithFilter(const SkClipStack& clipStack,
     if (!content) {
         return;
     }
-    this->setGraphicState(SkPDFGraphicState::GetSMaskGraphicState(
-            maskDevice->makeFormXObjectFromDevice(dstMaskBounds, true), false,
-            SkPDFGraphicState::kLuminosity_SMaskMode, fDocument), content.stream());
+    this->setSMaskGraphicState(maskDevice->makeFormXObjectFromDevice(dstMaskBounds, true), false,
+                               SkPDFGraphicState::kLuminosity_SMaskMode, content.stream());
     SkPDFUtils::AppendRectangle(SkRect::Make(dstMaskBounds), content.stream());
     SkPDFUtils::PaintPath(SkPaint::kFill_Style, path.getFillType(), content.stream());
     this->clearMaskOnGraphicState(content.stream());
 }
 
-void SkPDFDevice::setGraphicState(SkPDFIndirectReference gs, SkDynamicMemoryWStream* content) {
-    SkPDFUtils::ApplyGraphicState(add_resource(fGraphicStateResources, gs), content);
+void SkPDFDevice::setGraphicState(const SkPDFResource& gs, SkDynamicMemoryWStream* content) {
+    SkPDFUtils::ApplyGraphicState(fResources.add(SkPDFResourceType::kExtGState, gs), content);
 }
 
-void SkPDFDevice::clearMaskOnGraphicState(SkDynamicMemoryWStream* contentStream) {
-    // The no-softmask graphic state is used to "turn off" the mask for later draw calls.
-    SkPDFIndirectReference& noSMaskGS = fDocument->fNoSmaskGraphicState;
+void SkPDFDevice::setSMaskGraphicState(const SkPDFResource& sMask,
+                                       bool invert,
+                                       SkPDFGraphicState::SkPDFSMaskMode sMaskMode,
+                                       SkDynamicMemoryWStream* content) {
+    if (fPage) {
+        this->setGraphicState(fPage->sMaskGraphicState(sMask, invert, sMaskMode), content);
+        return;
+    }
+    this->setGraphicState(SkPDFGraphicState::GetSMaskGraphicState(
+            sMask.fRef, invert, sMaskMode, fDocument), content);
+}
+
+static SkPDFIndirectReference get_no_smask_graphic_state(SkPDFDocument* doc) {
+    SkPDFIndirectReference& noSMaskGS = doc->fNoSmaskGraphicState;
     if (!noSMaskGS) {
         SkPDFDict tmp("ExtGState");
         tmp.insertName("SMask", "None");
-        noSMaskGS = fDocument->emit(tmp);
+        noSMaskGS = doc->emit(tmp);
     }
-    this->setGraphicState(noSMaskGS, contentStream);
+    return noSMaskGS;
+}
+
+void SkPDFDevice::clearMaskOnGraphicState(SkDynamicMemoryWStream* contentStream) {
+    // The no-softmask graphic state is used to "turn off" the mask for later draw calls.
+    this->setGraphicState(fPage ? fPage->noSMaskGraphicState()
+                                : get_no_smask_graphic_state(fDocument), contentStream);
 }
 
 void SkPDFDevice::internalDrawPath(const SkClipStack& clipStack,
@@ -845,7 +861,8 @@ void SkPDFDevice::internalDrawGlyphRun(
 
     int markId = -1;
     if (fNodeId) {
-        markId = fDocument->getMarkIdForNodeId(fNodeId);
+        markId = fPage ? fPage->markIdForNodeId(fNodeId)
+                       : fDocument->getMarkIdForNodeId(fNodeId);
     }
 
     if (markId != -1) {
@@ -925,12 +942,18 @@ void SkPDFDevice::internalDrawGlyphRun(
             }
             if (needs_new_font(font, gid, glyphCache.get(), fontType)) {
                 // Not yet specified font or need to switch font.
-                font = SkPDFFont::GetFontResource(fDocument, glyphCache.get(), typeface, gid);
+                SkPDFResource fontResource;
+                if (fPage) {
+                    font = fPage->font(glyphCache.get(), typeface, gid, &fontResource);
+                } else {
+                    font = SkPDFFont::GetFontResource(fDocument, glyphCache.get(), typeface, gid);
+                    fontResource = font->indirectReference();
+                }
                 SkASSERT(font);  // All preconditions for SkPDFFont::GetFontResource are met.
                 glyphPositioner.flush();
                 glyphPositioner.setWideChars(font->multiByteGlyphs());
                 SkPDFWriteResourceName(out, SkPDFResourceType::kFont,
-                                       add_resource(fFontResources, font->indirectReference()));
+                                       fResources.add(SkPDFResourceType::kFont, fontResource));
                 out->writeText(" ");
                 SkPDFUtils::AppendScalar(textSize, out);
                 out->writeText(" Tf\n");
@@ -959,10 +982,11 @@ void SkPDFDevice::drawVertices(const SkVertices*, const SkVertices::Bone[], int,
     // TODO: implement drawVertices
 }
 
-void SkPDFDevice::drawFormXObject(SkPDFIndirectReference xObject, SkDynamicMemoryWStream* content) {
+void SkPDFDevice::drawFormXObject(const SkPDFResource& xObject,
+                                  SkDynamicMemoryWStream* content) {
     SkASSERT(xObject);
     SkPDFWriteResourceName(content, SkPDFResourceType::kXObject,
-                           add_resource(fXObjectResources, xObject));
+                           fResources.add(SkPDFResourceType::kXObject, xObject));
     content->writeText(" Do\n");
 }
 
@@ -1005,20 +1029,8 @@ sk_sp<SkSurface> SkPDFDevice::makeSurface(const SkImageInfo& info, const SkSurfa
     return SkSurface::MakeRaster(info, &props);
 }
 
-static std::vector<SkPDFIndirectReference> sort(const SkTHashSet<SkPDFIndirectReference>& src) {
-    std::vector<SkPDFIndirectReference> dst;
-    dst.reserve(src.count());
-    src.foreach([&dst](SkPDFIndirectReference ref) { dst.push_back(ref); } );
-    std::sort(dst.begin(), dst.end(),
-            [](SkPDFIndirectReference a, SkPDFIndirectReference b) { return a.fValue < b.fValue; });
-    return dst;
-}
-
 std::unique_ptr<SkPDFDict> SkPDFDevice::makeResourceDict() {
-    return SkPDFMakeResourceDict(sort(fGraphicStateResources),
-                                 sort(fShaderResources),
-                                 sort(fXObjectResources),
-                                 sort(fFontResources));
+    return fResources.makeResourceDict();
 }
 
 std::unique_ptr<SkStreamAsset> SkPDFDevice::content() {
@@ -1107,7 +1119,7 @@ bool SkPDFDevice::handleInversePath(const SkPath& origPath,
     return true;
 }
 
-SkPDFIndirectReference SkPDFDevice::makeFormXObjectFromDevice(SkIRect bounds, bool alpha) {
+SkPDFResource SkPDFDevice::makeFormXObjectFromDevice(SkIRect bounds, bool alpha) {
     SkMatrix inverseTransform = SkMatrix::I();
     if (!fInitialTransform.isIdentity()) {
         if (!fInitialTransform.invert(&inverseTransform)) {
@@ -1117,6 +1129,12 @@ SkPDFIndirectReference SkPDFDevice::makeFormXObjectFromDevice(SkIRect bounds, bo
     }
     const char* colorSpace = alpha ? "DeviceGray" : nullptr;
 
+    if (fPage) {
+        SkPDFResource xobject = fPage->formXObject(this->content(), bounds, std::move(fResources),
+                                                   inverseTransform, colorSpace);
+        this->reset();
+        return xobject;
+    }
     SkPDFIndirectReference xobject =
         SkPDFMakeFormXObject(fDocument, this->content(),
                              SkPDFMakeArray(bounds.left(), bounds.top(),
@@ -1129,12 +1147,12 @@ SkPDFIndirectReference SkPDFDevice::makeFormXObjectFromDevice(SkIRect bounds, bo
     return xobject;
 }
 
-SkPDFIndirectReference SkPDFDevice::makeFormXObjectFromDevice(bool alpha) {
+SkPDFResource SkPDFDevice::makeFormXObjectFromDevice(bool alpha) {
     return this->makeFormXObjectFromDevice(SkIRect{0, 0, this->width(), this->height()}, alpha);
 }
 
-void SkPDFDevice::drawFormXObjectWithMask(SkPDFIndirectReference xObject,
-                                          SkPDFIndirectReference sMask,
+void SkPDFDevice::drawFormXObjectWithMask(const SkPDFResource& xObject,
+                                          const SkPDFResource& sMask,
                                           SkBlendMode mode,
                                           bool invertClip) {
     SkASSERT(sMask);
@@ -1144,9 +1162,8 @@ void SkPDFDevice::drawFormXObjectWithMask(SkPDFIndirectReference xObject,
     if (!content) {
         return;
     }
-    this->setGraphicState(SkPDFGraphicState::GetSMaskGraphicState(
-            sMask, invertClip, SkPDFGraphicState::kAlpha_SMaskMode,
-            fDocument), content.stream());
+    this->setSMaskGraphicState(sMask, invertClip, SkPDFGraphicState::kAlpha_SMaskMode,
+                               content.stream());
     this->drawFormXObject(xObject, content.stream());
     this->clearMaskOnGraphicState(content.stream());
 }
@@ -1158,6 +1175,7 @@ static bool treat_as_regular_pdf_blend_mode(SkBlendMode blendMode) {
 
 static void populate_graphic_state_entry_from_paint(
         SkPDFDocument* doc,
+        SkPDFConcurrentPage* page,
         const SkMatrix& matrix,
         const SkClipStack* clipStack,
         SkIRect deviceBounds,
@@ -1165,8 +1183,7 @@ static void populate_graphic_state_entry_from_paint(
         const SkMatrix& initialTransform,
         SkScalar textScale,
         SkPDFGraphicStackState::Entry* entry,
-        SkTHashSet<SkPDFIndirectReference>* shaderResources,
-        SkTHashSet<SkPDFIndirectReference>* graphicStateResources) {
+        SkPDFResourceList* resources) {
     NOT_IMPLEMENTED(paint.getPathEffect() != nullptr, false);
     NOT_IMPLEMENTED(paint.getMaskFilter() != nullptr, false);
     NOT_IMPLEMENTED(paint.getColorFilter() != nullptr, false);
@@ -1209,25 +1226,28 @@ static void populate_graphic_state_entry_from_paint(
             SkIRect bounds;
             clipStackBounds.roundOut(&bounds);
 
-            SkPDFIndirectReference pdfShader
-                = SkPDFMakeShader(doc, shader, transform, bounds, paint.getColor());
+            SkPDFResource pdfShader;
+            if (page) {
+                pdfShader = page->shader(sk_ref_sp(shader), transform, bounds, paint.getColor());
+            } else {
+                pdfShader = SkPDFMakeShader(doc, shader, transform, bounds, paint.getColor());
+            }
 
             if (pdfShader) {
                 // pdfShader has been canonicalized so we can directly compare pointers.
-                entry->fShaderIndex = add_resource(*shaderResources, pdfShader);
+                entry->fShaderIndex = resources->add(SkPDFResourceType::kPattern, pdfShader);
             }
         }
     }
 
-    SkPDFIndirectReference newGraphicState;
-    if (color == paint.getColor4f()) {
-        newGraphicState = SkPDFGraphicState::GetGraphicStateForPaint(doc, paint);
-    } else {
-        SkPaint newPaint = paint;
-        newPaint.setColor4f(color, nullptr);
-        newGraphicState = SkPDFGraphicState::GetGraphicStateForPaint(doc, newPaint);
+    SkTCopyOnFirstWrite<SkPaint> gsPaint(paint);
+    if (color != paint.getColor4f()) {
+        gsPaint.writable()->setColor4f(color, nullptr);
     }
-    entry->fGraphicStateIndex = add_resource(*graphicStateResources, newGraphicState);
+    SkPDFResource newGraphicState =
+            page ? page->graphicStateForPaint(*gsPaint)
+                 : SkPDFResource(SkPDFGraphicState::GetGraphicStateForPaint(doc, *gsPaint));
+    entry->fGraphicStateIndex = resources->add(SkPDFResourceType::kExtGState, newGraphicState);
     entry->fTextScaleX = textScale;
 }
 
@@ -1235,7 +1255,7 @@ SkDynamicMemoryWStream* SkPDFDevice::setUpContentEntry(const SkClipStack* clipSt
                                                        const SkMatrix& matrix,
                                                        const SkPaint& paint,
                                                        SkScalar textScale,
-                                                       SkPDFIndirectReference* dst) {
+                                                       SkPDFResource* dst) {
     SkASSERT(!*dst);
     SkBlendMode blendMode = paint.getBlendMode();
 
@@ -1278,6 +1298,7 @@ SkDynamicMemoryWStream* SkPDFDevice::setUpContentEntry(const SkClipStack* clipSt
     SkPDFGraphicStackState::Entry entry;
     populate_graphic_state_entry_from_paint(
             fDocument,
+            fPage,
             matrix,
             clipStack,
             this->bounds(),
@@ -1285,8 +1306,7 @@ SkDynamicMemoryWStream* SkPDFDevice::setUpContentEntry(const SkClipStack* clipSt
             fInitialTransform,
             textScale,
             &entry,
-            &fShaderResources,
-            &fGraphicStateResources);
+            &fResources);
     fActiveStackState.updateClip(clipStack, this->bounds());
     fActiveStackState.updateMatrix(entry.fMatrix);
     fActiveStackState.updateDrawingState(entry);
@@ -1296,7 +1316,7 @@ SkDynamicMemoryWStream* SkPDFDevice::setUpContentEntry(const SkClipStack* clipSt
 
 void SkPDFDevice::finishContentEntry(const SkClipStack* clipStack,
                                      SkBlendMode blendMode,
-                                     SkPDFIndirectReference dst,
+                                     const SkPDFResource& dst,
                                      SkPath* shape) {
     SkASSERT(blendMode != SkBlendMode::kDst);
     if (treat_as_regular_pdf_blend_mode(blendMode)) {
@@ -1344,7 +1364,7 @@ void SkPDFDevice::finishContentEntry(const SkClipStack* clipStack,
 
     SkPaint stockPaint;
 
-    SkPDFIndirectReference srcFormXObject;
+    SkPDFResource srcFormXObject;
     if (this->isContentEmpty()) {
         // If nothing was drawn and there's no shape, then the draw was a
         // no-op, but dst needs to be restored for that to be true.
@@ -1378,7 +1398,7 @@ void SkPDFDevice::finishContentEntry(const SkClipStack* clipStack,
             filledPaint.setColor(SK_ColorBLACK);
             filledPaint.setStyle(SkPaint::kFill_Style);
             SkClipStack empty;
-            SkPDFDevice shapeDev(this->size(), fDocument, fInitialTransform);
+            SkPDFDevice shapeDev(this->size(), fDocument, fInitialTransform, fPage);
             shapeDev.internalDrawPath(clipStack ? *clipStack : empty,
                                       SkMatrix::I(), *shape, filledPaint, true);
             this->drawFormXObjectWithMask(dst, shapeDev.makeFormXObjectFromDevice(),
@@ -1452,6 +1472,39 @@ static sk_sp<SkImage> color_filter(const SkImage* image,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Separate SkImages with the same contents share one XObject.
+static SkPDFIndirectReference serialize_shared_image(const SkImage* image, SkPDFDocument* doc) {
+    SkPDFImageContentKey key;
+    if (!SkPDFMakeImageContentKey(image, &key)) {
+        return SkPDFSerializeImage(image, doc, doc->metadata().fEncodingQuality);
+    }
+    SkMD5::Digest digest = SkPDFImageContentDigest(image);
+    std::vector<SkPDFImageContentEntry>* entries = doc->fPDFImageContentMap.find(key);
+    if (!entries) {
+        entries = doc->fPDFImageContentMap.set(key, std::vector<SkPDFImageContentEntry>());
+    }
+    for (const SkPDFImageContentEntry& entry : *entries) {
+        if (entry.fDigest == digest) {
+            return entry.fRef;
+        }
+    }
+    SkPDFIndirectReference ref = SkPDFSerializeImage(image, doc, doc->metadata().fEncodingQuality);
+    entries->push_back({digest, ref});
+    return ref;
+}
+
+static SkPDFIndirectReference get_image_resource(SkPDFDocument* doc, const SkKeyedImage& image) {
+    SkBitmapKey key = image.key();
+    if (SkPDFIndirectReference* pdfimagePtr = doc->fPDFBitmapMap.find(key)) {
+        return *pdfimagePtr;
+    }
+    SkASSERT(image);
+    SkPDFIndirectReference pdfimage = serialize_shared_image(image.image().get(), doc);
+    SkASSERT((key != SkBitmapKey{{0, 0, 0, 0}, 0}));
+    doc->fPDFBitmapMap.set(key, pdfimage);
+    return pdfimage;
+}
+
 static bool is_integer(SkScalar x) {
     return x == SkScalarTruncToScalar(x);
 }
@@ -1564,9 +1617,9 @@ void SkPDFDevice::internalDrawImageRect(SkKeyedImage imageSubset,
         if (!content) {
             return;
         }
-        this->setGraphicState(SkPDFGraphicState::GetSMaskGraphicState(
+        this->setSMaskGraphicState(
                 maskDevice->makeFormXObjectFromDevice(maskDeviceBounds, true), false,
-                SkPDFGraphicState::kLuminosity_SMaskMode, fDocument), content.stream());
+                SkPDFGraphicState::kLuminosity_SMaskMode, content.stream());
         SkPDFUtils::AppendRectangle(SkRect::Make(this->size()), content.stream());
         SkPDFUtils::PaintPath(SkPaint::kFill_Style, SkPath::kWinding_FillType, content.stream());
         this->clearMaskOnGraphicState(content.stream());
@@ -1689,16 +1742,11 @@ void SkPDFDevice::internalDrawImageRect(SkKeyedImage imageSubset,
         // (maybe in the resource cache?)
     }
 
-    SkBitmapKey key = imageSubset.key();
-    SkPDFIndirectReference* pdfimagePtr = fDocument->fPDFBitmapMap.find(key);
-    SkPDFIndirectReference pdfimage = pdfimagePtr ? *pdfimagePtr : SkPDFIndirectReference();
-    if (!pdfimagePtr) {
-        SkASSERT(imageSubset);
-        pdfimage = SkPDFSerializeImage(imageSubset.image().get(), fDocument,
-                                       fDocument->metadata().fEncodingQuality);
-        SkASSERT((key != SkBitmapKey{{0, 0, 0, 0}, 0}));
-        fDocument->fPDFBitmapMap.set(key, pdfimage);
+    if (fPage) {
+        this->drawFormXObject(fPage->image(std::move(imageSubset)), content.stream());
+        return;
     }
+    SkPDFIndirectReference pdfimage = get_image_resource(fDocument, imageSubset);
     SkASSERT(pdfimage != SkPDFIndirectReference());
     this->drawFormXObject(pdfimage, content.stream());
 }
@@ -1764,3 +1812,106 @@ SkImageFilterCache* SkPDFDevice::getImageFilterCache() {
     // filter traversal.
     return SkImageFilterCache::Create(SkImageFilterCache::kDefaultTransientSize);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkPDFResource SkPDFConcurrentPage::graphicStateForPaint(const SkPaint& paint) {
+    SkPDFDocument* doc = fDocument;
+    auto make = [doc, paint]() { return SkPDFGraphicState::GetGraphicStateForPaint(doc, paint); };
+    if (SkPaint::kFill_Style == paint.getStyle()) {
+        SkPDFFillGraphicState key = SkPDFGraphicState::FillKey(paint);
+        if (sk_sp<SkPDFDeferredObject>* found = fFillGraphicStates.find(key)) {
+            return *found;
+        }
+        return *fFillGraphicStates.set(key, SkPDFDefer(make));
+    }
+    SkPDFStrokeGraphicState key = SkPDFGraphicState::StrokeKey(paint);
+    if (sk_sp<SkPDFDeferredObject>* found = fStrokeGraphicStates.find(key)) {
+        return *found;
+    }
+    return *fStrokeGraphicStates.set(key, SkPDFDefer(make));
+}
+
+SkPDFResource SkPDFConcurrentPage::sMaskGraphicState(SkPDFResource sMask,
+                                                     bool invert,
+                                                     SkPDFGraphicState::SkPDFSMaskMode sMaskMode) {
+    SkPDFDocument* doc = fDocument;
+    return SkPDFDefer([doc, sMask, invert, sMaskMode]() {
+        return SkPDFGraphicState::GetSMaskGraphicState(sMask.resolve(), invert, sMaskMode, doc);
+    });
+}
+
+SkPDFResource SkPDFConcurrentPage::noSMaskGraphicState() {
+    if (!fNoSMaskGraphicState) {
+        SkPDFDocument* doc = fDocument;
+        fNoSMaskGraphicState = SkPDFDefer([doc]() { return get_no_smask_graphic_state(doc); });
+    }
+    return fNoSMaskGraphicState;
+}
+
+SkPDFResource SkPDFConcurrentPage::shader(sk_sp<SkShader> shader,
+                                          const SkMatrix& canvasTransform,
+                                          const SkIRect& surfaceBBox,
+                                          SkColor paintColor) {
+    if (SkShader::kNone_GradientType == shader->asAGradient(nullptr) && surfaceBBox.isEmpty()) {
+        return SkPDFResource();  // SkPDFMakeShader() would not make a pattern.
+    }
+    SkPDFDocument* doc = fDocument;
+    return SkPDFDefer([doc, shader, canvasTransform, surfaceBBox, paintColor]() {
+        return SkPDFMakeShader(doc, shader.get(), canvasTransform, surfaceBBox, paintColor);
+    });
+}
+
+SkPDFResource SkPDFConcurrentPage::image(SkKeyedImage image) {
+    SkBitmapKey key = image.key();
+    if (sk_sp<SkPDFDeferredObject>* found = fImages.find(key)) {
+        return *found;
+    }
+    SkPDFDocument* doc = fDocument;
+    return *fImages.set(key, SkPDFDefer([doc, image]() { return get_image_resource(doc, image); }));
+}
+
+SkPDFResource SkPDFConcurrentPage::formXObject(std::unique_ptr<SkStreamAsset> content,
+                                               const SkIRect& bounds,
+                                               SkPDFResourceList resources,
+                                               const SkMatrix& inverseTransform,
+                                               const char* colorSpace) {
+    SkPDFDocument* doc = fDocument;
+    return SkPDFDefer([doc, content = std::move(content), bounds,
+                       resources = std::move(resources), inverseTransform, colorSpace]() mutable {
+        return SkPDFMakeFormXObject(doc, std::move(content),
+                                    SkPDFMakeArray(bounds.left(), bounds.top(),
+                                                   bounds.right(), bounds.bottom()),
+                                    resources.makeResourceDict(), inverseTransform, colorSpace);
+    });
+}
+
+SkPDFFont* SkPDFConcurrentPage::font(SkStrike* cache,
+                                     SkTypeface* typeface,
+                                     SkGlyphID glyphID,
+                                     SkPDFResource* resource) {
+    uint64_t fontID;
+    SkPDFFont* font =
+            SkPDFFont::GetPageFont(&fFonts, fDocument, cache, typeface, glyphID, &fontID);
+    sk_sp<SkPDFDeferredObject>* deferred = fFontResources.find(fontID);
+    if (!deferred) {
+        SkPDFDocument* doc = fDocument;
+        SkTHashMap<uint64_t, SkPDFFont>* fonts = &fFonts;
+        // By the time the page is finalized, its font has all of the page's glyphs.
+        deferred = fFontResources.set(fontID, SkPDFDefer([doc, fonts, fontID]() {
+            const SkPDFFont* pageFont = fonts->find(fontID);
+            SkASSERT(pageFont);
+            return SkPDFFont::GetFontResource(doc, fontID, *pageFont)->indirectReference();
+        }));
+    }
+    *resource = *deferred;
+    return font;
+}
+
+int SkPDFConcurrentPage::markIdForNodeId(int nodeId) {
+    if (!fDocument->hasMarkForNodeId(nodeId)) {
+        return -1;
+    }
+    fMarkedNodeIds.push_back(nodeId);
+    return SkToInt(fMarkedNodeIds.size()) - 1;
+}
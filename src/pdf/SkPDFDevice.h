@@ -21,6 +21,8 @@
 #include "src/core/SkTextBlobPriv.h"
 #include "src/pdf/SkKeyedImage.h"
 #include "src/pdf/SkPDFGraphicStackState.h"
+#include "src/pdf/SkPDFGraphicState.h"
+#include "src/pdf/SkPDFResourceDict.h"
 #include "src/pdf/SkPDFTypes.h"
 
 #include <vector>
@@ -28,6 +30,7 @@
 class SkGlyphRunList;
 class SkKeyedImage;
 class SkPDFArray;
+class SkPDFConcurrentPage;
 class SkPDFDevice;
 class SkPDFDict;
 class SkPDFDocument;
@@ -54,12 +57,15 @@ public:
      *         for early serializing of large immutable objects, such
      *         as images (via SkPDFDocument::serialize()).
      *  @param initialTransform Transform to be applied to the entire page.
+     *  @param page  Non-null if the page is drawn concurrently; its resources
+     *         are deferred until the page is finalized.
      */
     SkPDFDevice(SkISize pageSize, SkPDFDocument* document,
-                const SkMatrix& initialTransform = SkMatrix::I());
+                const SkMatrix& initialTransform = SkMatrix::I(),
+                SkPDFConcurrentPage* page = nullptr);
 
     sk_sp<SkPDFDevice> makeCongruentDevice() {
-        return sk_make_sp<SkPDFDevice>(this->size(), fDocument);
+        return sk_make_sp<SkPDFDevice>(this->size(), fDocument, SkMatrix::I(), fPage);
     }
 
     ~SkPDFDevice() override;
@@ -128,10 +134,7 @@ private:
 
     SkMatrix fInitialTransform;
 
-    SkTHashSet<SkPDFIndirectReference> fGraphicStateResources;
-    SkTHashSet<SkPDFIndirectReference> fXObjectResources;
-    SkTHashSet<SkPDFIndirectReference> fShaderResources;
-    SkTHashSet<SkPDFIndirectReference> fFontResources;
+    SkPDFResourceList fResources;
     int fNodeId;
 
     SkDynamicMemoryWStream fContent;
@@ -139,17 +142,18 @@ private:
     bool fNeedsExtraSave = false;
     SkPDFGraphicStackState fActiveStackState;
     SkPDFDocument* fDocument;
+    SkPDFConcurrentPage* fPage;
 
     ////////////////////////////////////////////////////////////////////////////
 
     SkBaseDevice* onCreateDevice(const CreateInfo&, const SkPaint*) override;
 
     // Set alpha to true if making a transparency group form x-objects.
-    SkPDFIndirectReference makeFormXObjectFromDevice(bool alpha = false);
-    SkPDFIndirectReference makeFormXObjectFromDevice(SkIRect bbox, bool alpha = false);
+    SkPDFResource makeFormXObjectFromDevice(bool alpha = false);
+    SkPDFResource makeFormXObjectFromDevice(SkIRect bbox, bool alpha = false);
 
-    void drawFormXObjectWithMask(SkPDFIndirectReference xObject,
-                                 SkPDFIndirectReference sMask,
+    void drawFormXObjectWithMask(const SkPDFResource& xObject,
+                                 const SkPDFResource& sMask,
                                  SkBlendMode,
                                  bool invertClip);
 
@@ -161,8 +165,8 @@ private:
                                               const SkMatrix& matrix,
                                               const SkPaint& paint,
                                               SkScalar,
-                                              SkPDFIndirectReference* dst);
-    void finishContentEntry(const SkClipStack*, SkBlendMode, SkPDFIndirectReference, SkPath*);
+                                              SkPDFResource* dst);
+    void finishContentEntry(const SkClipStack*, SkBlendMode, const SkPDFResource&, SkPath*);
     bool isContentEmpty();
 
     void internalDrawGlyphRun(const SkGlyphRun& glyphRun, SkPoint offset, const SkPaint& runPaint);
@@ -188,8 +192,10 @@ private:
     bool handleInversePath(const SkPath& origPath, const SkPaint& paint, bool pathIsMutable);
 
     void clearMaskOnGraphicState(SkDynamicMemoryWStream*);
-    void setGraphicState(SkPDFIndirectReference gs, SkDynamicMemoryWStream*);
-    void drawFormXObject(SkPDFIndirectReference xObject, SkDynamicMemoryWStream*);
+    void setGraphicState(const SkPDFResource& gs, SkDynamicMemoryWStream*);
+    void setSMaskGraphicState(const SkPDFResource& sMask, bool invert,
+                              SkPDFGraphicState::SkPDFSMaskMode, SkDynamicMemoryWStream*);
+    void drawFormXObject(const SkPDFResource& xObject, SkDynamicMemoryWStream*);
 
     bool hasEmptyClip() const { return this->cs().isEmpty(this->bounds()); }
 
@@ -198,4 +204,50 @@ private:
     typedef SkClipStackDevice INHERITED;
 };
 
+/**
+ *  What a page drawn concurrently (see SkPDF::Metadata::fConcurrentPages)
+ *  keeps instead of touching the document while it is drawn.  The objects its
+ *  content streams name are deferred, and made when SkPDFDocument finalizes
+ *  the page, in page order, so that object numbers do not depend on which page
+ *  finished drawing first.  The page device and its layers share one of these,
+ *  and are all drawn on one thread.
+ */
+class SkPDFConcurrentPage {
+public:
+    explicit SkPDFConcurrentPage(SkPDFDocument* doc) : fDocument(doc) {}
+
+    SkPDFResource graphicStateForPaint(const SkPaint&);
+    SkPDFResource sMaskGraphicState(SkPDFResource sMask, bool invert,
+                                    SkPDFGraphicState::SkPDFSMaskMode);
+    SkPDFResource noSMaskGraphicState();
+    SkPDFResource shader(sk_sp<SkShader>, const SkMatrix&, const SkIRect& bounds, SkColor);
+    SkPDFResource image(SkKeyedImage);
+    SkPDFResource formXObject(std::unique_ptr<SkStreamAsset> content,
+                              const SkIRect& bounds,
+                              SkPDFResourceList resources,
+                              const SkMatrix& inverseTransform,
+                              const char* colorSpace);
+    /** The page's own font for glyphID; see SkPDFFont::GetPageFont(). */
+    SkPDFFont* font(SkStrike*, SkTypeface*, SkGlyphID, SkPDFResource* resource);
+    // Returns -1 if no mark ID.
+    int markIdForNodeId(int nodeId);
+
+    const SkMatrix& transform() const { return fDevice->initialTransform(); }
+
+    sk_sp<SkPDFDevice> fDevice;
+    std::vector<std::pair<sk_sp<SkData>, SkRect>> fLinkToURLs;
+    std::vector<std::pair<sk_sp<SkData>, SkRect>> fLinkToDestinations;
+    std::vector<std::pair<sk_sp<SkData>, SkPoint>> fNamedDestinations;
+    std::vector<int> fMarkedNodeIds;  // by mark ID
+
+private:
+    SkPDFDocument* fDocument;
+    SkTHashMap<SkPDFFillGraphicState, sk_sp<SkPDFDeferredObject>> fFillGraphicStates;
+    SkTHashMap<SkPDFStrokeGraphicState, sk_sp<SkPDFDeferredObject>> fStrokeGraphicStates;
+    sk_sp<SkPDFDeferredObject> fNoSMaskGraphicState;
+    SkTHashMap<SkBitmapKey, sk_sp<SkPDFDeferredObject>> fImages;
+    SkTHashMap<uint64_t, SkPDFFont> fFonts;
+    SkTHashMap<uint64_t, sk_sp<SkPDFDeferredObject>> fFontResources;
+};
+
 #endif
@@ -8,15 +8,19 @@
 #include "include/docs/SkPDFDocument.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkMakeUnique.h"
+#include "src/pdf/SkDeflate.h"
+#include "src/pdf/SkPDFBitmap.h"
 #include "src/pdf/SkPDFDevice.h"
 #include "src/pdf/SkPDFFont.h"
 #include "src/pdf/SkPDFGradientShader.h"
 #include "src/pdf/SkPDFGraphicState.h"
 #include "src/pdf/SkPDFShader.h"
+#include "src/pdf/SkPDFSubsetFontCache.h"
 #include "src/pdf/SkPDFTag.h"
 #include "src/pdf/SkPDFUtils.h"
 
@@ -36,17 +40,29 @@ static size_t difference(size_t minuend, size_t subtrahend) {
     return SkASSERT(minuend >= subtrahend), minuend - subtrahend;
 }
 
-void SkPDFOffsetMap::markStartOfObject(int referenceNumber, const SkWStream* s) {
+SkPDFOffsetMap::Entry* SkPDFOffsetMap::entry(int referenceNumber) {
     SkASSERT(referenceNumber > 0);
     size_t index = SkToSizeT(referenceNumber - 1);
-    if (index >= fOffsets.size()) {
-        fOffsets.resize(index + 1);
+    if (index >= fEntries.size()) {
+        fEntries.resize(index + 1);
     }
-    fOffsets[index] = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    return &fEntries[index];
+}
+
+void SkPDFOffsetMap::markStartOfObject(int referenceNumber, const SkWStream* s) {
+    this->entry(referenceNumber)->fOffset = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+}
+
+void SkPDFOffsetMap::markObjectInObjectStream(int referenceNumber,
+                                              int objectStreamNumber,
+                                              int index) {
+    Entry* entry = this->entry(referenceNumber);
+    entry->fObjectStreamNumber = objectStreamNumber;
+    entry->fIndex = index;
 }
 
 int SkPDFOffsetMap::objectCount() const {
-    return SkToInt(fOffsets.size() + 1); // Include the special zeroth object in the count.
+    return SkToInt(fEntries.size() + 1); // Include the special zeroth object in the count.
 }
 
 int SkPDFOffsetMap::emitCrossReferenceTable(SkWStream* s) const {
@@ -54,13 +70,59 @@ int SkPDFOffsetMap::emitCrossReferenceTable(SkWStream* s) const {
     s->writeText("xref\n0 ");
     s->writeDecAsText(this->objectCount());
     s->writeText("\n0000000000 65535 f \n");
-    for (int offset : fOffsets) {
-        SkASSERT(offset > 0);  // Offset was set.
-        s->writeBigDecAsText(offset, 10);
+    for (const Entry& entry : fEntries) {
+        SkASSERT(entry.fOffset > 0);  // Offset was set.
+        SkASSERT(entry.fObjectStreamNumber == 0);  // Can't list packed objects in a table.
+        s->writeBigDecAsText(entry.fOffset, 10);
         s->writeText(" 00000 n \n");
     }
     return xRefFileOffset;
 }
+
+static void write_big_endian(SkWStream* s, uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        s->write8((value >> (8 * i)) & 0xFF);
+    }
+}
+
+int SkPDFOffsetMap::emitCrossReferenceStream(SkWStream* s,
+                                             int referenceNumber,
+                                             SkPDFDict* trailer) {
+    SkASSERT(SkToSizeT(referenceNumber) == fEntries.size() + 1);
+    int xRefFileOffset = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    this->markStartOfObject(referenceNumber, s);
+
+    // Each entry is a type (0: free, 1: at an offset, 2: in an object stream), then an offset
+    // or object stream number, then a generation number or index in the object stream.
+    static constexpr int kFieldWidths[] = {1, 4, 2};
+    SkDynamicMemoryWStream entries;
+    {
+        SkDeflateWStream deflate(&entries);
+        write_big_endian(&deflate, 0, kFieldWidths[0]);
+        write_big_endian(&deflate, 0, kFieldWidths[1]);
+        write_big_endian(&deflate, 0xFFFF, kFieldWidths[2]);
+        for (const Entry& entry : fEntries) {
+            bool packed = entry.fObjectStreamNumber != 0;
+            SkASSERT(packed || entry.fOffset > 0);
+            write_big_endian(&deflate, packed ? 2 : 1, kFieldWidths[0]);
+            write_big_endian(&deflate, packed ? entry.fObjectStreamNumber : entry.fOffset,
+                             kFieldWidths[1]);
+            write_big_endian(&deflate, packed ? entry.fIndex : 0, kFieldWidths[2]);
+        }
+    }
+    trailer->insertInt("Size", this->objectCount());
+    trailer->insertObject("W", SkPDFMakeArray(kFieldWidths[0], kFieldWidths[1], kFieldWidths[2]));
+    trailer->insertName("Filter", "FlateDecode");
+    trailer->insertInt("Length", SkToInt(entries.bytesWritten()));
+
+    s->writeDecAsText(referenceNumber);
+    s->writeText(" 0 obj\n");
+    trailer->emitObject(s);
+    s->writeText(" stream\n");
+    entries.writeToAndReset(s);
+    s->writeText("\nendstream\nendobj\n");
+    return xRefFileOffset;
+}
 //
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -71,9 +133,11 @@ static_assert((SKPDF_MAGIC[1] & 0x7F) == "Skia"[1], "");
 static_assert((SKPDF_MAGIC[2] & 0x7F) == "Skia"[2], "");
 static_assert((SKPDF_MAGIC[3] & 0x7F) == "Skia"[3], "");
 #endif
-static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream) {
+static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream, bool objectStreams) {
     offsetMap->markStartOfDocument(wStream);
-    wStream->writeText("%PDF-1.4\n%" SKPDF_MAGIC "\n");
+    // Object streams and cross-reference streams are new in PDF 1.5.
+    wStream->writeText(objectStreams ? "%PDF-1.5\n%" SKPDF_MAGIC "\n"
+                                     : "%PDF-1.4\n%" SKPDF_MAGIC "\n");
     // The PDF spec recommends including a comment with four
     // bytes, all with their high bits set.  "\xD3\xEB\xE9\xE1" is
     // "Skia" with the high bits set.
@@ -90,6 +154,19 @@ static void begin_indirect_object(SkPDFOffsetMap* offsetMap,
 
 static void end_indirect_object(SkWStream* s) { s->writeText("\nendobj\n"); }
 
+static void populate_trailer(SkPDFDict* trailerDict,
+                             SkPDFIndirectReference infoDict,
+                             SkPDFIndirectReference docCatalog,
+                             SkUUID uuid) {
+    SkASSERT(docCatalog != SkPDFIndirectReference());
+    trailerDict->insertRef("Root", docCatalog);
+    SkASSERT(infoDict != SkPDFIndirectReference());
+    trailerDict->insertRef("Info", infoDict);
+    if (SkUUID() != uuid) {
+        trailerDict->insertObject("ID", SkPDFMetadata::MakePdfId(uuid, uuid));
+    }
+}
+
 // Xref table and footer
 static void serialize_footer(const SkPDFOffsetMap& offsetMap,
                              SkWStream* wStream,
@@ -99,13 +176,7 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     int xRefFileOffset = offsetMap.emitCrossReferenceTable(wStream);
     SkPDFDict trailerDict;
     trailerDict.insertInt("Size", offsetMap.objectCount());
-    SkASSERT(docCatalog != SkPDFIndirectReference());
-    trailerDict.insertRef("Root", docCatalog);
-    SkASSERT(infoDict != SkPDFIndirectReference());
-    trailerDict.insertRef("Info", infoDict);
-    if (SkUUID() != uuid) {
-        trailerDict.insertObject("ID", SkPDFMetadata::MakePdfId(uuid, uuid));
-    }
+    populate_trailer(&trailerDict, infoDict, docCatalog, uuid);
     wStream->writeText("trailer\n");
     trailerDict.emitObject(wStream);
     wStream->writeText("\nstartxref\n");
@@ -113,13 +184,30 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF");
 }
 
+// Xref stream, which doubles as the trailer, and footer
+static void serialize_footer_with_xref_stream(SkPDFOffsetMap* offsetMap,
+                                              SkWStream* wStream,
+                                              SkPDFIndirectReference xRef,
+                                              SkPDFIndirectReference infoDict,
+                                              SkPDFIndirectReference docCatalog,
+                                              SkUUID uuid) {
+    SkPDFDict trailerDict("XRef");
+    populate_trailer(&trailerDict, infoDict, docCatalog, uuid);
+    int xRefFileOffset = offsetMap->emitCrossReferenceStream(wStream, xRef.fValue, &trailerDict);
+    wStream->writeText("startxref\n");
+    wStream->writeBigDecAsText(xRefFileOffset);
+    wStream->writeText("\n%%EOF");
+}
+
+// PDF wants a tree describing all the pages in the document.  We arbitrary
+// choose 8 as the number of allowed children of each node.
+static constexpr size_t kMaxPageTreeNodeSize = 8;
+
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
         const std::vector<SkPDFIndirectReference>& pageRefs) {
-    // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
-    // nodes have type "Pages" with an array of children, a parent pointer, and
+    // The internal nodes have type "Pages" with an array of children, a parent pointer, and
     // the number of leaves below the node as "Count."  The leaves are passed
     // into the method, have type "Page" and need a parent pointer. This method
     // builds the tree bottom up, skipping internal nodes that would have only
@@ -132,10 +220,9 @@ static SkPDFIndirectReference generate_page_tree(
 
         static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
             std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
             const size_t n = vec.size();
             SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
+            const size_t result_len = (n - 1) / kMaxPageTreeNodeSize + 1;
             SkASSERT(result_len >= 1);
             SkASSERT(n == 1 || result_len < n);
             result.reserve(result_len);
@@ -148,7 +235,7 @@ static SkPDFIndirectReference generate_page_tree(
                 SkPDFIndirectReference parent = doc->reserveRef();
                 auto kids_list = SkPDFMakeArray();
                 int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
+                for (size_t j = 0; j < kMaxPageTreeNodeSize && index < n; ++j) {
                     PageTreeNode& node = vec[index++];
                     node.fNode->insertRef("Parent", parent);
                     kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
@@ -198,6 +285,8 @@ SkPDFDocument::SkPDFDocument(SkWStream* stream,
         fTagTree.init(fMetadata.fStructureElementTreeRoot);
     }
     fExecutor = metadata.fExecutor;
+    fConcurrentPages = fExecutor && fMetadata.fConcurrentPages;
+    fSubsetFontCache = SkPDFSubsetFontCache::Global();
 }
 
 SkPDFDocument::~SkPDFDocument() {
@@ -206,32 +295,109 @@ SkPDFDocument::~SkPDFDocument() {
 }
 
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
-    object.emitObject(this->beginObject(ref));
-    this->endObject();
+    if (fMetadata.fObjectStreams) {
+        fObjectStreamObjects.emplace_back(ref, SkToInt(fObjectStreamContent.bytesWritten()));
+        object.emitObject(&fObjectStreamContent);
+        fObjectStreamContent.writeText("\n");
+        // Readers must decompress a whole object stream to find one object in it.
+        static constexpr size_t kMaxObjectsPerStream = 100;
+        if (fObjectStreamObjects.size() == kMaxObjectsPerStream) {
+            this->writeObjectStream();
+        }
+        return ref;
+    }
+    SkWStream* stream = this->beginObject(ref);
+    object.emitObject(stream);
+    this->endObject(ref, stream);
     return ref;
 }
 
+void SkPDFDocument::writeObjectStream() {
+    if (fObjectStreamObjects.empty()) {
+        return;
+    }
+    // An object stream starts with the number and offset of each object in it.
+    SkDynamicMemoryWStream content;
+    for (const auto& object : fObjectStreamObjects) {
+        content.writeDecAsText(object.first.fValue);
+        content.writeText(" ");
+        content.writeDecAsText(object.second);
+        content.writeText("\n");
+    }
+    auto dict = SkPDFMakeDict("ObjStm");
+    dict->insertInt("N", SkToInt(fObjectStreamObjects.size()));
+    dict->insertInt("First", SkToInt(content.bytesWritten()));
+    fObjectStreamContent.writeToAndReset(&content);
+    SkPDFIndirectReference objectStream =
+            SkPDFStreamOut(std::move(dict), content.detachAsStream(), this);
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        for (size_t i = 0; i < fObjectStreamObjects.size(); ++i) {
+            fOffsetMap.markObjectInObjectStream(fObjectStreamObjects[i].first.fValue,
+                                                objectStream.fValue, SkToInt(i));
+        }
+    }
+    fObjectStreamObjects.clear();
+}
+
 SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) {
     fMutex.acquire();
+    if (this->emitsInOrder()) {
+        // Objects emitted without a reserved slot are emitted in order on the drawing thread.
+        if (!fEmitSlots.find(ref.fValue)) {
+            fEmitSlots.set(ref.fValue, fNextEmitSlot++);
+        }
+        fMutex.release();
+        return new SkDynamicMemoryWStream;
+    }
     begin_indirect_object(&fOffsetMap, ref, this->getStream());
     return this->getStream();
 };
 
-void SkPDFDocument::endObject() {
+void SkPDFDocument::endObject(SkPDFIndirectReference ref, SkWStream* stream) {
+    if (this->emitsInOrder()) {
+        sk_sp<SkData> data = static_cast<SkDynamicMemoryWStream*>(stream)->detachAsData();
+        delete stream;
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        int* slot = fEmitSlots.find(ref.fValue);
+        SkASSERT(slot);
+        fPendingObjects.set(*slot, PendingObject{ref, std::move(data)});
+        fEmitSlots.remove(ref.fValue);
+        this->writePendingObjects();
+        return;
+    }
     end_indirect_object(this->getStream());
     fMutex.release();
 };
 
+void SkPDFDocument::reserveEmitSlot(SkPDFIndirectReference ref) {
+    if (this->emitsInOrder()) {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        fEmitSlots.set(ref.fValue, fNextEmitSlot++);
+    }
+}
+
+// Write out the pending objects whose turn has come.  Called with fMutex held.
+void SkPDFDocument::writePendingObjects() {
+    SkWStream* stream = this->getStream();
+    while (const PendingObject* object = fPendingObjects.find(fNextSlotToWrite)) {
+        begin_indirect_object(&fOffsetMap, object->fRef, stream);
+        stream->write(object->fData->data(), object->fData->size());
+        end_indirect_object(stream);
+        fPendingObjects.remove(fNextSlotToWrite++);
+    }
+}
+
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (!fInfoDict) {
         // if this is the first page if the document.
         {
             SkAutoMutexAcquire autoMutexAcquire(fMutex);
-            serializeHeader(&fOffsetMap, this->getStream());
+            serializeHeader(&fOffsetMap, this->getStream(), fMetadata.fObjectStreams);
 
         }
 
@@ -246,6 +412,19 @@ SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
             fXMP = SkPDFMetadata::MakeXMPObject(fMetadata, fUUID, fUUID, this);
         }
     }
+    if (fConcurrentPages) {
+        // The page is drawn into its SkPDFDevice later, on the executor.
+        fRecordingPageSize = SkSize::Make(width, height);
+        return fPageRecorder.beginRecording(width, height);
+    }
+    this->beginPageDevice(width, height);
+    reset_object(&fCanvas, fPageDevice);
+    fCanvas.scale(fRasterScale, fRasterScale);
+    return &fCanvas;
+}
+
+sk_sp<SkPDFDevice> SkPDFDocument::makePageDevice(SkScalar width, SkScalar height,
+                                                 SkPDFConcurrentPage* page) {
     // By scaling the page at the device level, we will create bitmap layer
     // devices at the rasterized scale, not the 72dpi scale.  Bitmap layer
     // devices are created when saveLayer is called with an ImageFilter;  see
@@ -256,11 +435,12 @@ SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     // bottom left. This matrix corrects for that, as well as the raster scale.
     initialTransform.setScaleTranslate(fInverseRasterScale, -fInverseRasterScale,
                                        0, fInverseRasterScale * pageSize.height());
-    fPageDevice = sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform);
-    reset_object(&fCanvas, fPageDevice);
-    fCanvas.scale(fRasterScale, fRasterScale);
+    return sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform, page);
+}
+
+void SkPDFDocument::beginPageDevice(SkScalar width, SkScalar height) {
+    fPageDevice = this->makePageDevice(width, height, nullptr);
     fPageRefs.push_back(this->reserveRef());
-    return &fCanvas;
 }
 
 static void populate_link_annotation(SkPDFDict* annotation, const SkRect& r) {
@@ -326,8 +506,79 @@ static SkPDFIndirectReference append_destinations(
 }
 
 void SkPDFDocument::onEndPage() {
+    if (fConcurrentPages) {
+        sk_sp<SkPicture> picture = fPageRecorder.finishRecordingAsPicture();
+        SkSize size = fRecordingPageSize;
+        size_t pageIndex = fRecordedPageCount++;
+        this->incrementJobCount();
+        fExecutor->add([this, picture, size, pageIndex]() {
+            this->drawConcurrentPage(picture, size, pageIndex);
+            this->signalJobComplete();
+        });
+        return;
+    }
     SkASSERT(!fCanvas.imageInfo().dimensions().isZero());
     reset_object(&fCanvas);
+    this->endPageDevice();
+}
+
+// Pages are drawn in parallel, but name their resources with handles of their own, so nothing
+// that would take an object number happens until a page is finalized, in page order.
+void SkPDFDocument::drawConcurrentPage(sk_sp<SkPicture> picture, SkSize size, size_t pageIndex) {
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fDrawnPagesMutex);
+        if (fAbortingPages) {
+            return;
+        }
+    }
+    auto page = skstd::make_unique<SkPDFConcurrentPage>(this);
+    page->fDevice = this->makePageDevice(size.width(), size.height(), page.get());
+    {
+        SkCanvas canvas(page->fDevice);
+        canvas.scale(fRasterScale, fRasterScale);
+        picture->playback(&canvas);
+    }
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fDrawnPagesMutex);
+        fDrawnPages.set(pageIndex, std::move(page));
+        if (fFinalizingPages) {
+            return;
+        }
+        fFinalizingPages = true;
+    }
+    while (true) {
+        std::unique_ptr<SkPDFConcurrentPage> next;
+        {
+            SkAutoMutexAcquire autoMutexAcquire(fDrawnPagesMutex);
+            std::unique_ptr<SkPDFConcurrentPage>* found = fDrawnPages.find(fNextPageToFinalize);
+            if (!found || fAbortingPages) {
+                fFinalizingPages = false;
+                return;
+            }
+            next = std::move(*found);
+            fDrawnPages.remove(fNextPageToFinalize++);
+        }
+        this->finalizeConcurrentPage(std::move(next));
+    }
+}
+
+void SkPDFDocument::finalizeConcurrentPage(std::unique_ptr<SkPDFConcurrentPage> page) {
+    fPageRefs.push_back(this->reserveRef());
+    for (auto& dest : page->fNamedDestinations) {
+        fNamedDestinations.push_back(
+                SkPDFNamedDestination{std::move(dest.first), dest.second, this->currentPage()});
+    }
+    fCurrentPageLinkToURLs = std::move(page->fLinkToURLs);
+    fCurrentPageLinkToDestinations = std::move(page->fLinkToDestinations);
+    for (size_t markId = 0; markId < page->fMarkedNodeIds.size(); ++markId) {
+        SkAssertResult(this->getMarkIdForNodeId(page->fMarkedNodeIds[markId]) == SkToInt(markId));
+    }
+    // Making the resource dictionary makes the page's deferred resources.
+    fPageDevice = std::move(page->fDevice);
+    this->endPageDevice();
+}
+
+void SkPDFDocument::endPageDevice() {
     SkASSERT(fPageDevice);
 
     auto page = SkPDFMakeDict("Page");
@@ -352,11 +603,89 @@ void SkPDFDocument::onEndPage() {
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
+    if (fMetadata.fStreamingChunkSize > 0) {
+        SkPDFIndirectReference pageRef = fPageRefs[fEndedPageCount];
+        page->insertRef("Parent", this->openPageTreeNode(0));
+        this->emit(*page, pageRef);
+        this->addToPageTree(0, pageRef, 1);
+        if (++fEndedPageCount % fMetadata.fStreamingChunkSize == 0) {
+            this->finishChunk();
+        }
+        return;
+    }
     fPages.emplace_back(std::move(page));
+    ++fEndedPageCount;
+}
+
+static std::unique_ptr<SkPDFDict> make_page_tree_node(
+        const std::vector<SkPDFIndirectReference>& kids, int pageCount,
+        SkPDFIndirectReference parent) {
+    auto kidsList = SkPDFMakeArray();
+    for (SkPDFIndirectReference kid : kids) {
+        kidsList->appendRef(kid);
+    }
+    auto node = SkPDFMakeDict("Pages");
+    node->insertInt("Count", pageCount);
+    node->insertObject("Kids", std::move(kidsList));
+    if (parent != SkPDFIndirectReference()) {
+        node->insertRef("Parent", parent);
+    }
+    return node;
+}
+
+SkPDFIndirectReference SkPDFDocument::openPageTreeNode(size_t level) {
+    SkASSERT(level <= fOpenPageTreeNodes.size());
+    if (level == fOpenPageTreeNodes.size()) {
+        fOpenPageTreeNodes.emplace_back();
+    }
+    PageTreeNode& node = fOpenPageTreeNodes[level];
+    if (node.fRef == SkPDFIndirectReference()) {
+        node.fRef = this->reserveRef();
+    }
+    return node.fRef;
+}
+
+void SkPDFDocument::addToPageTree(size_t level, SkPDFIndirectReference kid, int pageCount) {
+    SkASSERT(level < fOpenPageTreeNodes.size());
+    fOpenPageTreeNodes[level].fKids.push_back(kid);
+    fOpenPageTreeNodes[level].fPageCount += pageCount;
+    if (fOpenPageTreeNodes[level].fKids.size() < kMaxPageTreeNodeSize) {
+        return;
+    }
+    SkPDFIndirectReference parent = this->openPageTreeNode(level + 1);
+    PageTreeNode node = std::move(fOpenPageTreeNodes[level]);
+    fOpenPageTreeNodes[level] = PageTreeNode();
+    this->emit(*make_page_tree_node(node.fKids, node.fPageCount, parent), node.fRef);
+    this->addToPageTree(level + 1, node.fRef, node.fPageCount);
+}
+
+SkPDFIndirectReference SkPDFDocument::finishPageTree() {
+    // Write out the nodes that are not full, bottom up.  The topmost one is the root.
+    for (size_t level = 0; level < fOpenPageTreeNodes.size(); ++level) {
+        if (fOpenPageTreeNodes[level].fKids.empty()) {
+            continue;
+        }
+        PageTreeNode node = std::move(fOpenPageTreeNodes[level]);
+        fOpenPageTreeNodes[level] = PageTreeNode();
+        if (level + 1 == fOpenPageTreeNodes.size()) {
+            return this->emit(*make_page_tree_node(node.fKids, node.fPageCount,
+                                                   SkPDFIndirectReference()), node.fRef);
+        }
+        SkPDFIndirectReference parent = this->openPageTreeNode(level + 1);
+        this->emit(*make_page_tree_node(node.fKids, node.fPageCount, parent), node.fRef);
+        this->addToPageTree(level + 1, node.fRef, node.fPageCount);
+    }
+    SkASSERT(false);
+    return SkPDFIndirectReference();
 }
 
 void SkPDFDocument::onAbort() {
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fDrawnPagesMutex);
+        fAbortingPages = true;
+    }
     this->waitForJobs();
+    fDrawnPages.reset();
 }
 
 static sk_sp<SkData> SkSrgbIcm() {
@@ -518,9 +847,25 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
     return fonts;
 }
 
+void SkPDFDocument::finishChunk() {
+    for (const SkPDFFont* f : get_fonts(*this)) {
+        f->emitSubset(this);
+    }
+    // Later pages start over with new fonts, which get their own subsets.
+    fFontMap.reset();
+    fImageShaderMap.reset();
+    fGradientPatternMap.reset();
+    fStrokeGSMap.reset();
+    fFillGSMap.reset();
+}
+
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fConcurrentPages) {
+        // Finish drawing the recorded pages.
+        this->waitForJobs();
+    }
+    if (0 == fEndedPageCount) {
         this->waitForJobs();
         return;
     }
@@ -533,7 +878,11 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    if (fMetadata.fStreamingChunkSize > 0) {
+        docCatalog->insertRef("Pages", this->finishPageTree());
+    } else {
+        docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    }
 
     if (!fNamedDestinations.empty()) {
         docCatalog->insertRef("Dests", append_destinations(this, fNamedDestinations));
@@ -554,11 +903,18 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     for (const SkPDFFont* f : get_fonts(*this)) {
         f->emitSubset(this);
     }
+    this->writeObjectStream();
 
     this->waitForJobs();
     {
         SkAutoMutexAcquire autoMutexAcquire(fMutex);
-        serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
+        SkASSERT(fPendingObjects.count() == 0);
+        if (fMetadata.fObjectStreams) {
+            serialize_footer_with_xref_stream(&fOffsetMap, this->getStream(), this->reserveRef(),
+                                              fInfoDict, docCatalogRef, fUUID);
+        } else {
+            serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
+        }
     }
 }
 
@@ -8,6 +8,7 @@
 #define SkPDFDocumentPriv_DEFINED
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/SkMutex.h"
@@ -20,14 +21,21 @@
 #include <memory>
 
 class SkExecutor;
+class SkPDFConcurrentPage;
 class SkPDFDevice;
 class SkPDFFont;
 struct SkAdvancedTypefaceMetrics;
 struct SkBitmapKey;
 struct SkPDFFillGraphicState;
+struct SkPDFImageContentEntry;
+struct SkPDFImageContentKey;
 struct SkPDFImageShaderKey;
 struct SkPDFStrokeGraphicState;
 
+namespace SkPDFSubsetFontCache {
+class Cache;
+}
+
 namespace SkPDFGradientShader {
 struct Key;
 struct KeyHash;
@@ -40,11 +48,23 @@ class SkPDFOffsetMap {
 public:
     void markStartOfDocument(const SkWStream*);
     void markStartOfObject(int referenceNumber, const SkWStream*);
+    void markObjectInObjectStream(int referenceNumber, int objectStreamNumber, int index);
     int objectCount() const;
     int emitCrossReferenceTable(SkWStream* s) const;
+    // Writes the cross-reference stream as object referenceNumber, which must be the last
+    // object.  Returns the stream's offset.
+    int emitCrossReferenceStream(SkWStream* s, int referenceNumber, SkPDFDict* trailer);
 private:
-    std::vector<int> fOffsets;
+    // An object is either at an offset in the document, or packed into an object stream.
+    struct Entry {
+        int fOffset = 0;
+        int fObjectStreamNumber = 0;
+        int fIndex = 0;
+    };
+    std::vector<Entry> fEntries;
     size_t fBaseOffset = SIZE_MAX;
+
+    Entry* entry(int referenceNumber);
 };
 
 
@@ -85,7 +105,7 @@ public:
         stream->writeText(" stream\n");
         writeStream(stream);
         stream->writeText("\nendstream");
-        this->endObject();
+        this->endObject(ref, stream);
     }
 
     const SkPDF::Metadata& metadata() const { return fMetadata; }
@@ -96,13 +116,27 @@ public:
     }
     // Returns -1 if no mark ID.
     int getMarkIdForNodeId(int nodeId);
+    // True if getMarkIdForNodeId() would return a mark ID.  Safe to call while drawing.
+    bool hasMarkForNodeId(int nodeId) const { return fTagTree.hasNodeId(nodeId); }
 
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
+    // When objects are written in a fixed order (see SkPDF::Metadata::fConcurrentPages), an
+    // object that another thread will emit later takes its place in that order now.
+    void reserveEmitSlot(SkPDFIndirectReference);
+    // True if objects must be emitted on the thread that reserved their numbers, or have their
+    // place held with reserveEmitSlot().
+    bool emitsInOrder() const { return fConcurrentPages; }
+
     SkExecutor* executor() const { return fExecutor; }
+
+    // Subset fonts are shared through the process-wide cache unless this is set to another.
+    SkPDFSubsetFontCache::Cache* subsetFontCache() const { return fSubsetFontCache; }
+    void setSubsetFontCache(SkPDFSubsetFontCache::Cache* cache) { fSubsetFontCache = cache; }
+
     void incrementJobCount();
     void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+    size_t currentPageIndex() { return fEndedPageCount; }
     size_t pageCount() { return fPageRefs.size(); }
 
     const SkMatrix& currentPageTransform() const;
@@ -112,14 +146,17 @@ public:
     SkTHashMap<SkPDFGradientShader::Key, SkPDFIndirectReference, SkPDFGradientShader::KeyHash>
         fGradientPatternMap;
     SkTHashMap<SkBitmapKey, SkPDFIndirectReference> fPDFBitmapMap;
+    SkTHashMap<SkPDFImageContentKey, std::vector<SkPDFImageContentEntry>> fPDFImageContentMap;
     SkTHashMap<uint32_t, std::unique_ptr<SkAdvancedTypefaceMetrics>> fTypefaceMetrics;
     SkTHashMap<uint32_t, std::vector<SkString>> fType1GlyphNames;
-    SkTHashMap<uint32_t, std::vector<SkUnichar>> fToUnicodeMap;
+    SkTHashMap<uint32_t, std::unique_ptr<std::vector<SkUnichar>>> fToUnicodeMap;
     SkTHashMap<uint32_t, SkPDFIndirectReference> fFontDescriptors;
     SkTHashMap<uint32_t, SkPDFIndirectReference> fType3FontDescriptors;
     SkTHashMap<uint64_t, SkPDFFont> fFontMap;
     SkTHashMap<SkPDFStrokeGraphicState, SkPDFIndirectReference> fStrokeGSMap;
     SkTHashMap<SkPDFFillGraphicState, SkPDFIndirectReference> fFillGSMap;
+    // Guards fTypefaceMetrics and fToUnicodeMap, which pages drawn concurrently share.
+    SkMutex fFontInfoMutex;
     SkPDFIndirectReference fInvertFunction;
     SkPDFIndirectReference fNoSmaskGraphicState;
 
@@ -128,10 +165,18 @@ public:
     std::vector<SkPDFNamedDestination> fNamedDestinations;
 
 private:
+    struct PendingObject {
+        SkPDFIndirectReference fRef;
+        sk_sp<SkData> fData;
+    };
+
     SkPDFOffsetMap fOffsetMap;
     SkCanvas fCanvas;
+    SkPictureRecorder fPageRecorder;
+    SkSize fRecordingPageSize = {0, 0};
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    size_t fEndedPageCount = 0;
 
     sk_sp<SkPDFDevice> fPageDevice;
     std::atomic<int> fNextObjectNumber = {1};
@@ -143,6 +188,7 @@ private:
     SkScalar fRasterScale = 1;
     SkScalar fInverseRasterScale = 1;
     SkExecutor* fExecutor = nullptr;
+    SkPDFSubsetFontCache::Cache* fSubsetFontCache = nullptr;
 
     // For tagged PDFs.
     SkPDFTagTree fTagTree;
@@ -150,9 +196,54 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
+    // For SkPDF::Metadata::fConcurrentPages.  Each recorded page is drawn on the executor into
+    // its own device.  Drawn pages wait in fDrawnPages until every page before them has been
+    // finalized; whichever thread draws the next page to finalize finalizes it and any drawn
+    // pages after it.  Objects are written in order.
+    bool fConcurrentPages = false;
+    size_t fRecordedPageCount = 0;
+    SkMutex fDrawnPagesMutex;
+    SkTHashMap<size_t, std::unique_ptr<SkPDFConcurrentPage>> fDrawnPages;
+    size_t fNextPageToFinalize = 0;
+    bool fFinalizingPages = false;
+    bool fAbortingPages = false;
+
+    // Objects are written in the order of their slots, which are handed out in the order a
+    // serial run would write the objects.  Guarded by fMutex.
+    int fNextEmitSlot = 0;
+    int fNextSlotToWrite = 0;
+    SkTHashMap<int, int> fEmitSlots;                // object number -> slot
+    SkTHashMap<int, PendingObject> fPendingObjects; // slot -> object
+
+    // For SkPDF::Metadata::fObjectStreams.  Objects emitted since the last object stream was
+    // written, and where each starts in fObjectStreamContent.  Only touched by emit().
+    SkDynamicMemoryWStream fObjectStreamContent;
+    std::vector<std::pair<SkPDFIndirectReference, int>> fObjectStreamObjects;
+
+    // For SkPDF::Metadata::fStreamingChunkSize.  The page tree is built as pages end, bottom
+    // up: each level has a node that takes kids until it is full, then is written out.
+    struct PageTreeNode {
+        SkPDFIndirectReference fRef;
+        std::vector<SkPDFIndirectReference> fKids;
+        int fPageCount = 0;
+    };
+    std::vector<PageTreeNode> fOpenPageTreeNodes;  // leaves first
+
+    SkPDFIndirectReference openPageTreeNode(size_t level);
+    void addToPageTree(size_t level, SkPDFIndirectReference kid, int pageCount);
+    SkPDFIndirectReference finishPageTree();
+    void finishChunk();
+
     void waitForJobs();
+    void writeObjectStream();
+    sk_sp<SkPDFDevice> makePageDevice(SkScalar width, SkScalar height, SkPDFConcurrentPage*);
+    void beginPageDevice(SkScalar width, SkScalar height);
+    void endPageDevice();
+    void drawConcurrentPage(sk_sp<SkPicture>, SkSize, size_t pageIndex);
+    void finalizeConcurrentPage(std::unique_ptr<SkPDFConcurrentPage>);
     SkWStream* beginObject(SkPDFIndirectReference);
-    void endObject();
+    void endObject(SkPDFIndirectReference, SkWStream*);
+    void writePendingObjects();
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
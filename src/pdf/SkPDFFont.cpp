@@ -39,6 +39,7 @@
 #include "src/pdf/SkPDFMakeCIDGlyphWidthsArray.h"
 #include "src/pdf/SkPDFMakeToUnicodeCmap.h"
 #include "src/pdf/SkPDFSubsetFont.h"
+#include "src/pdf/SkPDFSubsetFontCache.h"
 #include "src/pdf/SkPDFType1Font.h"
 #include "src/pdf/SkPDFUtils.h"
 #include "src/utils/SkUTF.h"
@@ -125,6 +126,7 @@ static bool can_embed(const SkAdvancedTypefaceMetrics& metrics) {
 const SkAdvancedTypefaceMetrics* SkPDFFont::GetMetrics(const SkTypeface* typeface,
                                                        SkPDFDocument* canon) {
     SkASSERT(typeface);
+    SkAutoMutexAcquire lock(canon->fFontInfoMutex);
     SkFontID id = typeface->uniqueID();
     if (std::unique_ptr<SkAdvancedTypefaceMetrics>* ptr = canon->fTypefaceMetrics.find(id)) {
         return ptr->get();  // canon retains ownership.
@@ -176,13 +178,14 @@ const std::vector<SkUnichar>& SkPDFFont::GetUnicodeMap(const SkTypeface* typefac
                                                        SkPDFDocument* canon) {
     SkASSERT(typeface);
     SkASSERT(canon);
+    SkAutoMutexAcquire lock(canon->fFontInfoMutex);
     SkFontID id = typeface->uniqueID();
-    if (std::vector<SkUnichar>* ptr = canon->fToUnicodeMap.find(id)) {
-        return *ptr;
+    if (std::unique_ptr<std::vector<SkUnichar>>* ptr = canon->fToUnicodeMap.find(id)) {
+        return **ptr;
     }
-    std::vector<SkUnichar> buffer(typeface->countGlyphs());
-    typeface->getGlyphToUnicodeMap(buffer.data());
-    return *canon->fToUnicodeMap.set(id, std::move(buffer));
+    auto buffer = skstd::make_unique<std::vector<SkUnichar>>(typeface->countGlyphs());
+    typeface->getGlyphToUnicodeMap(buffer->data());
+    return **canon->fToUnicodeMap.set(id, std::move(buffer));
 }
 
 SkAdvancedTypefaceMetrics::FontType SkPDFFont::FontType(const SkAdvancedTypefaceMetrics& metrics) {
@@ -203,10 +206,13 @@ static bool has_outline_glyph(SkGlyphID gid, SkStrike* cache) {
     return glyph.isEmpty() || cache->findPath(glyph);
 }
 
-SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
-                                      SkStrike* cache,
-                                      SkTypeface* face,
-                                      SkGlyphID glyphID) {
+SkPDFFont* SkPDFFont::FindOrMake(SkTHashMap<uint64_t, SkPDFFont>* fonts,
+                                 SkPDFDocument* doc,
+                                 SkStrike* cache,
+                                 SkTypeface* face,
+                                 SkGlyphID glyphID,
+                                 bool reserveRef,
+                                 uint64_t* fontIDOut) {
     SkASSERT(doc);
     SkASSERT(face);  // All SkPDFDevice::internalDrawText ensures this.
     const SkAdvancedTypefaceMetrics* fontMetrics = SkPDFFont::GetMetrics(face, doc);
@@ -220,8 +226,11 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
     bool multibyte = SkPDFFont::IsMultiByte(type);
     SkGlyphID subsetCode = multibyte ? 0 : first_nonzero_glyph_for_single_byte_encoding(glyphID);
     uint64_t fontID = (static_cast<uint64_t>(SkTypeface::UniqueID(face)) << 16) | subsetCode;
+    if (fontIDOut) {
+        *fontIDOut = fontID;
+    }
 
-    if (SkPDFFont* found = doc->fFontMap.find(fontID)) {
+    if (SkPDFFont* found = fonts->find(fontID)) {
         SkASSERT(multibyte == found->multiByteGlyphs());
         return found;
     }
@@ -241,11 +250,47 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
         firstNonZeroGlyph = subsetCode;
         lastGlyph = SkToU16(SkTMin<int>((int)lastGlyph, 254 + (int)subsetCode));
     }
-    auto ref = doc->reserveRef();
-    return doc->fFontMap.set(
+    auto ref = reserveRef ? doc->reserveRef() : SkPDFIndirectReference();
+    return fonts->set(
             fontID, SkPDFFont(std::move(typeface), firstNonZeroGlyph, lastGlyph, type, ref));
 }
 
+SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
+                                      SkStrike* cache,
+                                      SkTypeface* face,
+                                      SkGlyphID glyphID) {
+    return FindOrMake(&doc->fFontMap, doc, cache, face, glyphID, true, nullptr);
+}
+
+SkPDFFont* SkPDFFont::GetPageFont(SkTHashMap<uint64_t, SkPDFFont>* pageFonts,
+                                  SkPDFDocument* doc,
+                                  SkStrike* cache,
+                                  SkTypeface* face,
+                                  SkGlyphID glyphID,
+                                  uint64_t* fontID) {
+    return FindOrMake(pageFonts, doc, cache, face, glyphID, false, fontID);
+}
+
+SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
+                                      uint64_t fontID,
+                                      const SkPDFFont& pageFont) {
+    SkPDFFont* font = doc->fFontMap.find(fontID);
+    if (!font) {
+        font = doc->fFontMap.set(fontID, SkPDFFont(pageFont.refTypeface(),
+                                                   pageFont.firstGlyphID(),
+                                                   pageFont.lastGlyphID(),
+                                                   pageFont.getType(),
+                                                   doc->reserveRef()));
+    }
+    // The font's encoding is fixed by fontID, whichever page made it first.
+    SkASSERT(font->multiByteGlyphs() == pageFont.multiByteGlyphs());
+    SkASSERT(font->firstGlyphID() == pageFont.firstGlyphID());
+    pageFont.glyphUsage().getSetValues([font](unsigned gid) {
+        font->noteGlyphUsage(SkToU16(gid));
+    });
+    return font;
+}
+
 SkPDFFont::SkPDFFont(sk_sp<SkTypeface> typeface,
                      SkGlyphID firstGlyphID,
                      SkGlyphID lastGlyphID,
@@ -300,6 +345,40 @@ static sk_sp<SkData> stream_to_data(std::unique_ptr<SkStreamAsset> stream) {
     return SkData::MakeFromStream(stream.get(), size);
 }
 
+static sk_sp<SkData> subset_font(SkTypeface* face,
+                                 std::unique_ptr<SkStreamAsset> fontAsset,
+                                 int ttcIndex,
+                                 const SkPDFGlyphUse& glyphUsage,
+                                 SkPDFDocument* doc,
+                                 const char* fontName) {
+    const SkPDF::Metadata& metadata = doc->metadata();
+    SkPDF::Metadata::Subsetter subsetter = metadata.fSubsetter;
+    SkPDFSubsetFontCache::Cache* cache = doc->subsetFontCache();
+    if (sk_sp<SkData> subset = cache->find(face->uniqueID(), subsetter, glyphUsage)) {
+        return subset;
+    }
+    sk_sp<SkData> fontData = stream_to_data(std::move(fontAsset));
+    if (!fontData) {
+        return nullptr;
+    }
+    SkPDF::PersistentCache* persistentCache = metadata.fSubsetFontCache;
+    sk_sp<SkData> key;
+    sk_sp<SkData> subset;
+    if (persistentCache) {
+        key = SkPDFSubsetFontCache::MakePersistentKey(*fontData, ttcIndex, subsetter,
+                                                      glyphUsage);
+        subset = persistentCache->load(*key);
+    }
+    if (!subset) {
+        subset = SkPDFSubsetFont(std::move(fontData), glyphUsage, subsetter, fontName, ttcIndex);
+        if (subset && persistentCache) {
+            persistentCache->store(*key, *subset);
+        }
+    }
+    cache->add(face->uniqueID(), subsetter, glyphUsage, subset);
+    return subset;
+}
+
 static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     const SkAdvancedTypefaceMetrics* metricsPtr =
         SkPDFFont::GetMetrics(font.typeface(), doc);
@@ -328,10 +407,9 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                 if (!SkToBool(metrics.fFlags &
                               SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag)) {
                     SkASSERT(font.firstGlyphID() == 1);
-                    sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
-                            stream_to_data(std::move(fontAsset)), font.glyphUsage(),
-                            doc->metadata().fSubsetter,
-                            metrics.fFontName.c_str(), ttcIndex);
+                    sk_sp<SkData> subsetFontData = subset_font(
+                            face, std::move(fontAsset), ttcIndex, font.glyphUsage(),
+                            doc, metrics.fFontName.c_str());
                     if (subsetFontData) {
                         std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                         tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
@@ -10,6 +10,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/private/SkTHash.h"
 #include "src/core/SkAdvancedTypefaceMetrics.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/pdf/SkPDFGlyphUse.h"
@@ -95,6 +96,23 @@ public:
                                       SkTypeface* typeface,
                                       SkGlyphID glyphID);
 
+    /** Like GetFontResource(), but for a page drawn concurrently, which keeps
+     *  fonts of its own in pageFonts until it is finalized.  These have no
+     *  indirect reference; GetFontResource(doc, fontID, pageFont) merges one
+     *  into the document's font.
+     *  @param fontID  Set to the key of the font in pageFonts.
+     */
+    static SkPDFFont* GetPageFont(SkTHashMap<uint64_t, SkPDFFont>* pageFonts,
+                                  SkPDFDocument* doc,
+                                  SkStrike* cache,
+                                  SkTypeface* typeface,
+                                  SkGlyphID glyphID,
+                                  uint64_t* fontID);
+
+    static SkPDFFont* GetFontResource(SkPDFDocument* doc,
+                                      uint64_t fontID,
+                                      const SkPDFFont& pageFont);
+
     /** Gets SkAdvancedTypefaceMetrics, and caches the result.
      *  @param typeface can not be nullptr.
      *  @return nullptr only when typeface is bad.
@@ -129,6 +147,14 @@ private:
     SkPDFIndirectReference fIndirectReference;
     SkAdvancedTypefaceMetrics::FontType fFontType = (SkAdvancedTypefaceMetrics::FontType)(-1);
 
+    static SkPDFFont* FindOrMake(SkTHashMap<uint64_t, SkPDFFont>*,
+                                 SkPDFDocument*,
+                                 SkStrike*,
+                                 SkTypeface*,
+                                 SkGlyphID,
+                                 bool reserveRef,
+                                 uint64_t* fontID);
+
     SkPDFFont(sk_sp<SkTypeface>,
               SkGlyphID firstGlyphID,
               SkGlyphID lastGlyphID,
@@ -53,11 +53,28 @@ static uint8_t pdf_blend_mode(SkBlendMode mode) {
     return SkToU8((unsigned)mode);
 }
 
+SkPDFFillGraphicState SkPDFGraphicState::FillKey(const SkPaint& p) {
+    SkASSERT(SkPaint::kFill_Style == p.getStyle());
+    return {p.getColor4f().fA, pdf_blend_mode(p.getBlendMode())};
+}
+
+SkPDFStrokeGraphicState SkPDFGraphicState::StrokeKey(const SkPaint& p) {
+    SkASSERT(SkPaint::kFill_Style != p.getStyle());
+    return {
+        p.getStrokeWidth(),
+        p.getStrokeMiter(),
+        p.getColor4f().fA,
+        SkToU8(p.getStrokeCap()),
+        SkToU8(p.getStrokeJoin()),
+        pdf_blend_mode(p.getBlendMode())
+    };
+}
+
 SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument* doc,
                                                                   const SkPaint& p) {
     SkASSERT(doc);
     if (SkPaint::kFill_Style == p.getStyle()) {
-        SkPDFFillGraphicState fillKey = {p.getColor4f().fA, pdf_blend_mode(p.getBlendMode())};
+        SkPDFFillGraphicState fillKey = FillKey(p);
         auto& fillMap = doc->fFillGSMap;
         if (SkPDFIndirectReference* statePtr = fillMap.find(fillKey)) {
             return *statePtr;
@@ -70,14 +87,7 @@ SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument*
         fillMap.set(fillKey, ref);
         return ref;
     } else {
-        SkPDFStrokeGraphicState strokeKey = {
-            p.getStrokeWidth(),
-            p.getStrokeMiter(),
-            p.getColor4f().fA,
-            SkToU8(p.getStrokeCap()),
-            SkToU8(p.getStrokeJoin()),
-            pdf_blend_mode(p.getBlendMode())
-        };
+        SkPDFStrokeGraphicState strokeKey = StrokeKey(p);
         auto& sMap = doc->fStrokeGSMap;
         if (SkPDFIndirectReference* statePtr = sMap.find(strokeKey)) {
             return *statePtr;
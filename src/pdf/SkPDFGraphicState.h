@@ -68,4 +68,10 @@ struct SkPDFFillGraphicState {
 };
 SK_END_REQUIRE_DENSE
 
+namespace SkPDFGraphicState {
+    /** The keys GetGraphicStateForPaint() canonicalizes fill and stroke paints by. */
+    SkPDFFillGraphicState FillKey(const SkPaint&);
+    SkPDFStrokeGraphicState StrokeKey(const SkPaint&);
+}
+
 #endif
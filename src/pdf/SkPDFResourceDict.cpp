@@ -9,6 +9,8 @@
 #include "src/pdf/SkPDFResourceDict.h"
 #include "src/pdf/SkPDFTypes.h"
 
+#include <algorithm>
+
 // Sanity check that the values of enum ResourceType correspond to the
 // expected values as defined in the arrays below.
 // If these are failing, you may need to update the kResourceTypePrefixes
@@ -94,3 +96,49 @@ std::unique_ptr<SkPDFDict> SkPDFMakeResourceDict(
     add_subdict(fontResources,         SkPDFResourceType::kFont,      dict.get());
     return dict;
 }
+
+int SkPDFResourceList::add(SkPDFResourceType type, const SkPDFResource& resource) {
+    SkASSERT((unsigned)type < kTypeCount);
+    if (!resource.fDeferred) {
+        SkASSERT(fDeferred[(unsigned)type].empty());
+        fRefs[(unsigned)type].add(resource.fRef);
+        return resource.fRef.fValue;
+    }
+    SkASSERT(fRefs[(unsigned)type].count() == 0);
+    std::vector<sk_sp<SkPDFDeferredObject>>& deferred = fDeferred[(unsigned)type];
+    if (int* key = fDeferredKeys[(unsigned)type].find(resource.fDeferred.get())) {
+        return *key;
+    }
+    int key = SkToInt(deferred.size());
+    fDeferredKeys[(unsigned)type].set(resource.fDeferred.get(), key);
+    deferred.push_back(resource.fDeferred);
+    return key;
+}
+
+std::unique_ptr<SkPDFDict> SkPDFResourceList::makeResourceDict() const {
+    auto dict = SkPDFMakeDict();
+    dict->insertObject("ProcSets", make_proc_set());
+    for (unsigned i = 0; i < kTypeCount; ++i) {
+        SkPDFResourceType type = (SkPDFResourceType)i;
+        std::vector<SkPDFIndirectReference> refs;
+        fRefs[i].foreach([&refs](SkPDFIndirectReference ref) { refs.push_back(ref); });
+        std::sort(refs.begin(), refs.end(),
+                  [](SkPDFIndirectReference a, SkPDFIndirectReference b) {
+                      return a.fValue < b.fValue;
+                  });
+        add_subdict(refs, type, dict.get());
+        if (fDeferred[i].empty()) {
+            continue;
+        }
+        auto resources = SkPDFMakeDict();
+        for (size_t key = 0; key < fDeferred[i].size(); ++key) {
+            SkPDFIndirectReference ref = fDeferred[i][key]->resolve();
+            // A shader can turn out to have nothing to draw; leave its name undefined.
+            if (ref != SkPDFIndirectReference()) {
+                resources->insertRef(resource(type, SkToInt(key)), ref);
+            }
+        }
+        dict->insertObject(resource_name(type), std::move(resources));
+    }
+    return dict;
+}
@@ -8,6 +8,8 @@
 #ifndef SkPDFResourceDict_DEFINED
 #define SkPDFResourceDict_DEFINED
 
+#include "include/core/SkRefCnt.h"
+#include "include/private/SkTHash.h"
 #include "src/pdf/SkPDFFont.h"
 
 #include <vector>
@@ -47,4 +49,72 @@ std::unique_ptr<SkPDFDict> SkPDFMakeResourceDict(
  */
 void SkPDFWriteResourceName(SkWStream*, SkPDFResourceType type, int key);
 
+/** An object that is made the first time it is resolved, rather than when a
+ *  content stream first names it.  Pages drawn concurrently (see
+ *  SkPDF::Metadata::fConcurrentPages) defer their resources so that object
+ *  numbers are handed out in page order, when each page is finalized.
+ */
+class SkPDFDeferredObject : public SkRefCnt {
+public:
+    SkPDFIndirectReference resolve() {
+        if (fRef == SkPDFIndirectReference()) {
+            fRef = this->onMake();
+        }
+        return fRef;
+    }
+
+protected:
+    virtual SkPDFIndirectReference onMake() = 0;
+
+private:
+    SkPDFIndirectReference fRef;
+};
+
+/** Defer calling make, which returns the object's indirect reference. */
+template <typename Fn>
+sk_sp<SkPDFDeferredObject> SkPDFDefer(Fn make) {
+    class Deferred final : public SkPDFDeferredObject {
+    public:
+        explicit Deferred(Fn&& fn) : fFn(std::move(fn)) {}
+    private:
+        SkPDFIndirectReference onMake() override { return fFn(); }
+        Fn fFn;
+    };
+    return sk_make_sp<Deferred>(std::move(make));
+}
+
+/** A resource named by a content stream: either an object that has already
+ *  been emitted, or a deferred one.
+ */
+struct SkPDFResource {
+    SkPDFResource() = default;
+    SkPDFResource(SkPDFIndirectReference ref) : fRef(ref) {}
+    SkPDFResource(sk_sp<SkPDFDeferredObject> deferred) : fDeferred(std::move(deferred)) {}
+
+    explicit operator bool() const { return fRef != SkPDFIndirectReference() || fDeferred; }
+    SkPDFIndirectReference resolve() const { return fDeferred ? fDeferred->resolve() : fRef; }
+
+    SkPDFIndirectReference fRef;
+    sk_sp<SkPDFDeferredObject> fDeferred;
+};
+
+/** The resources named by one content stream.  Emitted objects are named by
+ *  their object numbers; deferred ones, whose numbers are not known yet, by
+ *  the order they were first named in.  A list holds one kind or the other.
+ */
+class SkPDFResourceList {
+public:
+    /** Returns the key to name the resource by with SkPDFWriteResourceName(). */
+    int add(SkPDFResourceType, const SkPDFResource&);
+
+    /** Create the resource dictionary, resolving any deferred resources. */
+    std::unique_ptr<SkPDFDict> makeResourceDict() const;
+
+private:
+    static constexpr int kTypeCount = 4;
+    SkTHashSet<SkPDFIndirectReference> fRefs[kTypeCount];
+    std::vector<sk_sp<SkPDFDeferredObject>> fDeferred[kTypeCount];
+    SkTHashMap<const SkPDFDeferredObject*, int> fDeferredKeys[kTypeCount];
+};
+
 #endif
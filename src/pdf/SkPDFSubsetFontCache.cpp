@@ -0,0 +1,230 @@
+// Copyright 2019 Google LLC.
+// Use of this source code is governed by a BSD-style license that can be found in the LICENSE file.
+
+#include "src/pdf/SkPDFSubsetFontCache.h"
+
+#include "include/private/SkChecksum.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
+#include "include/private/SkTInternalLList.h"
+#include "include/private/SkTo.h"
+#include "src/core/SkMD5.h"
+#include "src/core/SkOpts.h"
+#include "src/pdf/SkPDFGlyphUse.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Both subsetters always keep glyph 0.
+std::vector<SkGlyphID> glyphs_used(const SkPDFGlyphUse& glyphUsage) {
+    std::vector<SkGlyphID> glyphs{0};
+    glyphUsage.getSetValues([&glyphs](unsigned gid) {
+        if (gid != 0) {
+            glyphs.push_back(SkToU16(gid));
+        }
+    });
+    return glyphs;
+}
+
+struct Key {
+    SkFontID fFontID;
+    uint32_t fSubsetter;
+    uint32_t fGlyphsHash;
+
+    bool operator==(const Key& that) const {
+        return fFontID     == that.fFontID     &&
+               fSubsetter  == that.fSubsetter  &&
+               fGlyphsHash == that.fGlyphsHash;
+    }
+};
+
+Key make_key(SkFontID fontID, SkPDF::Metadata::Subsetter subsetter,
+             const std::vector<SkGlyphID>& glyphs) {
+    return {fontID, (uint32_t)subsetter,
+            SkOpts::hash(glyphs.data(), glyphs.size() * sizeof(SkGlyphID))};
+}
+
+struct Entry {
+    Entry(const Key& key, std::vector<SkGlyphID> glyphs, sk_sp<SkData> subset)
+        : fKey(key), fGlyphs(std::move(glyphs)), fSubset(std::move(subset)) {}
+
+    size_t bytesUsed() const {
+        return sizeof(*this) + fGlyphs.size() * sizeof(SkGlyphID) + fSubset->size();
+    }
+
+    Key                    fKey;
+    std::vector<SkGlyphID> fGlyphs;  // sorted
+    sk_sp<SkData>          fSubset;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+};
+
+}  // namespace
+
+class SkPDFSubsetFontCache::Cache::Impl {
+public:
+    ~Impl() { this->purgeAsNeeded(0); }
+
+    sk_sp<SkData> find(const Key& key, const std::vector<SkGlyphID>& glyphs) {
+        SkAutoMutexAcquire lock(fMutex);
+        Entry* found = nullptr;
+        if (Entry** exact = fMap.find(key)) {
+            if ((*exact)->fGlyphs == glyphs) {
+                found = *exact;
+            }
+        }
+        if (!found) {
+            // A subset of any superset of the glyphs will do, since both subsetters keep
+            // glyph IDs, but only take it if it is not much bigger than a subset of our own.
+            SkTInternalLList<Entry>::Iter iter;
+            for (Entry* e = iter.init(fLRU, SkTInternalLList<Entry>::Iter::kHead_IterStart); e;
+                 e = iter.next()) {
+                if (e->fKey.fFontID == key.fFontID &&
+                    e->fKey.fSubsetter == key.fSubsetter &&
+                    e->fGlyphs.size() >= glyphs.size() &&
+                    e->fGlyphs.size() <= 2 * glyphs.size() &&
+                    (!found || e->fGlyphs.size() < found->fGlyphs.size()) &&
+                    std::includes(e->fGlyphs.begin(), e->fGlyphs.end(),
+                                  glyphs.begin(), glyphs.end())) {
+                    found = e;
+                }
+            }
+        }
+        if (!found) {
+            return nullptr;
+        }
+        fLRU.remove(found);
+        fLRU.addToHead(found);
+        return found->fSubset;
+    }
+
+    void add(const Key& key, std::vector<SkGlyphID> glyphs, sk_sp<SkData> subset) {
+        std::unique_ptr<Entry> entry(new Entry(key, std::move(glyphs), std::move(subset)));
+        SkAutoMutexAcquire lock(fMutex);
+        if (entry->bytesUsed() > fByteLimit) {
+            return;
+        }
+        if (Entry** existing = fMap.find(key)) {
+            this->remove(*existing);
+        }
+        fBytesUsed += entry->bytesUsed();
+        fMap.set(key, entry.get());
+        fLRU.addToHead(entry.release());
+        this->purgeAsNeeded(fByteLimit);
+    }
+
+    size_t setByteLimit(size_t byteLimit) {
+        SkAutoMutexAcquire lock(fMutex);
+        size_t previous = fByteLimit;
+        fByteLimit = byteLimit;
+        this->purgeAsNeeded(byteLimit);
+        return previous;
+    }
+
+    size_t getByteLimit() {
+        SkAutoMutexAcquire lock(fMutex);
+        return fByteLimit;
+    }
+
+    size_t getBytesUsed() {
+        SkAutoMutexAcquire lock(fMutex);
+        return fBytesUsed;
+    }
+
+    void purgeAll() {
+        SkAutoMutexAcquire lock(fMutex);
+        this->purgeAsNeeded(0);
+    }
+
+private:
+    void remove(Entry* entry) {
+        fBytesUsed -= entry->bytesUsed();
+        fMap.remove(entry->fKey);
+        fLRU.remove(entry);
+        delete entry;
+    }
+
+    void purgeAsNeeded(size_t byteLimit) {
+        while (fBytesUsed > byteLimit) {
+            this->remove(fLRU.tail());
+        }
+    }
+
+    SkMutex                             fMutex;
+    SkTHashMap<Key, Entry*, SkGoodHash> fMap;
+    SkTInternalLList<Entry>             fLRU;
+    size_t                              fBytesUsed = 0;
+    size_t                              fByteLimit = 0;
+};
+
+SkPDFSubsetFontCache::Cache::Cache() : fImpl(new Impl) {}
+
+SkPDFSubsetFontCache::Cache::~Cache() = default;
+
+sk_sp<SkData> SkPDFSubsetFontCache::Cache::find(SkFontID fontID,
+                                                SkPDF::Metadata::Subsetter subsetter,
+                                                const SkPDFGlyphUse& glyphUsage) {
+    if (0 == fImpl->getByteLimit()) {
+        return nullptr;
+    }
+    std::vector<SkGlyphID> glyphs = glyphs_used(glyphUsage);
+    return fImpl->find(make_key(fontID, subsetter, glyphs), glyphs);
+}
+
+void SkPDFSubsetFontCache::Cache::add(SkFontID fontID, SkPDF::Metadata::Subsetter subsetter,
+                                      const SkPDFGlyphUse& glyphUsage, sk_sp<SkData> subset) {
+    if (0 == fImpl->getByteLimit() || !subset) {
+        return;
+    }
+    std::vector<SkGlyphID> glyphs = glyphs_used(glyphUsage);
+    Key key = make_key(fontID, subsetter, glyphs);
+    fImpl->add(key, std::move(glyphs), std::move(subset));
+}
+
+size_t SkPDFSubsetFontCache::Cache::setByteLimit(size_t byteLimit) {
+    return fImpl->setByteLimit(byteLimit);
+}
+
+size_t SkPDFSubsetFontCache::Cache::getByteLimit() { return fImpl->getByteLimit(); }
+
+size_t SkPDFSubsetFontCache::Cache::getBytesUsed() { return fImpl->getBytesUsed(); }
+
+void SkPDFSubsetFontCache::Cache::purgeAll() { fImpl->purgeAll(); }
+
+SkPDFSubsetFontCache::Cache* SkPDFSubsetFontCache::Global() {
+    static Cache* gCache = new Cache;
+    return gCache;
+}
+
+sk_sp<SkData> SkPDFSubsetFontCache::MakePersistentKey(const SkData& fontData, int ttcIndex,
+                                                      SkPDF::Metadata::Subsetter subsetter,
+                                                      const SkPDFGlyphUse& glyphUsage) {
+    static const char kVersion[] = "SkPDFSubsetFont1";
+    std::vector<SkGlyphID> glyphs = glyphs_used(glyphUsage);
+    uint32_t header[2] = {(uint32_t)ttcIndex, (uint32_t)subsetter};
+    SkMD5 md5;
+    md5.write(kVersion, sizeof(kVersion));
+    md5.write(header, sizeof(header));
+    md5.write(glyphs.data(), glyphs.size() * sizeof(SkGlyphID));
+    md5.write(fontData.data(), fontData.size());
+    SkMD5::Digest digest = md5.finish();
+    return SkData::MakeWithCopy(digest.data, sizeof(digest.data));
+}
+
+size_t SkPDF::SetSubsetFontCacheLimit(size_t bytes) {
+    return SkPDFSubsetFontCache::Global()->setByteLimit(bytes);
+}
+
+size_t SkPDF::GetSubsetFontCacheLimit() {
+    return SkPDFSubsetFontCache::Global()->getByteLimit();
+}
+
+size_t SkPDF::GetSubsetFontCacheBytesUsed() {
+    return SkPDFSubsetFontCache::Global()->getBytesUsed();
+}
+
+void SkPDF::PurgeSubsetFontCache() {
+    SkPDFSubsetFontCache::Global()->purgeAll();
+}
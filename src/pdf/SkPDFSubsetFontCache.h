@@ -0,0 +1,51 @@
+// Copyright 2019 Google LLC.
+// Use of this source code is governed by a BSD-style license that can be found in the LICENSE file.
+#ifndef SkPDFSubsetFontCache_DEFINED
+#define SkPDFSubsetFontCache_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkTypeface.h"
+#include "include/docs/SkPDFDocument.h"
+
+#include <memory>
+
+class SkPDFGlyphUse;
+
+namespace SkPDFSubsetFontCache {
+
+// A thread-safe LRU cache of subset fonts, bounded by a byte limit.  Nothing is cached while
+// the limit is zero, the default.
+class Cache {
+public:
+    Cache();
+    ~Cache();
+
+    // Returns a cached subset of the font that has at least the glyphs in glyphUsage, or nullptr.
+    sk_sp<SkData> find(SkFontID, SkPDF::Metadata::Subsetter, const SkPDFGlyphUse& glyphUsage);
+
+    // Caches the subset of the font for glyphUsage, if it fits within the limit.
+    void add(SkFontID, SkPDF::Metadata::Subsetter, const SkPDFGlyphUse& glyphUsage,
+             sk_sp<SkData> subset);
+
+    // Returns the previous limit.
+    size_t setByteLimit(size_t);
+    size_t getByteLimit();
+    size_t getBytesUsed();
+    void purgeAll();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> fImpl;
+};
+
+// The process-wide cache used by documents unless told otherwise.
+// See SkPDF::SetSubsetFontCacheLimit().
+Cache* Global();
+
+// Returns the key for the subset in an SkPDF::PersistentCache.
+sk_sp<SkData> MakePersistentKey(const SkData& fontData, int ttcIndex,
+                                SkPDF::Metadata::Subsetter, const SkPDFGlyphUse& glyphUsage);
+
+}  // namespace SkPDFSubsetFontCache
+
+#endif  // SkPDFSubsetFontCache_DEFINED
@@ -23,6 +23,8 @@ public:
     void init(const SkPDF::StructureElementNode*);
     void reset();
     int getMarkIdForNodeId(int nodeId, unsigned pageIndex);
+    // True if getMarkIdForNodeId() returns a mark ID for nodeId.
+    bool hasNodeId(int nodeId) const { return fRoot && fNodeMap.find(nodeId); }
     SkPDFIndirectReference makeStructTreeRoot(SkPDFDocument* doc);
 
 private:
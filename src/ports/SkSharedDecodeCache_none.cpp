@@ -0,0 +1,12 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/lazy/SkSharedDecodeCache.h"
+
+sk_sp<SkSharedDecodeCache> SkSharedDecodeCache::Make(const char[], size_t) {
+    return nullptr;
+}
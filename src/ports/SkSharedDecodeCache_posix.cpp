@@ -0,0 +1,269 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPixmap.h"
+#include "include/core/SkString.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTFitsIn.h"
+#include "src/core/SkDiscardableMemory.h"
+#include "src/core/SkMakeUnique.h"
+#include "src/core/SkOSFile.h"
+#include "src/lazy/SkSharedDecodeCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+static constexpr char     kSuffix[]  = ".px";
+static constexpr char     kMagic[8]  = { 'S', 'k', 'P', 'i', 'x', 'e', 'l', 's' };
+static constexpr uint32_t kVersion   = 1;
+
+// Starts each file.  Padded so the pixels that follow it are well aligned.
+struct Header {
+    char     fMagic[8];
+    uint32_t fVersion;
+    int32_t  fWidth;
+    int32_t  fHeight;
+    uint32_t fColorType;
+    uint32_t fAlphaType;
+    uint32_t fRowBytes;
+    uint8_t  fPad[32];
+};
+static_assert(sizeof(Header) == 64, "Header should be 64 bytes");
+
+// Pixels in a file mapped read-only.  The mapping outlives the file if it is evicted.
+class MappedPixels final : public SkDiscardableMemory {
+public:
+    MappedPixels(void* addr, size_t length) : fAddr(addr), fLength(length) {}
+    ~MappedPixels() override { sk_fmunmap(fAddr, fLength); }
+
+    bool lock() override { return true; }
+    void* data() override { return (char*)fAddr + sizeof(Header); }
+    void unlock() override {}
+
+private:
+    void*  fAddr;
+    size_t fLength;
+};
+
+static timespec now() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts;
+}
+
+// Marks the file at path as just used.  Explicit times keep their full precision, where "now"
+// would only be as precise as the kernel's clock tick.
+static void touch(const char path[]) {
+    const timespec ts = now();
+    const timespec times[2] = { ts, ts };
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+static timespec modification_time(const struct stat& st) {
+#if defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    return st.st_mtimespec;
+#else
+    return st.st_mtim;
+#endif
+}
+
+class SharedDecodeCache final : public SkSharedDecodeCache {
+public:
+    SharedDecodeCache(const char dir[], size_t byteLimit) : fDir(dir), fByteLimit(byteLimit) {
+        fBytesUsed = total_size(this->entries());
+    }
+
+    std::unique_ptr<SkDiscardableMemory> find(const Key& key, const SkImageInfo& info,
+                                              size_t* rowBytes) override {
+        const SkString path = this->pathFor(key);
+        FILE* file = sk_fopen(path.c_str(), kRead_SkFILE_Flag);
+        if (!file) {
+            return nullptr;
+        }
+        size_t length = 0;
+        void* addr = sk_fmmap(file, &length);
+        sk_fclose(file);
+        if (!addr) {
+            return nullptr;
+        }
+
+        Header header;
+        if (length < sizeof(Header)) {
+            sk_fmunmap(addr, length);
+            return nullptr;
+        }
+        memcpy(&header, addr, sizeof(Header));
+        if (memcmp(header.fMagic, kMagic, sizeof(kMagic)) ||
+            header.fVersion   != kVersion                 ||
+            header.fWidth     != info.width()             ||
+            header.fHeight    != info.height()            ||
+            header.fColorType != (uint32_t)info.colorType() ||
+            header.fAlphaType != (uint32_t)info.alphaType() ||
+            header.fRowBytes  <  info.minRowBytes()        ||
+            length - sizeof(Header) < info.computeByteSize(header.fRowBytes)) {
+            sk_fmunmap(addr, length);
+            return nullptr;
+        }
+
+        touch(path.c_str());
+        *rowBytes = header.fRowBytes;
+        return skstd::make_unique<MappedPixels>(addr, length);
+    }
+
+    bool add(const Key& key, const SkPixmap& pixels) override {
+        const SkImageInfo& info = pixels.info();
+        const size_t rowBytes = info.minRowBytes();
+        const size_t fileSize = sizeof(Header) + info.computeByteSize(rowBytes);
+        if (!SkTFitsIn<uint32_t>(rowBytes) || fileSize > fByteLimit) {
+            return false;
+        }
+
+        // Write everything under a name no other process will use, then move it into place all
+        // at once, so no one can map a partly written file.
+        static std::atomic<uint32_t> gNextTemp{0};
+        const SkString path = this->pathFor(key);
+        SkString temp = SkStringPrintf("%s.%d.%u.tmp", path.c_str(), (int)getpid(),
+                                       gNextTemp.fetch_add(1, std::memory_order_relaxed));
+        FILE* file = sk_fopen(temp.c_str(), kWrite_SkFILE_Flag);
+        if (!file) {
+            return false;
+        }
+
+        Header header;
+        memset(&header, 0, sizeof(Header));
+        memcpy(header.fMagic, kMagic, sizeof(kMagic));
+        header.fVersion   = kVersion;
+        header.fWidth     = info.width();
+        header.fHeight    = info.height();
+        header.fColorType = info.colorType();
+        header.fAlphaType = info.alphaType();
+        header.fRowBytes  = (uint32_t)rowBytes;
+
+        bool ok = sk_fwrite(&header, sizeof(Header), file) == sizeof(Header);
+        for (int y = 0; ok && y < info.height(); ++y) {
+            ok = sk_fwrite(pixels.addr(0, y), rowBytes, file) == rowBytes;
+        }
+        sk_fclose(file);
+
+        if (ok) {
+            touch(temp.c_str());
+            ok = 0 == rename(temp.c_str(), path.c_str());
+        }
+        if (!ok) {
+            remove(temp.c_str());
+            return false;
+        }
+
+        // Only list the directory once our running count says it is over the limit, and then
+        // make some room, so that a full cache is not listed again on every add.
+        SkAutoExclusive lock(fMutex);
+        fBytesUsed += fileSize;
+        if (fBytesUsed > fByteLimit) {
+            fBytesUsed = this->purgeDownTo(fByteLimit - fByteLimit / 4);
+        }
+        return true;
+    }
+
+    size_t getTotalBytesUsed() override { return total_size(this->entries()); }
+
+    void purgeAll() override {
+        SkAutoExclusive lock(fMutex);
+        fBytesUsed = this->purgeDownTo(0);
+    }
+
+private:
+    struct Entry {
+        SkString fPath;
+        size_t   fSize;
+        timespec fUsed;
+    };
+
+    static size_t total_size(const std::vector<Entry>& entries) {
+        size_t total = 0;
+        for (const Entry& entry : entries) {
+            total += entry.fSize;
+        }
+        return total;
+    }
+
+    SkString pathFor(const Key& key) const {
+        SkString path(fDir);
+        path.append("/");
+        for (uint8_t byte : key.data) {
+            path.appendf("%02x", byte);
+        }
+        path.append(kSuffix);
+        return path;
+    }
+
+    std::vector<Entry> entries() const {
+        std::vector<Entry> entries;
+        SkOSFile::Iter iter(fDir.c_str(), kSuffix);
+        SkString name;
+        while (iter.next(&name)) {
+            SkString path = SkStringPrintf("%s/%s", fDir.c_str(), name.c_str());
+            struct stat st;
+            if (0 == stat(path.c_str(), &st) && S_ISREG(st.st_mode)) {
+                entries.push_back({ std::move(path), (size_t)st.st_size, modification_time(st) });
+            }
+        }
+        return entries;
+    }
+
+    // Removes the least recently used entries until the rest fit in limit, and returns the size
+    // of the rest.
+    size_t purgeDownTo(size_t limit) {
+        std::vector<Entry> entries = this->entries();
+        size_t total = total_size(entries);
+        if (total <= limit) {
+            return total;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            if (a.fUsed.tv_sec != b.fUsed.tv_sec) {
+                return a.fUsed.tv_sec < b.fUsed.tv_sec;
+            }
+            return a.fUsed.tv_nsec < b.fUsed.tv_nsec;
+        });
+        for (const Entry& entry : entries) {
+            if (total <= limit) {
+                break;
+            }
+            // Another process may have removed it first, but either way it's gone.
+            remove(entry.fPath.c_str());
+            total -= entry.fSize;
+        }
+        return total;
+    }
+
+    const SkString fDir;
+    const size_t   fByteLimit;
+
+    // Bytes in the directory when it was last listed, plus what this cache has added since.
+    // Other processes' entries are only counted from the next listing.
+    SkMutex fMutex;
+    size_t  fBytesUsed;
+};
+
+}  // namespace
+
+sk_sp<SkSharedDecodeCache> SkSharedDecodeCache::Make(const char dir[], size_t byteLimit) {
+    if (!dir || !sk_mkdir(dir) || !sk_isdir(dir)) {
+        return nullptr;
+    }
+    return sk_make_sp<SharedDecodeCache>(dir, byteLimit);
+}
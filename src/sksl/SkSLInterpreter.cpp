@@ -25,6 +25,9 @@
 #include "src/sksl/ir/SkSLVarDeclarationsStatement.h"
 #include "src/sksl/ir/SkSLVariableReference.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace SkSL {
 
 static constexpr int UNINITIALIZED = 0xDEADBEEF;
@@ -490,6 +493,321 @@ void Interpreter::run() {
     }
 }
 
+Interpreter::Value* Interpreter::runStriped(const ByteCodeFunction& f, int N, int count,
+                                            Interpreter::Value args[],
+                                            Interpreter::Value inputs[]) {
+    SkASSERT(0 < count && count <= N && N <= kMaxStripe);
+    fCurrentFunction = &f;
+    fStack.clear();
+    fGlobals.clear();
+#ifdef TRACE
+    this->disassemble(f);
+#endif
+    fStack.insert(fStack.end(), args, args + f.fParameterCount * N);
+    fStack.resize((f.fParameterCount + f.fLocalCount) * N, Value((int) UNINITIALIZED));
+    fGlobals.resize(f.fOwner.fGlobalCount * N, Value((int) UNINITIALIZED));
+    for (int i = f.fOwner.fInputSlots.size() - 1; i >= 0; --i) {
+        std::fill_n(fGlobals.begin() + f.fOwner.fInputSlots[i] * N, N, inputs[i]);
+    }
+    this->runStriped(N, count);
+    int offset = 0;
+    for (const auto& p : f.fDeclaration.fParameters) {
+        int slots = p->fType.columns() * p->fType.rows();
+        if (p->fModifiers.fFlags & Modifiers::kOut_Flag) {
+            std::copy_n(fStack.begin() + offset * N, slots * N, args + offset * N);
+        }
+        offset += slots;
+    }
+    return fStack.data();
+}
+
+// Calls fn(lane) for every lane in mask. When every lane is running, this is a plain loop the
+// compiler can vectorize.
+template <typename Fn>
+static void for_each_lane(const bool mask[], bool all, int N, Fn&& fn) {
+    if (all) {
+        for (int l = 0; l < N; ++l) {
+            fn(l);
+        }
+    } else {
+        for (int l = 0; l < N; ++l) {
+            if (mask[l]) {
+                fn(l);
+            }
+        }
+    }
+}
+
+#define STRIPED_BINARY_OP(inst, field, op)                                     \
+    case ByteCodeInstruction::inst: {                                          \
+        for (int i = 0; i < vecCount; ++i) {                                   \
+            Value* a = stripe(top - 2 * vecCount + i);                         \
+            const Value* b = stripe(top - vecCount + i);                       \
+            for_each_lane(mask, all, N, [&](int l) {                           \
+                a[l] = Value(a[l].field op b[l].field);                        \
+            });                                                                \
+        }                                                                      \
+        top -= vecCount;                                                       \
+        break;                                                                 \
+    }
+
+#define STRIPED_UNARY_OP(inst, dstField, expr)                                 \
+    case ByteCodeInstruction::inst: {                                          \
+        for (int i = 0; i < vecCount; ++i) {                                   \
+            Value* v = stripe(top - 1 - i);                                    \
+            for_each_lane(mask, all, N, [&](int l) {                           \
+                v[l].dstField = expr;                                          \
+            });                                                                \
+        }                                                                      \
+        break;                                                                 \
+    }
+
+void Interpreter::runStriped(int N, int count) {
+    static constexpr int kDone = std::numeric_limits<int>::max();
+
+    // Stack slot s holds one value per lane, at fStack[s * N + lane]. Each lane has its own
+    // instruction pointer and stack depth, though lanes at the same instruction always share the
+    // same depth.
+    int laneIP[kMaxStripe], laneTop[kMaxStripe];
+    for (int l = 0; l < N; ++l) {
+        laneIP[l] = l < count ? 0 : kDone;
+        laneTop[l] = (int) fStack.size() / N;
+    }
+    auto stripe = [this, N](int slot) {
+        SkASSERT(slot >= 0 && (slot + 1) * N <= (int) fStack.size());
+        return &fStack[slot * N];
+    };
+    auto reserve = [this, N](int slots) {
+        if (slots * N > (int) fStack.size()) {
+            fStack.resize(slots * N);
+        }
+    };
+    const uint8_t* code = fCurrentFunction->fCode.data();
+    for (;;) {
+        // The lanes furthest behind run together until they either split at a branch or catch
+        // up to the next lanes behind them, which then join in. Structured control flow means
+        // this keeps lanes together except while they are actually taking different paths.
+        int ip = kDone;
+        for (int l = 0; l < N; ++l) {
+            ip = std::min(ip, laneIP[l]);
+        }
+        if (ip == kDone) {
+            return;
+        }
+        bool mask[kMaxStripe];
+        int first = -1,
+            running = 0,
+            next = kDone;
+        for (int l = 0; l < N; ++l) {
+            mask[l] = laneIP[l] == ip;
+            if (mask[l]) {
+                first = first < 0 ? l : first;
+                running++;
+            } else {
+                next = std::min(next, laneIP[l]);
+            }
+        }
+        const bool all = running == N;
+        int top = laneTop[first];
+
+        bool stopped = false;
+        while (ip < next && !stopped) {
+            ByteCodeInstruction inst = (ByteCodeInstruction) READ8();
+            int vecCount = 1;
+            bool vector = false;
+            if (inst == ByteCodeInstruction::kVector) {
+                vecCount = READ8();
+                inst = (ByteCodeInstruction) READ8();
+                vector = true;
+            }
+            // Copies slot src to slot dst in each running lane.
+            auto copy = [&](Value* dst, const Value* src) {
+                for_each_lane(mask, all, N, [&](int l) { dst[l] = src[l]; });
+            };
+            switch (inst) {
+                STRIPED_BINARY_OP(kAddI, fSigned, +)
+                STRIPED_BINARY_OP(kAddF, fFloat, +)
+                case ByteCodeInstruction::kBranch:
+                    ip = READ16();
+                    break;
+                STRIPED_BINARY_OP(kCompareIEQ, fSigned, ==)
+                STRIPED_BINARY_OP(kCompareFEQ, fFloat, ==)
+                STRIPED_BINARY_OP(kCompareINEQ, fSigned, !=)
+                STRIPED_BINARY_OP(kCompareFNEQ, fFloat, !=)
+                STRIPED_BINARY_OP(kCompareSGT, fSigned, >)
+                STRIPED_BINARY_OP(kCompareUGT, fUnsigned, >)
+                STRIPED_BINARY_OP(kCompareFGT, fFloat, >)
+                STRIPED_BINARY_OP(kCompareSGTEQ, fSigned, >=)
+                STRIPED_BINARY_OP(kCompareUGTEQ, fUnsigned, >=)
+                STRIPED_BINARY_OP(kCompareFGTEQ, fFloat, >=)
+                STRIPED_BINARY_OP(kCompareSLT, fSigned, <)
+                STRIPED_BINARY_OP(kCompareULT, fUnsigned, <)
+                STRIPED_BINARY_OP(kCompareFLT, fFloat, <)
+                STRIPED_BINARY_OP(kCompareSLTEQ, fSigned, <=)
+                STRIPED_BINARY_OP(kCompareULTEQ, fUnsigned, <=)
+                STRIPED_BINARY_OP(kCompareFLTEQ, fFloat, <=)
+                case ByteCodeInstruction::kConditionalBranch: {
+                    int target = READ16();
+                    const Value* cond = stripe(--top);
+                    int taken = 0;
+                    for_each_lane(mask, all, N, [&](int l) { taken += cond[l].fBool ? 1 : 0; });
+                    if (taken == running) {
+                        ip = target;
+                    } else if (taken > 0) {
+                        // Our lanes disagree, so from here on they go their separate ways.
+                        for_each_lane(mask, all, N, [&](int l) {
+                            laneIP[l]  = cond[l].fBool ? target : ip;
+                            laneTop[l] = top;
+                        });
+                        stopped = true;
+                    }
+                    break;
+                }
+                case ByteCodeInstruction::kDebugPrint: {
+                    const Value* v = stripe(--top);
+                    for_each_lane(mask, all, N, [&](int l) {
+                        printf("Debug[%d]: %d(int), %d(uint), %f(float)\n", l, v[l].fSigned,
+                               v[l].fUnsigned, v[l].fFloat);
+                    });
+                    break;
+                }
+                STRIPED_BINARY_OP(kDivideS, fSigned, /)
+                STRIPED_BINARY_OP(kDivideU, fUnsigned, /)
+                STRIPED_BINARY_OP(kDivideF, fFloat, /)
+                case ByteCodeInstruction::kDup:
+                    reserve(top + 1);
+                    copy(stripe(top), stripe(top - 1));
+                    top++;
+                    break;
+                case ByteCodeInstruction::kDupDown: {
+                    // Copies the top n values to below the value beneath them.
+                    int n = READ8();
+                    int base = top - n - 1;
+                    reserve(top + n);
+                    for (int i = n - 1; i >= 0; --i) {
+                        copy(stripe(base + n + 1 + i), stripe(base + 1 + i));
+                    }
+                    copy(stripe(base + n), stripe(base));
+                    for (int i = 0; i < n; ++i) {
+                        copy(stripe(base + i), stripe(base + n + 1 + i));
+                    }
+                    top += n;
+                    break;
+                }
+                STRIPED_UNARY_OP(kFloatToInt, fSigned, (int) v[l].fFloat)
+                STRIPED_UNARY_OP(kSignedToFloat, fFloat, (float) v[l].fSigned)
+                STRIPED_UNARY_OP(kUnsignedToFloat, fFloat, (float) v[l].fUnsigned)
+                case ByteCodeInstruction::kLoad: {
+                    int target = stripe(--top)[first].fSigned;
+                    reserve(top + vecCount);
+                    for (int i = 0; i < vecCount; ++i) {
+                        copy(stripe(top++), stripe(target + i));
+                    }
+                    break;
+                }
+                case ByteCodeInstruction::kLoadGlobal: {
+                    int target = READ8();
+                    SkASSERT((target + 1) * N <= (int) fGlobals.size());
+                    reserve(top + 1);
+                    copy(stripe(top++), &fGlobals[target * N]);
+                    break;
+                }
+                case ByteCodeInstruction::kLoadSwizzle: {
+                    int target = stripe(--top)[first].fSigned;
+                    int n = READ8();
+                    reserve(top + n);
+                    for (int i = 0; i < n; ++i) {
+                        copy(stripe(top++), stripe(target + code[ip + i]));
+                    }
+                    ip += n;
+                    break;
+                }
+                STRIPED_BINARY_OP(kMultiplyS, fSigned, *)
+                STRIPED_BINARY_OP(kMultiplyU, fUnsigned, *)
+                STRIPED_BINARY_OP(kMultiplyF, fFloat, *)
+                STRIPED_UNARY_OP(kNot, fBool, !v[l].fBool)
+                STRIPED_UNARY_OP(kNegateF, fFloat, -v[l].fFloat)
+                STRIPED_UNARY_OP(kNegateS, fSigned, -v[l].fSigned)
+                case ByteCodeInstruction::kNop:
+                    break;
+                case ByteCodeInstruction::kPop:
+                    top -= READ8();
+                    break;
+                case ByteCodeInstruction::kPushImmediate: {
+                    Value v((int) READ32());
+                    reserve(top + 1);
+                    Value* dst = stripe(top++);
+                    for_each_lane(mask, all, N, [&](int l) { dst[l] = v; });
+                    break;
+                }
+                STRIPED_BINARY_OP(kRemainderS, fSigned, %)
+                STRIPED_BINARY_OP(kRemainderU, fUnsigned, %)
+                case ByteCodeInstruction::kReturn: {
+                    int n = READ8();
+                    for (int i = 0; i < n; ++i) {
+                        copy(stripe(i), stripe(top - n + i));
+                    }
+                    for_each_lane(mask, all, N, [&](int l) { laneIP[l] = kDone; });
+                    stopped = true;
+                    break;
+                }
+                case ByteCodeInstruction::kStore:
+                    if (vector) {
+                        int target = stripe(top - vecCount - 1)[first].fSigned;
+                        for (int i = 0; i < vecCount; ++i) {
+                            copy(stripe(target + i), stripe(top - vecCount + i));
+                        }
+                        top -= vecCount;
+                    } else {
+                        top -= 2;
+                        copy(stripe(stripe(top)[first].fSigned), stripe(top + 1));
+                    }
+                    break;
+                case ByteCodeInstruction::kStoreGlobal: {
+                    top -= 2;
+                    int target = stripe(top)[first].fSigned;
+                    SkASSERT((target + 1) * N <= (int) fGlobals.size());
+                    copy(&fGlobals[target * N], stripe(top + 1));
+                    break;
+                }
+                case ByteCodeInstruction::kStoreSwizzle: {
+                    int n = READ8();
+                    int target = stripe(top - n - 1)[first].fSigned;
+                    for (int i = 0; i < n; ++i) {
+                        copy(stripe(target + code[ip + i]), stripe(top - n + i));
+                    }
+                    top -= n + 1;
+                    ip += n;
+                    break;
+                }
+                STRIPED_BINARY_OP(kSubtractI, fSigned, -)
+                STRIPED_BINARY_OP(kSubtractF, fFloat, -)
+                case ByteCodeInstruction::kSwizzle: {
+                    Value vec[4 * kMaxStripe];
+                    int n = READ8();
+                    top -= n;
+                    std::copy_n(stripe(top), n * N, vec);
+                    n = READ8();
+                    reserve(top + n);
+                    for (int i = 0; i < n; ++i) {
+                        copy(stripe(top++), vec + READ8() * N);
+                    }
+                    break;
+                }
+                default:
+                    printf("unsupported instruction %d\n", (int) inst);
+                    SkASSERT(false);
+            }
+        }
+        if (!stopped) {
+            for_each_lane(mask, all, N, [&](int l) {
+                laneIP[l]  = ip;
+                laneTop[l] = top;
+            });
+        }
+    }
+}
+
 } // namespace
 
 #endif
@@ -61,11 +61,27 @@ public:
      */
     Value* run(const ByteCodeFunction& f, Value args[], Value inputs[]);
 
+    /**
+     * The most invocations runStriped() can run at once; this matches SkRasterPipeline_kMaxStride.
+     */
+    static constexpr int kMaxStripe = 16;
+
+    /**
+     * As run(), but invokes the function 'count' times at once, one invocation per lane of an
+     * N-wide stripe (count <= N <= kMaxStripe). Each argument slot holds one value per lane, so
+     * lane i's value of slot s is args[s * N + i], as is the returned stack. Lanes that take
+     * different branches run apart under a mask until their paths meet again. Every lane sees
+     * the same 'inputs'.
+     */
+    Value* runStriped(const ByteCodeFunction& f, int N, int count, Value args[], Value inputs[]);
+
 private:
     StackIndex stackAlloc(int count);
 
     void run();
 
+    void runStriped(int N, int count);
+
     void push(Value v);
 
     Value pop();
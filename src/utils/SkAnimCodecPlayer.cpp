@@ -11,11 +11,18 @@
 #include "include/utils/SkAnimCodecPlayer.h"
 #include "src/codec/SkCodecImageGenerator.h"
 #include <algorithm>
+#include <cstdint>
 
-SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec)
+    : SkAnimCodecPlayer(std::move(codec), SIZE_MAX) {}
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec, size_t frameCacheBytes)
+    : fCodec(std::move(codec))
+    , fCacheBudget(frameCacheBytes) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
     fImages.resize(fFrameInfos.size());
+    fLastUsed.resize(fFrameInfos.size());
 
     // change the interpretation of fDuration to a end-time for that frame
     size_t dur = 0;
@@ -40,13 +47,24 @@ SkISize SkAnimCodecPlayer::dimensions() {
     return { fImageInfo.width(), fImageInfo.height() };
 }
 
-sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
-    SkASSERT((unsigned)index < fFrameInfos.size());
+bool SkAnimCodecPlayer::isKeyFrame(int index) const {
+    return fFrameInfos[index].fRequiredFrame == SkCodec::kNoFrame ||
+           index % kKeyFrameInterval == 0;
+}
 
-    if (fImages[index]) {
-        return fImages[index];
+// Returns the latest cached frame in [requiredFrame, index) that index can be decoded on top of,
+// or kNoFrame if there is none.
+int SkAnimCodecPlayer::findPriorFrame(int requiredFrame, int index) const {
+    for (int i = index - 1; i >= requiredFrame; --i) {
+        if (fImages[i] &&
+            fFrameInfos[i].fDisposalMethod != SkCodecAnimation::DisposalMethod::kRestorePrevious) {
+            return i;
+        }
     }
+    return SkCodec::kNoFrame;
+}
 
+sk_sp<SkImage> SkAnimCodecPlayer::decodeFrame(int index, int priorIndex, const SkImage* prior) {
     size_t rb = fImageInfo.minRowBytes();
     size_t size = fImageInfo.computeByteSize(rb);
     auto data = SkData::MakeUninitialized(size);
@@ -54,19 +72,87 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkCodec::Options opts;
     opts.fFrameIndex = index;
 
-    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNoFrame) {
-        auto requiredImage = fImages[requiredFrame];
-        SkPixmap requiredPM;
-        if (requiredImage && requiredImage->peekPixels(&requiredPM)) {
-            sk_careful_memcpy(data->writable_data(), requiredPM.addr(), size);
-            opts.fPriorFrame = requiredFrame;
+    SkPixmap priorPM;
+    if (prior && prior->peekPixels(&priorPM)) {
+        sk_careful_memcpy(data->writable_data(), priorPM.addr(), size);
+        opts.fPriorFrame = priorIndex;
+    }
+    if (SkCodec::kSuccess != fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
+        return nullptr;
+    }
+    auto image = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+    this->cacheFrame(index, image);
+    return image;
+}
+
+void SkAnimCodecPlayer::cacheFrame(int index, sk_sp<SkImage> image) {
+    SkASSERT(!fImages[index]);
+    fImages[index] = std::move(image);
+    fLastUsed[index] = ++fUseCount;
+    fCachedBytes += fImageInfo.computeMinByteSize();
+    this->purgeFrames();
+}
+
+void SkAnimCodecPlayer::purgeFrames() {
+    while (fCachedBytes > fCacheBudget) {
+        // Drop the least recently used frame, preferring frames that are not key frames.
+        int victim = -1;
+        for (int i = 0; i < (int)fImages.size(); ++i) {
+            if (!fImages[i]) {
+                continue;
+            }
+            if (victim < 0) {
+                victim = i;
+                continue;
+            }
+            bool key = this->isKeyFrame(i),
+                 victimKey = this->isKeyFrame(victim);
+            if (key != victimKey ? !key : fLastUsed[i] < fLastUsed[victim]) {
+                victim = i;
+            }
         }
+        SkASSERT(victim >= 0);
+        fImages[victim].reset();
+        fCachedBytes -= fImageInfo.computeMinByteSize();
     }
-    if (SkCodec::kSuccess == fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
-        return fImages[index] = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
+    SkASSERT((unsigned)index < fFrameInfos.size());
+
+    if (fImages[index]) {
+        fLastUsed[index] = ++fUseCount;
+        return fImages[index];
+    }
+
+    // Walk back through the frames that index depends on, until we reach one that can be decoded
+    // on top of a cached frame, or that depends on nothing.  Then decode forward from there.
+    std::vector<int> chain = { index };
+    int priorIndex = SkCodec::kNoFrame;
+    sk_sp<SkImage> prior;
+    for (;;) {
+        const int requiredFrame = fFrameInfos[chain.back()].fRequiredFrame;
+        if (requiredFrame == SkCodec::kNoFrame) {
+            break;
+        }
+        priorIndex = this->findPriorFrame(requiredFrame, chain.back());
+        if (priorIndex != SkCodec::kNoFrame) {
+            prior = fImages[priorIndex];
+            fLastUsed[priorIndex] = ++fUseCount;
+            break;
+        }
+        chain.push_back(requiredFrame);
+    }
+
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        // Hold on to each frame until the next is decoded, even if the cache drops it.
+        prior = this->decodeFrame(*it, priorIndex, prior.get());
+        if (!prior) {
+            return nullptr;
+        }
+        priorIndex = *it;
     }
-    return nullptr;
+    return prior;
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
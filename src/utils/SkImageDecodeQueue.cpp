@@ -0,0 +1,116 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkImageDecodeQueue.h"
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "src/core/SkBitmapCache.h"
+#include "src/core/SkBitmapProvider.h"
+#include "src/core/SkMipMap.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/image/SkImage_Base.h"
+
+SkImageDecodeQueue::SkImageDecodeQueue(SkExecutor* executor)
+    : fTaskGroup(new SkTaskGroup(*executor)) {}
+
+SkImageDecodeQueue::~SkImageDecodeQueue() {
+    this->cancelAll();
+    fTaskGroup->wait();
+}
+
+void SkImageDecodeQueue::request(sk_sp<SkImage> image, int priority, SkISize drawSize) {
+    if (!image || !image->isLazyGenerated()) {
+        return;
+    }
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        for (Request& req : fRequests) {
+            if (req.fImage->uniqueID() == image->uniqueID()) {
+                req.fPriority = priority;
+                req.fDrawSize = drawSize;
+                return;
+            }
+        }
+        fRequests.push_back({std::move(image), priority, drawSize, fNextOrder++});
+    }
+    // Each task decodes whichever request is most urgent when it starts running, so there is
+    // one task per request, but not necessarily for that request.
+    fTaskGroup->add([this] { this->decodeNext(); });
+}
+
+bool SkImageDecodeQueue::setPriority(const SkImage* image, int priority) {
+    SkAutoMutexAcquire lock(fMutex);
+    for (Request& req : fRequests) {
+        if (req.fImage->uniqueID() == image->uniqueID()) {
+            req.fPriority = priority;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SkImageDecodeQueue::cancel(const SkImage* image) {
+    SkAutoMutexAcquire lock(fMutex);
+    for (size_t i = 0; i < fRequests.size(); ++i) {
+        if (fRequests[i].fImage->uniqueID() == image->uniqueID()) {
+            fRequests.erase(fRequests.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkImageDecodeQueue::cancelAll() {
+    SkAutoMutexAcquire lock(fMutex);
+    fRequests.clear();
+}
+
+int SkImageDecodeQueue::countQueued() const {
+    SkAutoMutexAcquire lock(fMutex);
+    return (int)fRequests.size();
+}
+
+void SkImageDecodeQueue::wait() {
+    fTaskGroup->wait();
+}
+
+void SkImageDecodeQueue::decodeNext() {
+    Request req;
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        if (fRequests.empty()) {
+            return;     // Cancelled.
+        }
+        size_t best = 0;
+        for (size_t i = 1; i < fRequests.size(); ++i) {
+            const Request& r = fRequests[i];
+            if (r.fPriority > fRequests[best].fPriority ||
+                (r.fPriority == fRequests[best].fPriority && r.fOrder < fRequests[best].fOrder)) {
+                best = i;
+            }
+        }
+        req = std::move(fRequests[best]);
+        fRequests.erase(fRequests.begin() + best);
+    }
+
+    const SkImage* image = req.fImage.get();
+    SkBitmap bitmap;
+    if (!as_IB(image)->getROPixels(&bitmap, SkImage::kAllow_CachingHint)) {
+        return;
+    }
+
+    if (!req.fDrawSize.isEmpty() &&
+        (req.fDrawSize.width() < image->width() || req.fDrawSize.height() < image->height())) {
+        SkBitmapProvider provider(image);
+        const SkMipMap* mips = SkMipMapCache::FindAndRef(provider.makeCacheDesc());
+        if (!mips) {
+            mips = SkMipMapCache::AddAndRef(provider);
+        }
+        SkSafeUnref(mips);
+    }
+}
@@ -11,6 +11,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkDrawLooper.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
@@ -30,18 +31,23 @@
 #include "include/effects/SkLayerDrawLooper.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/private/SkFloatBits.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkBlurPriv.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMathPriv.h"
 #include "src/core/SkRectPriv.h"
+#include "src/core/SkSpecialImage.h"
 #include "src/effects/SkEmbossMaskFilter.h"
+#include "src/effects/imagefilters/SkBlurImageFilterPriv.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 
 #include "tools/gpu/GrContextFactory.h"
 
+#include <functional>
 #include <math.h>
 #include <string.h>
 #include <utility>
@@ -742,3 +748,110 @@ DEF_TEST(zero_blur, reporter) {
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
 
+
+// Large blurs work on several rows at once, in bands of rows.  Moving the mask down and right
+// changes which rows and columns are blurred together, but must not change the results.
+DEF_TEST(BlurMaskLargeSigmaGrouping, reporter) {
+    SkRandom rand;
+    for (double sigma : {2.5, 20.0}) {
+        for (int size : {1, 7, 9, 150}) {
+            const int w = size + 3,
+                      h = size;
+            for (int pad : {1, 3, 8}) {
+                SkMask plain, padded;
+                plain.fFormat   = padded.fFormat   = SkMask::kA8_Format;
+                plain.fBounds   = SkIRect::MakeWH(w, h);
+                padded.fBounds  = SkIRect::MakeWH(w + pad, h + pad);
+                plain.fRowBytes = w;
+                padded.fRowBytes = w + pad;
+                plain.fImage  = SkMask::AllocImage(plain.computeImageSize());
+                padded.fImage = SkMask::AllocImage(padded.computeImageSize(),
+                                                   SkMask::kZeroInit_Alloc);
+                SkAutoMaskFreeImage plainStorage(plain.fImage),
+                                    paddedStorage(padded.fImage);
+                for (int y = 0; y < h; y++) {
+                    for (int x = 0; x < w; x++) {
+                        *plain.getAddr8(x, y) = *padded.getAddr8(x + pad, y + pad) = rand.nextU();
+                    }
+                }
+
+                SkMaskBlurFilter filter(sigma, sigma);
+                SkMask plainDst, paddedDst;
+                filter.blur(plain,  &plainDst);
+                filter.blur(padded, &paddedDst);
+                SkAutoMaskFreeImage plainDstStorage(plainDst.fImage),
+                                    paddedDstStorage(paddedDst.fImage);
+
+                bool same = true;
+                for (int y = paddedDst.fBounds.fTop; y < paddedDst.fBounds.fBottom; y++) {
+                    for (int x = paddedDst.fBounds.fLeft; x < paddedDst.fBounds.fRight; x++) {
+                        uint8_t expected = plainDst.fBounds.contains(x - pad, y - pad)
+                                         ? *plainDst.getAddr8(x - pad, y - pad) : 0;
+                        same &= *paddedDst.getAddr8(x, y) == expected;
+                    }
+                }
+                REPORTER_ASSERT(reporter, same, "sigma %g, %dx%d, pad %d", sigma, w, h, pad);
+            }
+        }
+    }
+}
+
+// Runs each task on the calling thread as soon as it is added.
+class InlineExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { work(); }
+};
+
+// Large blurs split their rows into bands and blur them on an SkExecutor.  Run the same blurs
+// on the calling thread alone and on a thread pool, and expect the same results.
+DEF_TEST(BlurLargeSigmaThreaded, reporter) {
+    SkRandom rand;
+    SkMask src;
+    src.fFormat   = SkMask::kA8_Format;
+    src.fBounds   = SkIRect::MakeWH(517, 389);
+    src.fRowBytes = src.fBounds.width();
+    src.fImage    = SkMask::AllocImage(src.computeImageSize());
+    SkAutoMaskFreeImage srcStorage(src.fImage);
+    for (size_t i = 0; i < src.computeImageSize(); i++) {
+        src.fImage[i] = rand.nextU();
+    }
+
+    SkBitmap image;
+    image.allocN32Pixels(301, 211);
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            *image.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+    image.setImmutable();
+    const SkIRect imageBounds = SkIRect::MakeWH(image.width(), image.height());
+    sk_sp<SkSpecialImage> special = SkSpecialImage::MakeFromRaster(imageBounds, image);
+
+    auto blurMask = [&](SkMask* dst, SkExecutor& executor) {
+        SkMaskBlurFilter(20, 20).blur(src, dst, executor);
+    };
+    auto blurImage = [&](SkBitmap* dst, SkExecutor& executor) {
+        sk_sp<SkSpecialImage> blurred =
+                SkBlurImageFilterCPU({20, 20}, special.get(), special, imageBounds,
+                                     imageBounds.makeOutset(60, 60), executor);
+        return blurred && blurred->getROPixels(dst);
+    };
+
+    InlineExecutor serial;
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkMask serialMask, threadedMask;
+    SkBitmap serialImage, threadedImage;
+    blurMask(&serialMask, serial);
+    blurMask(&threadedMask, *pool);
+    SkAutoMaskFreeImage serialMaskStorage(serialMask.fImage),
+                        threadedMaskStorage(threadedMask.fImage);
+    REPORTER_ASSERT(reporter, blurImage(&serialImage, serial));
+    REPORTER_ASSERT(reporter, blurImage(&threadedImage, *pool));
+
+    REPORTER_ASSERT(reporter, serialMask.fBounds == threadedMask.fBounds);
+    REPORTER_ASSERT(reporter, serialMask.fRowBytes == threadedMask.fRowBytes);
+    REPORTER_ASSERT(reporter, 0 == memcmp(serialMask.fImage, threadedMask.fImage,
+                                          serialMask.computeImageSize()));
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(serialImage, threadedImage));
+}
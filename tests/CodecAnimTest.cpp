@@ -484,3 +484,76 @@ DEF_TEST(AnimCodecPlayer, r) {
         REPORTER_ASSERT(r, f1->bounds().size() == test.fSize);
     }
 }
+
+DEF_TEST(AnimCodecPlayer_frameCache, r) {
+    for (const char* file : { "images/alphabetAnim.gif", "images/flightAnim.gif",
+                              "images/randPixelsAnim.gif", "images/blendBG.webp",
+                              "images/webp-animated.webp" }) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        if (!data) {
+            continue;
+        }
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        if (!codec) {
+            // WebP may not be supported in this build.
+            continue;
+        }
+
+        // Decode each frame on its own to compare against, and find a time that seeks to it.
+        const SkImageInfo info = codec->getInfo();
+        const size_t frameBytes = info.computeMinByteSize();
+        const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+        const int frameCount = (int)frameInfos.size();
+        std::vector<SkBitmap> expected(frameCount);
+        std::vector<uint32_t> seekTimes;
+        std::vector<int> seekFrames;
+        uint32_t start = 0;
+        for (int i = 0; i < frameCount; ++i) {
+            expected[i].allocPixels(info);
+            SkCodec::Options options;
+            options.fFrameIndex = i;
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(info, expected[i].getPixels(),
+                                                                     expected[i].rowBytes(),
+                                                                     &options));
+            if (frameInfos[i].fDuration > 0) {
+                seekTimes.push_back(start + 1);
+                seekFrames.push_back(i);
+            }
+            start += frameInfos[i].fDuration;
+        }
+
+        // Play through twice, then jump around.
+        std::vector<int> order;
+        for (int loop = 0; loop < 2; ++loop) {
+            for (int i = 0; i < (int)seekTimes.size(); ++i) {
+                order.push_back(i);
+            }
+        }
+        for (int i = 0; i < 40; ++i) {
+            order.push_back((i * 7 + i / 3) % seekTimes.size());
+        }
+
+        for (size_t budgetFrames : { (size_t)0, (size_t)1, (size_t)3, SIZE_MAX / frameBytes }) {
+            const size_t budget = budgetFrames * frameBytes;
+            SkAnimCodecPlayer player(SkCodec::MakeFromData(data), budget);
+            for (int i : order) {
+                player.seek(seekTimes[i]);
+                sk_sp<SkImage> frame = player.getFrame();
+                SkPixmap pm;
+                if (!frame || !frame->peekPixels(&pm)) {
+                    ERRORF(r, "%s: no frame %d with budget %zu", file, seekFrames[i], budget);
+                    continue;
+                }
+                const SkBitmap& bm = expected[seekFrames[i]];
+                for (int y = 0; y < info.height(); ++y) {
+                    if (memcmp(pm.addr(0, y), bm.getAddr(0, y), info.minRowBytes())) {
+                        ERRORF(r, "%s: frame %d mismatch with budget %zu",
+                               file, seekFrames[i], budget);
+                        break;
+                    }
+                }
+                REPORTER_ASSERT(r, player.frameCacheBytesUsed() <= budget);
+            }
+        }
+    }
+}
@@ -6,6 +6,7 @@
  */
 
 #include "include/codec/SkCodec.h"
+#include "include/codec/SkPartialDataStream.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
@@ -58,8 +59,51 @@ static bool compare_bitmaps(skiatest::Reporter* r, const SkBitmap& bm1, const Sk
     return true;
 }
 
+// Feeds the file to a codec a piece at a time, through either a HaltingStream or an
+// SkPartialDataStream.
+class PartialFeed {
+public:
+    PartialFeed(const sk_sp<SkData>& file, size_t minBytes, bool useDataStream) {
+        if (useDataStream) {
+            auto stream = SkPartialDataStream::Make(file->size());
+            stream->append(file->data(), minBytes);
+            fDataStream = stream.get();
+            fStream = std::move(stream);
+            fFile = file;
+        } else {
+            auto stream = skstd::make_unique<HaltingStream>(file, minBytes);
+            fHaltingStream = stream.get();
+            fStream = std::move(stream);
+        }
+    }
+
+    // Note that we cheat and hold on to a pointer to the stream, though it is
+    // owned by the codec after this call.
+    std::unique_ptr<SkStream> releaseStream() { return std::move(fStream); }
+
+    void addNewData(size_t extra) {
+        if (fHaltingStream) {
+            fHaltingStream->addNewData(extra);
+        } else {
+            const size_t received = fDataStream->bytesReceived();
+            extra = SkTMin(extra, fFile->size() - received);
+            fDataStream->append(fFile->bytes() + received, extra);
+        }
+    }
+
+    bool isAllDataReceived() const {
+        return fHaltingStream ? fHaltingStream->isAllDataReceived() : fDataStream->isComplete();
+    }
+
+private:
+    std::unique_ptr<SkStream> fStream;
+    HaltingStream*            fHaltingStream = nullptr;
+    SkPartialDataStream*      fDataStream = nullptr;
+    sk_sp<SkData>             fFile;
+};
+
 static void test_partial(skiatest::Reporter* r, const char* name, const sk_sp<SkData>& file,
-                         size_t minBytes, size_t increment) {
+                         size_t minBytes, size_t increment, bool useDataStream = false) {
     SkBitmap truth;
     if (!create_truth(file, &truth)) {
         ERRORF(r, "Failed to decode %s\n", name);
@@ -67,11 +111,8 @@ static void test_partial(skiatest::Reporter* r, const char* name, const sk_sp<Sk
     }
 
     // Now decode part of the file
-    HaltingStream* stream = new HaltingStream(file, minBytes);
-
-    // Note that we cheat and hold on to a pointer to stream, though it is owned by
-    // partialCodec.
-    auto partialCodec = SkCodec::MakeFromStream(std::unique_ptr<SkStream>(stream));
+    PartialFeed feed(file, minBytes, useDataStream);
+    auto partialCodec = SkCodec::MakeFromStream(feed.releaseStream());
     if (!partialCodec) {
         ERRORF(r, "Failed to create codec for %s with %zu bytes", name, minBytes);
         return;
@@ -89,12 +130,12 @@ static void test_partial(skiatest::Reporter* r, const char* name, const sk_sp<Sk
             break;
         }
 
-        if (stream->isAllDataReceived()) {
+        if (feed.isAllDataReceived()) {
             ERRORF(r, "Failed to start incremental decode\n");
             return;
         }
 
-        stream->addNewData(increment);
+        feed.addNewData(increment);
     }
 
     while (true) {
@@ -110,19 +151,20 @@ static void test_partial(skiatest::Reporter* r, const char* name, const sk_sp<Sk
 
         REPORTER_ASSERT(r, result == SkCodec::kIncompleteInput);
 
-        if (stream->isAllDataReceived()) {
+        if (feed.isAllDataReceived()) {
             ERRORF(r, "Failed to completely decode %s", name);
             return;
         }
 
-        stream->addNewData(increment);
+        feed.addNewData(increment);
     }
 
     // compare to original
     compare_bitmaps(r, truth, incremental);
 }
 
-static void test_partial(skiatest::Reporter* r, const char* name, size_t minBytes = 0) {
+static void test_partial(skiatest::Reporter* r, const char* name, size_t minBytes = 0,
+                         bool useDataStream = false) {
     sk_sp<SkData> file = GetResourceAsData(name);
     if (!file) {
         SkDebugf("missing resource %s\n", name);
@@ -131,7 +173,7 @@ static void test_partial(skiatest::Reporter* r, const char* name, size_t minByte
 
     // This size is arbitrary, but deliberately different from the buffer size used by SkPngCodec.
     constexpr size_t kIncrement = 1000;
-    test_partial(r, name, file, SkTMax(file->size() / 2, minBytes), kIncrement);
+    test_partial(r, name, file, SkTMax(file->size() / 2, minBytes), kIncrement, useDataStream);
 }
 
 DEF_TEST(Codec_partial, r) {
@@ -154,6 +196,85 @@ DEF_TEST(Codec_partial, r) {
     test_partial(r, "images/color_wheel.gif");
 }
 
+// Same as above, but the codecs read the data in place from an SkPartialDataStream.
+DEF_TEST(Codec_partialDataStream, r) {
+    test_partial(r, "images/box.gif", 0, true);
+    test_partial(r, "images/randPixels.gif", 215, true);
+    test_partial(r, "images/color_wheel.gif", 0, true);
+    test_partial(r, "images/plane.png", 0, true);
+    test_partial(r, "images/plane_interlaced.png", 0, true);
+    test_partial(r, "images/yellow_rose.png", 0, true);
+}
+
+// SkJpegCodec has no incremental decode, but it reads the data in place as it arrives, so a
+// scanline decode started on part of the file can finish as long as each row is in before it
+// is read.
+DEF_TEST(Codec_partialDataStreamJpeg, r) {
+    for (const char* path : { "images/mandrill_512_q075.jpg", "images/color_wheel.jpg" }) {
+        sk_sp<SkData> file = GetResourceAsData(path);
+        if (!file) {
+            continue;
+        }
+        SkBitmap truth;
+        if (!create_truth(file, &truth)) {
+            ERRORF(r, "Failed to decode %s", path);
+            continue;
+        }
+
+        PartialFeed feed(file, file->size() / 2, true);
+        auto codec = SkCodec::MakeFromStream(feed.releaseStream());
+        if (!codec) {
+            ERRORF(r, "Failed to create codec for %s", path);
+            continue;
+        }
+        SkBitmap bm;
+        bm.allocPixels(truth.info());
+        if (SkCodec::kSuccess != codec->startScanlineDecode(bm.info())) {
+            ERRORF(r, "Failed to start scanline decode of %s", path);
+            continue;
+        }
+        for (int y = 0; y < bm.height(); y++) {
+            feed.addNewData(1000);
+            REPORTER_ASSERT(r, 1 == codec->getScanlines(bm.getAddr(0, y), 1, bm.rowBytes()));
+        }
+        REPORTER_ASSERT(r, feed.isAllDataReceived());
+        compare_bitmaps(r, truth, bm);
+    }
+}
+
+// A codec reading from memory picks up data that arrives after it was created.
+DEF_TEST(Codec_partialDataStreamGrows, r) {
+    for (const char* path : { "images/mandrill_512_q075.jpg", "images/color_wheel.gif" }) {
+        sk_sp<SkData> file = GetResourceAsData(path);
+        if (!file) {
+            continue;
+        }
+        SkBitmap truth;
+        if (!create_truth(file, &truth)) {
+            ERRORF(r, "Failed to decode %s", path);
+            continue;
+        }
+
+        auto stream = SkPartialDataStream::Make(file->size());
+        SkPartialDataStream* streamPtr = stream.get();
+        REPORTER_ASSERT(r, streamPtr->append(file->data(), file->size() / 2) == file->size() / 2);
+        auto codec = SkCodec::MakeFromStream(std::move(stream));
+        if (!codec) {
+            ERRORF(r, "Failed to create codec for %s", path);
+            continue;
+        }
+
+        const size_t rest = file->size() - streamPtr->bytesReceived();
+        REPORTER_ASSERT(r, streamPtr->append(file->bytes() + file->size() / 2, rest + 1) == rest);
+        REPORTER_ASSERT(r, streamPtr->isComplete());
+
+        SkBitmap bm;
+        bm.allocPixels(truth.info());
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(bm.pixmap()));
+        compare_bitmaps(r, truth, bm);
+    }
+}
+
 DEF_TEST(Codec_partialWuffs, r) {
     const char* path = "images/alphabetAnim.gif";
     auto file = GetResourceAsData(path);
@@ -13,6 +13,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkImageInfo.h"
@@ -25,6 +26,7 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/core/SkUnPreMultiply.h"
+#include "include/core/SkYUVASizeInfo.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
@@ -33,6 +35,7 @@
 #include "include/utils/SkFrontBufferedStream.h"
 #include "include/utils/SkRandom.h"
 #include "src/codec/SkCodecImageGenerator.h"
+#include "src/codec/SkPngCodec.h"
 #include "src/core/SkAutoMalloc.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkMD5.h"
@@ -1008,6 +1011,169 @@ DEF_TEST(Codec_jpeg_rewind, r) {
     REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
 }
 
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DEF_TEST(Codec_jpeg_executor, r) {
+    // This image has a restart marker after every MCU row, and an ICC profile.
+    auto data = GetResourceAsData("images/icc-v2-gbr.jpg");
+    if (!data) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+
+    for (float scale : { 1.0f, 0.5f, 0.375f }) {
+        SkISize dims = codec->getScaledDimensions(scale);
+        for (SkColorType ct : { kN32_SkColorType, kRGBA_F16_SkColorType, kRGB_565_SkColorType }) {
+            auto info = codec->getInfo().makeWH(dims.width(), dims.height()).makeColorType(ct);
+            if (kRGB_565_SkColorType == ct) {
+                info = info.makeColorSpace(nullptr);
+            }
+            SkBitmap serial, banded;
+            serial.allocPixels(info);
+            banded.allocPixels(info);
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(serial.pixmap()));
+
+            SkCodec::Options options;
+            options.fExecutor = executor.get();
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(banded.pixmap(), &options));
+            REPORTER_ASSERT(r, same_pixels(serial, banded), "scale %g, color type %d", scale, ct);
+        }
+    }
+
+    codec = SkCodec::MakeFromData(data);
+    SkYUVASizeInfo sizeInfo;
+    REPORTER_ASSERT(r, codec->queryYUV8(&sizeInfo, nullptr));
+    SkAutoMalloc serial(sizeInfo.computeTotalBytes()),
+                 banded(sizeInfo.computeTotalBytes());
+    void* serialPlanes[SkYUVASizeInfo::kMaxCount];
+    void* bandedPlanes[SkYUVASizeInfo::kMaxCount];
+    sizeInfo.computePlanes(serial.get(), serialPlanes);
+    sizeInfo.computePlanes(banded.get(), bandedPlanes);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(sizeInfo, serialPlanes));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(sizeInfo, bandedPlanes,
+                                                                 executor.get()));
+    REPORTER_ASSERT(r, !memcmp(serial.get(), banded.get(), sizeInfo.computeTotalBytes()));
+
+    // Images without restart markers, or which need a swizzler, still decode serially.
+    for (const char* path : { "images/mandrill_512_q075.jpg", "images/mandrill_cmyk.jpg" }) {
+        codec = SkCodec::MakeFromData(GetResourceAsData(path));
+        SkBitmap serial, banded;
+        serial.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+        banded.allocPixels(serial.info());
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(serial.pixmap()));
+
+        SkCodec::Options options;
+        options.fExecutor = executor.get();
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(banded.pixmap(), &options));
+        REPORTER_ASSERT(r, same_pixels(serial, banded), "%s", path);
+    }
+}
+
+// Tall enough for several deflate blocks, with rows that use every filter.
+static sk_sp<SkData> make_tall_png(SkColorType colorType, SkAlphaType alphaType,
+                                   uint32_t seed = 0) {
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::Make(123, 700, colorType, alphaType));
+    SkBitmap src;
+    src.allocN32Pixels(bm.width(), bm.height());
+    SkRandom rand(seed);
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) {
+            const U8CPU a = kOpaque_SkAlphaType == alphaType ? 0xFF : 0x80 | (rand.nextU() & 0x7F);
+            *src.getAddr32(x, y) = SkPreMultiplyARGB(a, x * 2 + (rand.nextU() & 7), y / 3,
+                                                     rand.nextU() & 0xFF);
+        }
+    }
+    SkAssertResult(src.readPixels(bm.pixmap()));
+
+    SkDynamicMemoryWStream stream;
+    SkAssertResult(SkPngEncoder::Encode(&stream, bm.pixmap(), SkPngEncoder::Options()));
+    return stream.detachAsData();
+}
+
+static SkBitmap decode_subset(SkAndroidCodec* codec, SkIRect subset, int sampleSize) {
+    SkAndroidCodec::AndroidOptions options;
+    options.fSubset = &subset;
+    options.fSampleSize = sampleSize;
+    SkISize dims = codec->getSampledSubsetDimensions(sampleSize, subset);
+    SkBitmap bm;
+    bm.allocPixels(codec->getInfo().makeWH(dims.width(), dims.height())
+                                    .makeColorType(kN32_SkColorType)
+                                    .makeAlphaType(kPremul_SkAlphaType));
+    if (SkCodec::kSuccess != codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                     &options)) {
+        bm.reset();
+    }
+    return bm;
+}
+
+DEF_TEST(Codec_pngIndex, r) {
+    const struct {
+        SkColorType fColorType;
+        SkAlphaType fAlphaType;
+    } kFormats[] = {
+        { kN32_SkColorType,       kOpaque_SkAlphaType   },  // RGB
+        { kN32_SkColorType,       kPremul_SkAlphaType   },  // RGBA
+        { kRGBA_F16_SkColorType,  kPremul_SkAlphaType   },  // 16-bit RGBA
+        { kGray_8_SkColorType,    kOpaque_SkAlphaType   },
+    };
+    const SkIRect kSubsets[] = {
+        SkIRect::MakeXYWH(0, 0, 123, 40),
+        SkIRect::MakeXYWH(10, 333, 64, 50),
+        SkIRect::MakeXYWH(0, 693, 123, 7),
+    };
+
+    for (const auto& format : kFormats) {
+        sk_sp<SkData> data = make_tall_png(format.fColorType, format.fAlphaType);
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        sk_sp<SkData> index = static_cast<SkPngCodec*>(codec.get())->buildIndex(16);
+        if (!index) {
+            ERRORF(r, "Could not index color type %d", format.fColorType);
+            continue;
+        }
+
+        // A later codec for the same image can use the serialized index.
+        std::unique_ptr<SkCodec> reloaded = SkCodec::MakeFromData(data);
+        REPORTER_ASSERT(r, static_cast<SkPngCodec*>(reloaded.get())->setIndex(*index));
+
+        auto plain   = SkAndroidCodec::MakeFromData(data),
+             indexed = SkAndroidCodec::MakeFromCodec(std::move(codec)),
+             loaded  = SkAndroidCodec::MakeFromCodec(std::move(reloaded));
+        for (const SkIRect& subset : kSubsets) {
+            for (int sampleSize : { 1, 2, 3 }) {
+                SkBitmap expected = decode_subset(plain.get(), subset, sampleSize);
+                REPORTER_ASSERT(r, !expected.drawsNothing());
+                for (SkAndroidCodec* codec : { indexed.get(), loaded.get() }) {
+                    SkBitmap actual = decode_subset(codec, subset, sampleSize);
+                    REPORTER_ASSERT(r, !actual.drawsNothing() && same_pixels(expected, actual),
+                                    "color type %d, subset y %d, sample size %d",
+                                    format.fColorType, subset.top(), sampleSize);
+                }
+            }
+        }
+
+        // An index does not apply to any other image.
+        sk_sp<SkData> other = make_tall_png(format.fColorType, format.fAlphaType, 1);
+        codec = SkCodec::MakeFromData(other);
+        REPORTER_ASSERT(r, !static_cast<SkPngCodec*>(codec.get())->setIndex(*index));
+    }
+
+    // Interlaced images cannot be indexed.
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(
+            GetResourceAsData("images/plane_interlaced.png"));
+    if (codec) {
+        REPORTER_ASSERT(r, !static_cast<SkPngCodec*>(codec.get())->buildIndex(1));
+    }
+}
+
 static void check_color_xform(skiatest::Reporter* r, const char* path) {
     std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromStream(GetResourceAsStream(path)));
 
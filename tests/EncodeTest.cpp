@@ -11,6 +11,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
@@ -291,6 +292,44 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngBands, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+
+    // Unpremul RGBA exercises the 4 byte per pixel path as well as the opaque 3 byte one.
+    SkBitmap unpremul;
+    unpremul.allocPixels(bitmap.info().makeAlphaType(kUnpremul_SkAlphaType));
+    unpremul.eraseColor(0x80FF0000);
+    unpremul.writePixels(bitmap.pixmap(), 0, 0);
+    unpremul.erase(0x00000000, SkIRect::MakeWH(128, 512));
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const SkBitmap* src : { &bitmap, &unpremul }) {
+        for (auto filters : { SkPngEncoder::FilterFlag::kAll,
+                              SkPngEncoder::FilterFlag::kNone,
+                              SkPngEncoder::FilterFlag::kPaeth }) {
+            SkPngEncoder::Options options;
+            options.fFilterFlags = filters;
+
+            SkDynamicMemoryWStream serialDst, bandedDst;
+            REPORTER_ASSERT(r, SkPngEncoder::Encode(&serialDst, src->pixmap(), options));
+            options.fExecutor = executor.get();
+            REPORTER_ASSERT(r, SkPngEncoder::Encode(&bandedDst, src->pixmap(), options));
+
+            sk_sp<SkData> serial = serialDst.detachAsData(),
+                          banded = bandedDst.detachAsData();
+            REPORTER_ASSERT(r, banded->size() < serial->size() + serial->size() / 50);
+
+            SkBitmap serialBm, bandedBm;
+            SkImage::MakeFromEncoded(serial)->asLegacyBitmap(&serialBm);
+            SkImage::MakeFromEncoded(banded)->asLegacyBitmap(&bandedBm);
+            REPORTER_ASSERT(r, almost_equals(serialBm, bandedBm, 0));
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
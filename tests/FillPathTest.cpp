@@ -5,9 +5,14 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkRegion.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlitter.h"
+#include "src/core/SkMask.h"
 #include "src/core/SkScan.h"
 #include "tests/Test.h"
 
@@ -46,3 +51,167 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+// Fills path without anti-aliasing, scaled up by scale.
+static SkBitmap supersample_path_a8(const SkPath& path, int scale) {
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeA8(200 * scale, 150 * scale));
+    bm.eraseColor(SK_ColorTRANSPARENT);
+    SkPaint paint;
+    SkCanvas canvas(bm);
+    canvas.scale(scale, scale);
+    canvas.drawPath(path, paint);
+    return bm;
+}
+
+// Writes coverage straight into an A8 pixmap, and notes whether every row arrived once, top to
+// bottom, through blitAntiH(), as run-length encoding blitters like SkAAClip's builder need.
+struct A8CoverageBlitter : public SkBlitter {
+    explicit A8CoverageBlitter(const SkPixmap& dst) : fDst(dst) {}
+
+    void blitH(int x, int y, int width) override {
+        fOnlyAntiH = false;
+        memset(fDst.writable_addr8(x, y), 0xFF, width);
+    }
+
+    void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override {
+        fRowsInOrder &= y > fLastY;
+        fLastY = y;
+        for (int n; (n = runs[0]) > 0; runs += n, antialias += n, x += n) {
+            memset(fDst.writable_addr8(x, y), antialias[0], n);
+        }
+    }
+
+    void blitV(int x, int y, int height, SkAlpha alpha) override {
+        fOnlyAntiH = false;
+        INHERITED::blitV(x, y, height, alpha);
+    }
+
+    void blitRect(int x, int y, int width, int height) override {
+        fOnlyAntiH = false;
+        INHERITED::blitRect(x, y, width, height);
+    }
+
+    void blitMask(const SkMask& mask, const SkIRect& clip) override {
+        fOnlyAntiH = false;
+        INHERITED::blitMask(mask, clip);
+    }
+
+    SkPixmap fDst;
+    int      fLastY = -1;
+    bool     fRowsInOrder = true;
+    bool     fOnlyAntiH = true;
+
+    typedef SkBlitter INHERITED;
+};
+
+// Fills path with sparse strips.  If rleFriendly is not null, sets it to whether the rows arrived
+// the way run-length encoding blitters need.
+static SkBitmap sparse_strip_fill_a8(const SkPath& path, bool forceRLE,
+                                     bool* rleFriendly = nullptr) {
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeA8(200, 150));
+    bm.eraseColor(SK_ColorTRANSPARENT);
+    A8CoverageBlitter blitter(bm.pixmap());
+    SkScan::SparseStripFillPath(path, &blitter, path.getBounds().roundOut(),
+                                SkIRect::MakeWH(bm.width(), bm.height()), forceRLE);
+    if (rleFriendly) {
+        *rleFriendly = blitter.fRowsInOrder && blitter.fOnlyAntiH;
+    }
+    return bm;
+}
+
+// Sparse strips compute exact area coverage, so they should match a finely supersampled
+// non-AA fill, except where more than one edge crosses a pixel.
+DEF_TEST(FillPathSparseStrips, reporter) {
+    SkRandom rand;
+
+    // Short edges, like a detailed map outline, wandering a little past every side.
+    SkPath walk;
+    SkPoint p = { 100, 75 };
+    walk.moveTo(p);
+    for (int i = 0; i < 1000; i++) {
+        p.offset(rand.nextRangeF(-3, 3), rand.nextRangeF(-3, 3));
+        p.set(SkTPin(p.fX, -10.0f, 210.0f), SkTPin(p.fY, -10.0f, 160.0f));
+        walk.lineTo(p);
+    }
+    walk.close();
+
+    SkPath star;
+    for (int i = 0; i < 7; i++) {
+        SkScalar t = SK_ScalarPI * 6 * i / 7;
+        star.lineTo(100.3f + 110 * SkScalarSin(t), 75.2f - 80 * SkScalarCos(t));
+    }
+    star.close();
+
+    SkPath curves;
+    curves.addCircle(60, 60, 50);
+    curves.addCircle(110, 80, 60);
+    curves.addOval({-30, 100, 90, 180});
+    curves.moveTo(10, 140);
+    curves.cubicTo(250, -80, -50, -80, 190, 140);
+    curves.conicTo(100, 10, 10, 140, 0.5f);
+
+    SkPath small;
+    small.addRect({10.25f, 20.5f, 10.75f, 60});
+    small.addRect({30.1f, 40.1f, 33.3f, 40.9f});
+
+    for (const SkPath& base : {walk, star, curves, small}) {
+        for (SkPath::FillType fill : {SkPath::kWinding_FillType, SkPath::kEvenOdd_FillType}) {
+            SkPath path = base;
+            path.setFillType(fill);
+
+            constexpr int kScale = 16;
+            SkBitmap supersampled = supersample_path_a8(path, kScale);
+            SkBitmap actual = sparse_strip_fill_a8(path, false);
+
+            int worst = 0, mismatches = 0;
+            for (int y = 0; y < actual.height(); y++) {
+                for (int x = 0; x < actual.width(); x++) {
+                    int sum = 0;
+                    for (int sy = 0; sy < kScale; sy++) {
+                        for (int sx = 0; sx < kScale; sx++) {
+                            sum += *supersampled.getAddr8(x * kScale + sx, y * kScale + sy);
+                        }
+                    }
+                    int diff = SkTAbs(sum / (kScale * kScale) - *actual.getAddr8(x, y));
+                    worst = SkTMax(worst, diff);
+                    mismatches += diff > 16;
+                }
+            }
+            // Pixels crossed by several edges can legitimately be far off.
+            REPORTER_ASSERT(reporter, mismatches <= actual.width() * actual.height() / 100,
+                            "fill %d, %d pixels differ by more than 16, worst %d",
+                            fill, mismatches, worst);
+        }
+    }
+}
+
+// SkAAClip fills with forceRLE, building its runs row by row from blitAntiH(); sparse strips must
+// give it the same coverage they draw, in a form it can take.
+DEF_TEST(FillPathSparseStripsRLE, reporter) {
+    SkRandom rand;
+    SkPath path;
+    SkPoint p = { 100, 75 };
+    path.moveTo(p);
+    for (int i = 0; i < 1000; i++) {
+        p.offset(rand.nextRangeF(-3, 3), rand.nextRangeF(-3, 3));
+        p.set(SkTPin(p.fX, 5.0f, 195.0f), SkTPin(p.fY, 5.0f, 145.0f));
+        path.lineTo(p);
+    }
+    path.close();
+    path.addCircle(60.3f, 50.6f, 40);
+
+    bool rleFriendly = false;
+    SkBitmap drawn = sparse_strip_fill_a8(path, false),
+             rle   = sparse_strip_fill_a8(path, true, &rleFriendly);
+    REPORTER_ASSERT(reporter, rleFriendly);
+
+    int mismatches = 0;
+    for (int y = 0; y < drawn.height(); y++) {
+        for (int x = 0; x < drawn.width(); x++) {
+            mismatches += *drawn.getAddr8(x, y) != *rle.getAddr8(x, y);
+        }
+    }
+    REPORTER_ASSERT(reporter, mismatches == 0, "%d pixels differ", mismatches);
+}
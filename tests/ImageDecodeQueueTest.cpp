@@ -0,0 +1,153 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageGenerator.h"
+#include "include/utils/SkImageDecodeQueue.h"
+#include "src/core/SkBitmapCache.h"
+#include "src/core/SkMakeUnique.h"
+#include "src/core/SkMipMap.h"
+#include "tests/Test.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+
+namespace {
+
+class CountingGenerator : public SkImageGenerator {
+public:
+    CountingGenerator(SkColor color, std::atomic<int>* count)
+        : SkImageGenerator(SkImageInfo::MakeN32Premul(64, 64))
+        , fColor(color)
+        , fCount(count) {}
+
+protected:
+    bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                     const Options&) override {
+        (*fCount)++;
+        SkBitmap bm;
+        bm.installPixels(info, pixels, rowBytes);
+        bm.eraseColor(fColor);
+        return true;
+    }
+
+private:
+    SkColor           fColor;
+    std::atomic<int>* fCount;
+};
+
+// Runs work only when the test (or SkTaskGroup::wait()) asks it to.
+class ManualExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { fWork.push_back(std::move(work)); }
+
+    void borrow() override { this->runOne(); }
+
+    bool runOne() {
+        if (fWork.empty()) {
+            return false;
+        }
+        auto work = std::move(fWork.front());
+        fWork.pop_front();
+        work();
+        return true;
+    }
+
+private:
+    std::deque<std::function<void(void)>> fWork;
+};
+
+}  // namespace
+
+static sk_sp<SkImage> make_counting_image(SkColor color, std::atomic<int>* count) {
+    return SkImage::MakeFromGenerator(skstd::make_unique<CountingGenerator>(color, count));
+}
+
+DEF_TEST(ImageDecodeQueue_priority, r) {
+    ManualExecutor executor;
+    std::atomic<int> counts[3] = {{0}, {0}, {0}};
+    sk_sp<SkImage> images[3];
+    for (int i = 0; i < 3; ++i) {
+        images[i] = make_counting_image(SK_ColorBLUE, &counts[i]);
+    }
+
+    SkImageDecodeQueue queue(&executor);
+    queue.request(images[0], 0);
+    queue.request(images[1], 5);
+    queue.request(images[2], 1);
+    SkBitmap raster;
+    raster.allocN32Pixels(8, 8);
+    queue.request(SkImage::MakeFromBitmap(raster), 9);     // Not lazy, so ignored.
+    REPORTER_ASSERT(r, queue.countQueued() == 3);
+
+    REPORTER_ASSERT(r, executor.runOne());
+    REPORTER_ASSERT(r, counts[0] == 0 && counts[1] == 1 && counts[2] == 0);
+
+    REPORTER_ASSERT(r, queue.setPriority(images[0].get(), 10));
+    REPORTER_ASSERT(r, !queue.setPriority(images[1].get(), 10));
+    REPORTER_ASSERT(r, executor.runOne());
+    REPORTER_ASSERT(r, counts[0] == 1 && counts[1] == 1 && counts[2] == 0);
+
+    REPORTER_ASSERT(r, queue.cancel(images[2].get()));
+    REPORTER_ASSERT(r, !queue.cancel(images[2].get()));
+    REPORTER_ASSERT(r, queue.countQueued() == 0);
+    queue.wait();
+    REPORTER_ASSERT(r, counts[2] == 0);
+
+    // Drawing a decoded image does not decode it again.
+    SkBitmap dst;
+    dst.allocN32Pixels(64, 64);
+    SkCanvas canvas(dst);
+    canvas.drawImage(images[1], 0, 0);
+    REPORTER_ASSERT(r, counts[1] == 1);
+    REPORTER_ASSERT(r, dst.getColor(10, 10) == SK_ColorBLUE);
+
+    canvas.drawImage(images[2], 0, 0);
+    REPORTER_ASSERT(r, counts[2] == 1);
+}
+
+DEF_TEST(ImageDecodeQueue_mipmaps, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    std::atomic<int> fullCount{0}, mipCount{0};
+    sk_sp<SkImage> full = make_counting_image(SK_ColorRED, &fullCount),
+                   mip  = make_counting_image(SK_ColorRED, &mipCount);
+    {
+        SkImageDecodeQueue queue(executor.get());
+        queue.request(full, 0, {64, 64});
+        queue.request(mip,  0, {16, 16});
+        queue.request(mip,  0, {16, 16});    // Already queued.
+        queue.wait();
+    }
+    REPORTER_ASSERT(r, fullCount == 1 && mipCount == 1);
+
+    SkBitmap bm;
+    REPORTER_ASSERT(r, SkBitmapCache::Find(SkBitmapCacheDesc::Make(full.get()), &bm));
+    REPORTER_ASSERT(r, SkBitmapCache::Find(SkBitmapCacheDesc::Make(mip.get()), &bm));
+
+    const SkMipMap* mips = SkMipMapCache::FindAndRef(SkBitmapCacheDesc::Make(full.get()));
+    REPORTER_ASSERT(r, !mips);
+    SkSafeUnref(mips);
+    mips = SkMipMapCache::FindAndRef(SkBitmapCacheDesc::Make(mip.get()));
+    REPORTER_ASSERT(r, mips);
+    SkSafeUnref(mips);
+}
+
+DEF_TEST(ImageDecodeQueue_destroy, r) {
+    ManualExecutor executor;
+    std::atomic<int> count{0};
+    {
+        SkImageDecodeQueue queue(&executor);
+        queue.request(make_counting_image(SK_ColorGREEN, &count));
+        queue.request(make_counting_image(SK_ColorGREEN, &count));
+        // The queue's destructor cancels both requests, then runs their (now empty) tasks.
+    }
+    REPORTER_ASSERT(r, count == 0);
+    REPORTER_ASSERT(r, !executor.runOne());
+}
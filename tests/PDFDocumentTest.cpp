@@ -6,16 +6,28 @@
  */
 #include "tests/Test.h"
 
+#include "include/core/SkAnnotation.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkMaskFilter.h"
+#include "include/core/SkPathEffect.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/private/SkTo.h"
 #include "src/core/SkOSFile.h"
+#include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/utils/SkOSPath.h"
+#include "tools/ProcStats.h"
 #include "tools/Resources.h"
 
 #include "tools/ToolUtils.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
 
@@ -256,3 +268,338 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+namespace {
+// Tracks how many pages are inside PageOverlapPathEffect::onFilterPath at once.
+struct PageOverlap {
+    std::atomic<int> fInside{0};
+    std::atomic<bool> fOverlapped{false};
+    bool fWait = false;
+};
+
+// Leaves paths untouched, but while fWait is set the first page to get here holds its
+// thread until some other page is being drawn at the same time (or five seconds pass).
+class PageOverlapPathEffect final : public SkPathEffect {
+public:
+    explicit PageOverlapPathEffect(PageOverlap* overlap) : fOverlap(overlap) {}
+
+    Factory getFactory() const override { return nullptr; }
+    const char* getTypeName() const override { return "PageOverlapPathEffect"; }
+
+protected:
+    bool onFilterPath(SkPath* dst, const SkPath& src, SkStrokeRec*,
+                      const SkRect*) const override {
+        if (fOverlap->fInside.fetch_add(1) > 0) {
+            fOverlap->fOverlapped = true;
+        } else if (fOverlap->fWait) {
+            for (int i = 0; i < 500 && !fOverlap->fOverlapped; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        fOverlap->fInside.fetch_sub(1);
+        *dst = src;
+        return true;
+    }
+
+private:
+    PageOverlap* fOverlap;
+};
+}  // namespace
+
+static sk_sp<SkData> make_concurrent_pages_document(SkExecutor* executor,
+                                                    PageOverlap* overlap) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(32, 32);
+    bitmap.eraseColor(0x4F9643A0);
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+    const SkPoint gradientPoints[2] = {{0, 0}, {100, 100}};
+    const SkColor gradientColors[2] = {SK_ColorBLUE, SK_ColorYELLOW};
+
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    metadata.fConcurrentPages = true;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int i = 0; i < 20; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        SkPaint paint;
+        paint.setColor(SkColorSetARGB(0xFF, 0x00, (uint8_t)(12 * i), 0x00));
+        paint.setPathEffect(sk_make_sp<PageOverlapPathEffect>(overlap));
+        canvas->drawPath(SkPath().addOval({36, 36, 300, 300}), paint);
+        paint.setPathEffect(nullptr);
+        paint.setAlphaf(0.5f);
+        canvas->drawCircle(300, 400, 10.0f * (i + 1), paint);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(3);
+        canvas->drawRect({320, 320, 400, 400}, paint);
+        canvas->drawString("Page", 36, 700, SkFont(nullptr, 10.0f + i), SkPaint());
+        canvas->drawImage(image, 400, 36);
+
+        SkPaint blurPaint;
+        blurPaint.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 2.0f + i));
+        canvas->drawRect({36, 500, 136, 600}, blurPaint);
+
+        SkPaint gradientPaint;
+        gradientPaint.setShader(SkGradientShader::MakeLinear(
+                gradientPoints, gradientColors, nullptr, 2, SkTileMode::kClamp));
+        canvas->drawRect({200, 500, 300, 600}, gradientPaint);
+
+        SkPaint layerPaint;
+        layerPaint.setBlendMode(SkBlendMode::kLuminosity);
+        canvas->saveLayer(nullptr, &layerPaint);
+        canvas->drawColor(SkColorSetARGB(0x80, 0xFF, 0x00, (uint8_t)(12 * i)));
+        canvas->restore();
+
+        sk_sp<SkData> url = SkData::MakeWithCString("https://skia.org");
+        SkAnnotateRectWithURL(canvas, {36, 36, 300, 300}, url.get());
+        SkString name = SkStringPrintf("page%d", i);
+        sk_sp<SkData> here = SkData::MakeWithCString(name.c_str());
+        SkAnnotateNamedDestination(canvas, {36, 36}, here.get());
+        SkString prev = SkStringPrintf("page%d", i > 0 ? i - 1 : 0);
+        sk_sp<SkData> there = SkData::MakeWithCString(prev.c_str());
+        SkAnnotateLinkToDestination(canvas, {36, 740, 136, 760}, there.get());
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Pages drawn concurrently come out the same whatever the number of threads.
+DEF_TEST(SkPDF_concurrent_pages, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_concurrent_pages, r);
+    std::unique_ptr<SkExecutor> oneThread = SkExecutor::MakeFIFOThreadPool(1),
+                                fourThreads = SkExecutor::MakeFIFOThreadPool(4);
+    PageOverlap serial;
+    sk_sp<SkData> expected = make_concurrent_pages_document(oneThread.get(), &serial);
+    REPORTER_ASSERT(r, contains(expected->bytes(), expected->size(), "/Count 20"));
+    REPORTER_ASSERT(r, !serial.fOverlapped);
+    for (int i = 0; i < 4; ++i) {
+        PageOverlap parallel;
+        parallel.fWait = true;
+        sk_sp<SkData> actual = make_concurrent_pages_document(fourThreads.get(), &parallel);
+        REPORTER_ASSERT(r, parallel.fOverlapped);
+        REPORTER_ASSERT(r, actual->equals(expected.get()));
+    }
+    PageOverlap inlinedOverlap;
+    sk_sp<SkData> inlined = make_concurrent_pages_document(&SkExecutor::GetDefault(),
+                                                           &inlinedOverlap);
+    REPORTER_ASSERT(r, inlined->equals(expected.get()));
+}
+
+DEF_TEST(SkPDF_concurrent_pages_abort, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_concurrent_pages_abort, r);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool();
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor.get();
+    metadata.fConcurrentPages = true;
+    SkNullWStream dst;
+    auto doc = SkPDF::MakeDocument(&dst, metadata);
+    for (int i = 0; i < 10; ++i) {
+        doc->beginPage(612, 792)->drawColor(SK_ColorRED);
+    }
+    doc->abort();
+}
+
+static sk_sp<SkData> make_small_objects_document(bool objectStreams) {
+    SkPDF::Metadata metadata;
+    metadata.fObjectStreams = objectStreams;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int i = 0; i < 10; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        for (int j = 0; j < 30; ++j) {
+            SkPaint paint;
+            paint.setAlpha(SkToU8(8 * j + i));
+            SkRect rect = SkRect::MakeXYWH(20 * j, 20 * j, 20, 20);
+            canvas->drawRect(rect, paint);
+            sk_sp<SkData> url = SkData::MakeWithCString("https://skia.org");
+            SkAnnotateRectWithURL(canvas, rect, url.get());
+        }
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+DEF_TEST(SkPDF_object_streams, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_object_streams, r);
+    sk_sp<SkData> classic = make_small_objects_document(false),
+                  packed  = make_small_objects_document(true);
+    REPORTER_ASSERT(r, contains(classic->bytes(), classic->size(), "%PDF-1.4"));
+    REPORTER_ASSERT(r, contains(classic->bytes(), classic->size(), "\ntrailer\n"));
+    REPORTER_ASSERT(r, contains(packed->bytes(), packed->size(), "%PDF-1.5"));
+    REPORTER_ASSERT(r, contains(packed->bytes(), packed->size(), "/Type /ObjStm"));
+    REPORTER_ASSERT(r, contains(packed->bytes(), packed->size(), "/Type /XRef"));
+    REPORTER_ASSERT(r, !contains(packed->bytes(), packed->size(), "\ntrailer\n"));
+    REPORTER_ASSERT(r, !contains(packed->bytes(), packed->size(), "/Subtype /Link"));
+    REPORTER_ASSERT(r, packed->size() < classic->size());
+    INFOF(r, "Object streams: %zu bytes, down from %zu.\n", packed->size(), classic->size());
+}
+
+static int count(const SkData& data, const char needle[]) {
+    const size_t len = strlen(needle);
+    int n = 0;
+    for (size_t i = 0; i + len <= data.size(); ++i) {
+        if (0 == memcmp(data.bytes() + i, needle, len)) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+static void draw_streaming_page(SkCanvas* canvas, const SkFont& font, int i) {
+    SkPaint paint;
+    const SkPoint points[2] = {{36, 36}, {300, 300}};
+    const SkColor colors[2] = {SkColorSetRGB(i & 0xFF, (i >> 8) & 0xFF, 0), SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2, SkTileMode::kClamp));
+    canvas->drawRect({36, 36, 300, 300}, paint);
+    paint.setShader(nullptr);
+    paint.setAlpha(i & 0xFF);
+    canvas->drawCircle(300, 400, 50, paint);
+    SkPaint stroke;
+    stroke.setStyle(SkPaint::kStroke_Style);
+    canvas->drawLine(36, 600, 576, 600, stroke);
+    canvas->drawString("Streaming", 36, 700, font, SkPaint());
+}
+
+static bool forgot_fonts_and_graphic_states(SkDocument* doc) {
+    SkPDFDocument* pdf = static_cast<SkPDFDocument*>(doc);
+    return pdf->fFontMap.count() == 0 && pdf->fFillGSMap.count() == 0 &&
+           pdf->fStrokeGSMap.count() == 0 && pdf->fGradientPatternMap.count() == 0 &&
+           pdf->fImageShaderMap.count() == 0;
+}
+
+static sk_sp<SkData> make_streaming_document(skiatest::Reporter* r, int chunkSize) {
+    SkPDF::Metadata metadata;
+    metadata.fStreamingChunkSize = chunkSize;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+    for (int i = 0; i < 41; ++i) {
+        draw_streaming_page(doc->beginPage(612, 792), font, i);
+        doc->endPage();
+        if (chunkSize > 0 && (i + 1) % chunkSize == 0) {
+            REPORTER_ASSERT(r, forgot_fonts_and_graphic_states(doc.get()));
+        }
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+DEF_TEST(SkPDF_streaming, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming, r);
+    sk_sp<SkData> classic  = make_streaming_document(r, 0),
+                  streamed = make_streaming_document(r, 8);
+    REPORTER_ASSERT(r, contains(classic->bytes(), classic->size(), "/Count 41"));
+    REPORTER_ASSERT(r, contains(streamed->bytes(), streamed->size(), "/Count 41"));
+    REPORTER_ASSERT(r, count(*classic, "/Type /Page\n") == 41);
+    REPORTER_ASSERT(r, count(*streamed, "/Type /Page\n") == 41);
+    // Each of the six chunks of pages gets its own fonts.
+    int fonts = count(*classic, "/Type /Font\n");
+    REPORTER_ASSERT(r, fonts > 0);
+    REPORTER_ASSERT(r, count(*streamed, "/Type /Font\n") == 6 * fonts);
+}
+
+// Checks that the fonts, graphic states and shaders used by each chunk of pages are kept
+// until the chunk ends and are then forgotten.
+DEF_TEST(SkPDF_streaming_forgets_chunks, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming_forgets_chunks, r);
+    constexpr int kChunkSize = 4;
+    SkPDF::Metadata metadata;
+    metadata.fStreamingChunkSize = kChunkSize;
+    SkNullWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    SkPDFDocument* pdf = static_cast<SkPDFDocument*>(doc.get());
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+    for (int i = 0; i < 3 * kChunkSize; ++i) {
+        draw_streaming_page(doc->beginPage(612, 792), font, i);
+        doc->endPage();
+        if ((i + 1) % kChunkSize == 0) {
+            REPORTER_ASSERT(r, forgot_fonts_and_graphic_states(doc.get()));
+        } else {
+            REPORTER_ASSERT(r, pdf->fFontMap.count() == 1);
+            REPORTER_ASSERT(r, pdf->fFillGSMap.count() > 0);
+            REPORTER_ASSERT(r, pdf->fStrokeGSMap.count() > 0);
+            REPORTER_ASSERT(r, pdf->fGradientPatternMap.count() > 0);
+        }
+    }
+    doc->close();
+    REPORTER_ASSERT(r, stream.bytesWritten() > 0);
+}
+
+#ifdef SK_PDF_ENABLE_SLOW_TESTS
+// Streams a document with many pages, checking that the document forgets what each chunk of
+// pages used, and reports how the resident set size changes.
+DEF_TEST(SkPDF_streaming_memory, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming_memory, r);
+    constexpr int kPageCount = 5000;
+    constexpr int kChunkSize = 50;
+    SkPDF::Metadata metadata;
+    metadata.fStreamingChunkSize = kChunkSize;
+    SkNullWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+    int startRSS = -1;
+    for (int i = 0; i < kPageCount; ++i) {
+        draw_streaming_page(doc->beginPage(612, 792), font, i);
+        doc->endPage();
+        if ((i + 1) % kChunkSize == 0) {
+            REPORTER_ASSERT(r, forgot_fonts_and_graphic_states(doc.get()));
+        }
+        if (i + 1 == kChunkSize) {
+            startRSS = sk_tools::getCurrResidentSetSizeMB();
+        }
+    }
+    int endRSS = sk_tools::getCurrResidentSetSizeMB();
+    doc->close();
+    REPORTER_ASSERT(r, stream.bytesWritten() > 0);
+    INFOF(r, "Streaming %d pages: resident set %d MB after the first chunk, %d MB at the end, "
+             "%d MB at peak.\n", kPageCount, startRSS, endRSS, sk_tools::getMaxResidentSetSizeMB());
+}
+#endif
+
+static sk_sp<SkImage> make_raster_image(SkColor color, bool marked = false) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(color);
+    bitmap.erase(SK_ColorWHITE, {8, 8, 24, 24});
+    if (marked) {
+        // Off the grid of pixels that SkPDFMakeImageContentKey() samples.
+        bitmap.erase(SK_ColorBLACK, {1, 1, 2, 2});
+    }
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
+}
+
+// Separate SkImages with the same contents share one XObject.
+DEF_TEST(SkPDF_image_dedup, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_image_dedup, r);
+    sk_sp<SkData> jpegData = GetResourceAsData("images/mandrill_512_q075.jpg");
+    bool hasJpeg = jpegData && SkImage::MakeFromEncoded(jpegData);
+    sk_sp<SkData> pngData = GetResourceAsData("images/mandrill_128.png");
+    bool hasPng = pngData && SkImage::MakeFromEncoded(pngData);
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream);
+    for (int i = 0; i < 4; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawImage(make_raster_image(SK_ColorRED), 0, 0);
+        canvas->drawImage(make_raster_image(i < 2 ? SK_ColorGREEN : SK_ColorBLUE), 100, 0);
+        // Subsets with the same size but different pixels are different images.
+        sk_sp<SkImage> red = make_raster_image(SK_ColorRED);
+        canvas->drawImage(red->makeSubset({0, 0, 48, 48}), 200, 0);
+        canvas->drawImage(red->makeSubset({16, 16, 64, 64}), 300, 0);
+        // So are images that differ only where their content keys do not look.
+        canvas->drawImage(make_raster_image(SK_ColorRED, true), 400, 0);
+        if (hasJpeg) {
+            canvas->drawImage(SkImage::MakeFromEncoded(jpegData), 0, 100);
+        }
+        if (hasPng) {
+            // Lazy images are compared by their encoded data, without decoding them.
+            canvas->drawImage(SkImage::MakeFromEncoded(pngData), 0, 300);
+        }
+        doc->endPage();
+    }
+    doc->close();
+    sk_sp<SkData> pdf = stream.detachAsData();
+    REPORTER_ASSERT(r, count(*pdf, "/Subtype /Image") == 6 + (hasJpeg ? 1 : 0) + (hasPng ? 1 : 0));
+}
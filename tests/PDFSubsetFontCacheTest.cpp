@@ -0,0 +1,190 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "tests/Test.h"
+
+#ifdef SK_SUPPORT_PDF
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkStream.h"
+#include "include/docs/SkPDFDocument.h"
+#include "src/pdf/SkPDFDocumentPriv.h"
+#include "src/pdf/SkPDFGlyphUse.h"
+#include "src/pdf/SkPDFSubsetFontCache.h"
+#include "tools/Resources.h"
+
+#include <initializer_list>
+
+static const SkPDF::Metadata::Subsetter kHarfbuzz = SkPDF::Metadata::kHarfbuzz_Subsetter;
+static const SkPDF::Metadata::Subsetter kSfntly = SkPDF::Metadata::kSfntly_Subsetter;
+
+static void use_glyphs(SkPDFGlyphUse* glyphUsage, std::initializer_list<SkGlyphID> glyphs) {
+    for (SkGlyphID gid : glyphs) {
+        glyphUsage->set(gid);
+    }
+}
+
+static sk_sp<SkData> make_subset(const char* name, size_t size) {
+    sk_sp<SkData> data = SkData::MakeUninitialized(size);
+    memset(data->writable_data(), 0, size);
+    strncpy((char*)data->writable_data(), name, size);
+    return data;
+}
+
+DEF_TEST(SkPDF_SubsetFontCache, r) {
+    SkPDFSubsetFontCache::Cache cache;
+
+    SkPDFGlyphUse abc(1, 100);
+    use_glyphs(&abc, {1, 2, 3});
+    SkPDFGlyphUse ab(1, 100);
+    use_glyphs(&ab, {1, 2});
+    SkPDFGlyphUse a(1, 100);
+    use_glyphs(&a, {1});
+    SkPDFGlyphUse none(1, 100);
+    SkPDFGlyphUse abd(1, 100);
+    use_glyphs(&abd, {1, 2, 4});
+
+    // Nothing is cached without a limit.
+    cache.add(1, kHarfbuzz, abc, make_subset("abc", 1000));
+    REPORTER_ASSERT(r, !cache.find(1, kHarfbuzz, abc));
+    REPORTER_ASSERT(r, cache.getBytesUsed() == 0);
+
+    cache.setByteLimit(10000);
+    REPORTER_ASSERT(r, cache.getByteLimit() == 10000);
+    sk_sp<SkData> abcSubset = make_subset("abc", 1000);
+    cache.add(1, kHarfbuzz, abc, abcSubset);
+    REPORTER_ASSERT(r, cache.getBytesUsed() >= 1000);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, abc) == abcSubset);
+
+    // Subsets are per font and per subsetter.
+    REPORTER_ASSERT(r, !cache.find(2, kHarfbuzz, abc));
+    REPORTER_ASSERT(r, !cache.find(1, kSfntly, abc));
+
+    // A subset of a superset of the glyphs is reused, unless it has too many more glyphs.
+    // Glyph 0 is in every subset, so {0,1,2,3} may stand in for {0,1} but not {0}.
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, ab) == abcSubset);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, a) == abcSubset);
+    REPORTER_ASSERT(r, !cache.find(1, kHarfbuzz, none));
+    REPORTER_ASSERT(r, !cache.find(1, kHarfbuzz, abd));
+
+    // The smallest superset is preferred.
+    sk_sp<SkData> abSubset = make_subset("ab", 1000);
+    cache.add(1, kHarfbuzz, ab, abSubset);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, ab) == abSubset);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, a) == abSubset);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, abc) == abcSubset);
+
+    // Adding the same glyphs again replaces the subset.
+    size_t bytesUsed = cache.getBytesUsed();
+    sk_sp<SkData> abSubset2 = make_subset("ab2", 1000);
+    cache.add(1, kHarfbuzz, ab, abSubset2);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, ab) == abSubset2);
+    REPORTER_ASSERT(r, cache.getBytesUsed() == bytesUsed);
+
+    // The least recently used subsets are purged to stay within the limit.
+    cache.add(2, kHarfbuzz, abc, make_subset("2abc", 6000));
+    REPORTER_ASSERT(r, cache.getBytesUsed() <= 10000);
+    REPORTER_ASSERT(r, cache.find(2, kHarfbuzz, abc));
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, abc) == abcSubset);
+    cache.add(3, kHarfbuzz, abc, make_subset("3abc", 2000));
+    REPORTER_ASSERT(r, cache.getBytesUsed() <= 10000);
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, ab) == abcSubset);
+
+    // Subsets bigger than the limit are not cached.
+    cache.add(4, kHarfbuzz, abc, make_subset("4abc", 20000));
+    REPORTER_ASSERT(r, !cache.find(4, kHarfbuzz, abc));
+    REPORTER_ASSERT(r, cache.find(1, kHarfbuzz, abc) == abcSubset);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(r, cache.getBytesUsed() == 0);
+    REPORTER_ASSERT(r, !cache.find(1, kHarfbuzz, abc));
+}
+
+DEF_TEST(SkPDF_SubsetFontCache_persistentKey, r) {
+    sk_sp<SkData> font = SkData::MakeWithCString("font data");
+    sk_sp<SkData> otherFont = SkData::MakeWithCString("other font data");
+    SkPDFGlyphUse ab(1, 100);
+    use_glyphs(&ab, {1, 2});
+    SkPDFGlyphUse ab2(1, 200);
+    use_glyphs(&ab2, {2, 1});
+    SkPDFGlyphUse abc(1, 100);
+    use_glyphs(&abc, {1, 2, 3});
+
+    sk_sp<SkData> key = SkPDFSubsetFontCache::MakePersistentKey(*font, 0, kHarfbuzz, ab);
+    REPORTER_ASSERT(r, key->size() > 0);
+    REPORTER_ASSERT(r, key->equals(
+            SkPDFSubsetFontCache::MakePersistentKey(*font, 0, kHarfbuzz, ab2).get()));
+    REPORTER_ASSERT(r, !key->equals(
+            SkPDFSubsetFontCache::MakePersistentKey(*otherFont, 0, kHarfbuzz, ab).get()));
+    REPORTER_ASSERT(r, !key->equals(
+            SkPDFSubsetFontCache::MakePersistentKey(*font, 1, kHarfbuzz, ab).get()));
+    REPORTER_ASSERT(r, !key->equals(
+            SkPDFSubsetFontCache::MakePersistentKey(*font, 0, kSfntly, ab).get()));
+    REPORTER_ASSERT(r, !key->equals(
+            SkPDFSubsetFontCache::MakePersistentKey(*font, 0, kHarfbuzz, abc).get()));
+}
+
+namespace {
+
+// Hands back the whole font for every subset; it has all the glyphs, at their own IDs.
+class FullFontCache : public SkPDF::PersistentCache {
+public:
+    explicit FullFontCache(sk_sp<SkData> font) : fFont(std::move(font)) {}
+
+    sk_sp<SkData> load(const SkData&) override {
+        fLoads++;
+        return fFont;
+    }
+    void store(const SkData&, const SkData&) override { fStores++; }
+
+    sk_sp<SkData> fFont;
+    int fLoads = 0;
+    int fStores = 0;
+};
+
+}  // namespace
+
+static sk_sp<SkData> make_text_document(sk_sp<SkTypeface> typeface,
+                                        SkPDFSubsetFontCache::Cache* cache,
+                                        SkPDF::PersistentCache* persistentCache) {
+    SkDynamicMemoryWStream stream;
+    SkPDF::Metadata metadata;
+    metadata.fSubsetFontCache = persistentCache;
+    SkPDFDocument doc(&stream, metadata);
+    doc.setSubsetFontCache(cache);
+    SkCanvas* canvas = doc.beginPage(612, 792);
+    SkFont font(std::move(typeface), 24);
+    canvas->drawString("Subset fonts", 72, 72, font, SkPaint());
+    doc.close();
+    return stream.detachAsData();
+}
+
+DEF_TEST(SkPDF_SubsetFontCache_document, r) {
+    const char* kFont = "fonts/Roboto-Regular.ttf";
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface(kFont);
+    sk_sp<SkData> fontData = GetResourceAsData(kFont);
+    if (!typeface || !fontData) {
+        return;
+    }
+    SkPDFSubsetFontCache::Cache cache;
+    cache.setByteLimit(1 << 20);
+
+    // The persistent cache is consulted before subsetting, and subsets it provides are kept
+    // in the in-memory cache for the next document.
+    FullFontCache persistentCache(fontData);
+    sk_sp<SkData> first = make_text_document(typeface, &cache, &persistentCache);
+    REPORTER_ASSERT(r, persistentCache.fLoads == 1);
+    REPORTER_ASSERT(r, persistentCache.fStores == 0);
+    REPORTER_ASSERT(r, cache.getBytesUsed() >= fontData->size());
+
+    sk_sp<SkData> second = make_text_document(typeface, &cache, &persistentCache);
+    REPORTER_ASSERT(r, persistentCache.fLoads == 1);
+    REPORTER_ASSERT(r, first->equals(second.get()));
+}
+
+#endif
@@ -35,6 +35,7 @@
 #include "tests/Test.h"
 
 #include <memory>
+#include <vector>
 
 class SkRRect;
 class SkRegion;
@@ -879,3 +880,76 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+
+class PathIDCanvas : public SkCanvas {
+public:
+    PathIDCanvas() : INHERITED(100, 100) {}
+
+    void onDrawPath(const SkPath& path, const SkPaint&) override {
+        fIDs.push_back(path.getGenerationID());
+        fPaths.push_back(path);
+    }
+    void onClipPath(const SkPath& path, SkClipOp, ClipEdgeStyle) override {
+        fIDs.push_back(path.getGenerationID());
+        fPaths.push_back(path);
+    }
+
+    std::vector<uint32_t> fIDs;
+    std::vector<SkPath>   fPaths;
+
+private:
+    typedef SkCanvas INHERITED;
+};
+
+static SkPath make_icon_path(SkScalar size) {
+    SkPath path;
+    path.moveTo(0, 0);
+    path.quadTo(size, 0, size, size);
+    path.conicTo(0, size, 0, 0, 0.5f);
+    path.close();
+    return path;
+}
+
+static sk_sp<SkPicture> record_icon_paths(uint32_t recordFlags, SkPath* edited) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(100, 100, nullptr, recordFlags);
+    SkPaint paint;
+    canvas->save();
+    canvas->clipPath(make_icon_path(50), true);
+    *edited = make_icon_path(10);
+    canvas->drawPath(*edited, paint);
+    canvas->drawPath(make_icon_path(10), paint);
+    canvas->drawPath(make_icon_path(20), paint);
+    canvas->drawPath(make_icon_path(10), paint);
+    canvas->restore();
+    return recorder.finishRecordingAsPicture();
+}
+
+DEF_TEST(Picture_InternPaths, r) {
+    SkPath edited;
+    sk_sp<SkPicture> interned =
+            record_icon_paths(SkPictureRecorder::kInternPaths_RecordFlag, &edited);
+    // Changing a path after drawing it must not change what was recorded.
+    edited.lineTo(5, 5);
+
+    PathIDCanvas internedCanvas;
+    interned->playback(&internedCanvas);
+    const std::vector<uint32_t>& ids = internedCanvas.fIDs;
+    REPORTER_ASSERT(r, ids.size() == 5);
+    REPORTER_ASSERT(r, ids[1] == ids[2] && ids[1] == ids[4]);
+    REPORTER_ASSERT(r, ids[0] != ids[1] && ids[3] != ids[1] && ids[0] != ids[3]);
+    REPORTER_ASSERT(r, internedCanvas.fPaths[1] == make_icon_path(10));
+    REPORTER_ASSERT(r, ids[1] != edited.getGenerationID());
+
+    PathIDCanvas plainCanvas;
+    sk_sp<SkPicture> plain = record_icon_paths(0, &edited);
+    plain->playback(&plainCanvas);
+    REPORTER_ASSERT(r, plainCanvas.fIDs.size() == 5);
+    REPORTER_ASSERT(r, plainCanvas.fIDs[1] != plainCanvas.fIDs[2]);
+    for (size_t i = 0; i < plainCanvas.fPaths.size(); ++i) {
+        REPORTER_ASSERT(r, plainCanvas.fPaths[i] == internedCanvas.fPaths[i]);
+    }
+
+    // SkPictureRecord stores each generation ID once, so interned pictures serialize smaller.
+    REPORTER_ASSERT(r, interned->serialize()->size() < plain->serialize()->size());
+}
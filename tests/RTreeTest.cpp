@@ -45,11 +45,19 @@ static bool verify_query(SkRect query, SkRect rects[], SkTDArray<int>& found) {
 
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
                         const SkRTree& tree) {
+    SkRect queries[NUM_QUERIES];
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
         SkTDArray<int> hits;
-        SkRect query = random_rect(rand);
-        tree.search(query, &hits);
-        REPORTER_ASSERT(reporter, verify_query(query, rects, hits));
+        queries[i] = random_rect(rand);
+        tree.search(queries[i], &hits);
+        REPORTER_ASSERT(reporter, verify_query(queries[i], rects, hits));
+    }
+
+    // Searching for all the queries at once should find the same results, in the same order.
+    SkTDArray<int> batchHits[NUM_QUERIES];
+    tree.search(queries, NUM_QUERIES, batchHits);
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        REPORTER_ASSERT(reporter, verify_query(queries[i], rects, batchHits[i]));
     }
 }
 
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageGenerator.h"
+#include "src/core/SkDiscardableMemory.h"
+#include "src/core/SkMakeUnique.h"
+#include "src/core/SkOSFile.h"
+#include "src/image/SkImage_Base.h"
+#include "src/image/SkImage_Lazy.h"
+#include "src/lazy/SkSharedDecodeCache.h"
+#include "src/utils/SkOSPath.h"
+#include "tests/Test.h"
+
+#include <atomic>
+
+#if !defined(SK_BUILD_FOR_WIN)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+static sk_sp<SkSharedDecodeCache> make_cache(skiatest::Reporter* r, const char name[],
+                                             size_t byteLimit) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return nullptr;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), name);
+    sk_sp<SkSharedDecodeCache> cache = SkSharedDecodeCache::Make(dir.c_str(), byteLimit);
+#if !defined(SK_BUILD_FOR_WIN)
+    REPORTER_ASSERT(r, cache);
+#endif
+    if (cache) {
+        cache->purgeAll();
+    }
+    return cache;
+}
+
+static SkBitmap make_bitmap(SkColor color) {
+    SkBitmap bm;
+    bm.allocN32Pixels(16, 16);
+    bm.eraseColor(color);
+    return bm;
+}
+
+static SkSharedDecodeCache::Key make_key(const char str[]) {
+    sk_sp<SkData> encoded = SkData::MakeWithCString(str);
+    return SkSharedDecodeCache::MakeKey(*encoded, SkImageInfo::MakeN32Premul(16, 16), {0, 0});
+}
+
+static bool has_pixels(SkSharedDecodeCache* cache, const SkSharedDecodeCache::Key& key,
+                       SkColor color) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(16, 16);
+    size_t rowBytes;
+    std::unique_ptr<SkDiscardableMemory> dm = cache->find(key, info, &rowBytes);
+    if (!dm || !dm->lock()) {
+        return false;
+    }
+    SkBitmap bm;
+    bm.installPixels(info, dm->data(), rowBytes);
+    bool matches = bm.getColor(3, 7) == color;
+    dm->unlock();
+    return matches;
+}
+
+DEF_TEST(SharedDecodeCache_findAndAdd, r) {
+    sk_sp<SkSharedDecodeCache> cache = make_cache(r, "shared_decode_find", 1 << 20);
+    if (!cache) {
+        return;
+    }
+    const SkSharedDecodeCache::Key key = make_key("red");
+    REPORTER_ASSERT(r, !has_pixels(cache.get(), key, SK_ColorRED));
+    REPORTER_ASSERT(r, cache->add(key, make_bitmap(SK_ColorRED).pixmap()));
+    REPORTER_ASSERT(r, has_pixels(cache.get(), key, SK_ColorRED));
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() >= 16 * 16 * 4);
+
+    // Keys cover how the data was decoded as well as the data itself.
+    sk_sp<SkData> encoded = SkData::MakeWithCString("red");
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(16, 16);
+    REPORTER_ASSERT(r, key == SkSharedDecodeCache::MakeKey(*encoded, info, {0, 0}));
+    REPORTER_ASSERT(r, key != SkSharedDecodeCache::MakeKey(*encoded, info, {1, 0}));
+    const SkImageInfo opaque = info.makeAlphaType(kOpaque_SkAlphaType);
+    REPORTER_ASSERT(r, key != SkSharedDecodeCache::MakeKey(*encoded, opaque, {0, 0}));
+
+    // A cache opened on the same directory (e.g. in another process) sees the same pixels.
+    sk_sp<SkSharedDecodeCache> other = make_cache(r, "shared_decode_other", 1 << 20);
+    SkString dir = SkOSPath::Join(skiatest::GetTmpDir().c_str(), "shared_decode_find");
+    sk_sp<SkSharedDecodeCache> same = SkSharedDecodeCache::Make(dir.c_str(), 1 << 20);
+    REPORTER_ASSERT(r, has_pixels(same.get(), key, SK_ColorRED));
+    REPORTER_ASSERT(r, !has_pixels(other.get(), key, SK_ColorRED));
+
+    // Asking for the pixels with a different info misses.
+    size_t rowBytes;
+    REPORTER_ASSERT(r, !cache->find(key, info.makeWH(8, 32), &rowBytes));
+    REPORTER_ASSERT(r, !cache->find(key, info.makeColorType(kAlpha_8_SkColorType), &rowBytes));
+
+    // Pixels stay mapped after they are purged.
+    std::unique_ptr<SkDiscardableMemory> dm = cache->find(key, info, &rowBytes);
+    REPORTER_ASSERT(r, dm);
+    same->purgeAll();
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() == 0);
+    REPORTER_ASSERT(r, !has_pixels(cache.get(), key, SK_ColorRED));
+    REPORTER_ASSERT(r, dm->lock());
+    REPORTER_ASSERT(r, *(SkPMColor*)dm->data() == SkPreMultiplyColor(SK_ColorRED));
+    dm->unlock();
+}
+
+#if !defined(SK_BUILD_FOR_WIN)
+// Makes every entry in dir look as if it were last used a minute earlier than it was, so the
+// order of entries used back to back does not depend on how precise file times are.
+static void age_entries(const char dir[]) {
+    SkOSFile::Iter iter(dir, ".px");
+    SkString name;
+    while (iter.next(&name)) {
+        SkString path = SkOSPath::Join(dir, name.c_str());
+        struct stat st;
+        if (0 == stat(path.c_str(), &st)) {
+            const timespec times[2] = { { st.st_mtime - 60, 0 }, { st.st_mtime - 60, 0 } };
+            utimensat(AT_FDCWD, path.c_str(), times, 0);
+        }
+    }
+}
+
+DEF_TEST(SharedDecodeCache_evict, r) {
+    // Room for three 16x16 N32 entries, with their headers, but not four.
+    static constexpr size_t kEntrySize = 16 * 16 * 4 + 64;
+    sk_sp<SkSharedDecodeCache> cache = make_cache(r, "shared_decode_evict", 3 * kEntrySize);
+    if (!cache) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(skiatest::GetTmpDir().c_str(), "shared_decode_evict");
+    const SkSharedDecodeCache::Key a = make_key("a"),
+                                   b = make_key("b"),
+                                   c = make_key("c"),
+                                   d = make_key("d");
+    REPORTER_ASSERT(r, cache->add(a, make_bitmap(SK_ColorRED).pixmap()));
+    age_entries(dir.c_str());
+    REPORTER_ASSERT(r, cache->add(b, make_bitmap(SK_ColorGREEN).pixmap()));
+    age_entries(dir.c_str());
+    REPORTER_ASSERT(r, cache->add(c, make_bitmap(SK_ColorBLUE).pixmap()));
+    age_entries(dir.c_str());
+    REPORTER_ASSERT(r, has_pixels(cache.get(), a, SK_ColorRED));
+    age_entries(dir.c_str());
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() == 3 * kEntrySize);
+
+    // b and c are now the least recently used.  Going over the limit evicts down to three
+    // quarters of it, so the next few adds need not evict again.
+    REPORTER_ASSERT(r, cache->add(d, make_bitmap(SK_ColorYELLOW).pixmap()));
+    REPORTER_ASSERT(r,  has_pixels(cache.get(), a, SK_ColorRED));
+    REPORTER_ASSERT(r, !has_pixels(cache.get(), b, SK_ColorGREEN));
+    REPORTER_ASSERT(r, !has_pixels(cache.get(), c, SK_ColorBLUE));
+    REPORTER_ASSERT(r,  has_pixels(cache.get(), d, SK_ColorYELLOW));
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() == 2 * kEntrySize);
+
+    // Entries bigger than the whole cache are not written.
+    SkBitmap big;
+    big.allocN32Pixels(64, 64);
+    big.eraseColor(SK_ColorBLACK);
+    REPORTER_ASSERT(r, !cache->add(make_key("big"), big.pixmap()));
+    REPORTER_ASSERT(r, has_pixels(cache.get(), a, SK_ColorRED));
+
+    cache->purgeAll();
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() == 0);
+}
+#endif
+
+namespace {
+
+class EncodedGenerator : public SkImageGenerator {
+public:
+    EncodedGenerator(sk_sp<SkData> encoded, std::atomic<int>* count)
+        : SkImageGenerator(SkImageInfo::MakeN32Premul(16, 16))
+        , fEncoded(std::move(encoded))
+        , fCount(count) {}
+
+protected:
+    sk_sp<SkData> onRefEncodedData() override { return fEncoded; }
+
+    bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                     const Options&) override {
+        (*fCount)++;
+        SkBitmap bm;
+        bm.installPixels(info, pixels, rowBytes);
+        bm.eraseColor(SK_ColorCYAN);
+        return true;
+    }
+
+private:
+    sk_sp<SkData>     fEncoded;
+    std::atomic<int>* fCount;
+};
+
+}  // namespace
+
+DEF_TEST(SharedDecodeCache_lazyImage, r) {
+    sk_sp<SkSharedDecodeCache> cache = make_cache(r, "shared_decode_lazy", 1 << 20);
+    if (!cache) {
+        return;
+    }
+
+    // Two images from the same bytes, as if made in two processes.
+    sk_sp<SkData> encoded = SkData::MakeWithCString("not really encoded");
+    std::atomic<int> count{0};
+    sk_sp<SkImage> first  = SkImage::MakeFromGenerator(
+                                    skstd::make_unique<EncodedGenerator>(encoded, &count)),
+                   second = SkImage::MakeFromGenerator(
+                                    skstd::make_unique<EncodedGenerator>(encoded, &count));
+
+    // Lazy images share decodes through SkSharedDecodeCache::Get(); pass ours in instead.
+    auto getROPixels = [&cache](const sk_sp<SkImage>& image, SkBitmap* bm) {
+        return static_cast<const SkImage_Lazy*>(as_IB(image))->getROPixels(
+                bm, SkImage::kAllow_CachingHint, cache.get());
+    };
+
+    SkBitmap bm;
+    REPORTER_ASSERT(r, getROPixels(first, &bm));
+    REPORTER_ASSERT(r, count == 1);
+    REPORTER_ASSERT(r, cache->getTotalBytesUsed() > 0);
+
+    SkBitmap bm2;
+    REPORTER_ASSERT(r, getROPixels(second, &bm2));
+    REPORTER_ASSERT(r, count == 1);
+    REPORTER_ASSERT(r, bm2.isImmutable());
+    REPORTER_ASSERT(r, bm2.getColor(5, 5) == SK_ColorCYAN);
+
+    cache->purgeAll();
+}
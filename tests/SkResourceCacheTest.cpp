@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -15,6 +16,7 @@
 #include "src/core/SkMakeUnique.h"
 #include "src/core/SkMipMap.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
@@ -291,3 +293,41 @@ DEF_TEST(ResourceCache_purge, reporter) {
         }
     }
 }
+
+struct ValueRec : SkResourceCache::Rec {
+    TestKey fKey;
+    int32_t fValue;
+
+    ValueRec(int32_t data, int32_t value) : fKey(0, data), fValue(value) {}
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return 1024; }
+    const char* getCategory() const override { return "test-category"; }
+
+    static bool Finder(const SkResourceCache::Rec& baseRec, void* context) {
+        *(int32_t*)context = static_cast<const ValueRec&>(baseRec).fValue;
+        return true;
+    }
+};
+
+/*
+ *  Hit the global cache from several threads at once.  Other tests may be purging it too, so we
+ *  can't count on finding anything, but whatever we find must be what was added under that key.
+ */
+DEF_TEST(ResourceCache_global_threads, reporter) {
+    const int kCount = 1000;
+    std::atomic<int> wrong{0};
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkTaskGroup(*executor).batch(kCount, [&](int i) {
+        SkResourceCache::Add(new ValueRec(i, 3 * i));
+        for (int data : {i, i / 2, kCount - i}) {
+            int32_t value;
+            if (SkResourceCache::Find(TestKey(0, data), ValueRec::Finder, &value) &&
+                value != 3 * data) {
+                wrong++;
+            }
+        }
+    });
+    REPORTER_ASSERT(reporter, wrong == 0);
+}
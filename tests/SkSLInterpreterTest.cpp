@@ -246,3 +246,66 @@ DEF_TEST(SkSLInterpreterGeneric, r) {
          (SkSL::Interpreter::Value*) &value2, 2,
          (SkSL::Interpreter::Value*) expected2);
 }
+
+// Runs src striped over N lanes of varied colors, checking each lane against a scalar run.
+static void test_striped(skiatest::Reporter* r, const char* src) {
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                                                             SkSL::Program::kGeneric_Kind,
+                                                             SkSL::String(src),
+                                                             SkSL::Program::Settings());
+    REPORTER_ASSERT(r, program);
+    if (!program) {
+        printf("%s\n%s", src, compiler.errorText().c_str());
+        return;
+    }
+    std::unique_ptr<SkSL::ByteCode> byteCode = compiler.toByteCode(*program);
+    REPORTER_ASSERT(r, !compiler.errorCount());
+    SkSL::ByteCodeFunction* main = byteCode->fFunctions[0].get();
+    SkSL::Interpreter interpreter(std::move(program), std::move(byteCode));
+
+    auto color = [](int lane, int channel) { return ((lane * 7 + channel * 3) % 11) / 10.0f; };
+    for (int N : { 4, 8, 16 }) {
+        for (int count : { 1, N - 1, N }) {
+            float striped[4 * SkSL::Interpreter::kMaxStripe];
+            for (int lane = 0; lane < N; ++lane) {
+                for (int channel = 0; channel < 4; ++channel) {
+                    striped[channel * N + lane] = color(lane, channel);
+                }
+            }
+            interpreter.runStriped(*main, N, count, (SkSL::Interpreter::Value*) striped,
+                                   nullptr);
+
+            for (int lane = 0; lane < count; ++lane) {
+                float scalar[4];
+                for (int channel = 0; channel < 4; ++channel) {
+                    scalar[channel] = color(lane, channel);
+                }
+                interpreter.run(*main, (SkSL::Interpreter::Value*) scalar, nullptr);
+                for (int channel = 0; channel < 4; ++channel) {
+                    REPORTER_ASSERT(r, scalar[channel] == striped[channel * N + lane],
+                                    "%s: lane %d of %d, channel %d", src, lane, N, channel);
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(SkSLInterpreterStriped, r) {
+    // Each of these sends some lanes one way and some the other.
+    test_striped(r, "void main(inout half4 color) { if (color.r > 0.5) color.g = color.r * 2; "
+                    "else color.b = 1 - color.a; }");
+    test_striped(r, "void main(inout half4 color) { if (color.r > color.g) { if (color.b > 0.3) "
+                    "{ color.a = 1; } else { color.a = 2; } } else { color.a = color.b / 3; } }");
+    test_striped(r, "void main(inout half4 color) { while (color.r < 8) { "
+                    "color.r = color.r * 2 + 0.25; color.g = color.g + 1; } }");
+    test_striped(r, "void main(inout half4 color) { do { color.r = color.r + 0.25; "
+                    "color.g = color.g + 1; } while (color.r < color.b * 4); }");
+    test_striped(r, "void main(inout half4 color) { for (int i = 0; i < 10; ++i) { "
+                    "if (i > color.r * 10) break; color.g = color.g + 1; "
+                    "if (color.b > 0.5) continue; color.b = color.b + 0.125; } }");
+    test_striped(r, "half x; void main(inout half4 color) { x = 3; if (color.r > 0.5) "
+                    "x = color.g; color.b = x; }");
+    test_striped(r, "void main(inout half4 color) { half4 t = color * 2; "
+                    "if (t.x > 1) { color = t.wzyx; } else { color.r = 9; } }");
+}
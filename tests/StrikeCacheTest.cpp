@@ -0,0 +1,78 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkTypeface.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+#include "tools/fonts/RandomScalerContext.h"
+
+static SkExclusiveStrikePtr find_or_create(SkStrikeCache* cache, const SkFont& font) {
+    return SkExclusiveStrikePtr(cache->findOrCreateStrike(
+            font, SkPaint(), SkSurfaceProps(SkSurfaceProps::kLegacyFontHost_InitType),
+            kFakeGammaAndBoostContrast, SkMatrix::I()));
+}
+
+// Threads remember the strikes they use in front caches, but those strikes stay in the cache,
+// counted against its budget, and purging must let go of every one of them.
+DEF_TEST(StrikeCache_ThreadFrontCaches, reporter) {
+    // The portable typefaces are owned by their font manager, so wrap one in a typeface that
+    // only we and the strikes refer to.
+    sk_sp<SkTypeface> typeface = sk_make_sp<SkRandomTypeface>(
+            ToolUtils::create_portable_typeface("serif", SkFontStyle()), SkPaint(), false);
+    const SkGlyphID glyph = SkFont(typeface).unicharToGlyph('A');
+
+    SkStrikeCache cache{true};
+    {
+        auto executor = SkExecutor::MakeFIFOThreadPool(4);
+        SkTaskGroup(*executor).batch(64, [&](int i) {
+            SkFont font(typeface, 8 + i % 16);
+            for (int lookups = 0; lookups < 4; lookups++) {
+                auto strike = find_or_create(&cache, font);
+                const SkGlyph& g = strike->getGlyphIDMetrics(glyph);
+                strike->findImage(g);
+            }
+        });
+    }
+    // Two threads may each build a strike for the same font if they want it at the same time.
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() >= 16);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() <= 64);
+
+    // This thread remembers the strike it used, and must let go of it once it is purged.
+    find_or_create(&cache, SkFont(typeface, 12));
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(reporter, typeface->unique());
+
+    {
+        auto strike = find_or_create(&cache, SkFont(typeface, 12));
+        REPORTER_ASSERT(reporter, strike->getGlyphIDMetrics(glyph).getGlyphID() == glyph);
+    }
+    {
+        // A strike in use is not handed out again, even from the front cache.
+        auto strike = find_or_create(&cache, SkFont(typeface, 12));
+        auto other = find_or_create(&cache, SkFont(typeface, 12));
+        REPORTER_ASSERT(reporter, other.get() != strike.get());
+
+        // Nor is it purged.
+        other = SkExclusiveStrikePtr();
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+        REPORTER_ASSERT(reporter, strike->getGlyphIDMetrics(glyph).getGlyphID() == glyph);
+    }
+
+    // Released unchanged, it comes straight back from the front cache.
+    const SkStrike* first = find_or_create(&cache, SkFont(typeface, 12)).get();
+    REPORTER_ASSERT(reporter, find_or_create(&cache, SkFont(typeface, 12)).get() == first);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, typeface->unique());
+}
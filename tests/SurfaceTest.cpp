@@ -7,11 +7,13 @@
 
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkOverdrawCanvas.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkRegion.h"
 #include "include/core/SkSurface.h"
+#include "include/effects/SkBlurImageFilter.h"
 #include "include/gpu/GrBackendSurface.h"
 #include "include/gpu/GrContext.h"
 #include "src/core/SkDevice.h"
@@ -1045,3 +1047,125 @@ DEF_TEST(surface_image_unity, reporter) {
         }
     }
 }
+
+// Anti-aliased geometry that crosses tile edges.
+static void draw_tiled_test_geometry(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawCircle(50, 50, 40, paint);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeLTRB(10.5f, 20.25f, 80.75f, 70.5f), paint);
+
+    canvas->save();
+    canvas->translate(20, 10);
+    canvas->rotate(15);
+    SkPath clip;
+    clip.addOval(SkRect::MakeXYWH(10, 10, 80, 60));
+    canvas->clipPath(clip, true);
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+    canvas->restore();
+}
+
+// Layers, including filtered layers that read across tile edges.
+static void draw_tiled_test_layers(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRect(SkRect::MakeLTRB(10, 20, 80, 70), paint);
+
+    SkPaint layerPaint;
+    layerPaint.setImageFilter(SkBlurImageFilter::Make(3, 3, nullptr));
+    canvas->saveLayer(nullptr, &layerPaint);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawRect(SkRect::MakeXYWH(30, 60, 40, 30), paint);
+    canvas->restore();
+
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    canvas->translate(5, 5);
+    paint.setColor(SK_ColorRED);
+    canvas->drawRect(SkRect::MakeXYWH(40, 0, 20, 100), paint);
+    canvas->restore();
+
+    auto backdrop = SkBlurImageFilter::Make(2, 2, nullptr);
+    canvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, backdrop.get(), 0));
+    paint.setColor(0x80FFFF00);
+    canvas->drawRect(SkRect::MakeXYWH(5, 5, 90, 20), paint);
+    canvas->restore();
+}
+
+DEF_TEST(SurfaceRasterTiled, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(100, 100);
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto untiled = SkSurface::MakeRaster(info);
+    draw_tiled_test_layers(untiled->getCanvas());
+    SkBitmap expectedLayers;
+    expectedLayers.allocPixels(info);
+    REPORTER_ASSERT(reporter, untiled->readPixels(expectedLayers, 0, 0));
+
+    for (int tileSize : { 0, 7, 16, 100 }) {
+        SkBitmap actual;
+        actual.allocPixels(info);
+
+        auto tiled = SkSurface::MakeRasterTiled(info, executor.get(), tileSize);
+        REPORTER_ASSERT(reporter, tiled);
+        draw_tiled_test_layers(tiled->getCanvas());
+        REPORTER_ASSERT(reporter, tiled->readPixels(actual, 0, 0));
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedLayers, actual));
+
+        // Geometry is scan converted against the clip, so where it crosses a tile edge it is
+        // expected to match a raster canvas clipped to each tile in turn, not an unclipped one.
+        const int step = tileSize ? tileSize : 512;
+        SkBitmap expectedGeometry;
+        expectedGeometry.allocPixels(info);
+        expectedGeometry.eraseColor(SK_ColorTRANSPARENT);
+        for (int y = 0; y < info.height(); y += step) {
+            for (int x = 0; x < info.width(); x += step) {
+                SkCanvas canvas(expectedGeometry);
+                canvas.clipRect(SkRect::Make(SkIRect::MakeXYWH(x, y, step, step)));
+                draw_tiled_test_geometry(&canvas);
+            }
+        }
+
+        tiled = SkSurface::MakeRasterTiled(info, executor.get(), tileSize);
+        draw_tiled_test_geometry(tiled->getCanvas());
+        REPORTER_ASSERT(reporter, tiled->readPixels(actual, 0, 0));
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedGeometry, actual));
+    }
+}
+
+DEF_TEST(SurfaceRasterTiled_StateAcrossSnapshots, reporter) {
+    auto executor = SkExecutor::MakeFIFOThreadPool(2);
+    auto surface = SkSurface::MakeRasterTiled(SkImageInfo::MakeN32Premul(64, 64),
+                                              executor.get(), 16);
+    SkCanvas* canvas = surface->getCanvas();
+
+    canvas->clear(SK_ColorWHITE);
+    sk_sp<SkImage> before = surface->makeImageSnapshot();
+
+    // Snapshot with a save, a translate, and a layer still open; they must carry over.
+    canvas->save();
+    canvas->translate(32, 0);
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    sk_sp<SkImage> middle = surface->makeImageSnapshot();
+    SkPaint paint;
+    paint.setColor(SK_ColorBLACK);
+    canvas->drawRect(SkRect::MakeWH(32, 64), paint);
+    canvas->restore();
+    canvas->restore();
+    canvas->drawRect(SkRect::MakeWH(32, 64), paint);
+    sk_sp<SkImage> after = surface->makeImageSnapshot();
+
+    REPORTER_ASSERT(reporter, before.get() != after.get());
+    uint32_t pixel;
+    SkImageInfo one = SkImageInfo::MakeN32Premul(1, 1);
+    REPORTER_ASSERT(reporter, middle->readPixels(one, &pixel, 4, 48, 8));
+    REPORTER_ASSERT(reporter, pixel == SkPreMultiplyColor(SK_ColorWHITE));
+    REPORTER_ASSERT(reporter, after->readPixels(one, &pixel, 4, 8, 8));
+    REPORTER_ASSERT(reporter, pixel == SkPreMultiplyColor(SK_ColorBLACK));
+    REPORTER_ASSERT(reporter, after->readPixels(one, &pixel, 4, 48, 8));
+    REPORTER_ASSERT(reporter, SkGetPackedR32(pixel) > 0x70 && SkGetPackedR32(pixel) < 0x90);
+    REPORTER_ASSERT(reporter, before->readPixels(one, &pixel, 4, 8, 8));
+    REPORTER_ASSERT(reporter, pixel == SkPreMultiplyColor(SK_ColorWHITE));
+}
@@ -7,6 +7,8 @@
 
 #include "include/core/SkSwizzle.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "include/private/SkTemplates.h"
+#include "include/utils/SkRandom.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkOpts.h"
 #include "tests/Test.h"
@@ -152,3 +154,59 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+// Copies exactly the bytes a swizzle should read, so tools like ASAN catch any reads past them.
+static SkAutoTMalloc<uint8_t> tight_copy(const uint8_t* src, size_t bytes) {
+    SkAutoTMalloc<uint8_t> copy(bytes);
+    memcpy(copy.get(), src, bytes);
+    return copy;
+}
+
+DEF_TEST(SwizzleIndexOpts, r) {
+    SkRandom rand;
+    uint32_t ctable[256];
+    for (uint32_t& c : ctable) {
+        c = rand.nextU();
+    }
+    uint8_t src[512];
+    for (uint8_t& byte : src) {
+        byte = rand.nextU() & 0xFF;
+    }
+
+    // Enough pixels to run both the vector loops and the tails that follow them.
+    uint32_t dst[100];
+    for (int count = 1; count <= 100; count++) {
+        for (int bits : {1, 2, 4}) {
+            SkOpts::Swizzle_index proc = 1 == bits ? SkOpts::index1_to_8888
+                                       : 2 == bits ? SkOpts::index2_to_8888
+                                       :             SkOpts::index4_to_8888;
+            proc(dst, tight_copy(src, (count * bits + 7) / 8).get(), count, ctable);
+            for (int i = 0; i < count; i++) {
+                int bit = i * bits;
+                int index = (src[bit / 8] >> (8 - bits - bit % 8)) & ((1 << bits) - 1);
+                REPORTER_ASSERT(r, dst[i] == ctable[index]);
+            }
+        }
+
+        for (int deltaSrc : {1, 2, 3, 5}) {
+            SkOpts::index8_to_8888(dst, tight_copy(src, (count - 1) * deltaSrc + 1).get(), count,
+                                   deltaSrc, ctable);
+            for (int i = 0; i < count; i++) {
+                REPORTER_ASSERT(r, dst[i] == ctable[src[i * deltaSrc]]);
+            }
+        }
+
+        for (int deltaSrc : {4, 8, 12, 16}) {
+            if ((count - 1) * deltaSrc + 4 > (int)sizeof(src)) {
+                continue;
+            }
+            SkOpts::sample_8888(dst, tight_copy(src, (count - 1) * deltaSrc + 4).get(), count,
+                                deltaSrc);
+            for (int i = 0; i < count; i++) {
+                uint32_t expected;
+                memcpy(&expected, src + i * deltaSrc, 4);
+                REPORTER_ASSERT(r, dst[i] == expected);
+            }
+        }
+    }
+}
@@ -6,20 +6,19 @@
  */
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkYUVASizeInfo.h"
+#include "include/encode/SkWebpEncoder.h"
 #include "include/private/SkTemplates.h"
 #include "src/core/SkAutoMalloc.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
 static void codec_yuv(skiatest::Reporter* reporter,
-                      const char path[],
-                      SkISize expectedSizes[4]) {
-    std::unique_ptr<SkStream> stream(GetResourceAsStream(path));
-    if (!stream) {
-        return;
-    }
+                      std::unique_ptr<SkStream> stream,
+                      SkISize expectedSizes[4],
+                      SkYUVColorSpace expectedColorSpace) {
     std::unique_ptr<SkCodec> codec(SkCodec::MakeFromStream(std::move(stream)));
     REPORTER_ASSERT(reporter, codec);
     if (!codec) {
@@ -58,7 +57,7 @@ static void codec_yuv(skiatest::Reporter* reporter,
             REPORTER_ASSERT(reporter,
                             info.fWidthBytes[i] == (uint32_t) SkAlign8(info.fSizes[i].width()));
         }
-        REPORTER_ASSERT(reporter, kJPEG_SkYUVColorSpace == colorSpace);
+        REPORTER_ASSERT(reporter, expectedColorSpace == colorSpace);
     }
 
     // Allocate the memory for the YUV decode
@@ -74,6 +73,17 @@ static void codec_yuv(skiatest::Reporter* reporter,
     REPORTER_ASSERT(reporter, SkCodec::kSuccess == codec->getYUV8Planes(info, planes));
 }
 
+static void codec_yuv(skiatest::Reporter* reporter,
+                      const char path[],
+                      SkISize expectedSizes[4],
+                      SkYUVColorSpace expectedColorSpace = kJPEG_SkYUVColorSpace) {
+    std::unique_ptr<SkStream> stream(GetResourceAsStream(path));
+    if (!stream) {
+        return;
+    }
+    codec_yuv(reporter, std::move(stream), expectedSizes, expectedColorSpace);
+}
+
 DEF_TEST(Jpeg_YUV_Codec, r) {
     SkISize sizes[4];
 
@@ -124,3 +134,69 @@ DEF_TEST(Jpeg_YUV_Codec, r) {
     // A PNG should fail.
     codec_yuv(r, "images/arrow.png", nullptr);
 }
+
+DEF_TEST(Webp_YUV_Codec, r) {
+    SkISize sizes[4];
+
+    // Lossy, with U and V half the size of Y.
+    sizes[0].set(800, 800);
+    sizes[1].set(400, 400);
+    sizes[2].set(400, 400);
+    sizes[3].set(0, 0);
+    codec_yuv(r, "images/webp-color-profile-lossy.webp", sizes, kRec601_SkYUVColorSpace);
+
+    // Lossy with odd dimensions, where U and V round up.
+    SkBitmap odd;
+    odd.allocPixels(SkImageInfo::MakeN32(301, 201, kOpaque_SkAlphaType));
+    odd.eraseColor(SK_ColorYELLOW);
+    odd.erase(SK_ColorBLUE, SkIRect::MakeXYWH(100, 50, 101, 101));
+    SkWebpEncoder::Options options;
+    options.fCompression = SkWebpEncoder::Compression::kLossy;
+    SkDynamicMemoryWStream encoded;
+    if (SkWebpEncoder::Encode(&encoded, odd.pixmap(), options)) {
+        sizes[0].set(301, 201);
+        sizes[1].set(151, 101);
+        sizes[2].set(151, 101);
+        codec_yuv(r, encoded.detachAsStream(), sizes, kRec601_SkYUVColorSpace);
+    }
+
+    // Lossless, lossy with alpha, and animated images should fail.
+    codec_yuv(r, "images/color_wheel.webp", nullptr);
+    codec_yuv(r, "images/baby_tux.webp", nullptr);
+    codec_yuv(r, "images/webp-animated.webp", nullptr);
+}
+
+// WebP can decode all three planes scaled down, by asking for a smaller Y plane.
+DEF_TEST(Webp_YUV_Scaled, r) {
+    std::unique_ptr<SkCodec> codec =
+            SkCodec::MakeFromData(GetResourceAsData("images/webp-color-profile-lossy.webp"));
+    if (!codec) {
+        return;
+    }
+    SkYUVASizeInfo info;
+    if (!codec->queryYUV8(&info, nullptr)) {
+        ERRORF(r, "Expected YUV support");
+        return;
+    }
+
+    info.fSizes[0].set(301, 201);
+    info.fSizes[1].set(151, 101);
+    info.fSizes[2].set(151, 101);
+    for (int i = 0; i < 3; ++i) {
+        info.fWidthBytes[i] = SkAlign8(info.fSizes[i].width());
+    }
+    SkAutoMalloc storage(info.computeTotalBytes());
+    void* planes[SkYUVASizeInfo::kMaxCount];
+    info.computePlanes(storage.get(), planes);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(info, planes));
+
+    // U and V must be half the size of Y.
+    info.fSizes[1].set(150, 100);
+    REPORTER_ASSERT(r, SkCodec::kInvalidInput == codec->getYUV8Planes(info, planes));
+
+    // Y can't be bigger than the image.
+    SkYUVASizeInfo tooBig;
+    codec->queryYUV8(&tooBig, nullptr);
+    tooBig.fSizes[0].set(802, 800);
+    REPORTER_ASSERT(r, SkCodec::kInvalidInput == codec->getYUV8Planes(tooBig, planes));
+}
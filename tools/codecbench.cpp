@@ -0,0 +1,370 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkStream.h"
+#include "include/private/SkTArray.h"
+#include "include/private/SkTemplates.h"
+#include "src/core/SkMakeUnique.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/utils/SkJSONWriter.h"
+#include "src/utils/SkOSPath.h"
+#include "tools/ProcStats.h"
+#include "tools/flags/CommandLineFlags.h"
+#include "tools/flags/CommonFlags.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+/**
+ *  Decodes a corpus of images with every combination of destination color type, sample size,
+ *  subset, and thread count, and reports decode throughput in megapixels per second.
+ *
+ *  Each configuration decodes one image over and over for at least --ms.  With more than one
+ *  thread, each thread decodes its own copy of the image, so the throughput is for the whole
+ *  machine.  Alongside throughput it reports the process's peak resident set size after the
+ *  configuration, and how many times operator new was called per decode.  (Allocations through
+ *  sk_malloc() and the codec libraries' own allocators are not counted.)
+ */
+
+static DEFINE_string(images, "resources/images",
+                     "Images and/or directories of images to decode.");
+static DEFINE_string(colorTypes, "n32 f16 565 a8",
+                     "Destination color types to decode to: n32, f16, 565, and/or a8.");
+static DEFINE_string(sampleSizes, "1 2 4 8", "Sample sizes to decode at.");
+static DEFINE_string(subsets, "full",
+                     "Regions to decode: 'full', or WxH for a centered subset of that size.");
+static DEFINE_string(threads, "1", "Thread counts to decode with.");
+static DEFINE_int(ms, 250, "Minimum milliseconds to spend decoding each configuration.");
+static DEFINE_string(json, "", "If set, write results to this file as JSON.");
+static DEFINE_string2(match, m, nullptr,
+                      "[~][^]substring[$] [...] of image names to decode.\n"
+                      "Multiple matches may be separated by spaces.\n"
+                      "~ causes a matching image to always be skipped\n"
+                      "^ requires the start of the image name to match\n"
+                      "$ requires the end of the image name to match\n"
+                      "^ and $ requires an exact match\n"
+                      "If an image does not match any list entry,\n"
+                      "it is skipped unless some list entry starts with ~");
+static DEFINE_bool2(quiet, q, false, "Don't print results as they're measured.");
+
+static std::atomic<int64_t> gAllocations{0};
+
+void* operator new(size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        SK_ABORT("codecbench: out of memory");
+    }
+    return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+struct Config {
+    SkColorType fColorType;
+    const char* fColorTypeName;
+    int         fSampleSize;
+    SkISize     fSubsetSize;    // Empty means decode the whole image.
+    int         fThreads;
+};
+
+struct Result {
+    SkString    fImage;
+    const char* fFormat;
+    Config      fConfig;
+    SkIRect     fSubset;
+    SkISize     fDstSize;
+    int64_t     fDecodes;
+    double      fMs;
+    double      fMPPerSec;
+    double      fAllocsPerDecode;
+    int         fMaxRSSMB;
+};
+
+static const char* format_name(SkEncodedImageFormat format) {
+    switch (format) {
+        case SkEncodedImageFormat::kBMP:  return "bmp";
+        case SkEncodedImageFormat::kGIF:  return "gif";
+        case SkEncodedImageFormat::kICO:  return "ico";
+        case SkEncodedImageFormat::kJPEG: return "jpeg";
+        case SkEncodedImageFormat::kPNG:  return "png";
+        case SkEncodedImageFormat::kWBMP: return "wbmp";
+        case SkEncodedImageFormat::kWEBP: return "webp";
+        case SkEncodedImageFormat::kPKM:  return "pkm";
+        case SkEncodedImageFormat::kKTX:  return "ktx";
+        case SkEncodedImageFormat::kASTC: return "astc";
+        case SkEncodedImageFormat::kDNG:  return "dng";
+        case SkEncodedImageFormat::kHEIF: return "heif";
+    }
+    return "unknown";
+}
+
+static bool parse_color_type(const char* name, SkColorType* colorType) {
+    if (0 == strcmp(name, "n32")) { *colorType = kN32_SkColorType;       return true; }
+    if (0 == strcmp(name, "f16")) { *colorType = kRGBA_F16_SkColorType;  return true; }
+    if (0 == strcmp(name, "565")) { *colorType = kRGB_565_SkColorType;   return true; }
+    if (0 == strcmp(name, "a8"))  { *colorType = kAlpha_8_SkColorType;   return true; }
+    return false;
+}
+
+// Everything one thread needs to decode one configuration of one image.
+class Decoder {
+public:
+    Decoder(sk_sp<SkData> encoded, const Config& config)
+        : fCodec(SkAndroidCodec::MakeFromData(std::move(encoded))) {
+        if (!fCodec) {
+            return;
+        }
+        const SkISize size = fCodec->getInfo().dimensions();
+        SkISize dstSize;
+        if (config.fSubsetSize.isEmpty()) {
+            fSubset = SkIRect::MakeSize(size);
+            dstSize = fCodec->getSampledDimensions(config.fSampleSize);
+        } else {
+            if (config.fSubsetSize.width()  > size.width() ||
+                config.fSubsetSize.height() > size.height()) {
+                return;
+            }
+            fSubset = SkIRect::MakeXYWH((size.width()  - config.fSubsetSize.width())  / 2,
+                                        (size.height() - config.fSubsetSize.height()) / 2,
+                                        config.fSubsetSize.width(),
+                                        config.fSubsetSize.height());
+            if (!fCodec->getSupportedSubset(&fSubset)) {
+                return;
+            }
+            dstSize = fCodec->getSampledSubsetDimensions(config.fSampleSize, fSubset);
+            fOptions.fSubset = &fSubset;
+        }
+        if (dstSize.isEmpty()) {
+            return;
+        }
+        fOptions.fSampleSize = config.fSampleSize;
+
+        const SkColorType colorType = config.fColorType;
+        fInfo = SkImageInfo::Make(dstSize.width(), dstSize.height(), colorType,
+                                  fCodec->computeOutputAlphaType(false),
+                                  fCodec->computeOutputColorSpace(colorType));
+        fRowBytes = fInfo.minRowBytes();
+        fPixels.reset(fInfo.computeByteSize(fRowBytes));
+    }
+
+    bool isValid() const { return fCodec && !fInfo.isEmpty(); }
+    const SkIRect& subset() const { return fSubset; }
+    const SkImageInfo& info() const { return fInfo; }
+    SkEncodedImageFormat format() const { return fCodec->getEncodedFormat(); }
+
+    SkCodec::Result decode() {
+        return fCodec->getAndroidPixels(fInfo, fPixels.get(), fRowBytes, &fOptions);
+    }
+
+private:
+    std::unique_ptr<SkAndroidCodec>  fCodec;
+    SkAndroidCodec::AndroidOptions   fOptions;
+    SkIRect                          fSubset = SkIRect::MakeEmpty();
+    SkImageInfo                      fInfo;
+    size_t                           fRowBytes = 0;
+    SkAutoTMalloc<char>              fPixels;
+};
+
+static bool is_success(SkCodec::Result result) {
+    return SkCodec::kSuccess == result || SkCodec::kIncompleteInput == result;
+}
+
+// Returns false if this configuration can't be decoded.
+static bool measure(const SkString& path, sk_sp<SkData> encoded, const Config& config,
+                    SkExecutor* executor, Result* result) {
+    SkTArray<std::unique_ptr<Decoder>> decoders;
+    for (int i = 0; i < config.fThreads; i++) {
+        decoders.push_back(skstd::make_unique<Decoder>(encoded, config));
+        if (!decoders.back()->isValid()) {
+            return false;
+        }
+    }
+
+    // Warm up each decoder, which also tells us whether this conversion is supported.
+    for (const auto& decoder : decoders) {
+        if (!is_success(decoder->decode())) {
+            return false;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    const auto duration = std::chrono::milliseconds(FLAGS_ms);
+    std::atomic<int64_t> decodes{0};
+    const int64_t allocationsBefore = gAllocations.load();
+    const auto start = clock::now();
+    auto work = [&](int i) {
+        Decoder* decoder = decoders[i].get();
+        int64_t count = 0;
+        do {
+            decoder->decode();
+            count++;
+        } while (clock::now() - start < duration);
+        decodes.fetch_add(count);
+    };
+    if (config.fThreads == 1) {
+        work(0);
+    } else {
+        SkTaskGroup(*executor).batch(config.fThreads, work);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    const int64_t allocations = gAllocations.load() - allocationsBefore;
+
+    const Decoder& decoder = *decoders[0];
+    result->fImage           = SkOSPath::Basename(path.c_str());
+    result->fFormat          = format_name(decoder.format());
+    result->fConfig          = config;
+    result->fSubset          = decoder.subset();
+    result->fDstSize         = decoder.info().dimensions();
+    result->fDecodes         = decodes.load();
+    result->fMs              = ms;
+    result->fMPPerSec        = (double)result->fDecodes * decoder.info().width()
+                                                        * decoder.info().height() / (ms * 1000);
+    result->fAllocsPerDecode = (double)allocations / result->fDecodes;
+    result->fMaxRSSMB        = sk_tools::getMaxResidentSetSizeMB();
+    return true;
+}
+
+static void print(const Result& r) {
+    SkString subset("full");
+    if (!r.fConfig.fSubsetSize.isEmpty()) {
+        subset.printf("%d,%d,%dx%d", r.fSubset.x(), r.fSubset.y(),
+                      r.fSubset.width(), r.fSubset.height());
+    }
+    SkDebugf("%9.2f  %8.1f  %6d  %7d  %-3s  %6d  %7d  %-18s  %s\n",
+             r.fMPPerSec, r.fAllocsPerDecode, r.fMaxRSSMB, r.fConfig.fThreads,
+             r.fConfig.fColorTypeName, r.fConfig.fSampleSize, (int)r.fDecodes,
+             subset.c_str(), r.fImage.c_str());
+}
+
+static void write_json(const char* path, const SkTArray<Result>& results) {
+    SkFILEWStream stream(path);
+    if (!stream.isValid()) {
+        SkDebugf("Couldn't open %s to write results.\n", path);
+        return;
+    }
+    SkJSONWriter writer(&stream, SkJSONWriter::Mode::kPretty);
+    writer.beginObject();
+    writer.beginArray("results");
+    for (const Result& r : results) {
+        writer.beginObject(nullptr, false);
+        writer.appendString("image", r.fImage.c_str());
+        writer.appendString("format", r.fFormat);
+        writer.appendString("colorType", r.fConfig.fColorTypeName);
+        writer.appendS32("sampleSize", r.fConfig.fSampleSize);
+        writer.appendS32("threads", r.fConfig.fThreads);
+        if (!r.fConfig.fSubsetSize.isEmpty()) {
+            writer.beginArray("subset", false);
+            writer.appendS32(r.fSubset.fLeft);
+            writer.appendS32(r.fSubset.fTop);
+            writer.appendS32(r.fSubset.fRight);
+            writer.appendS32(r.fSubset.fBottom);
+            writer.endArray();
+        }
+        writer.appendS32("width", r.fDstSize.width());
+        writer.appendS32("height", r.fDstSize.height());
+        writer.appendS64("decodes", r.fDecodes);
+        writer.appendDouble("ms", r.fMs);
+        writer.appendDouble("megapixels_per_sec", r.fMPPerSec);
+        writer.appendDouble("allocations_per_decode", r.fAllocsPerDecode);
+        writer.appendS32("max_rss_mb", r.fMaxRSSMB);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+int main(int argc, char** argv) {
+    CommandLineFlags::SetUsage("Measures decode throughput of a corpus of images.");
+    CommandLineFlags::Parse(argc, argv);
+    SkGraphics::Init();
+
+    SkTArray<SkString> images;
+    if (!CollectImages(FLAGS_images, &images)) {
+        return 1;
+    }
+
+    SkTArray<Config> configs;
+    for (int c = 0; c < FLAGS_colorTypes.count(); c++) {
+        SkColorType colorType;
+        if (!parse_color_type(FLAGS_colorTypes[c], &colorType)) {
+            SkDebugf("Can't parse %s from --colorTypes as a color type.\n", FLAGS_colorTypes[c]);
+            return 1;
+        }
+        for (int s = 0; s < FLAGS_sampleSizes.count(); s++) {
+            int sampleSize;
+            if (1 != sscanf(FLAGS_sampleSizes[s], "%d", &sampleSize) || sampleSize < 1) {
+                SkDebugf("Can't parse %s from --sampleSizes as a sample size.\n",
+                         FLAGS_sampleSizes[s]);
+                return 1;
+            }
+            for (int r = 0; r < FLAGS_subsets.count(); r++) {
+                SkISize subset = SkISize::MakeEmpty();
+                if (0 != strcmp(FLAGS_subsets[r], "full") &&
+                    (2 != sscanf(FLAGS_subsets[r], "%dx%d", &subset.fWidth, &subset.fHeight) ||
+                     subset.isEmpty())) {
+                    SkDebugf("Can't parse %s from --subsets as 'full' or WxH.\n",
+                             FLAGS_subsets[r]);
+                    return 1;
+                }
+                for (int t = 0; t < FLAGS_threads.count(); t++) {
+                    int threads;
+                    if (1 != sscanf(FLAGS_threads[t], "%d", &threads) || threads < 1) {
+                        SkDebugf("Can't parse %s from --threads as a thread count.\n",
+                                 FLAGS_threads[t]);
+                        return 1;
+                    }
+                    configs.push_back({colorType, FLAGS_colorTypes[c], sampleSize, subset,
+                                       threads});
+                }
+            }
+        }
+    }
+
+    int maxThreads = 1;
+    for (const Config& config : configs) {
+        maxThreads = SkTMax(maxThreads, config.fThreads);
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(maxThreads);
+
+    if (!FLAGS_quiet) {
+        SkDebugf("     MP/s  allocs/d  maxrss  threads  ct   sample  decodes  subset"
+                 "              image\n");
+    }
+    SkTArray<Result> results;
+    for (const SkString& path : images) {
+        if (CommandLineFlags::ShouldSkip(FLAGS_match, SkOSPath::Basename(path.c_str()).c_str())) {
+            continue;
+        }
+        sk_sp<SkData> encoded = SkData::MakeFromFileName(path.c_str());
+        if (!encoded) {
+            SkDebugf("Couldn't read %s.\n", path.c_str());
+            continue;
+        }
+        for (const Config& config : configs) {
+            Result result;
+            if (measure(path, encoded, config, executor.get(), &result)) {
+                if (!FLAGS_quiet) {
+                    print(result);
+                }
+                results.push_back(result);
+            }
+        }
+    }
+
+    if (!FLAGS_json.isEmpty()) {
+        write_json(FLAGS_json[0], results);
+    }
+    return 0;
+}
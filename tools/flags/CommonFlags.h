@@ -36,6 +36,7 @@ bool CollectImages(CommandLineFlags::StringArray dir, SkTArray<SkString>* output
 void SetCtxOptionsFromCommonFlags(struct GrContextOptions*);
 
 /**
- *  Enable, disable, or force analytic anti-aliasing using --analyticAA and --forceAnalyticAA.
+ *  Enable, disable, or force analytic anti-aliasing using --analyticAA and --forceAnalyticAA,
+ *  and sparse strip anti-aliasing using --sparseStripAA and --forceSparseStripAA.
  */
 void SetAnalyticAAFromCommonFlags();
@@ -9,8 +9,14 @@ static DEFINE_bool(forceAnalyticAA, false,
             "Force analytic anti-aliasing even if the path is complicated: "
             "whether it's concave or convex, we consider a path complicated"
             "if its number of points is comparable to its resolution.");
+static DEFINE_bool(sparseStripAA, false,
+            "If true, fill paths with very many points using sparse strip anti-aliasing.");
+static DEFINE_bool(forceSparseStripAA, false,
+            "Force sparse strip anti-aliasing for every anti-aliased path fill it can handle.");
 
 void SetAnalyticAAFromCommonFlags() {
-    gSkUseAnalyticAA   = FLAGS_analyticAA;
-    gSkForceAnalyticAA = FLAGS_forceAnalyticAA;
+    gSkUseAnalyticAA      = FLAGS_analyticAA;
+    gSkForceAnalyticAA    = FLAGS_forceAnalyticAA;
+    gSkUseSparseStripAA   = FLAGS_sparseStripAA;
+    gSkForceSparseStripAA = FLAGS_forceSparseStripAA;
 }